@@ -271,9 +271,24 @@ bool DjvuApplication::flip(int direction)
     return down_cast<DjvuView*>(reading_view)->flip(direction);
 }
 
+QString DjvuApplication::cacheStatistics()
+{
+    QWidget* reading_view = main_window_.getView(DJVU_VIEW);
+    if (reading_view == 0)
+    {
+        return QString();
+    }
+    return down_cast<DjvuView*>(reading_view)->cacheStatistics();
+}
+
 bool DjvuApplicationAdaptor::flip(int direction)
 {
     return app_->flip(direction);
 }
 
+QString DjvuApplicationAdaptor::cacheStatistics()
+{
+    return app_->cacheStatistics();
+}
+
 }
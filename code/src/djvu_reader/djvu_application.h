@@ -45,6 +45,7 @@ public Q_SLOTS:
     void onScreenSizeChanged(int);
 
     bool flip(int);
+    QString cacheStatistics();
 
 private:
     MainWindow main_window_;
@@ -78,6 +79,7 @@ public Q_SLOTS:
     bool close(const QString & path) { return app_->close(path); }
 
     bool flip(int);
+    QString cacheStatistics();
 
 private:
     DjvuApplication *app_;
@@ -6,6 +6,39 @@
 namespace djvu_reader
 {
 
+static const long MIN_CACHE_SIZE = 8*1024*1024;
+static const long MAX_CACHE_SIZE = 64*1024*1024;
+static const long DEFAULT_CACHE_SIZE = 30*1024*1024;
+
+/* Returns the memory which can be claimed without swapping, in bytes,
+   or zero if it is unknown. Old kernels have no MemAvailable entry. */
+
+static long
+availableMemory()
+{
+  QFile file("/proc/meminfo");
+  if (! file.open(QIODevice::ReadOnly))
+    return 0;
+
+  long available = -1;
+  long free_memory = 0;
+  QByteArray line;
+  while (! (line = file.readLine()).isEmpty())
+    {
+      QList<QByteArray> fields = line.simplified().split(' ');
+      if (fields.size() < 2)
+        continue;
+      long kb = fields[1].toLong();
+      if (fields[0] == "MemAvailable:")
+        available = kb;
+      else if (fields[0] == "MemFree:" ||
+               fields[0] == "Buffers:" ||
+               fields[0] == "Cached:")
+        free_memory += kb;
+    }
+  return (available >= 0 ? available : free_memory) * 1024;
+}
+
 // ----------------------------------------
 // QDJVUCONTEXT
 
@@ -32,7 +65,7 @@ QDjVuContext::QDjVuContext(const char *programname, QObject *parent)
 {
   context = ddjvu_context_create(programname);
   ddjvu_message_set_callback(context, callback, (void*)this);
-  ddjvu_cache_set_size(context, 30*1024*1024);
+  ddjvu_cache_set_size(context, defaultCacheSize());
 }
 
 QDjVuContext::~QDjVuContext()
@@ -43,7 +76,8 @@ QDjVuContext::~QDjVuContext()
 
 /*! \property QDjVuContext::cacheSize
     \brief The size of the decoded page cache in bytes. 
-    The default cache size is 30 megabytes. */
+    The default cache size is a quarter of the available memory,
+    between 8 and 64 megabytes. */
 
 long 
 QDjVuContext::cacheSize() const
@@ -57,6 +91,43 @@ QDjVuContext::setCacheSize(long size)
   ddjvu_cache_set_size(context, size);
 }
 
+/*! Returns the default size of the decoded page cache.
+    Environment variable \a DJVU_CACHE_SIZE overrides
+    it with a size in megabytes. */
+
+long
+QDjVuContext::defaultCacheSize()
+{
+  bool ok = false;
+  long size = qgetenv("DJVU_CACHE_SIZE").toLong(&ok);
+  if (ok && size > 0)
+    return size * 1024 * 1024;
+
+  long available = availableMemory();
+  if (available <= 0)
+    return DEFAULT_CACHE_SIZE;
+  return qBound(MIN_CACHE_SIZE, available / 4, MAX_CACHE_SIZE);
+}
+
+/*! Returns the counters of the decoded page cache
+    as a human readable string. */
+
+QString
+QDjVuContext::cacheStatistics() const
+{
+  ddjvu_cachestats_t stats;
+  ddjvu_cache_get_stats(context, &stats);
+  unsigned long lookups = stats.hits + stats.misses;
+  return QString("file cache: hits %1 misses %2 (%3%) evictions %4 files %5 bytes %6 / %7")
+    .arg(stats.hits)
+    .arg(stats.misses)
+    .arg(lookups ? stats.hits * 100 / lookups : 0)
+    .arg(stats.evictions)
+    .arg(stats.files)
+    .arg(stats.size)
+    .arg(cacheSize());
+}
+
 void 
 QDjVuContext::callback(ddjvu_context_t *, void *closure)
 {
@@ -24,6 +24,8 @@ public:
     QDjVuContext(const char *programname=0, QObject *parent=0);
     long cacheSize() const;
     void setCacheSize(long);
+    QString cacheStatistics() const;
+    static long defaultCacheSize();
     virtual bool event(QEvent*);
     operator ddjvu_context_t*() { return context; }
   
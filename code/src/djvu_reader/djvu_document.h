@@ -63,6 +63,7 @@ public:
     void streamWrite(int stream_id, const char *data, unsigned long len );
     void streamClose(int stream_id, bool stop = false);
     operator ddjvu_document_t*() { return document_; }
+    QDjVuContext & context() { return ctx_; }
     virtual bool isValid() { return document_ != 0; }
 
     int runningProcesses(void);
@@ -37,6 +37,7 @@ QDjVuPage::QDjVuPage(QDjVuDocument *doc, int page_no, QObject *parent)
   , content_area_needed_(false)
   , is_ready_(false)
   , is_thumbnail_(false)
+  , is_coarse_(false)
   , thumbnail_direction_(THUMBNAIL_RENDER_INVALID)
 {
     initialColorTable();
@@ -120,9 +121,11 @@ bool QDjVuPage::handle(ddjvu_message_t *msg)
     return false;
 }
 
-bool QDjVuPage::implRender(const RenderSetting & setting, ddjvu_format_t * render_format)
+/// Render the page. A coarse render uses the data decoded so far, ddjvu
+/// fails to render when there is not enough data yet.
+bool QDjVuPage::implRender(const RenderSetting & setting, ddjvu_format_t * render_format, bool coarse)
 {
-    if (isReady() && isDecodeDone())
+    if (isReady() && (isDecodeDone() || coarse))
     {
         ddjvu_rect_t page_rect = {0, 0, setting.contentArea().width(), setting.contentArea().height()};
         ddjvu_rect_t render_rect = page_rect;
@@ -139,14 +142,19 @@ bool QDjVuPage::implRender(const RenderSetting & setting, ddjvu_format_t * rende
         if (ret > 0)
         {
             image_ = image;
-            render_needed_ = false;
+            is_coarse_ = !isDecodeDone();
+
+            // a coarse image still needs the final render
+            render_needed_ = is_coarse_;
             return true;
         }
+    }
 
-        if (!image_.isNull())
-        {
-            image_ = QImage();
-        }
+    // keep displaying the coarse image until the final one is ready
+    if (!image_.isNull() && !(is_coarse_ && image_.size() == setting.contentArea().size()))
+    {
+        image_ = QImage();
+        is_coarse_ = false;
     }
     render_needed_ = true;
     return false;
@@ -154,7 +162,7 @@ bool QDjVuPage::implRender(const RenderSetting & setting, ddjvu_format_t * rende
 
 bool QDjVuPage::render(const RenderSetting & setting, ddjvu_format_t * render_format)
 {
-    if (render_setting_ != setting || image_.isNull())
+    if (render_setting_ != setting || image_.isNull() || is_coarse_)
     {
         // re-render the page
         render_setting_ = setting;
@@ -168,6 +176,11 @@ bool QDjVuPage::render(ddjvu_format_t * render_format)
     return implRender(render_setting_, render_format);
 }
 
+bool QDjVuPage::renderCoarse(ddjvu_format_t * render_format)
+{
+    return implRender(render_setting_, render_format, true);
+}
+
 void QDjVuPage::lock()
 {
 }
@@ -202,6 +215,11 @@ bool QDjVuPage::isDecodeDone()
     return ret;
 }
 
+bool QDjVuPage::isDecoding()
+{
+    return ddjvu_page_decoding_status(page_) == DDJVU_JOB_STARTED;
+}
+
 QRect QDjVuPage::contentArea(int page_no)
 {
     if (QDjVuPage::content_areas_.contains(page_no))
@@ -398,7 +416,10 @@ static void expandContentArea(const int page_width,
     }
 }
 
-QRect QDjVuPage::getContentArea(ddjvu_format_t * render_format)
+/// Get the content area of the page. A provisional content area is estimated
+/// from the data decoded so far, it is not cached and the content area is
+/// still needed until the page is decoded.
+QRect QDjVuPage::getContentArea(ddjvu_format_t * render_format, bool provisional)
 {
     content_area_needed_ = false;
     QRect content_area = QDjVuPage::contentArea(page_no_);
@@ -410,9 +431,23 @@ QRect QDjVuPage::getContentArea(ddjvu_format_t * render_format)
     if (!isReady() || !isDecodeDone())
     {
         content_area_needed_ = true;
-        return content_area;
+        if (provisional && isReady() && detectContentArea(render_format, content_area))
+        {
+            provisional_area_ = content_area;
+            return content_area;
+        }
+        return QRect();
+    }
+
+    if (detectContentArea(render_format, content_area))
+    {
+        QDjVuPage::content_areas_[page_no_] = content_area;
     }
+    return content_area;
+}
 
+bool QDjVuPage::detectContentArea(ddjvu_format_t * render_format, QRect & content_area)
+{
     // intialize the content area
     content_area.setTopLeft(QPoint(0, 0));
     content_area.setSize(info_.page_size);
@@ -451,9 +486,9 @@ QRect QDjVuPage::getContentArea(ddjvu_format_t * render_format)
         content_area.setBottomRight(QPoint(
             static_cast<ZoomFactor>(content_area.right()) / zoom,
             static_cast<ZoomFactor>(content_area.bottom()) / zoom));
-        QDjVuPage::content_areas_[page_no_] = content_area;
+        return true;
     }
-    return content_area;
+    return false;
 }
 
 PageTextEntities & QDjVuPage::pageTextEntities(int page_no, bool & existed)
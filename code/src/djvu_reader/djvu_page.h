@@ -120,12 +120,16 @@ public:
     QImage * image() { return &image_; }
 
     bool isDecodeDone();
+    bool isDecoding();
+    bool isCoarse() { return is_coarse_; }
     int  pageNum();
 
     const RenderSetting & renderSetting() const { return render_setting_; }
     bool render(const RenderSetting & setting, ddjvu_format_t * render_format);
     bool render(ddjvu_format_t * render_format);
-    QRect getContentArea(ddjvu_format_t * render_format);
+    bool renderCoarse(ddjvu_format_t * render_format);
+    QRect getContentArea(ddjvu_format_t * render_format, bool provisional = false);
+    const QRect & provisionalContentArea() const { return provisional_area_; }
 
     void lock();
     void unlock();
@@ -146,7 +150,8 @@ Q_SIGNALS:
     void contentAreaReady(const QRect & content_area);
 
 private:
-    bool implRender(const RenderSetting & setting, ddjvu_format_t * render_format);
+    bool implRender(const RenderSetting & setting, ddjvu_format_t * render_format, bool coarse = false);
+    bool detectContentArea(ddjvu_format_t * render_format, QRect & content_area);
     void updateInfo();
 
     static QRect contentArea(int page_no);
@@ -164,8 +169,10 @@ private:
     bool                        content_area_needed_;
     bool                        is_ready_;
     bool                        is_thumbnail_;
+    bool                        is_coarse_;          ///< image rendered from partially decoded data
     ThumbnailRenderDirection    thumbnail_direction_;
     RenderSetting               render_setting_;
+    QRect                       provisional_area_;   ///< content area estimated while decoding
     DjvuPageInfo                info_;
     QImage                      image_;
     static ContentAreaMap       content_areas_;
@@ -0,0 +1,993 @@
+// The libdjvu headers must come before ddjvuapi.h to get the backdoor
+// ddjvu_get_DjVuImage() declared.
+#include "libdjvu/DjVuImage.h"
+#include "libdjvu/JB2Image.h"
+
+#include <algorithm>
+#include <climits>
+#include <math.h>
+
+#include "djvu_reflow.h"
+#include "djvu_document.h"
+
+namespace djvu_reader
+{
+
+static const int    REFLOW_CACHE_PAGES  = 16;   ///< segmented pages kept in memory
+static const int    REFLOW_PREFETCH     = 2;    ///< pages segmented ahead of the current one
+static const int    REFLOW_TEXT_HEIGHT  = 24;   ///< screen height of the median component
+static const int    REFLOW_MARGIN       = 16;   ///< screen margin in pixels
+static const int    REFLOW_MAX_PIXELS   = 2 * 1024 * 1024;  ///< size limit of the rendered image
+static const int    MAX_CUT_DEPTH       = 32;
+
+// Segmentation and layout thresholds, in units of the median component height
+static const double COLUMN_GAP          = 1.5;  ///< minimal gutter between columns
+static const double SECTION_GAP         = 1.5;  ///< minimal gap between text blocks
+static const double THIN_LINE           = 0.5;  ///< lines lower than this are accents, dots...
+static const double FIGURE_HEIGHT       = 4.0;  ///< lines higher than this are figures
+static const double WORD_GAP            = 0.35; ///< minimal gap between words
+static const double PARAGRAPH_INDENT    = 1.0;  ///< minimal indent of a first line
+static const double SHORT_LINE          = 4.0;  ///< space left by the last line of a paragraph
+static const double WORD_SPACE          = 0.5;
+static const double LINE_SPACE          = 0.4;
+
+static QVector<QRgb> GREY_TABLE;
+
+static void initialGreyTable()
+{
+    if (GREY_TABLE.size() <= 0)
+    {
+        for(int i = 0; i < 256; ++i)
+        {
+            GREY_TABLE.push_back(qRgba(i, i, i, 255));
+        }
+    }
+}
+
+/// Split a block of components at the gaps of their projection onto one axis.
+/// Parts are returned left to right (or top to bottom).
+static bool splitBlock(const QVector<QRect> & comps,
+                       const QVector<int> & block,
+                       bool along_x,
+                       int min_gap,
+                       QVector< QVector<int> > & parts)
+{
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int i = 0; i < block.size(); ++i)
+    {
+        const QRect & r = comps[block[i]];
+        lo = std::min(lo, along_x ? r.left() : r.top());
+        hi = std::max(hi, along_x ? r.right() : r.bottom());
+    }
+
+    // coverage of the projection, stored as differences
+    QVector<int> cover(hi - lo + 2, 0);
+    for (int i = 0; i < block.size(); ++i)
+    {
+        const QRect & r = comps[block[i]];
+        cover[(along_x ? r.left() : r.top()) - lo]++;
+        cover[(along_x ? r.right() : r.bottom()) - lo + 1]--;
+    }
+
+    // cuts are the first coordinates after the gaps
+    std::vector<int> cuts;
+    int depth = 0;
+    int gap = -1;
+    for (int p = 0; p <= hi - lo; ++p)
+    {
+        depth += cover[p];
+        if (depth == 0)
+        {
+            if (gap < 0)
+            {
+                gap = p;
+            }
+        }
+        else if (gap >= 0)
+        {
+            if (p - gap >= min_gap)
+            {
+                cuts.push_back(lo + p);
+            }
+            gap = -1;
+        }
+    }
+
+    if (cuts.empty())
+    {
+        return false;
+    }
+
+    // components never straddle a gap
+    parts.clear();
+    parts.resize(cuts.size() + 1);
+    for (int i = 0; i < block.size(); ++i)
+    {
+        const QRect & r = comps[block[i]];
+        int start = along_x ? r.left() : r.top();
+        int part = std::upper_bound(cuts.begin(), cuts.end(), start) - cuts.begin();
+        parts[part].push_back(block[i]);
+    }
+    return true;
+}
+
+/// Recursive XY-cut. Columns are tried before sections, so that the text of
+/// two columns with aligned sections is not interleaved.
+static void cutBlock(const QVector<QRect> & comps,
+                     const QVector<int> & block,
+                     int text_height,
+                     QVector< QVector<int> > & leaves,
+                     int depth)
+{
+    if (depth < MAX_CUT_DEPTH && block.size() > 1)
+    {
+        QVector< QVector<int> > parts;
+        if (splitBlock(comps, block, true, qRound(text_height * COLUMN_GAP), parts) ||
+            splitBlock(comps, block, false, qRound(text_height * SECTION_GAP), parts))
+        {
+            for (int i = 0; i < parts.size(); ++i)
+            {
+                cutBlock(comps, parts[i], text_height, leaves, depth + 1);
+            }
+            return;
+        }
+    }
+    leaves.push_back(block);
+}
+
+static QRect boundingBox(const QVector<QRect> & comps, const QVector<int> & block)
+{
+    QRect box;
+    for (int i = 0; i < block.size(); ++i)
+    {
+        box |= comps[block[i]];
+    }
+    return box;
+}
+
+static void addFigure(ReflowPage & page, const QRect & area)
+{
+    ReflowWord word;
+    word.area   = area;
+    word.top    = area.top();
+    word.bottom = area.bottom();
+    word.flags  = ReflowWord::NEW_PARAGRAPH | ReflowWord::FIGURE;
+    page.words.push_back(word);
+}
+
+static bool lessLeft(const QRect & a, const QRect & b)
+{
+    return a.left() < b.left();
+}
+
+/// Cut a leaf block into lines and words
+static void addBlock(const QVector<QRect> & comps,
+                     const QVector<int> & block,
+                     int text_height,
+                     bool new_paragraph,
+                     ReflowPage & page)
+{
+    QVector< QVector<int> > lines;
+    if (!splitBlock(comps, block, false, 1, lines))
+    {
+        lines.clear();
+        lines.push_back(block);
+    }
+
+    QVector<QRect> boxes;
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        boxes.push_back(boundingBox(comps, lines[i]));
+    }
+
+    // merge accents, dots and dashes standing alone into the closest line
+    const int thin = qRound(text_height * THIN_LINE);
+    int i = 0;
+    while (i < lines.size() && lines.size() > 1)
+    {
+        if (boxes[i].height() >= thin)
+        {
+            ++i;
+            continue;
+        }
+
+        int above = i > 0 ? boxes[i].top() - boxes[i - 1].bottom() : INT_MAX;
+        int below = i + 1 < lines.size() ? boxes[i + 1].top() - boxes[i].bottom() : INT_MAX;
+        int target = above <= below ? i - 1 : i + 1;
+        if (std::min(above, below) > text_height)
+        {
+            ++i;
+            continue;
+        }
+
+        lines[target] += lines[i];
+        boxes[target] |= boxes[i];
+        lines.remove(i);
+        boxes.remove(i);
+        if (target < i)
+        {
+            --i;
+        }
+    }
+
+    const QRect block_box = boundingBox(comps, block);
+    const int word_gap = qRound(text_height * WORD_GAP);
+    bool previous_figure = false;
+    for (i = 0; i < lines.size(); ++i)
+    {
+        const QRect & box = boxes[i];
+        if (box.height() > text_height * FIGURE_HEIGHT)
+        {
+            addFigure(page, box);
+            previous_figure = true;
+            continue;
+        }
+
+        bool paragraph = previous_figure ||
+                         box.left() - block_box.left() > text_height * PARAGRAPH_INDENT;
+        if (i == 0)
+        {
+            paragraph = paragraph || new_paragraph;
+        }
+        else
+        {
+            paragraph = paragraph || block_box.right() - boxes[i - 1].right() > text_height * SHORT_LINE;
+        }
+        previous_figure = false;
+
+        QVector<QRect> line;
+        for (int j = 0; j < lines[i].size(); ++j)
+        {
+            line.push_back(comps[lines[i][j]]);
+        }
+        std::sort(line.begin(), line.end(), lessLeft);
+
+        ReflowWord word;
+        word.top    = box.top();
+        word.bottom = box.bottom();
+        word.flags  = paragraph ? ReflowWord::NEW_PARAGRAPH : 0;
+        word.area   = line.front();
+        for (int j = 1; j < line.size(); ++j)
+        {
+            if (line[j].left() - word.area.right() - 1 > word_gap)
+            {
+                page.words.push_back(word);
+                word.flags = 0;
+                word.area  = line[j];
+            }
+            else
+            {
+                word.area |= line[j];
+            }
+        }
+        page.words.push_back(word);
+    }
+}
+
+static QRect scaleRect(const QRect & rect, double zoom)
+{
+    int left   = static_cast<int>(rect.left() * zoom);
+    int top    = static_cast<int>(rect.top() * zoom);
+    int right  = static_cast<int>(ceil((rect.right() + 1) * zoom));
+    int bottom = static_cast<int>(ceil((rect.bottom() + 1) * zoom));
+    return QRect(left, top, std::max(right - left, 1), std::max(bottom - top, 1));
+}
+
+// ----------------------------------------
+// ReflowWorker
+
+ReflowWorker::ReflowWorker(QObject *parent)
+    : QThread(parent)
+    , stop_(false)
+{
+}
+
+ReflowWorker::~ReflowWorker()
+{
+    stop();
+    wait();
+}
+
+/// Queue a page for segmentation. Urgent jobs are processed first.
+void ReflowWorker::addJob(const ReflowJob & job, bool urgent)
+{
+    QMutexLocker locker(&mutex_);
+    if (urgent)
+    {
+        jobs_.prepend(job);
+    }
+    else
+    {
+        jobs_.enqueue(job);
+    }
+
+    if (!isRunning())
+    {
+        start(QThread::LowPriority);
+    }
+    wait_.wakeOne();
+}
+
+bool ReflowWorker::takeResult(ReflowPagePtr & result)
+{
+    QMutexLocker locker(&mutex_);
+    if (results_.isEmpty())
+    {
+        return false;
+    }
+    result = results_.dequeue();
+    return true;
+}
+
+/// Drop the queued jobs and the results not taken yet. A job being
+/// segmented still delivers its result.
+void ReflowWorker::clear()
+{
+    QMutexLocker locker(&mutex_);
+    jobs_.clear();
+    results_.clear();
+}
+
+void ReflowWorker::stop()
+{
+    QMutexLocker locker(&mutex_);
+    stop_ = true;
+    jobs_.clear();
+    wait_.wakeOne();
+}
+
+void ReflowWorker::run()
+{
+    forever
+    {
+        ReflowJob job;
+        {
+            QMutexLocker locker(&mutex_);
+            while (jobs_.isEmpty() && !stop_)
+            {
+                wait_.wait(&mutex_);
+            }
+            if (stop_)
+            {
+                return;
+            }
+            job = jobs_.dequeue();
+        }
+
+        ReflowPagePtr result = segment(job);
+        {
+            QMutexLocker locker(&mutex_);
+            results_.enqueue(result);
+        }
+        emit resultReady();
+    }
+}
+
+/// Segment the components of a page into words, in reading order.
+/// Pages without text components are reflowed as one figure.
+ReflowPagePtr ReflowWorker::segment(const ReflowJob & job)
+{
+    ReflowPagePtr page(new ReflowPage);
+    page->page_no    = job.page_no;
+    page->generation = job.generation;
+    page->page_size  = job.page_size;
+
+    // drop the specks
+    QVector<QRect> comps;
+    comps.reserve(job.components.size());
+    for (int i = 0; i < job.components.size(); ++i)
+    {
+        const QRect & r = job.components[i];
+        if (r.width() > 2 || r.height() > 2)
+        {
+            comps.push_back(r);
+        }
+    }
+
+    if (comps.isEmpty())
+    {
+        addFigure(*page, QRect(QPoint(0, 0), job.page_size));
+        return page;
+    }
+
+    std::vector<int> heights(comps.size());
+    for (int i = 0; i < comps.size(); ++i)
+    {
+        heights[i] = comps[i].height();
+    }
+    std::nth_element(heights.begin(), heights.begin() + heights.size() / 2, heights.end());
+    page->text_height = std::max(heights[heights.size() / 2], 4);
+
+    QVector<int> all(comps.size());
+    for (int i = 0; i < comps.size(); ++i)
+    {
+        all[i] = i;
+    }
+
+    QVector< QVector<int> > leaves;
+    cutBlock(comps, all, page->text_height, leaves, 0);
+
+    // a block starts a paragraph unless it continues the previous one
+    // on the same lines or in the next column
+    int previous_bottom = INT_MIN;
+    for (int i = 0; i < leaves.size(); ++i)
+    {
+        QRect box = boundingBox(comps, leaves[i]);
+        addBlock(comps, leaves[i], page->text_height, box.top() > previous_bottom, *page);
+        previous_bottom = box.bottom();
+    }
+    return page;
+}
+
+// ----------------------------------------
+// DjvuReflow
+
+DjvuReflow::DjvuReflow()
+    : doc_(0)
+    , page_count_(0)
+    , render_format_(0)
+    , generation_(0)
+    , scale_(1.0)
+    , zoom_(1.0)
+    , cur_page_(-1)
+    , cur_screen_(0)
+    , last_screen_(false)
+    , image_zoom_(1.0)
+{
+    initialGreyTable();
+    render_format_ = ddjvu_format_create(DDJVU_FORMAT_GREY8, 0, 0);
+    ddjvu_format_set_row_order(render_format_, true);
+    ddjvu_format_set_y_direction(render_format_, true);
+    ddjvu_format_set_gamma(render_format_, 2.2);
+
+    connect(&worker_, SIGNAL(resultReady()), this, SLOT(onResultReady()));
+}
+
+DjvuReflow::~DjvuReflow()
+{
+    deattachDocument();
+    if (render_format_ != 0)
+    {
+        ddjvu_format_release(render_format_);
+    }
+}
+
+void DjvuReflow::attachDocument(QDjVuDocument *doc, int page_count)
+{
+    deattachDocument();
+    doc_ = doc;
+    page_count_ = page_count;
+}
+
+/// Forget all pages of the document. Results of jobs sent before are
+/// recognized by their generation and dropped.
+void DjvuReflow::deattachDocument()
+{
+    ++generation_;
+    worker_.clear();
+    pending_.clear();
+    pages_.clear();
+    cache_.clear();
+    lru_.clear();
+    screens_.clear();
+    image_ = QImage();
+    doc_ = 0;
+    page_count_ = 0;
+    cur_page_ = -1;
+}
+
+void DjvuReflow::setScreenSize(const QSize & size)
+{
+    if (screen_size_ == size)
+    {
+        return;
+    }
+    screen_size_ = size;
+    screens_.clear();
+    updateScreens();
+}
+
+void DjvuReflow::setScale(double scale)
+{
+    if (scale_ == scale)
+    {
+        return;
+    }
+    scale_ = scale;
+    screens_.clear();
+    updateScreens();
+}
+
+/// Display the page as soon as it has been segmented. The neighbour pages
+/// are segmented in the background.
+void DjvuReflow::showPage(int page_no, bool last_screen)
+{
+    if (doc_ == 0 || page_no < 0 || page_no >= page_count_)
+    {
+        return;
+    }
+
+    if (page_no != cur_page_)
+    {
+        cur_page_ = page_no;
+        screens_.clear();
+        image_ = QImage();
+    }
+    last_screen_ = last_screen;
+
+    // release the decoded pages which are not needed any more
+    DjvuPageIter idx = pages_.begin();
+    while (idx != pages_.end())
+    {
+        if (idx.key() < page_no || idx.key() > page_no + REFLOW_PREFETCH)
+        {
+            idx = pages_.erase(idx);
+        }
+        else
+        {
+            ++idx;
+        }
+    }
+
+    if (!screens_.isEmpty())
+    {
+        cur_screen_ = last_screen_ ? screens_.size() - 1 : 0;
+        renderScreen();
+        emit screenReady(cur_page_);
+    }
+    else
+    {
+        requirePage(page_no, true);
+        updateScreens();
+    }
+
+    for (int i = 1; i <= REFLOW_PREFETCH && page_no + i < page_count_; ++i)
+    {
+        requirePage(page_no + i, false);
+    }
+}
+
+/// Display the next screen of the current page. Returns false and keeps
+/// the current screen when there is no next screen or it cannot be rendered,
+/// so that the caller can move to the next page.
+bool DjvuReflow::nextScreen()
+{
+    if (cur_screen_ + 1 >= screens_.size())
+    {
+        return false;
+    }
+    return moveToScreen(cur_screen_ + 1);
+}
+
+/// Display the previous screen of the current page, see nextScreen()
+bool DjvuReflow::previousScreen()
+{
+    if (cur_screen_ <= 0 || screens_.isEmpty())
+    {
+        return false;
+    }
+    return moveToScreen(cur_screen_ - 1);
+}
+
+bool DjvuReflow::moveToScreen(int screen)
+{
+    const int previous = cur_screen_;
+    cur_screen_ = screen;
+    if (renderScreen())
+    {
+        return true;
+    }
+    cur_screen_ = previous;
+    renderScreen();
+    return false;
+}
+
+void DjvuReflow::paint(QPainter & painter, const QRect & rect)
+{
+    painter.fillRect(rect, Qt::white);
+    if (screens_.isEmpty() || image_.isNull())
+    {
+        return;
+    }
+
+    const ReflowScreen & screen = screens_[cur_screen_];
+    for (int i = 0; i < screen.size(); ++i)
+    {
+        const QRect & s = screen[i].source;
+        QRectF source(s.x() * image_zoom_ - image_origin_.x(),
+                      s.y() * image_zoom_ - image_origin_.y(),
+                      s.width() * image_zoom_,
+                      s.height() * image_zoom_);
+        painter.drawImage(QRectF(screen[i].target), image_, source);
+    }
+}
+
+void DjvuReflow::onPageInfo(QDjVuPage * from)
+{
+    handlePageDecoded(from);
+}
+
+void DjvuReflow::onRedisplay(QDjVuPage * from)
+{
+    handlePageDecoded(from);
+}
+
+void DjvuReflow::onResultReady()
+{
+    ReflowPagePtr result;
+    while (worker_.takeResult(result))
+    {
+        // the page belongs to a document detached since
+        if (result->generation != generation_)
+        {
+            continue;
+        }
+
+        pending_.remove(result->page_no);
+        if (doc_ == 0)
+        {
+            continue;
+        }
+
+        cachePage(result);
+        if (result->page_no == cur_page_)
+        {
+            updateScreens();
+        }
+    }
+}
+
+DjVuPagePtr DjvuReflow::getPage(int page_no)
+{
+    if (!pages_.contains(page_no))
+    {
+        DjVuPagePtr new_page(new QDjVuPage(doc_, page_no));
+        connect(new_page.get(), SIGNAL(pageInfo(QDjVuPage *)), this, SLOT(onPageInfo(QDjVuPage *)));
+        connect(new_page.get(), SIGNAL(redisplay(QDjVuPage *)), this, SLOT(onRedisplay(QDjVuPage *)));
+        pages_[page_no] = new_page;
+    }
+    return pages_[page_no];
+}
+
+/// Make sure the page is decoded and segmented
+void DjvuReflow::requirePage(int page_no, bool urgent)
+{
+    if (pending_.contains(page_no))
+    {
+        return;
+    }
+
+    // the current page is decoded again for rendering
+    if (cache_.contains(page_no) && page_no != cur_page_)
+    {
+        return;
+    }
+
+    DjVuPagePtr page = getPage(page_no);
+    if (page->isReady() && page->isDecodeDone())
+    {
+        handlePageDecoded(page.get(), urgent);
+    }
+}
+
+void DjvuReflow::handlePageDecoded(QDjVuPage * page, bool urgent)
+{
+    if (!page->isReady() || !page->isDecodeDone())
+    {
+        return;
+    }
+
+    int page_no = page->pageNum();
+    if (page_no == cur_page_)
+    {
+        urgent = true;
+    }
+
+    if (!cache_.contains(page_no) && !pending_.contains(page_no))
+    {
+        ReflowJob job;
+        job.page_no = page_no;
+        job.generation = generation_;
+        collectComponents(page, job);
+        pending_.insert(page_no);
+        worker_.addJob(job, urgent);
+    }
+
+    if (page_no == cur_page_)
+    {
+        updateScreens();
+    }
+}
+
+/// Copy the bounding boxes of the JB2 blits. This is done in the GUI thread,
+/// the worker only gets plain rectangles.
+bool DjvuReflow::collectComponents(QDjVuPage * page, ReflowJob & job)
+{
+    job.page_size = QSize(ddjvu_page_get_width(*page), ddjvu_page_get_height(*page));
+
+    bool ret = false;
+    G_TRY
+    {
+        GP<DjVuImage> image = ddjvu_get_DjVuImage(*page);
+        GP<JB2Image> jb2 = image ? image->get_fgjb() : GP<JB2Image>();
+        if (jb2 &&
+            image->get_rotate() == 0 &&
+            jb2->get_width() == job.page_size.width() &&
+            jb2->get_height() == job.page_size.height())
+        {
+            int height = jb2->get_height();
+            int count = jb2->get_blit_count();
+            job.components.reserve(count);
+            for (int i = 0; i < count; ++i)
+            {
+                const JB2Blit *blit = jb2->get_blit(i);
+                const JB2Shape & shape = jb2->get_shape(blit->shapeno);
+                if (!shape.bits)
+                {
+                    continue;
+                }
+
+                int w = shape.bits->columns();
+                int h = shape.bits->rows();
+                job.components.push_back(QRect(blit->left, height - blit->bottom - h, w, h));
+            }
+            ret = true;
+        }
+    }
+    G_CATCH_ALL
+    {
+        job.components.clear();
+    }
+    G_ENDCATCH;
+    return ret;
+}
+
+ReflowPagePtr DjvuReflow::cachedPage(int page_no)
+{
+    ReflowPages::iterator idx = cache_.find(page_no);
+    if (idx == cache_.end())
+    {
+        return ReflowPagePtr();
+    }
+    lru_.removeAll(page_no);
+    lru_.push_back(page_no);
+    return idx.value();
+}
+
+void DjvuReflow::cachePage(ReflowPagePtr page)
+{
+    cache_[page->page_no] = page;
+    lru_.removeAll(page->page_no);
+    lru_.push_back(page->page_no);
+    while (lru_.size() > REFLOW_CACHE_PAGES)
+    {
+        cache_.remove(lru_.takeFirst());
+    }
+}
+
+/// Lay out and render the current page if it is segmented and decoded
+void DjvuReflow::updateScreens()
+{
+    if (!screens_.isEmpty() || cur_page_ < 0 || !screen_size_.isValid())
+    {
+        return;
+    }
+
+    if (!cache_.contains(cur_page_) || !pages_.contains(cur_page_))
+    {
+        return;
+    }
+
+    DjVuPagePtr page = pages_[cur_page_];
+    if (!page->isReady() || !page->isDecodeDone())
+    {
+        return;
+    }
+
+    layoutPage();
+    cur_screen_ = last_screen_ ? screens_.size() - 1 : 0;
+    if (!renderScreen())
+    {
+        screens_.clear();
+        return;
+    }
+    emit screenReady(cur_page_);
+}
+
+/// Flow the words of the current page into screens. Words of a line are
+/// aligned on the bottom of their original lines.
+void DjvuReflow::layoutPage()
+{
+    screens_.clear();
+    ReflowPagePtr page = cachedPage(cur_page_);
+    if (page == 0 || page->page_size.isEmpty())
+    {
+        return;
+    }
+
+    const int left   = REFLOW_MARGIN;
+    const int top    = REFLOW_MARGIN;
+    const int width  = std::max(screen_size_.width() - 2 * REFLOW_MARGIN, 1);
+    const int bottom = std::max(screen_size_.height() - REFLOW_MARGIN, top + 1);
+
+    if (page->text_height > 0)
+    {
+        zoom_ = scale_ * REFLOW_TEXT_HEIGHT / page->text_height;
+    }
+    else
+    {
+        zoom_ = static_cast<double>(width) / page->page_size.width();
+    }
+    zoom_ = std::max(std::min(zoom_, 4.0), 0.05);
+
+    const double text_height = page->text_height * zoom_;
+    const int space   = std::max(qRound(text_height * WORD_SPACE), 2);
+    const int leading = std::max(qRound(text_height * LINE_SPACE), 1);
+    const int indent  = qRound(text_height * 2);
+
+    const QRect bounds(0, 0,
+                       qRound(page->page_size.width() * zoom_),
+                       qRound(page->page_size.height() * zoom_));
+
+    ReflowScreen screen;
+    ReflowScreen line;
+    int ascent = 0;
+    int x = 0;
+    int y = top;
+
+    for (int i = 0; i <= page->words.size(); ++i)
+    {
+        const ReflowWord *word = i < page->words.size() ? &page->words[i] : 0;
+        QRect source;
+        QSize size;
+        if (word != 0)
+        {
+            source = scaleRect(word->area, zoom_) & bounds;
+            if (source.isEmpty())
+            {
+                continue;
+            }
+            size = source.size();
+
+            // shrink the words and figures which do not fit the screen
+            if (size.width() > width || size.height() > bottom - top)
+            {
+                size.scale(width, bottom - top, Qt::KeepAspectRatio);
+            }
+        }
+
+        bool wrap = word == 0 ||
+                    (word->flags & (ReflowWord::NEW_PARAGRAPH | ReflowWord::FIGURE)) ||
+                    (!line.isEmpty() && x + size.width() > width);
+        if (wrap && !line.isEmpty())
+        {
+            if (y + ascent > bottom && !screen.isEmpty())
+            {
+                screens_.push_back(screen);
+                screen.clear();
+                y = top;
+            }
+            for (int j = 0; j < line.size(); ++j)
+            {
+                line[j].target.translate(0, y + ascent);
+                screen.push_back(line[j]);
+            }
+            y += ascent + leading;
+            line.clear();
+            ascent = 0;
+            x = 0;
+        }
+
+        if (word == 0)
+        {
+            break;
+        }
+
+        if (word->flags & ReflowWord::NEW_PARAGRAPH)
+        {
+            if (!screen.isEmpty())
+            {
+                y += leading;
+            }
+            x = (word->flags & ReflowWord::FIGURE) ? 0 : indent;
+        }
+
+        if (word->flags & ReflowWord::FIGURE)
+        {
+            if (y + size.height() > bottom && !screen.isEmpty())
+            {
+                screens_.push_back(screen);
+                screen.clear();
+                y = top;
+            }
+            QRect target(QPoint(left + (width - size.width()) / 2, y), size);
+            screen.push_back(ReflowItem(source, target));
+            y += size.height() + leading;
+            x = 0;
+            continue;
+        }
+
+        // the target is relative to the baseline until the line is placed
+        int word_ascent = qRound((word->bottom + 1 - word->area.top()) * zoom_ *
+                                 size.height() / source.height());
+        word_ascent = std::max(word_ascent, size.height());
+        ascent = std::max(ascent, word_ascent);
+        QRect target(QPoint(left + x, -word_ascent), size);
+        line.push_back(ReflowItem(source, target));
+        x += size.width() + space;
+    }
+
+    if (!screen.isEmpty() || screens_.isEmpty())
+    {
+        screens_.push_back(screen);
+    }
+}
+
+/// Render the part of the current page used by the current screen. Large
+/// areas, e.g. figures shrunk to fit the screen, are rendered at a lower
+/// resolution so that the image never exceeds REFLOW_MAX_PIXELS.
+bool DjvuReflow::renderScreen()
+{
+    image_ = QImage();
+    ReflowPagePtr reflow = cachedPage(cur_page_);
+    if (reflow == 0 || !pages_.contains(cur_page_) || screens_.isEmpty())
+    {
+        return false;
+    }
+
+    QRect area;
+    const ReflowScreen & screen = screens_[cur_screen_];
+    for (int i = 0; i < screen.size(); ++i)
+    {
+        area |= screen[i].source;
+    }
+    if (area.isEmpty())
+    {
+        // nothing to display on this screen
+        return true;
+    }
+
+    image_zoom_ = 1.0;
+    double pixels = static_cast<double>(area.width()) * area.height();
+    if (pixels > REFLOW_MAX_PIXELS)
+    {
+        image_zoom_ = sqrt(REFLOW_MAX_PIXELS / pixels);
+    }
+
+    const double zoom = zoom_ * image_zoom_;
+    QSize size(qRound(reflow->page_size.width() * zoom),
+               qRound(reflow->page_size.height() * zoom));
+    QRect region = scaleRect(area, image_zoom_) & QRect(QPoint(0, 0), size);
+    if (region.isEmpty())
+    {
+        return false;
+    }
+
+    ddjvu_rect_t page_rect = {0, 0, size.width(), size.height()};
+    ddjvu_rect_t render_rect = {region.x(), region.y(), region.width(), region.height()};
+    image_ = QImage(region.size(), QImage::Format_Indexed8);
+    if (image_.isNull())
+    {
+        qWarning("DjvuReflow::renderScreen: cannot allocate %dx%d image",
+                 region.width(), region.height());
+        return false;
+    }
+    image_.setColorTable(GREY_TABLE);
+    image_origin_ = region.topLeft();
+
+    int ret = ddjvu_page_render(*pages_[cur_page_],
+                                DDJVU_RENDER_COLOR,
+                                &page_rect,
+                                &render_rect,
+                                render_format_,
+                                image_.bytesPerLine(),
+                                reinterpret_cast<char *>(image_.bits()));
+    if (!ret)
+    {
+        image_ = QImage();
+        return false;
+    }
+    return true;
+}
+
+}
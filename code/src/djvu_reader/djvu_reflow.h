@@ -0,0 +1,185 @@
+#ifndef DJVU_REFLOW_H_
+#define DJVU_REFLOW_H_
+
+#include "djvu_utils.h"
+#include "djvu_page.h"
+
+namespace djvu_reader
+{
+
+/// Reflow is not a layout of the onyx sdk, keep it out of the sdk range
+static const PageLayoutType REFLOW_LAYOUT = static_cast<PageLayoutType>(100);
+
+/// The class ReflowWord is a word (or a figure) cut out of a scanned page
+class ReflowWord
+{
+public:
+    enum Flag
+    {
+        NEW_PARAGRAPH = 0x1,    ///< first word of a paragraph
+        FIGURE        = 0x2     ///< non-text block, kept in one piece
+    };
+
+    ReflowWord() : top(0), bottom(0), flags(0) {}
+    ~ReflowWord() {}
+
+public:
+    QRect area;                 ///< bounding box of the word in the page
+    int   top;                  ///< top of the text line holding the word
+    int   bottom;               ///< bottom of the text line holding the word
+    int   flags;                ///< combination of Flag
+};
+
+/// The segmentation result of a page, words are in reading order
+class ReflowPage
+{
+public:
+    ReflowPage() : page_no(-1), generation(0), text_height(0) {}
+    ~ReflowPage() {}
+
+public:
+    int                 page_no;
+    int                 generation;     ///< generation of the job, see ReflowJob
+    QSize               page_size;
+    int                 text_height;    ///< median height of the text components
+    QVector<ReflowWord> words;
+};
+
+typedef shared_ptr<ReflowPage> ReflowPagePtr;
+
+/// Connected components of a page waiting for segmentation
+class ReflowJob
+{
+public:
+    ReflowJob() : page_no(-1), generation(0) {}
+    ~ReflowJob() {}
+
+public:
+    int            page_no;
+    int            generation;      ///< document generation the page belongs to
+    QSize          page_size;
+    QVector<QRect> components;      ///< bounding boxes of the JB2 blits
+};
+
+/// Placement of a word on the screen
+class ReflowItem
+{
+public:
+    ReflowItem() {}
+    ReflowItem(const QRect & s, const QRect & t) : source(s), target(t) {}
+    ~ReflowItem() {}
+
+public:
+    QRect source;                   ///< area in the rendered page image
+    QRect target;                   ///< area in the screen
+};
+
+typedef QVector<ReflowItem> ReflowScreen;
+
+/// The class ReflowWorker segments pages in the background
+class ReflowWorker : public QThread
+{
+    Q_OBJECT
+public:
+    ReflowWorker(QObject *parent = 0);
+    ~ReflowWorker();
+
+    void addJob(const ReflowJob & job, bool urgent);
+    bool takeResult(ReflowPagePtr & result);
+    void clear();
+    void stop();
+
+    static ReflowPagePtr segment(const ReflowJob & job);
+
+Q_SIGNALS:
+    void resultReady();
+
+protected:
+    virtual void run();
+
+private:
+    QMutex                  mutex_;
+    QWaitCondition          wait_;
+    QQueue<ReflowJob>       jobs_;
+    QQueue<ReflowPagePtr>   results_;
+    bool                    stop_;
+};
+
+class QDjVuDocument;
+/// The class DjvuReflow re-flows the words of scanned pages into the screen
+class DjvuReflow : public QObject
+{
+    Q_OBJECT
+public:
+    DjvuReflow();
+    ~DjvuReflow();
+
+    void attachDocument(QDjVuDocument *doc, int page_count);
+    void deattachDocument();
+
+    void setScreenSize(const QSize & size);
+    void setScale(double scale);
+    double scale() const { return scale_; }
+
+    void showPage(int page_no, bool last_screen = false);
+    int  currentPage() const { return cur_page_; }
+    bool isReady() const { return !screens_.isEmpty(); }
+    bool nextScreen();
+    bool previousScreen();
+
+    void paint(QPainter & painter, const QRect & rect);
+
+Q_SIGNALS:
+    void screenReady(int page_no);
+
+private Q_SLOTS:
+    void onPageInfo(QDjVuPage * from);
+    void onRedisplay(QDjVuPage * from);
+    void onResultReady();
+
+private:
+    DjVuPagePtr getPage(int page_no);
+    void requirePage(int page_no, bool urgent);
+    void handlePageDecoded(QDjVuPage * page, bool urgent = false);
+    bool collectComponents(QDjVuPage * page, ReflowJob & job);
+
+    ReflowPagePtr cachedPage(int page_no);
+    void cachePage(ReflowPagePtr page);
+
+    void updateScreens();
+    void layoutPage();
+    bool renderScreen();
+    bool moveToScreen(int screen);
+
+private:
+    typedef QMap<int, DjVuPagePtr>   DjvuPages;
+    typedef DjvuPages::iterator      DjvuPageIter;
+    typedef QMap<int, ReflowPagePtr> ReflowPages;
+
+private:
+    QDjVuDocument           *doc_;              ///< document, owned by the model
+    int                     page_count_;        ///< total number of pages
+    ddjvu_format_t          *render_format_;    ///< grey render format
+
+    ReflowWorker            worker_;            ///< background segmentation
+    DjvuPages               pages_;             ///< pages being decoded or displayed
+    QSet<int>               pending_;           ///< pages sent to the worker
+    int                     generation_;        ///< incremented when the document is detached
+    ReflowPages             cache_;             ///< segmented pages
+    QList<int>              lru_;               ///< most recently used page at the end
+
+    QSize                   screen_size_;       ///< size of the view
+    double                  scale_;             ///< text magnification
+    double                  zoom_;              ///< zoom of the current page
+    int                     cur_page_;          ///< page being displayed
+    int                     cur_screen_;        ///< screen of the page being displayed
+    bool                    last_screen_;       ///< display last screen of the page when ready
+    QVector<ReflowScreen>   screens_;           ///< screens of the current page
+    QImage                  image_;             ///< rendered part of the current page
+    QPoint                  image_origin_;      ///< position of image_ in the page rendered at image_zoom_
+    double                  image_zoom_;        ///< ratio of image_ pixels to page pixels at zoom_
+};
+
+};
+
+#endif // DJVU_REFLOW_H_
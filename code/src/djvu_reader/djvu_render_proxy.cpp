@@ -4,8 +4,24 @@
 namespace djvu_reader
 {
 
+static const long PAGE_MEMORY_USAGE = 8 * 1024 * 1024;  ///< estimated size of a decoded page
+static const int  MAX_NEIGHBOURS    = 3;
+
+// Every refresh of the e-ink screen costs a flash, a coarse render is only
+// displayed when the page takes a while to decode and coarse renders are
+// kept apart from each other.
+static const int  COARSE_DELAY      = 300;      ///< ms of decoding before the first coarse render
+static const int  COARSE_INTERVAL   = 1000;     ///< ms between two coarse renders
+
 DjvuRenderProxy::DjvuRenderProxy()
     : render_format_(0)
+    , doc_(0)
+    , neighbours_(1)
+    , page_hits_(0)
+    , page_misses_(0)
+    , decoded_pages_(0)
+    , decode_ms_(0)
+    , progressive_passes_(1)
 {
     render_format_ = ddjvu_format_create(DDJVU_FORMAT_RGB24, 0, 0);
     ddjvu_format_set_row_order(render_format_, true);
@@ -22,14 +38,44 @@ DjvuRenderProxy::~DjvuRenderProxy()
     }
 }
 
+/// Keep as many decoded neighbour pages as the cache budget allows
+void DjvuRenderProxy::setCacheBudget(long bytes)
+{
+    neighbours_ = qBound(1, static_cast<int>(bytes / PAGE_MEMORY_USAGE) - 1, MAX_NEIGHBOURS);
+}
+
+QString DjvuRenderProxy::statistics() const
+{
+    int requests = page_hits_ + page_misses_;
+    return QString("page cache: hits %1 misses %2 (%3%) pages %4 neighbours %5 decoded %6 avg %7 ms")
+        .arg(page_hits_)
+        .arg(page_misses_)
+        .arg(requests > 0 ? page_hits_ * 100 / requests : 0)
+        .arg(pages_.size())
+        .arg(neighbours_)
+        .arg(decoded_pages_)
+        .arg(decoded_pages_ > 0 ? decode_ms_ / decoded_pages_ : 0);
+}
+
 void DjvuRenderProxy::render(PageRenderSettings & render_pages, QDjVuDocument * doc)
 {
-    // remove redundant pages
+    if (render_pages.isEmpty())
+    {
+        return;
+    }
+    doc_ = doc;
+
+    // remove the pages out of the neighbourhood, the decoded data of the
+    // neighbours is kept so that turning pages does not decode again
+    int first = render_pages.begin().key() - neighbours_;
+    int last  = (render_pages.end() - 1).key() + neighbours_;
     DjvuPageIter page_idx = pages_.begin();
     while (page_idx != pages_.end())
     {
-        if (!render_pages.contains(page_idx.key()))
+        if (page_idx.key() < first || page_idx.key() > last)
         {
+            decode_timers_.remove(page_idx.key());
+            coarse_passes_.remove(page_idx.key());
             page_idx = pages_.erase(page_idx);
         }
         else
@@ -49,11 +95,111 @@ void DjvuRenderProxy::render(PageRenderSettings & render_pages, QDjVuDocument *
         if (page->render(*render_setting, render_format_))
         {
             emit pageRenderReady(page);
+            prefetch(doc, page->pageNum());
+        }
+        else if (coarsePassAllowed(page.get()) && page->renderCoarse(render_format_))
+        {
+            notePass(page.get());
+            emit pageRenderReady(page);
         }
         render_idx++;
     }
 }
 
+/// Start decoding the next pages once the page has been displayed
+void DjvuRenderProxy::prefetch(QDjVuDocument * doc, int page_no)
+{
+    int count = doc->getPageCount();
+    for (int i = 1; i <= neighbours_ && page_no + i < count; ++i)
+    {
+        if (!pages_.contains(page_no + i))
+        {
+            getPage(doc, page_no + i);
+        }
+    }
+}
+
+void DjvuRenderProxy::updateDecodeTime(QDjVuPage * page)
+{
+    QMap<int, QTime>::iterator idx = decode_timers_.find(page->pageNum());
+    if (idx != decode_timers_.end() && page->isDecodeDone())
+    {
+        decode_ms_ += idx.value().elapsed();
+        decoded_pages_++;
+        decode_timers_.erase(idx);
+        coarse_passes_.remove(page->pageNum());
+    }
+}
+
+/// Check whether a page still being decoded can be displayed coarsely
+bool DjvuRenderProxy::coarsePassAllowed(QDjVuPage * page)
+{
+    if (page->isThumbnail() || !page->isDecoding())
+    {
+        return false;
+    }
+
+    QMap<int, QTime>::iterator timer = decode_timers_.find(page->pageNum());
+    if (timer == decode_timers_.end() || timer.value().elapsed() < COARSE_DELAY)
+    {
+        return false;
+    }
+
+    QMap<int, CoarsePasses>::iterator passes = coarse_passes_.find(page->pageNum());
+    if (passes == coarse_passes_.end())
+    {
+        return progressive_passes_ > 0;
+    }
+    return passes.value().first < progressive_passes_ &&
+           passes.value().second.elapsed() >= COARSE_INTERVAL;
+}
+
+void DjvuRenderProxy::notePass(QDjVuPage * page)
+{
+    CoarsePasses & passes = coarse_passes_[page->pageNum()];
+    passes.first++;
+    passes.second.start();
+}
+
+/// Continue retrieving the content area and rendering a page when more
+/// data has been decoded
+void DjvuRenderProxy::handlePageUpdate(DjVuPagePtr page)
+{
+    bool coarse = coarsePassAllowed(page.get());
+
+    // continue retrieving the content area
+    if (page->contentAreaNeeded())
+    {
+        QRect previous = page->provisionalContentArea();
+        const QRect & content_area = page->getContentArea(render_format_, coarse);
+        if (content_area.isValid() &&
+            (!page->contentAreaNeeded() || content_area != previous))
+        {
+            emit contentAreaReady(page, content_area);
+        }
+    }
+
+    // continue rendering the page
+    if (!page->renderNeeded())
+    {
+        return;
+    }
+
+    if (page->render(render_format_))
+    {
+        emit pageRenderReady(page);
+        if (doc_ != 0 && !page->isThumbnail())
+        {
+            prefetch(doc_, page->pageNum());
+        }
+    }
+    else if (coarse && page->renderCoarse(render_format_))
+    {
+        notePass(page.get());
+        emit pageRenderReady(page);
+    }
+}
+
 void DjvuRenderProxy::renderThumbnail(int page_num,
                                       const RenderSetting & render_setting,
                                       ThumbnailRenderDirection direction,
@@ -92,22 +238,8 @@ void DjvuRenderProxy::onPageInfo(QDjVuPage * from)
     {
         page = DjVuPagePtr(from);
     }
-
-    // continue retrieving the content area
-    if (page->contentAreaNeeded())
-    {
-        const QRect & content_area = page->getContentArea(render_format_);
-        if (content_area.isValid())
-        {
-            emit contentAreaReady(page, content_area);
-        }
-    }
-
-    // continue rendering the page
-    if (page->renderNeeded() && page->render(render_format_))
-    {
-        emit pageRenderReady(page);
-    }
+    updateDecodeTime(from);
+    handlePageUpdate(page);
 }
 
 void DjvuRenderProxy::onRelayout(QDjVuPage * from)
@@ -135,29 +267,24 @@ void DjvuRenderProxy::onRedisplay(QDjVuPage * from)
     {
         page = DjVuPagePtr(from);
     }
-
-    // continue retrieving the content area
-    if (page->contentAreaNeeded())
-    {
-        const QRect & content_area = page->getContentArea(render_format_);
-        if (content_area.isValid())
-        {
-            emit contentAreaReady(page, content_area);
-        }
-    }
-
-    // continue rendering the page
-    if (page->renderNeeded() && page->render(render_format_))
-    {
-        emit pageRenderReady(page);
-    }
+    updateDecodeTime(from);
+    handlePageUpdate(page);
 }
 
 DjVuPagePtr DjvuRenderProxy::getPage(QDjVuDocument * doc, int page_no)
 {
-    if (!pages_.contains(page_no))
+    if (pages_.contains(page_no))
+    {
+        page_hits_++;
+    }
+    else
     {
+        page_misses_++;
         DjVuPagePtr new_page(new QDjVuPage(doc, page_no));
+        if (!new_page->isDecodeDone())
+        {
+            decode_timers_[page_no].start();
+        }
 
         connect(new_page.get(), SIGNAL(relayout(QDjVuPage *)), this, SLOT(onRelayout(QDjVuPage *)));
         connect(new_page.get(), SIGNAL(redisplay(QDjVuPage *)), this, SLOT(onRedisplay(QDjVuPage *)));
@@ -25,6 +25,10 @@ public:
     void requirePageContentArea(int page_no, QDjVuDocument * doc);
     bool getPageRenderSetting(int page_no, RenderSetting & render_setting);
 
+    void setCacheBudget(long bytes);
+    void setProgressivePasses(int passes) { progressive_passes_ = passes; }
+    QString statistics() const;
+
 Q_SIGNALS:
     void pageRenderReady(DjVuPagePtr page);
     void relayout(DjVuPagePtr page);
@@ -40,14 +44,31 @@ private Q_SLOTS:
 
 private:
     DjVuPagePtr getPage(QDjVuDocument * doc, int page_no);
+    void prefetch(QDjVuDocument * doc, int page_no);
+    void updateDecodeTime(QDjVuPage * page);
+    void handlePageUpdate(DjVuPagePtr page);
+    bool coarsePassAllowed(QDjVuPage * page);
+    void notePass(QDjVuPage * page);
 
 private:
     typedef QMap<int, DjVuPagePtr> DjvuPages;
     typedef DjvuPages::iterator    DjvuPageIter;
+    typedef QPair<int, QTime>      CoarsePasses;
 
 private:
     DjvuPages      pages_;
     ddjvu_format_t *render_format_;
+    QDjVuDocument  *doc_;               ///< document of the last render request
+
+    int            neighbours_;         ///< decoded pages kept around the rendered ones
+    QMap<int, QTime> decode_timers_;    ///< pages being decoded
+    int            page_hits_;          ///< requests of pages held by the proxy
+    int            page_misses_;        ///< requests of pages to be created
+    int            decoded_pages_;      ///< pages decoded by the proxy
+    int            decode_ms_;          ///< total decoding time of these pages
+
+    int            progressive_passes_; ///< coarse refreshes allowed before the final one
+    QMap<int, CoarsePasses> coarse_passes_; ///< count and time of the coarse refreshes of pages
 
 };
 
@@ -14,6 +14,22 @@ namespace djvu_reader
 static const int OVERLAP_DISTANCE = 80;
 static const unsigned int AUTO_FLIP_INTERVAL = 1000;
 
+/// Log the cache counters after each page when DJVU_CACHE_STATS is set
+static bool logCacheStatistics()
+{
+    static const bool enabled = !qgetenv("DJVU_CACHE_STATS").isEmpty();
+    return enabled;
+}
+
+/// Coarse refreshes of a page being decoded, DJVU_PROGRESSIVE_PASSES
+/// overrides the default single pass and 0 disables them
+static int progressivePasses()
+{
+    bool ok = false;
+    int passes = qgetenv("DJVU_PROGRESSIVE_PASSES").toInt(&ok);
+    return (ok && passes >= 0) ? passes : 1;
+}
+
 static RotateDegree getSystemRotateDegree()
 {
     int degree = 0;
@@ -26,6 +42,7 @@ static RotateDegree getSystemRotateDegree()
 DjvuView::DjvuView(QWidget *parent)
     : BaseView(parent, Qt::FramelessWindowHint)
     , model_(0)
+    , reflow_backward_(false)
     , restore_count_(0)
     , bookmark_image_(0)
     , auto_flip_current_page_(1)
@@ -41,9 +58,11 @@ DjvuView::DjvuView(QWidget *parent)
     connect(&status_mgr_, SIGNAL(stylusChanged(const int)), this, SLOT(onStylusChanges(const int)));
     connect(&sketch_proxy_, SIGNAL(requestUpdateScreen()), this, SLOT(onRequestUpdateScreen()));
 
+    render_proxy_.setProgressivePasses(progressivePasses());
     connect(&render_proxy_, SIGNAL(pageRenderReady(DjVuPagePtr)), this, SLOT(onPageRenderReady(DjVuPagePtr)));
     connect(&render_proxy_, SIGNAL(contentAreaReady(DjVuPagePtr, const QRect &)),
             this, SLOT(onContentAreaReady(DjVuPagePtr, const QRect &)));
+    connect(&reflow_, SIGNAL(screenReady(int)), this, SLOT(onReflowReady(int)));
 
     flip_page_timer_.setInterval(AUTO_FLIP_INTERVAL);
     connect(&flip_page_timer_, SIGNAL(timeout()), this, SLOT(autoFlipMultiplePages()));
@@ -85,6 +104,7 @@ void DjvuView::deattachModel()
     disconnect(model_, SIGNAL(docPageReady()), this, SLOT(onDocPageReady()));
     disconnect(model_, SIGNAL(docThumbnailReady(int)), this, SLOT(onDocThumbnailReady(int)));
     disconnect(model_, SIGNAL(docIdle()), this, SLOT(onDocIdle()));
+    reflow_.deattachDocument();
     model_ = 0;
 }
 
@@ -218,6 +238,15 @@ void DjvuView::onLayoutDone()
         sketch_proxy_.save();
     }
 
+    // reflowed pages are rendered by the reflow
+    if (isReflow())
+    {
+        layout_pages_.clear();
+        reflow_.showPage(cur_page_, reflow_backward_);
+        reflow_backward_ = false;
+        return;
+    }
+
     // send the render requests
     PageRenderSettings render_settings;
     VisiblePages::iterator idx = layout_pages_.begin();
@@ -289,6 +318,10 @@ void DjvuView::onDocReady()
 
     // initialize the pages layout by configurations.
     // If the configurations are invalid, the layout is initialized by default.
+    render_proxy_.setCacheBudget(model_->document()->context().cacheSize());
+    reflow_.attachDocument(model_->document(), model_->getPagesTotalNumber());
+    reflow_.setScreenSize(size());
+
     initLayout();
     layout_->loadConfiguration(model_->getConf());
     resetLayout();
@@ -414,6 +447,15 @@ bool DjvuView::flip(int direction)
     return false;
 }
 
+QString DjvuView::cacheStatistics()
+{
+    if (model_ == 0)
+    {
+        return QString();
+    }
+    return render_proxy_.statistics() + "; " + model_->document()->context().cacheStatistics();
+}
+
 void DjvuView::onMouseLongPress(QPoint point, QSize size)
 {
     onPopupMenu();
@@ -514,6 +556,12 @@ void DjvuView::onPageRenderReady(DjVuPagePtr page)
 
 void DjvuView::handleNormalPageReady(DjVuPagePtr page)
 {
+    if (page->isCoarse())
+    {
+        handleCoarsePageReady(page);
+        return;
+    }
+
     if (restore_count_ > 1)
     {
         qDebug("Restore Left:%d", restore_count_);
@@ -553,18 +601,25 @@ void DjvuView::handleNormalPageReady(DjVuPagePtr page)
         return;
     }
 
-    // set the waveform by current paging mode
-    if (display_pages_.size() > 0)
+    // set the waveform by current paging mode, the coarse image of the page
+    // is replaced by a full refresh to clear the ghosting
+    if (coarse_pages_.remove(page->pageNum()))
     {
-        onyx::screen::instance().setDefaultWaveform(onyx::screen::ScreenProxy::GU);
+        onyx::screen::instance().setDefaultWaveform(current_waveform_);
     }
     else
     {
-        onyx::screen::instance().setDefaultWaveform(current_waveform_);
+        if (display_pages_.size() > 0)
+        {
+            onyx::screen::instance().setDefaultWaveform(onyx::screen::ScreenProxy::GU);
+        }
+        else
+        {
+            onyx::screen::instance().setDefaultWaveform(current_waveform_);
+        }
+        display_pages_.push_back(page);
     }
 
-    display_pages_.push_back(page);
-
     // retrieve the next one and send render request
     if (layout_pages_.empty())
     {
@@ -579,12 +634,87 @@ void DjvuView::handleNormalPageReady(DjVuPagePtr page)
         {
             restore_count_ = 0;
         }
+
+        if (logCacheStatistics())
+        {
+            qDebug() << cacheStatistics();
+        }
     }
 
     // redraw the Qt image buffer and make sure mandatory update the view
     update(onyx::screen::ScreenProxy::instance().defaultWaveform());
 }
 
+/// Display the coarse image of a page still being decoded. The page stays in
+/// the layout pages until its final image is ready.
+void DjvuView::handleCoarsePageReady(DjVuPagePtr page)
+{
+    if (restore_count_ > 1)
+    {
+        return;
+    }
+
+    bool found = false;
+    VisiblePagesIter idx = layout_pages_.begin();
+    for (; idx != layout_pages_.end(); ++idx)
+    {
+        if (page->pageNum() == (*idx)->key())
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        return;
+    }
+
+    if (sys::SysStatus::instance().isSystemBusy())
+    {
+        sys::SysStatus::instance().setSystemBusy( false );
+    }
+
+    if (!coarse_pages_.contains(page->pageNum()))
+    {
+        coarse_pages_.insert(page->pageNum());
+        display_pages_.push_back(page);
+    }
+
+    // fast partial refresh, the final image gets a full one
+    onyx::screen::instance().setDefaultWaveform(onyx::screen::ScreenProxy::GU);
+    update(onyx::screen::ScreenProxy::GU);
+}
+
+void DjvuView::onReflowReady(int page_no)
+{
+    if (!isReflow() || page_no != cur_page_)
+    {
+        return;
+    }
+
+    if (sys::SysStatus::instance().isSystemBusy())
+    {
+        sys::SysStatus::instance().setSystemBusy( false );
+    }
+
+    if (onyx::screen::instance().userData() == 0)
+    {
+        ++onyx::screen::instance().userData();
+    }
+
+    updateCurrentPage(page_no);
+    if (restore_count_ <= 0)
+    {
+        saveReadingContext();
+    }
+    else
+    {
+        restore_count_ = 0;
+    }
+    update(current_waveform_);
+}
+
 void DjvuView::displayThumbnailView()
 {
     QWidget* view = down_cast<MainWindow*>(parentWidget())->getView(THUMBNAIL_VIEW);
@@ -951,6 +1081,44 @@ void DjvuView::switchLayout(PageLayoutType mode)
     }
 }
 
+void DjvuView::toggleReflow()
+{
+    if (status_mgr_.isSlideShow())
+    {
+        return;
+    }
+    switchLayout(isReflow() ? PAGE_LAYOUT : REFLOW_LAYOUT);
+    update(onyx::screen::ScreenProxy::GC);
+}
+
+/// Display the next screen of the reflowed page, or the next page
+void DjvuView::reflowNext()
+{
+    if (reflow_.nextScreen())
+    {
+        update(current_waveform_);
+    }
+    else if (cur_page_ + 1 < model_->getPagesTotalNumber())
+    {
+        gotoPage(cur_page_ + 1);
+    }
+}
+
+/// Display the previous screen of the reflowed page, or the last screen of
+/// the previous page
+void DjvuView::reflowPrevious()
+{
+    if (reflow_.previousScreen())
+    {
+        update(current_waveform_);
+    }
+    else if (cur_page_ > 0)
+    {
+        reflow_backward_ = true;
+        gotoPage(cur_page_ - 1);
+    }
+}
+
 
 void DjvuView::mousePressEvent(QMouseEvent *me)
 {
@@ -1166,6 +1334,10 @@ void DjvuView::keyReleaseEvent(QKeyEvent *ke)
             {
                 gotoPage(auto_flip_current_page_);
             }
+            else if (isReflow())
+            {
+                reflowNext();
+            }
             else
             {
                 offset = (height() - OVERLAP_DISTANCE);
@@ -1179,6 +1351,11 @@ void DjvuView::keyReleaseEvent(QKeyEvent *ke)
         break;
     case Qt::Key_Right:
         {
+            if (isReflow())
+            {
+                reflowNext();
+                break;
+            }
             offset = (width() - OVERLAP_DISTANCE);
             if (isLandscape())
             {
@@ -1195,6 +1372,10 @@ void DjvuView::keyReleaseEvent(QKeyEvent *ke)
             {
                 gotoPage(auto_flip_current_page_);
             }
+            else if (isReflow())
+            {
+                reflowPrevious();
+            }
             else
             {
                 offset = -(height() - OVERLAP_DISTANCE);
@@ -1208,6 +1389,11 @@ void DjvuView::keyReleaseEvent(QKeyEvent *ke)
         break;
     case Qt::Key_Left:
         {
+            if (isReflow())
+            {
+                reflowPrevious();
+                break;
+            }
             offset = - (width() - OVERLAP_DISTANCE);
             if (isLandscape())
             {
@@ -1231,6 +1417,11 @@ void DjvuView::keyReleaseEvent(QKeyEvent *ke)
             enableScrolling();
         }
         break;
+    case Qt::Key_R:
+        {
+            toggleReflow();
+        }
+        break;
     case Qt::Key_W:
         {
             zooming(ZOOM_TO_WIDTH);
@@ -1307,8 +1498,15 @@ void DjvuView::enableScrolling()
 
 void DjvuView::paintEvent(QPaintEvent *pe)
 {
-    int count = display_pages_.size();
     QPainter painter(this);
+    if (isReflow())
+    {
+        reflow_.paint(painter, rect());
+        paintBookmark(painter);
+        return;
+    }
+
+    int count = display_pages_.size();
     for (int i = 0; i < count; ++i)
     {
         DjVuPagePtr page = display_pages_.get_page(i);
@@ -1326,6 +1524,7 @@ void DjvuView::updateCurrentPage(const int page_number)
 
 void DjvuView::resizeEvent(QResizeEvent *re)
 {
+    reflow_.setScreenSize(re->size());
     if (layout_ != 0 &&
         layout_->setWidgetArea(QRect(0,
                                      0,
@@ -1597,6 +1796,13 @@ void DjvuView::displayOutlines( bool )
 bool DjvuView::zooming( double zoom_setting )
 {
     view_setting_.zoom_setting = zoom_setting;
+    if (isReflow())
+    {
+        // in reflow mode the zoom only magnifies the text
+        reflow_.setScale(zoom_setting > 0 ? zoom_setting / 100.0 : 1.0);
+        return zoom_setting != ZOOM_SELECTION;
+    }
+
     if (zoom_setting == ZOOM_TO_PAGE)
     {
         layout_->zoomToBestFit();
@@ -1685,6 +1891,17 @@ void DjvuView::panRelease( QMouseEvent *me )
     {
         hitTest(me->pos());
     }
+    else if (isReflow())
+    {
+        if (offset_x + offset_y > 0)
+        {
+            reflowNext();
+        }
+        else
+        {
+            reflowPrevious();
+        }
+    }
     else
     {
         scroll(offset_x, offset_y);
@@ -1713,7 +1930,8 @@ void DjvuView::setSketchShape( const SketchShape shape )
 
 void DjvuView::paintPage(QPainter & painter, DjVuPagePtr page)
 {
-    if (page->image() == 0 || page->renderNeeded() || layout_ == 0)
+    if (page->image() == 0 || page->image()->isNull() || layout_ == 0 ||
+        (page->renderNeeded() && !page->isCoarse()))
     {
         return;
     }
@@ -1904,7 +2122,7 @@ void DjvuView::back()
 
         QVariant item = reading_history_.currentItem();
         ReadingHistoryContext ctx = item.value<ReadingHistoryContext>();
-        if (ctx.read_type != read_mode_)
+        if (ctx.read_type != read_mode_ && !(isReflow() && ctx.read_type == PAGE_LAYOUT))
         {
             cur_page_ = ctx.page_number;
             restore_count_++;
@@ -1923,7 +2141,7 @@ void DjvuView::forward()
 
         QVariant item = reading_history_.currentItem();
         ReadingHistoryContext ctx = item.value<ReadingHistoryContext>();
-        if (ctx.read_type != read_mode_)
+        if (ctx.read_type != read_mode_ && !(isReflow() && ctx.read_type == PAGE_LAYOUT))
         {
             cur_page_ = ctx.page_number;
             restore_count_++;
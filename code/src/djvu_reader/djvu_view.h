@@ -4,6 +4,7 @@
 #include "djvu_utils.h"
 #include "djvu_render_proxy.h"
 #include "djvu_page.h"
+#include "djvu_reflow.h"
 
 using namespace vbf;
 using namespace sketch;
@@ -40,6 +41,9 @@ public:
     // Flipping
     bool flip(int direction);
 
+    // Counters of the page caches
+    QString cacheStatistics();
+
 public Q_SLOTS:
     void onPageRenderReady(DjVuPagePtr page);
     void onPagebarClicked(const int, const int);
@@ -69,6 +73,7 @@ private Q_SLOTS:
     void onNeedContentArea(const int page_number);
 
     void onContentAreaReady(DjVuPagePtr page, const QRect & content_area);
+    void onReflowReady(int page_no);
     void onSaveAllOptions();
 
     void onUpdateBookmark();
@@ -104,6 +109,7 @@ private:
 
     // handle page ready events
     void handleNormalPageReady(DjVuPagePtr page);
+    void handleCoarsePageReady(DjVuPagePtr page);
     void handleThumbnailReady(DjVuPagePtr page);
 
     // configurations
@@ -142,6 +148,12 @@ private:
     // Zooming
     void selectionZoom();
 
+    // Reflow
+    bool isReflow() const { return read_mode_ == REFLOW_LAYOUT; }
+    void toggleReflow();
+    void reflowNext();
+    void reflowPrevious();
+
     // Pan
     void enableScrolling();
     void panPress( QMouseEvent *me );
@@ -211,6 +223,9 @@ private:
 
     DjvuRenderProxy         render_proxy_;              ///< render proxy
     DisplayPages<QDjVuPage> display_pages_;             ///< vector of displaying pages
+    QSet<int>               coarse_pages_;              ///< displaying pages rendered coarsely
+    DjvuReflow              reflow_;                    ///< reflow of scanned pages
+    bool                    reflow_backward_;           ///< show the last screen of the next page
 
     // Popup menu actions
     ZoomSettingActions      zoom_setting_actions_;
@@ -253,6 +268,7 @@ private:
 inline void DjvuView::clearVisiblePages()
 {
     display_pages_.clear();
+    coarse_pages_.clear();
 }
 
 };
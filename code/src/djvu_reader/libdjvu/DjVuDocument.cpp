@@ -872,7 +872,9 @@ DjVuDocument::url_to_file(const GURL & url, bool dont_create) const
       if (port && port->inherits("DjVuFile"))
       {
 	 DEBUG_MSG("found fully decoded file using DjVuPortcaster\n");
-	 return (DjVuFile *) (DjVuPort *) port;
+	 GP<DjVuFile> file=(DjVuFile *) (DjVuPort *) port;
+	 cache->note_hit(file);
+	 return file;
       }
    }
 
@@ -889,6 +891,8 @@ DjVuDocument::url_to_file(const GURL & url, bool dont_create) const
    if (!dont_create)
    {
       DEBUG_MSG("creating a new file\n");
+      if (cache)
+	 cache->note_miss();
       file=DjVuFile::create(url,const_cast<DjVuDocument *>(this),recover_errors,verbose_eof);
       const_cast<DjVuDocument *>(this)->set_file_aliases(file);
    }
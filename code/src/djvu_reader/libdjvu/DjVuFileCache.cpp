@@ -123,7 +123,10 @@ DjVuFileCache::add_file(const GP<DjVuFile> & file)
    for(pos=list;pos;++pos)
       if (list[pos]->get_file()==file) break;
    
-   if (pos) list[pos]->refresh();	// Refresh the timestamp
+      // Timestamps come from a counter rather than from time(): pages
+      // are turned faster than once per second, and the oldest item
+      // has to be the least recently used one.
+   if (pos) list[pos]->time=++stamp;	// Refresh the timestamp
    else
    {
 	 // Doesn't exist in the list yet
@@ -140,7 +143,9 @@ DjVuFileCache::add_file(const GP<DjVuFile> & file)
 
       if (_max_size>=0) clear_to_size(_max_size-add_size);
 
-      list.append(new Item(file));
+      GP<Item> item=new Item(file);
+      item->time=++stamp;
+      list.append(item);
       cur_size+=add_size;
       file_added(file);
    }
@@ -181,6 +186,7 @@ DjVuFileCache::clear_to_size(int size)
 	    cur_size-=item->get_size();
 	    GP<DjVuFile> file=item->file;
 	    list.del(item->list_pos);
+	    evictions++;
 	    file_cleared(file);
 	    if (cur_size<=0) cur_size=calculate_size();
 	 }
@@ -205,6 +211,7 @@ DjVuFileCache::clear_to_size(int size)
 	    cur_size-=list[oldest_pos]->get_size();
 	    GP<DjVuFile> file=list[oldest_pos]->file;
 	    list.del(oldest_pos);
+	    evictions++;
 	    file_cleared(file);
 
 	       // cur_size *may* become negative because items may change their
@@ -248,6 +255,40 @@ DjVuFileCache::del_file(const DjVuFile * file)
    DEBUG_MSG("current cache size=" << cur_size << "\n");
 }
 
+DjVuFileCache::Stats
+DjVuFileCache::get_stats(void)
+{
+   GCriticalSectionLock lock(&class_lock);
+
+   Stats stats;
+   stats.hits=hits;
+   stats.misses=misses;
+   stats.evictions=evictions;
+   stats.files=list.size();
+   stats.size=calculate_size();
+   return stats;
+}
+
+void
+DjVuFileCache::note_hit(const GP<DjVuFile> & file)
+{
+   GCriticalSectionLock lock(&class_lock);
+   hits++;
+   for(GPosition pos=list;pos;++pos)
+      if (list[pos]->get_file()==file)
+      {
+	 list[pos]->time=++stamp;
+	 break;
+      }
+}
+
+void
+DjVuFileCache::note_miss(void)
+{
+   GCriticalSectionLock lock(&class_lock);
+   misses++;
+}
+
 GPList<DjVuFileCache::Item>
 DjVuFileCache::get_items(void)
 {
@@ -123,6 +123,10 @@ public:
    int get_max_size(void) const {return 0;}
    void enable(bool en) {}
    bool is_enabled(void) const {return false;}
+   struct Stats { int hits, misses, evictions, files, size; };
+   Stats get_stats(void) { Stats s = {0, 0, 0, 0, 0}; return s; }
+   void note_hit(const GP<DjVuFile> &) {}
+   void note_miss(void) {}
 } ;
 #else
 class DjVuFileCache : public GPEnabled
@@ -168,6 +172,26 @@ public:
 	  setting the {\em maximum size} of the cache to #ZERO#. */
    bool		is_enabled(void) const;
 
+      /** Counters of the cache, used to tune its size. */
+   struct Stats
+   {
+      int	hits;		// decoded files found alive
+      int	misses;		// files which had to be created again
+      int	evictions;	// files dropped to honor the maximum size
+      int	files;		// files in the cache
+      int	size;		// estimated size of these files in bytes
+   };
+
+      /** Returns the counters of the cache. */
+   Stats	get_stats(void);
+
+      /** Called by \Ref{DjVuDocument} when a decoded file is found alive.
+	  The timestamp of the file is refreshed if it is in the cache. */
+   void		note_hit(const GP<DjVuFile> & file);
+
+      /** Called by \Ref{DjVuDocument} when a file has to be created. */
+   void		note_miss(void);
+
 public:
    class Item;
    
@@ -211,6 +235,10 @@ private:
    bool		enabled;
    int		max_size;
    int		cur_size;
+   int		hits;
+   int		misses;
+   int		evictions;
+   time_t	stamp;
 
    int		calculate_size(void);
    void		clear_to_size(int size);
@@ -256,7 +284,8 @@ DjVuFileCache::Item::refresh(void)
 
 inline
 DjVuFileCache::DjVuFileCache(const int xmax_size) :
-      enabled(true), max_size(xmax_size), cur_size(0) {}
+      enabled(true), max_size(xmax_size), cur_size(0),
+      hits(0), misses(0), evictions(0), stamp(0) {}
 
 inline void
 DjVuFileCache::clear(void)
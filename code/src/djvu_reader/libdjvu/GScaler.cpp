@@ -68,6 +68,15 @@
 
 #include "GScaler.h"
 
+#include <string.h>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+# define GSCALER_NEON 1
+#endif
+
 
 #ifdef HAVE_NAMESPACES
 namespace DJVU {
@@ -128,6 +137,120 @@ maxi(int x, int y)
 }
 
 
+// Interpolates n bytes between lines lower and upper.
+// GPixel lines are processed as runs of bytes because 
+// all three channels use the same vertical fraction.
+// Vector code computes l+(((u-l)*frac+FRACSIZE2)>>FRACBITS)
+// which is exactly what the interp table contains.
+
+static void
+interp_line(unsigned char *dest, const unsigned char *lower,
+            const unsigned char *upper, int n, int frac)
+{
+  unsigned char * const edest = dest + n;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i f = _mm_set1_epi16(frac);
+  const __m128i rnd = _mm_set1_epi16(FRACSIZE2);
+  for (; dest+16 <= edest; dest+=16, lower+=16, upper+=16)
+    {
+      __m128i l = _mm_loadu_si128((const __m128i*)lower);
+      __m128i u = _mm_loadu_si128((const __m128i*)upper);
+      __m128i l0 = _mm_unpacklo_epi8(l, zero);
+      __m128i l1 = _mm_unpackhi_epi8(l, zero);
+      __m128i d0 = _mm_sub_epi16(_mm_unpacklo_epi8(u, zero), l0);
+      __m128i d1 = _mm_sub_epi16(_mm_unpackhi_epi8(u, zero), l1);
+      d0 = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d0, f), rnd), FRACBITS);
+      d1 = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d1, f), rnd), FRACBITS);
+      __m128i r = _mm_packus_epi16(_mm_add_epi16(l0, d0), _mm_add_epi16(l1, d1));
+      _mm_storeu_si128((__m128i*)dest, r);
+    }
+#elif defined(GSCALER_NEON)
+  for (; dest+8 <= edest; dest+=8, lower+=8, upper+=8)
+    {
+      uint8x8_t l = vld1_u8(lower);
+      uint8x8_t u = vld1_u8(upper);
+      int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(u, l));
+      d = vrshrq_n_s16(vmulq_n_s16(d, (short)frac), FRACBITS);
+      int16x8_t r = vaddq_s16(vreinterpretq_s16_u16(vmovl_u8(l)), d);
+      vst1_u8(dest, vqmovun_s16(r));
+    }
+#endif
+  const short *deltas = & interp[frac][256];
+  for (; dest<edest; upper++,lower++,dest++)
+    {
+      const int l = *lower;
+      const int u = *upper;
+      *dest = l + deltas[u-l];
+    }
+}
+
+
+// Computes the integer reduction factor for ratio numer/denom
+// or zero when the ratio is not of the form 1/n with n>1.
+
+static inline int
+box_factor(int numer, int denom)
+{
+  if (numer < denom && denom % numer == 0)
+    return denom / numer;
+  return 0;
+}
+
+
+// Box filter used instead of the reduce-and-interpolate path when
+// both ratios are exact integer reductions (e.g. thumbnails).
+// Output pixel (x,y) is the average of input pixels
+// [x*kx,(x+1)*kx) x [y*ky,(y+1)*ky) clipped to the provided input.
+// Each pixel is made of nc consecutive bytes (one per channel).
+
+static void
+box_reduce(const GRect &provided_input, 
+           const unsigned char *inrow, int inrowsize,
+           const unsigned char *conv, const GRect &desired_output,
+           unsigned char *outrow, int outrowsize, 
+           int nc, int kx, int ky)
+{
+  const int w = desired_output.width();
+  int *acc;
+  GPBuffer<int> gacc(acc, w*nc);
+  for (int y=desired_output.ymin; y<desired_output.ymax; y++, outrow+=outrowsize)
+    {
+      const int iy0 = maxi(y*ky, provided_input.ymin);
+      const int iy1 = mini((y+1)*ky, provided_input.ymax);
+      memset(acc, 0, w*nc*sizeof(int));
+      for (int iy=iy0; iy<iy1; iy++)
+        {
+          const unsigned char *in = inrow + (iy-provided_input.ymin)*inrowsize;
+          int *a = acc;
+          for (int x=desired_output.xmin; x<desired_output.xmax; x++, a+=nc)
+            {
+              const int ix0 = maxi(x*kx, provided_input.xmin);
+              const int ix1 = mini((x+1)*kx, provided_input.xmax);
+              const unsigned char *p = in + (ix0-provided_input.xmin)*nc;
+              const unsigned char * const e = in + (ix1-provided_input.xmin)*nc;
+              if (conv)
+                for (; p<e; p++)
+                  a[0] += conv[*p];
+              else
+                for (; p<e; p+=nc)
+                  for (int c=0; c<nc; c++)
+                    a[c] += p[c];
+            }
+        }
+      const int *a = acc;
+      unsigned char *out = outrow;
+      for (int x=desired_output.xmin; x<desired_output.xmax; x++, a+=nc)
+        {
+          const int s = (iy1-iy0) *
+            (mini((x+1)*kx, provided_input.xmax) - maxi(x*kx, provided_input.xmin));
+          for (int c=0; c<nc; c++)
+            *out++ = (s > 0) ? (a[c]+s/2)/s : 0;
+        }
+    }
+}
+
+
 
 
 
@@ -140,6 +263,7 @@ GScaler::GScaler()
   : inw(0), inh(0), 
     xshift(0), yshift(0), redw(0), redh(0), 
     outw(0), outh(0),
+    xbox(0), ybox(0),
     gvcoord(vcoord,0), ghcoord(hcoord,0)
 {
 }
@@ -215,6 +339,7 @@ GScaler::set_horz_ratio(int numer, int denom)
     denom = inw;
   } else if (numer<=0 || denom<=0)
     G_THROW( ERR_MSG("GScaler.ratios") );
+  xbox = box_factor(numer, denom);
   // Compute horz reduction
   xshift = 0;
   redw = inw;
@@ -241,7 +366,8 @@ GScaler::set_vert_ratio(int numer, int denom)
     denom = inh;
   } else if (numer<=0 || denom<=0)
     G_THROW( ERR_MSG("GScaler.ratios") );
-  // Compute horz reduction
+  ybox = box_factor(numer, denom);
+  // Compute vert reduction
   yshift = 0;
   redh = inh;
   while (numer+numer < denom) {
@@ -419,16 +545,6 @@ GBitmapScaler::scale( const GRect &provided_input, const GBitmap &input,
       desired_output.height() != (int)output.rows() )
     output.init(desired_output.height(), desired_output.width());
   output.set_grays(256);
-  // Prepare temp stuff
-  gp1.resize(0);
-  gp2.resize(0);
-  glbuffer.resize(0);
-  prepare_interp();
-  const int bufw = required_red.width();
-  glbuffer.resize(bufw+2);
-  gp1.resize(bufw);
-  gp2.resize(bufw);
-  l1 = l2 = -1;
   // Prepare gray conversion array (conv)
   gconv.resize(0);
   gconv.resize(256);
@@ -439,6 +555,29 @@ GBitmapScaler::scale( const GRect &provided_input, const GBitmap &input,
         ?(((i*255) + (maxgray>>1)) / maxgray)
         :255;
     }
+  // Box filter for integer reductions
+  if (xbox > 1 && ybox > 1)
+    {
+      box_reduce(provided_input, input[0], input.rowsize(), conv,
+                 desired_output, output[0], output.rowsize(), 1, xbox, ybox);
+      gconv.resize(0);
+      return;
+    }
+  // Lines can be read directly when no reduction or conversion is needed
+  const bool direct = (xshift==0 && yshift==0 && maxgray==255);
+  // Prepare temp stuff
+  gp1.resize(0);
+  gp2.resize(0);
+  glbuffer.resize(0);
+  prepare_interp();
+  const int bufw = required_red.width();
+  glbuffer.resize(bufw+2);
+  if (! direct)
+    {
+      gp1.resize(bufw);
+      gp2.resize(bufw);
+      l1 = l2 = -1;
+    }
   // Loop on output lines
   for (int y=desired_output.ymin; y<desired_output.ymax; y++)
     {
@@ -449,18 +588,21 @@ GBitmapScaler::scale( const GRect &provided_input, const GBitmap &input,
         int fy2 = fy1+1;
         const unsigned char *lower, *upper;
         // Obtain upper and lower line in reduced image
-        lower = get_line(fy1, required_red, provided_input, input);
-        upper = get_line(fy2, required_red, provided_input, input);
+        if (! direct)
+          {
+            lower = get_line(fy1, required_red, provided_input, input);
+            upper = get_line(fy2, required_red, provided_input, input);
+          }
+        else
+          {
+            int dx = required_red.xmin-provided_input.xmin;
+            fy1 = maxi(fy1, required_red.ymin);
+            fy2 = mini(fy2, required_red.ymax-1);
+            lower = input[fy1-provided_input.ymin] + dx;
+            upper = input[fy2-provided_input.ymin] + dx;
+          }
         // Compute line
-        unsigned char *dest = lbuffer+1;
-        const short *deltas = & interp[fy&FRACMASK][256];
-        for(unsigned char const * const edest=(unsigned char const *)dest+bufw;
-          dest<edest;upper++,lower++,dest++)
-        {
-          const int l = *lower;
-          const int u = *upper;
-          *dest = l + deltas[u-l];
-        }
+        interp_line(lbuffer+1, lower, upper, bufw, fy&FRACMASK);
       }
       // Perform horizontal interpolation
       {
@@ -613,6 +755,15 @@ GPixmapScaler::scale( const GRect &provided_input, const GPixmap &input,
   if (desired_output.width() != (int)output.columns() ||
       desired_output.height() != (int)output.rows() )
     output.init(desired_output.height(), desired_output.width());
+  // Box filter for integer reductions
+  if (xbox > 1 && ybox > 1)
+    {
+      box_reduce(provided_input, (const unsigned char*)input[0], 
+                 input.rowsize()*sizeof(GPixel), 0, desired_output, 
+                 (unsigned char*)output[0], output.rowsize()*sizeof(GPixel),
+                 sizeof(GPixel), xbox, ybox);
+      return;
+    }
   // Prepare temp stuff 
   gp1.resize(0);
   gp2.resize(0);
@@ -650,21 +801,9 @@ GPixmapScaler::scale( const GRect &provided_input, const GPixmap &input,
             upper = input[fy2-provided_input.ymin] + dx;
           }
         // Compute line
-        GPixel *dest = lbuffer+1;
-        const short *deltas = & interp[fy&FRACMASK][256];
-        for(GPixel const * const edest = (GPixel const *)dest+bufw;
-          dest<edest;upper++,lower++,dest++)
-        {
-          const int lower_r = lower->r;
-          const int delta_r = deltas[(int)upper->r - lower_r];
-          dest->r = lower_r + delta_r;
-          const int lower_g = lower->g;
-          const int delta_g = deltas[(int)upper->g - lower_g];
-          dest->g = lower_g + delta_g;
-          const int lower_b = lower->b;
-          const int delta_b = deltas[(int)upper->b - lower_b];
-          dest->b = lower_b + delta_b;
-        }
+        interp_line((unsigned char*)(lbuffer+1), (const unsigned char*)lower,
+                    (const unsigned char*)upper, bufw*sizeof(GPixel), 
+                    fy&FRACMASK);
       }
       // Perform horizontal interpolation
       {
@@ -151,6 +151,8 @@ protected:
   int xshift, yshift;
   int redw, redh;
   int outw, outh;
+  // Integer reduction factors (zero unless the ratio is 1/n)
+  int xbox, ybox;
   // Fixed point coordinates
   int *vcoord;
   GPBuffer<int> gvcoord;
@@ -82,6 +82,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include "GThreads.h"
 #include "MMX.h"
 #undef IWTRANSFORM_TIMER
 #ifdef IWTRANSFORM_TIMER
@@ -150,109 +151,148 @@ public:
 };
 
 //////////////////////////////////////////////////////
-// MMX IMPLEMENTATION HELPERS
+// SIMD IMPLEMENTATION HELPERS
 //////////////////////////////////////////////////////
 
 
 // Note:
-// MMX implementation for vertical transforms only.
-// Speedup is basically related to faster memory transfer
-// The IW44 transform is not CPU bound, it is memory bound.
+// SSE2/NEON implementation for vertical transforms only.
+// Rows are processed eight coefficients at a time. Lifting
+// sums are computed on 32 bits and truncated back to 16 bits
+// exactly like the scalar code, so the output is bit-exact.
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+# define IWSIMD 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+# define IWSIMD 1
+#endif
 
-#ifdef MMX
+#if defined(__SSE2__)
+
+static inline __m128i
+sse2_lo32(__m128i x)
+{
+  return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+static inline __m128i
+sse2_hi32(__m128i x)
+{
+  return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
 
-static const short w9[]  = {9,9,9,9};
-static const short w1[]  = {1,1,1,1};
-static const int   d8[]  = {8,8};
-static const int   d16[] = {16,16};
+static inline __m128i
+sse2_lift32(__m128i a, __m128i b, __m128i rnd, int shift)
+{
+  // ((a<<3)+a-b+rnd)>>shift, truncated to 16 bits
+  __m128i x = _mm_add_epi32(_mm_slli_epi32(a, 3), a);
+  x = _mm_add_epi32(_mm_sub_epi32(x, b), rnd);
+  x = _mm_sra_epi32(x, _mm_cvtsi32_si128(shift));
+  return _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+}
+
+static inline __m128i
+sse2_lift(short *q, int s, int s3, __m128i rnd, int shift)
+{
+  __m128i b = _mm_loadu_si128((const __m128i*)(q-s));
+  __m128i c = _mm_loadu_si128((const __m128i*)(q+s));
+  __m128i a = _mm_loadu_si128((const __m128i*)(q-s3));
+  __m128i d = _mm_loadu_si128((const __m128i*)(q+s3));
+  __m128i lo = sse2_lift32(_mm_add_epi32(sse2_lo32(b), sse2_lo32(c)),
+                           _mm_add_epi32(sse2_lo32(a), sse2_lo32(d)),
+                           rnd, shift);
+  __m128i hi = sse2_lift32(_mm_add_epi32(sse2_hi32(b), sse2_hi32(c)),
+                           _mm_add_epi32(sse2_hi32(a), sse2_hi32(d)),
+                           rnd, shift);
+  return _mm_packs_epi32(lo, hi);
+}
 
 static void
-mmx_bv_1 ( short* &q, short* e, int s, int s3 )
+simd_bv_1 ( short* &q, short* e, int s, int s3 )
 {
-  while (q<e && (((long)q)&0x7))
+  const __m128i rnd = _mm_set1_epi32(16);
+  while (q+7 < e)
     {
-      int a = (int)q[-s] + (int)q[s];
-      int b = (int)q[-s3] + (int)q[s3];
-      *q -= (((a<<3)+a-b+16)>>5);
-      q ++;
-  }
-  while (q+3 < e)
+      __m128i p = _mm_loadu_si128((const __m128i*)q);
+      __m128i x = sse2_lift(q, s, s3, rnd, 5);
+      _mm_storeu_si128((__m128i*)q, _mm_sub_epi16(p, x));
+      q += 8;
+    }
+}
+
+static void
+simd_bv_2 ( short* &q, short* e, int s, int s3 )
+{
+  const __m128i rnd = _mm_set1_epi32(8);
+  while (q+7 < e)
     {
-      MMXar( movq,       q-s,mm0);  // MM0=[ b3, b2, b1, b0 ]
-      MMXar( movq,       q+s,mm2);  // MM2=[ c3, c2, c1, c0 ]
-      MMXrr( movq,       mm0,mm1);  
-      MMXrr( punpcklwd,  mm2,mm0);  // MM0=[ c1, b1, c0, b0 ]
-      MMXrr( punpckhwd,  mm2,mm1);  // MM1=[ c3, b3, c2, b2 ]
-      MMXar( pmaddwd,    w9,mm0);   // MM0=[ (c1+b1)*9, (c0+b0)*9 ]
-      MMXar( pmaddwd,    w9,mm1);   // MM1=[ (c3+b3)*9, (c2+b2)*9 ]
-      MMXar( movq,       q-s3,mm2);
-      MMXar( movq,       q+s3,mm4);
-      MMXrr( movq,       mm2,mm3);
-      MMXrr( punpcklwd,  mm4,mm2);  // MM2=[ d1, a1, d0, a0 ]
-      MMXrr( punpckhwd,  mm4,mm3);  // MM3=[ d3, a3, d2, a2 ]
-      MMXar( pmaddwd,    w1,mm2);   // MM2=[ (a1+d1)*1, (a0+d0)*1 ]
-      MMXar( pmaddwd,    w1,mm3);   // MM3=[ (a3+d3)*1, (a2+d2)*1 ]
-      MMXar( paddd,      d16,mm0);
-      MMXar( paddd,      d16,mm1);
-      MMXrr( psubd,      mm2,mm0);  // MM0=[ (c1+b1)*9-a1-d1+8, ...
-      MMXrr( psubd,      mm3,mm1);  // MM1=[ (c3+b3)*9-a3-d3+8, ...
-      MMXir( psrad,      5,mm0);
-      MMXar( movq,       q,mm7);    // MM7=[ p3,p2,p1,p0 ]
-      MMXir( psrad,      5,mm1);
-      MMXrr( packssdw,   mm1,mm0);  // MM0=[ x3,x2,x1,x0 ]
-      MMXrr( psubw,      mm0,mm7);  // MM7=[ p3-x3, p2-x2, ... ]
-      MMXra( movq,       mm7,q);
-#if defined(_MSC_VER) && defined(_DEBUG)
-      MMXemms;
-#endif
-      q += 4;
+      __m128i p = _mm_loadu_si128((const __m128i*)q);
+      __m128i x = sse2_lift(q, s, s3, rnd, 4);
+      _mm_storeu_si128((__m128i*)q, _mm_add_epi16(p, x));
+      q += 8;
     }
 }
 
+#elif defined(IWSIMD)
+
+static inline int32x4_t
+neon_lift32(int32x4_t a, int32x4_t b, int32x4_t rnd)
+{
+  // (a<<3)+a-b+rnd, before the final shift
+  return vaddq_s32(vsubq_s32(vaddq_s32(vshlq_n_s32(a, 3), a), b), rnd);
+}
 
 static void
-mmx_bv_2 ( short* &q, short* e, int s, int s3 )
+simd_bv_1 ( short* &q, short* e, int s, int s3 )
 {
-  while (q<e && (((long)q)&0x7))
+  const int32x4_t rnd = vdupq_n_s32(16);
+  while (q+7 < e)
     {
-      int a = (int)q[-s] + (int)q[s];
-      int b = (int)q[-s3] + (int)q[s3];
-      *q += (((a<<3)+a-b+8)>>4);
-      q ++;
+      int16x8_t p = vld1q_s16(q);
+      int16x8_t b = vld1q_s16(q-s);
+      int16x8_t c = vld1q_s16(q+s);
+      int16x8_t a = vld1q_s16(q-s3);
+      int16x8_t d = vld1q_s16(q+s3);
+      int32x4_t lo = neon_lift32(vaddl_s16(vget_low_s16(b), vget_low_s16(c)),
+                                 vaddl_s16(vget_low_s16(a), vget_low_s16(d)),
+                                 rnd);
+      int32x4_t hi = neon_lift32(vaddl_s16(vget_high_s16(b), vget_high_s16(c)),
+                                 vaddl_s16(vget_high_s16(a), vget_high_s16(d)),
+                                 rnd);
+      int16x8_t x = vcombine_s16(vmovn_s32(vshrq_n_s32(lo, 5)),
+                                 vmovn_s32(vshrq_n_s32(hi, 5)));
+      vst1q_s16(q, vsubq_s16(p, x));
+      q += 8;
     }
-  while (q+3 < e)
+}
+
+static void
+simd_bv_2 ( short* &q, short* e, int s, int s3 )
+{
+  const int32x4_t rnd = vdupq_n_s32(8);
+  while (q+7 < e)
     {
-      MMXar( movq,       q-s,mm0);  // MM0=[ b3, b2, b1, b0 ]
-      MMXar( movq,       q+s,mm2);  // MM2=[ c3, c2, c1, c0 ]
-      MMXrr( movq,       mm0,mm1);  
-      MMXrr( punpcklwd,  mm2,mm0);  // MM0=[ c1, b1, c0, b0 ]
-      MMXrr( punpckhwd,  mm2,mm1);  // MM1=[ c3, b3, c2, b2 ]
-      MMXar( pmaddwd,    w9,mm0);   // MM0=[ (c1+b1)*9, (c0+b0)*9 ]
-      MMXar( pmaddwd,    w9,mm1);   // MM1=[ (c3+b3)*9, (c2+b2)*9 ]
-      MMXar( movq,       q-s3,mm2);
-      MMXar( movq,       q+s3,mm4);
-      MMXrr( movq,       mm2,mm3);
-      MMXrr( punpcklwd,  mm4,mm2);  // MM2=[ d1, a1, d0, a0 ]
-      MMXrr( punpckhwd,  mm4,mm3);  // MM3=[ d3, a3, d2, a2 ]
-      MMXar( pmaddwd,    w1,mm2);   // MM2=[ (a1+d1)*1, (a0+d0)*1 ]
-      MMXar( pmaddwd,    w1,mm3);   // MM3=[ (a3+d3)*1, (a2+d2)*1 ]
-      MMXar( paddd,      d8,mm0);
-      MMXar( paddd,      d8,mm1);
-      MMXrr( psubd,      mm2,mm0);  // MM0=[ (c1+b1)*9-a1-d1+8, ...
-      MMXrr( psubd,      mm3,mm1);  // MM1=[ (c3+b3)*9-a3-d3+8, ...
-      MMXir( psrad,      4,mm0);
-      MMXar( movq,       q,mm7);    // MM7=[ p3,p2,p1,p0 ]
-      MMXir( psrad,      4,mm1);
-      MMXrr( packssdw,   mm1,mm0);  // MM0=[ x3,x2,x1,x0 ]
-      MMXrr( paddw,      mm0,mm7);  // MM7=[ p3+x3, p2+x2, ... ]
-      MMXra( movq,       mm7,q);
-#if defined(_MSC_VER) && defined(_DEBUG)
-      MMXemms;
-#endif
-      q += 4;
+      int16x8_t p = vld1q_s16(q);
+      int16x8_t b = vld1q_s16(q-s);
+      int16x8_t c = vld1q_s16(q+s);
+      int16x8_t a = vld1q_s16(q-s3);
+      int16x8_t d = vld1q_s16(q+s3);
+      int32x4_t lo = neon_lift32(vaddl_s16(vget_low_s16(b), vget_low_s16(c)),
+                                 vaddl_s16(vget_low_s16(a), vget_low_s16(d)),
+                                 rnd);
+      int32x4_t hi = neon_lift32(vaddl_s16(vget_high_s16(b), vget_high_s16(c)),
+                                 vaddl_s16(vget_high_s16(a), vget_high_s16(d)),
+                                 rnd);
+      int16x8_t x = vcombine_s16(vmovn_s32(vshrq_n_s32(lo, 4)),
+                                 vmovn_s32(vshrq_n_s32(hi, 4)));
+      vst1q_s16(q, vaddq_s16(p, x));
+      q += 8;
     }
 }
-#endif /* MMX */
+
+#endif /* IWSIMD */
 
 static void 
 filter_bv(short *p, int w, int h, int rowsize, int scale)
@@ -270,9 +310,9 @@ filter_bv(short *p, int w, int h, int rowsize, int scale)
         if (y>=3 && y+3<h)
           {
             // Generic case
-#ifdef MMX
-            if (scale==1 && MMXControl::mmxflag>0)
-              mmx_bv_1(q, e, s, s3);
+#ifdef IWSIMD
+            if (scale==1)
+              simd_bv_1(q, e, s, s3);
 #endif
             while (q<e)
               {
@@ -332,9 +372,9 @@ filter_bv(short *p, int w, int h, int rowsize, int scale)
         if (y>=6 && y<h)
           {
             // Generic case
-#ifdef MMX
-            if (scale==1 && MMXControl::mmxflag>0)
-              mmx_bv_2(q, e, s, s3);
+#ifdef IWSIMD
+            if (scale==1)
+              simd_bv_2(q, e, s, s3);
 #endif
             while (q<e)
               {
@@ -1867,6 +1907,190 @@ IW44Image::Transform::filter_end(void)
 }
 
 
+//////////////////////////////////////////////////////
+// PARALLEL RECONSTRUCTION
+//////////////////////////////////////////////////////
+
+
+// Note:
+// The vertical filter processes columns independently and the
+// horizontal filter processes rows independently.  Large transforms
+// are therefore split into strips that are filtered by a small pool
+// of worker threads.  The calling thread works on strips as well and
+// returns when all strips are done.  When the pool is already busy
+// (nested or concurrent reconstruction) or when there is a single
+// processor, the strips are simply filtered by the calling thread.
+
+#if THREADMODEL==POSIXTHREADS
+# define IWPARALLEL 1
+#endif
+
+// Transforms smaller than this are not worth splitting.
+static const int iw_parallel_min = 128*128;
+
+typedef void (*IWStripFunc)(void *arg, int strip, int nstrips);
+
+#ifdef IWPARALLEL
+
+static const int iw_maxworkers = 3;
+
+class IWWorkers
+{
+public:
+  static IWWorkers *instance();
+  int  size(void) const { return nworkers; }
+  bool run(IWStripFunc func, void *arg, int nstrips);
+private:
+  IWWorkers(void);
+  static void start(void *arg);
+  void loop(void);
+  GMonitor monitor;
+  GThread *threads[iw_maxworkers];
+  int nworkers;
+  bool busy;
+  IWStripFunc func;
+  void *arg;
+  int nstrips;
+  int next;
+  int done;
+};
+
+IWWorkers *
+IWWorkers::instance()
+{
+  // Workers are never destroyed: they sleep on the monitor when idle.
+  static IWWorkers *workers = new IWWorkers();
+  return workers;
+}
+
+IWWorkers::IWWorkers(void)
+  : nworkers(0), busy(false), func(0), arg(0), nstrips(0), next(0), done(0)
+{
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  int n = (ncpu > 1) ? (int)(ncpu - 1) : 0;
+  if (n > iw_maxworkers)
+    n = iw_maxworkers;
+  for (int i=0; i<n; i++)
+    {
+      threads[nworkers] = new GThread();
+      if (threads[nworkers]->create(start, (void*)this) < 0)
+        {
+          delete threads[nworkers];
+          break;
+        }
+      nworkers += 1;
+    }
+}
+
+void
+IWWorkers::start(void *arg)
+{
+  ((IWWorkers*)arg)->loop();
+}
+
+void
+IWWorkers::loop(void)
+{
+  GMonitorLock lock(&monitor);
+  for(;;)
+    {
+      while (! (busy && next < nstrips))
+        monitor.wait();
+      int strip = next++;
+      monitor.leave();
+      (*func)(arg, strip, nstrips);
+      monitor.enter();
+      if (++done == nstrips)
+        monitor.broadcast();
+    }
+}
+
+bool
+IWWorkers::run(IWStripFunc xfunc, void *xarg, int xnstrips)
+{
+  {
+    GMonitorLock lock(&monitor);
+    if (busy || nworkers == 0)
+      return false;
+    busy = true;
+    func = xfunc;
+    arg = xarg;
+    nstrips = xnstrips;
+    next = done = 0;
+    monitor.broadcast();
+  }
+  GMonitorLock lock(&monitor);
+  while (next < nstrips)
+    {
+      int strip = next++;
+      monitor.leave();
+      (*func)(arg, strip, nstrips);
+      monitor.enter();
+      done += 1;
+    }
+  while (done < nstrips)
+    monitor.wait();
+  busy = false;
+  return true;
+}
+
+#endif /* IWPARALLEL */
+
+static void
+iw_parallel(IWStripFunc func, void *arg, int npixels)
+{
+#ifdef IWPARALLEL
+  if (npixels >= iw_parallel_min)
+    {
+      IWWorkers *workers = IWWorkers::instance();
+      int nstrips = 2 * (workers->size() + 1);
+      if (workers->size() > 0 && workers->run(func, arg, nstrips))
+        return;
+    }
+#endif
+  (*func)(arg, 0, 1);
+}
+
+struct IWFilterArgs
+{
+  short *p;
+  int w, h, rowsize, scale;
+};
+
+// Returns the start of strip #strip# out of #nstrips# over #n# 
+// coefficients sampled every #scale# positions.
+static inline int
+iw_strip_start(int n, int scale, int strip, int nstrips)
+{
+  int count = (n + scale - 1) / scale;
+  return (int)(((long)count * strip) / nstrips) * scale;
+}
+
+static void
+filter_bv_strip(void *arg, int strip, int nstrips)
+{
+  IWFilterArgs *a = (IWFilterArgs*)arg;
+  int x0 = iw_strip_start(a->w, a->scale, strip, nstrips);
+  int x1 = iw_strip_start(a->w, a->scale, strip+1, nstrips);
+  if (strip+1 == nstrips)
+    x1 = a->w;
+  if (x1 > x0)
+    filter_bv(a->p + x0, x1 - x0, a->h, a->rowsize, a->scale);
+}
+
+static void
+filter_bh_strip(void *arg, int strip, int nstrips)
+{
+  IWFilterArgs *a = (IWFilterArgs*)arg;
+  int y0 = iw_strip_start(a->h, a->scale, strip, nstrips);
+  int y1 = iw_strip_start(a->h, a->scale, strip+1, nstrips);
+  if (strip+1 == nstrips)
+    y1 = a->h;
+  if (y1 > y0)
+    filter_bh(a->p + y0 * a->rowsize, a->w, y1 - y0, a->rowsize, a->scale);
+}
+
+
 //////////////////////////////////////////////////////
 // WAVELET TRANSFORM 
 //////////////////////////////////////////////////////
@@ -1888,12 +2112,14 @@ IW44Image::Transform::Decode::backward(short *p, int w, int h, int rowsize, int
       int tv,th;
       th = tv = GOS::ticks();
 #endif
-      filter_bv(p, w, h, rowsize, scale);
+      IWFilterArgs args = { p, w, h, rowsize, scale };
+      int npixels = (w / scale) * (h / scale);
+      iw_parallel(filter_bv_strip, (void*)&args, npixels);
 #ifdef IWTRANSFORM_TIMER
       th = GOS::ticks();
       tv = th - tv;
 #endif
-      filter_bh(p, w, h, rowsize, scale);
+      iw_parallel(filter_bh_strip, (void*)&args, npixels);
 #ifdef IWTRANSFORM_TIMER
       th = GOS::ticks()-th;
       DjVuPrintErrorUTF8("back%d\tv=%dms h=%dms\n", scale,tv,th);
@@ -1910,11 +2136,21 @@ IW44Image::Transform::Decode::backward(short *p, int w, int h, int rowsize, int
 // COLOR TRANSFORM 
 //////////////////////////////////////////////////////
 
-/* Converts YCbCr to RGB. */
-void 
-IW44Image::Transform::Decode::YCbCr_to_RGB(GPixel *p, int w, int h, int rowsize)
+struct IWColorArgs
+{
+  GPixel *p;
+  int w, h, rowsize;
+};
+
+static void
+YCbCr_to_RGB_strip(void *arg, int strip, int nstrips)
 {
-  for (int i=0; i<h; i++,p+=rowsize)
+  IWColorArgs *a = (IWColorArgs*)arg;
+  int y0 = iw_strip_start(a->h, 1, strip, nstrips);
+  int y1 = iw_strip_start(a->h, 1, strip+1, nstrips);
+  int w = a->w;
+  GPixel *p = a->p + y0 * a->rowsize;
+  for (int i=y0; i<y1; i++,p+=a->rowsize)
     {
       GPixel *q = p;
       for (int j=0; j<w; j++,q++)
@@ -1936,6 +2172,14 @@ IW44Image::Transform::Decode::YCbCr_to_RGB(GPixel *p, int w, int h, int rowsize)
     }
 }
 
+/* Converts YCbCr to RGB. */
+void 
+IW44Image::Transform::Decode::YCbCr_to_RGB(GPixel *p, int w, int h, int rowsize)
+{
+  IWColorArgs args = { p, w, h, rowsize };
+  iw_parallel(YCbCr_to_RGB_strip, (void*)&args, w * h);
+}
+
 
 #ifdef HAVE_NAMESPACES
 }
@@ -530,6 +530,31 @@ ddjvu_cache_get_size(ddjvu_context_t *ctx)
   return 0;
 }
 
+void
+ddjvu_cache_get_stats(ddjvu_context_t *ctx,
+                      ddjvu_cachestats_t *stats)
+{
+  memset(stats, 0, sizeof(ddjvu_cachestats_t));
+  G_TRY
+    {
+      GMonitorLock lock(&ctx->monitor);
+      if (ctx->cache)
+        {
+          DjVuFileCache::Stats s = ctx->cache->get_stats();
+          stats->hits = s.hits;
+          stats->misses = s.misses;
+          stats->evictions = s.evictions;
+          stats->files = s.files;
+          stats->size = s.size;
+        }
+    }
+  G_CATCH(ex)
+    {
+      ERROR1(ctx, ex);
+    }
+  G_ENDCATCH;
+}
+
 void
 ddjvu_cache_clear(ddjvu_context_t *ctx)
 {
@@ -227,6 +227,25 @@ DDJVUAPI void
 ddjvu_cache_clear(ddjvu_context_t *context);
 
 
+/* ddjvu_cache_get_stats ---
+   Returns the counters of the cache of decoded page data:
+   decoded files found alive (hits), files created again (misses),
+   files dropped to honor the maximum size (evictions),
+   and the number and estimated size in bytes of the cached files. */
+
+typedef struct ddjvu_cachestats_s {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long evictions;
+  unsigned long files;
+  unsigned long size;
+} ddjvu_cachestats_t;
+
+DDJVUAPI void
+ddjvu_cache_get_stats(ddjvu_context_t *context,
+                      ddjvu_cachestats_t *stats);
+
+
 
 /* ------- MESSAGE QUEUE ------- */
 
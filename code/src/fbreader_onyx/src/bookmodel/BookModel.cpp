@@ -19,27 +19,64 @@
 
 #include <ZLImage.h>
 #include <ZLFile.h>
+#include <ZLTime.h>
 
 #include "BookModel.h"
+#include "BookModelCache.h"
 #include "BookReader.h"
 
 #include "../formats/FormatPlugin.h"
 
+// the first pages are read before the book is shown, the rest in slices
+static const size_t FIRST_PARAGRAPHS = 512;
+static const size_t SLICE_SIZE = 16384;
+static const long SLICE_TIME = 50;
+
 BookModel::BookModel(const BookDescriptionPtr description)
     : myDescription(description)
     , isDRM(false)
     , myOpenStatus(OPEN_NORMAL)
+    , myPlugin(0)
 {
   myBookTextModel.reset(new ZLTextPlainModel(102400));
   myContentsModel.reset(new ContentsModel());
 	ZLFile file(description->fileName());
 	FormatPlugin *plugin = PluginCollection::instance().plugin(file, false);
-	if (plugin != 0) {
-		plugin->readModel(*description, *this);
+	if ((plugin != 0) && !BookModelCache::load(*description, *plugin, *this)) {
+		myLoader = plugin->createModelLoader(*description, *this);
+		if (myLoader) {
+			myPlugin = plugin;
+			loadParagraphs(FIRST_PARAGRAPHS);
+		} else if (plugin->readModel(*description, *this)) {
+			BookModelCache::save(*description, *plugin, *this);
+		}
 	}
 }
 
 BookModel::~BookModel() {
+	// the loader refers to the model, drop it first
+	myLoader.reset();
+}
+
+bool BookModel::loadSlice() {
+	if (!myLoader) {
+		return false;
+	}
+
+	ZLTime start;
+	do {
+		if (!myLoader->readSlice(SLICE_SIZE)) {
+			myLoader.reset();
+			BookModelCache::save(*myDescription, *myPlugin, *this);
+			return false;
+		}
+	} while (start.millisecondsTo(ZLTime()) < SLICE_TIME);
+	return true;
+}
+
+void BookModel::loadParagraphs(size_t count) {
+	while ((myBookTextModel->paragraphsNumber() <= count) && loadSlice()) {
+	}
 }
 
 const std::string &BookModel::fileName() const {
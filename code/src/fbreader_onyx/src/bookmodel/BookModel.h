@@ -29,6 +29,8 @@
 #include "../description/BookDescription.h"
 
 class ZLImage;
+class FormatPlugin;
+class ModelLoader;
 
 class ContentsModel : public ZLTextTreeModel {
 
@@ -71,6 +73,13 @@ public:
 
 	const BookDescriptionPtr description() const;
 
+	// the text of large books is read in slices after the first pages
+	bool isLoading() const;
+	// reads the next slice, returns false when the model is complete
+	bool loadSlice();
+	// reads slices until the model has more than count paragraphs
+	void loadParagraphs(size_t count);
+
 	// for DRM content
 	bool drm() const;
 	OpenStatus openStatus() const;
@@ -86,14 +95,18 @@ private:
 	std::map<std::string,Label> myInternalHyperlinks;
 	bool isDRM;
 	OpenStatus myOpenStatus;
+	FormatPlugin *myPlugin;
+	shared_ptr<ModelLoader> myLoader;
 
 friend class BookReader;
+friend class BookModelCache;
 };
 
 inline shared_ptr<ZLTextModel> BookModel::bookTextModel() const { return myBookTextModel; }
 inline shared_ptr<ZLTextModel> BookModel::contentsModel() const { return myContentsModel; }
 inline const ZLImageMap &BookModel::imageMap() const { return myImages; }
 inline const BookDescriptionPtr BookModel::description() const { return myDescription; }
+inline bool BookModel::isLoading() const { return myLoader.get() != 0; }
 inline bool BookModel::drm() const { return isDRM; }
 inline BookModel::OpenStatus BookModel::openStatus() const
 {
@@ -0,0 +1,666 @@
+/*
+ * Copyright (C) 2004-2009 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ZLibrary.h>
+#include <ZLFile.h>
+#include <ZLImage.h>
+#include <ZLFileImage.h>
+#include <ZLStringUtil.h>
+
+#include "BookModelCache.h"
+#include "BookModel.h"
+
+#include "../description/BookDescription.h"
+#include "../formats/FormatPlugin.h"
+
+static const char MAGIC[4] = { 'F', 'B', 'M', 'C' };
+static const unsigned int FORMAT_VERSION = 2;
+// magic, offset and size of the description of the snapshot
+static const size_t HEADER_SIZE = 12;
+static const unsigned int NO_INDEX = (unsigned int)-1;
+static const size_t MAX_CACHE_SIZE = 32 * 1024 * 1024;
+static const std::string EXTENSION = ".model";
+static const char PAGE_MAP_MAGIC[4] = { 'F', 'B', 'P', 'M' };
+static const std::string PAGE_MAP_EXTENSION = ".pages";
+
+enum ModelRole {
+	BOOK_TEXT_MODEL = 0,
+	CONTENTS_MODEL = 1,
+	FOOTNOTE_MODEL = 2,
+};
+
+enum ImageType {
+	FILE_IMAGE = 0,
+	SNAPSHOT_IMAGE = 1,
+};
+
+class MappedSnapshot : public ZLUserData {
+
+public:
+	MappedSnapshot(char *data, size_t size);
+	~MappedSnapshot();
+
+	char *data() const;
+	size_t size() const;
+
+private:
+	char *myData;
+	size_t mySize;
+};
+
+inline MappedSnapshot::MappedSnapshot(char *data, size_t size) : myData(data), mySize(size) {}
+inline MappedSnapshot::~MappedSnapshot() { munmap(myData, mySize); }
+inline char *MappedSnapshot::data() const { return myData; }
+inline size_t MappedSnapshot::size() const { return mySize; }
+
+// image data stored in the snapshot itself, for the images which are not
+// plain references into a file
+class SnapshotImage : public ZLSingleImage {
+
+public:
+	SnapshotImage(const std::string &mimeType, shared_ptr<ZLUserData> snapshot, const char *data, size_t size);
+	const shared_ptr<std::string> stringData() const;
+
+private:
+	shared_ptr<ZLUserData> mySnapshot;
+	const char *myData;
+	size_t mySize;
+};
+
+inline SnapshotImage::SnapshotImage(const std::string &mimeType, shared_ptr<ZLUserData> snapshot, const char *data, size_t size) : ZLSingleImage(mimeType), mySnapshot(snapshot), myData(data), mySize(size) {}
+
+const shared_ptr<std::string> SnapshotImage::stringData() const {
+	return shared_ptr<std::string>(new std::string(myData, mySize));
+}
+
+class SnapshotReader {
+
+public:
+	SnapshotReader(const char *data, size_t size);
+
+	bool readNumber(unsigned int &value);
+	bool readString(std::string &value);
+
+private:
+	const char *myPointer;
+	const char *myEnd;
+};
+
+inline SnapshotReader::SnapshotReader(const char *data, size_t size) : myPointer(data), myEnd(data + size) {}
+
+bool SnapshotReader::readNumber(unsigned int &value) {
+	if (myPointer + sizeof(unsigned int) > myEnd) {
+		return false;
+	}
+	memcpy(&value, myPointer, sizeof(unsigned int));
+	myPointer += sizeof(unsigned int);
+	return true;
+}
+
+bool SnapshotReader::readString(std::string &value) {
+	unsigned int length;
+	if (!readNumber(length) || (length > (size_t)(myEnd - myPointer))) {
+		return false;
+	}
+	value.assign(myPointer, length);
+	myPointer += length;
+	return true;
+}
+
+static void writeNumber(std::string &data, unsigned int value) {
+	data.append((const char*)&value, sizeof(unsigned int));
+}
+
+static void writeString(std::string &data, const std::string &value) {
+	writeNumber(data, value.length());
+	data.append(value);
+}
+
+// keep the blocks in the snapshot aligned
+static void align(std::string &data) {
+	data.append((8 - (HEADER_SIZE + data.size()) % 8) % 8, '\0');
+}
+
+std::string BookModelCache::directoryName() {
+	const char *home = getenv("HOME");
+	if (home == 0) {
+		return std::string();
+	}
+	return std::string(home) + ZLibrary::FileNameDelimiter + ZLibrary::ApplicationName() + ZLibrary::FileNameDelimiter + "models";
+}
+
+std::string BookModelCache::fileName(const std::string &key, const std::string &extension) {
+	const std::string directory = directoryName();
+	if (directory.empty()) {
+		return std::string();
+	}
+
+	// FNV-1a hash of the key
+	unsigned int hash = 2166136261U;
+	for (std::string::const_iterator it = key.begin(); it != key.end(); ++it) {
+		hash = (hash ^ (unsigned char)*it) * 16777619U;
+	}
+	char name[9];
+	snprintf(name, sizeof(name), "%08x", hash);
+	return directory + ZLibrary::FileNameDelimiter + name + extension;
+}
+
+// write a temporary file first so that a broken file is never read
+static bool writeFile(const std::string &path, const std::string **parts, size_t count) {
+	const std::string temporaryPath = path + ".tmp";
+	FILE *file = fopen(temporaryPath.c_str(), "wb");
+	if (file == 0) {
+		return false;
+	}
+	bool written = true;
+	for (size_t i = 0; written && (i < count); ++i) {
+		written = fwrite(parts[i]->data(), 1, parts[i]->size(), file) == parts[i]->size();
+	}
+	written = (fclose(file) == 0) && written;
+	if (!written || (rename(temporaryPath.c_str(), path.c_str()) != 0)) {
+		unlink(temporaryPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool BookModelCache::fingerprint(const BookDescription &description, const FormatPlugin &plugin, std::string &key) {
+	struct stat info;
+	if (stat(ZLFile(description.fileName()).physicalFilePath().c_str(), &info) != 0) {
+		return false;
+	}
+
+	key = description.fileName();
+	key += '\n';
+	ZLStringUtil::appendNumber(key, info.st_size);
+	key += '\n';
+	ZLStringUtil::appendNumber(key, info.st_mtime);
+	key += '\n';
+	key += description.encoding();
+	key += '\n';
+	key += description.language();
+	key += '\n';
+	key += plugin.iconName();
+	key += '\n';
+	ZLStringUtil::appendNumber(key, plugin.modelVersion());
+	key += '\n';
+	ZLStringUtil::appendNumber(key, FORMAT_VERSION);
+	key += '\n';
+	// the entries hold native sizes and pointers
+	ZLStringUtil::appendNumber(key, sizeof(size_t));
+	ZLStringUtil::appendNumber(key, sizeof(void*));
+	return true;
+}
+
+bool BookModelCache::load(const BookDescription &description, const FormatPlugin &plugin, BookModel &model) {
+	std::string key;
+	const std::string path = fileName(description.fileName(), EXTENSION);
+	if (path.empty() || !fingerprint(description, plugin, key)) {
+		return false;
+	}
+
+	int file = open(path.c_str(), O_RDONLY);
+	if (file == -1) {
+		return false;
+	}
+	struct stat info;
+	if ((fstat(file, &info) != 0) || ((size_t)info.st_size < HEADER_SIZE)) {
+		close(file);
+		return false;
+	}
+	// the image entries are bound to the image map of the model, the pages
+	// holding them are copied on write
+	void *address = mmap(0, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+	if (address == MAP_FAILED) {
+		return false;
+	}
+
+	shared_ptr<ZLUserData> snapshot(new MappedSnapshot((char*)address, info.st_size));
+	if (!read(key, snapshot, model)) {
+		clear(model);
+		return false;
+	}
+
+	// mark the snapshot as recently used
+	utime(path.c_str(), 0);
+	return true;
+}
+
+bool BookModelCache::read(const std::string &key, shared_ptr<ZLUserData> snapshot, BookModel &model) {
+	char *data = ((const MappedSnapshot&)*snapshot).data();
+	const size_t size = ((const MappedSnapshot&)*snapshot).size();
+
+	unsigned int metaOffset;
+	unsigned int metaSize;
+	memcpy(&metaOffset, data + 4, sizeof(unsigned int));
+	memcpy(&metaSize, data + 8, sizeof(unsigned int));
+	if ((memcmp(data, MAGIC, 4) != 0) || (metaOffset > size) || (metaSize > size - metaOffset)) {
+		return false;
+	}
+
+	SnapshotReader reader(data + metaOffset, metaSize);
+	std::string storedKey;
+	if (!reader.readString(storedKey) || (storedKey != key)) {
+		return false;
+	}
+
+	unsigned int imageNumber;
+	if (!reader.readNumber(imageNumber)) {
+		return false;
+	}
+	for (unsigned int i = 0; i < imageNumber; ++i) {
+		std::string id;
+		std::string mimeType;
+		unsigned int type;
+		unsigned int offset;
+		unsigned int length;
+		if (!reader.readString(id) || !reader.readString(mimeType) || !reader.readNumber(type)) {
+			return false;
+		}
+		if (type == FILE_IMAGE) {
+			std::string path;
+			unsigned int encoding;
+			if (!reader.readString(path) || !reader.readNumber(offset) || !reader.readNumber(length) || !reader.readNumber(encoding)) {
+				return false;
+			}
+			model.myImages[id] = shared_ptr<const ZLImage>(new ZLFileImage(mimeType, path, offset, length, (ZLFileImage::Encoding)encoding));
+		} else {
+			if (!reader.readNumber(offset) || !reader.readNumber(length) ||
+					(offset > size) || (length > size - offset)) {
+				return false;
+			}
+			model.myImages[id] = shared_ptr<const ZLImage>(new SnapshotImage(mimeType, snapshot, data + offset, length));
+		}
+	}
+
+	unsigned int modelNumber;
+	if (!reader.readNumber(modelNumber)) {
+		return false;
+	}
+	std::vector<shared_ptr<ZLTextModel> > models;
+	for (unsigned int i = 0; i < modelNumber; ++i) {
+		unsigned int role;
+		std::string id;
+		unsigned int offset;
+		unsigned int length;
+		unsigned int paragraphNumber;
+		if (!reader.readNumber(role) || !reader.readString(id) ||
+				!reader.readNumber(offset) || !reader.readNumber(length) ||
+				(offset > size) || (length > size - offset) ||
+				!reader.readNumber(paragraphNumber)) {
+			return false;
+		}
+
+		shared_ptr<ZLTextModel> textModel;
+		switch (role) {
+			case BOOK_TEXT_MODEL:
+				textModel = model.myBookTextModel;
+				break;
+			case CONTENTS_MODEL:
+				textModel = model.myContentsModel;
+				break;
+			default:
+				textModel.reset(new ZLTextPlainModel(8192));
+				model.myFootnotes.insert(std::pair<std::string,shared_ptr<ZLTextModel> >(id, textModel));
+				break;
+		}
+		textModel->adoptEntries(data + offset, length, snapshot);
+
+		std::vector<ZLTextTreeParagraph*> treeParagraphs;
+		for (unsigned int j = 0; j < paragraphNumber; ++j) {
+			unsigned int kind;
+			unsigned int entryOffset;
+			unsigned int entryNumber;
+			if (!reader.readNumber(kind) || !reader.readNumber(entryOffset) || !reader.readNumber(entryNumber)) {
+				return false;
+			}
+			if (role == CONTENTS_MODEL) {
+				unsigned int parent;
+				unsigned int isOpen;
+				unsigned int reference;
+				if (!reader.readNumber(parent) || !reader.readNumber(isOpen) || !reader.readNumber(reference) ||
+						((parent != NO_INDEX) && (parent >= treeParagraphs.size()))) {
+					return false;
+				}
+				ContentsModel &contentsModel = (ContentsModel&)*textModel;
+				ZLTextTreeParagraph *paragraph =
+					contentsModel.createParagraph((parent != NO_INDEX) ? treeParagraphs[parent] : 0);
+				paragraph->open(isOpen != 0);
+				if (reference != NO_INDEX) {
+					contentsModel.setReference(paragraph, reference);
+				}
+				treeParagraphs.push_back(paragraph);
+			} else {
+				((ZLTextPlainModel&)*textModel).createParagraph((ZLTextParagraph::Kind)kind);
+			}
+			if (!textModel->addParagraphEntries(entryOffset, entryNumber)) {
+				return false;
+			}
+		}
+
+		unsigned int imageEntryNumber;
+		if (!reader.readNumber(imageEntryNumber)) {
+			return false;
+		}
+		for (unsigned int j = 0; j < imageEntryNumber; ++j) {
+			unsigned int entryOffset;
+			if (!reader.readNumber(entryOffset) || !textModel->bindImageEntry(entryOffset, model.myImages)) {
+				return false;
+			}
+		}
+		models.push_back(textModel);
+	}
+
+	unsigned int labelNumber;
+	if (!reader.readNumber(labelNumber)) {
+		return false;
+	}
+	for (unsigned int i = 0; i < labelNumber; ++i) {
+		std::string id;
+		unsigned int modelIndex;
+		unsigned int paragraph;
+		if (!reader.readString(id) || !reader.readNumber(modelIndex) || !reader.readNumber(paragraph)) {
+			return false;
+		}
+		shared_ptr<ZLTextModel> labelModel;
+		if (modelIndex < models.size()) {
+			labelModel = models[modelIndex];
+		}
+		model.myInternalHyperlinks.insert(
+			std::pair<std::string,BookModel::Label>(id, BookModel::Label(labelModel, (int)paragraph))
+		);
+	}
+	return true;
+}
+
+void BookModelCache::clear(BookModel &model) {
+	model.myBookTextModel.reset(new ZLTextPlainModel(102400));
+	model.myContentsModel.reset(new ContentsModel());
+	model.myImages.clear();
+	model.myFootnotes.clear();
+	model.myInternalHyperlinks.clear();
+}
+
+void BookModelCache::save(const BookDescription &description, const FormatPlugin &plugin, const BookModel &model) {
+	// decrypted books never go to the disk
+	if (model.drm() || (model.openStatus() != BookModel::OPEN_NORMAL)) {
+		return;
+	}
+
+	std::string key;
+	const std::string path = fileName(description.fileName(), EXTENSION);
+	if (path.empty() || !fingerprint(description, plugin, key)) {
+		return;
+	}
+
+	// blocks of the snapshot following the header
+	std::string blocks;
+	std::string meta;
+	writeString(meta, key);
+
+	writeNumber(meta, model.myImages.size());
+	for (ZLImageMap::const_iterator it = model.myImages.begin(); it != model.myImages.end(); ++it) {
+		const ZLImage *image = it->second.get();
+		if ((image == 0) || !image->isSingle()) {
+			return;
+		}
+		writeString(meta, it->first);
+		writeString(meta, ((const ZLSingleImage*)image)->mimeType());
+		const ZLFileImage *fileImage = dynamic_cast<const ZLFileImage*>(image);
+		if (fileImage != 0) {
+			writeNumber(meta, FILE_IMAGE);
+			writeString(meta, fileImage->path());
+			writeNumber(meta, fileImage->offset());
+			writeNumber(meta, fileImage->size());
+			writeNumber(meta, fileImage->encoding());
+		} else {
+			shared_ptr<std::string> imageData = ((const ZLSingleImage*)image)->stringData();
+			align(blocks);
+			writeNumber(meta, SNAPSHOT_IMAGE);
+			writeNumber(meta, HEADER_SIZE + blocks.size());
+			if (imageData) {
+				writeNumber(meta, imageData->size());
+				blocks.append(*imageData);
+			} else {
+				writeNumber(meta, 0);
+			}
+		}
+	}
+
+	std::vector<shared_ptr<ZLTextModel> > models;
+	models.push_back(model.myBookTextModel);
+	models.push_back(model.myContentsModel);
+	std::map<std::string,shared_ptr<ZLTextModel> >::const_iterator footnote = model.myFootnotes.begin();
+	writeNumber(meta, 2 + model.myFootnotes.size());
+	for (size_t i = 0; i < 2 + model.myFootnotes.size(); ++i) {
+		std::string id;
+		if (i >= 2) {
+			id = footnote->first;
+			models.push_back(footnote->second);
+			++footnote;
+		}
+		const ZLTextModel &textModel = *models.back();
+
+		std::string entries;
+		std::vector<size_t> paragraphOffsets;
+		std::vector<size_t> imageEntries;
+		textModel.saveEntries(entries, paragraphOffsets, imageEntries);
+
+		align(blocks);
+		writeNumber(meta, (i < 2) ? i : (unsigned int)FOOTNOTE_MODEL);
+		writeString(meta, id);
+		writeNumber(meta, HEADER_SIZE + blocks.size());
+		writeNumber(meta, entries.size());
+		blocks.append(entries);
+
+		std::map<const ZLTextTreeParagraph*,unsigned int> treeIndices;
+		writeNumber(meta, paragraphOffsets.size());
+		for (size_t j = 0; j < paragraphOffsets.size(); ++j) {
+			const ZLTextParagraph *paragraph = textModel[j];
+			writeNumber(meta, paragraph->kind());
+			writeNumber(meta, paragraphOffsets[j]);
+			writeNumber(meta, paragraph->entryNumber());
+			if (i == CONTENTS_MODEL) {
+				// the root of the tree is not a paragraph of the model
+				const ZLTextTreeParagraph *treeParagraph = (const ZLTextTreeParagraph*)paragraph;
+				std::map<const ZLTextTreeParagraph*,unsigned int>::const_iterator parent =
+					treeIndices.find(treeParagraph->parent());
+				treeIndices[treeParagraph] = j;
+				writeNumber(meta, (parent != treeIndices.end()) ? parent->second : NO_INDEX);
+				writeNumber(meta, treeParagraph->isOpen() ? 1 : 0);
+				writeNumber(meta, ((const ContentsModel&)textModel).reference(treeParagraph));
+			}
+		}
+		writeNumber(meta, imageEntries.size());
+		for (std::vector<size_t>::const_iterator it = imageEntries.begin(); it != imageEntries.end(); ++it) {
+			writeNumber(meta, *it);
+		}
+	}
+
+	writeNumber(meta, model.myInternalHyperlinks.size());
+	for (std::map<std::string,BookModel::Label>::const_iterator it = model.myInternalHyperlinks.begin(); it != model.myInternalHyperlinks.end(); ++it) {
+		unsigned int modelIndex = NO_INDEX;
+		for (size_t i = 0; i < models.size(); ++i) {
+			if (models[i] == it->second.Model) {
+				modelIndex = i;
+				break;
+			}
+		}
+		writeString(meta, it->first);
+		writeNumber(meta, modelIndex);
+		writeNumber(meta, it->second.ParagraphNumber);
+	}
+
+	align(blocks);
+	if (HEADER_SIZE + blocks.size() + meta.size() > MAX_CACHE_SIZE / 2) {
+		return;
+	}
+
+	std::string header(MAGIC, 4);
+	writeNumber(header, HEADER_SIZE + blocks.size());
+	writeNumber(header, meta.size());
+
+	const std::string directory = directoryName();
+	mkdir(directory.substr(0, directory.rfind(ZLibrary::FileNameDelimiter)).c_str(), 0755);
+	mkdir(directory.c_str(), 0755);
+
+	const std::string *parts[] = { &header, &blocks, &meta };
+	if (writeFile(path, parts, 3)) {
+		shrink(path);
+	}
+}
+
+bool BookModelCache::pageMapKey(const std::string &bookFileName, const std::string &signature, std::string &key) {
+	struct stat info;
+	if (stat(ZLFile(bookFileName).physicalFilePath().c_str(), &info) != 0) {
+		return false;
+	}
+
+	key = bookFileName;
+	key += '\n';
+	ZLStringUtil::appendNumber(key, info.st_size);
+	key += '\n';
+	ZLStringUtil::appendNumber(key, info.st_mtime);
+	key += '\n';
+	key += signature;
+	return true;
+}
+
+bool BookModelCache::loadPageMap(const std::string &bookFileName, const std::string &signature, std::vector<unsigned int> &pageMap) {
+	std::string key;
+	if (!pageMapKey(bookFileName, signature, key)) {
+		return false;
+	}
+	const std::string path = fileName(bookFileName + '\n' + signature, PAGE_MAP_EXTENSION);
+	if (path.empty()) {
+		return false;
+	}
+
+	FILE *file = fopen(path.c_str(), "rb");
+	if (file == 0) {
+		return false;
+	}
+	std::string data;
+	char buffer[4096];
+	for (size_t length = fread(buffer, 1, sizeof(buffer), file); length > 0; length = fread(buffer, 1, sizeof(buffer), file)) {
+		data.append(buffer, length);
+	}
+	fclose(file);
+
+	SnapshotReader reader(data.data() + 4, (data.size() >= 4) ? data.size() - 4 : 0);
+	std::string storedKey;
+	unsigned int size;
+	if ((data.size() < 4) || (memcmp(data.data(), PAGE_MAP_MAGIC, 4) != 0) ||
+			!reader.readString(storedKey) || (storedKey != key) || !reader.readNumber(size)) {
+		return false;
+	}
+	pageMap.resize(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		if (!reader.readNumber(pageMap[i])) {
+			pageMap.clear();
+			return false;
+		}
+	}
+
+	// mark the page map as recently used
+	utime(path.c_str(), 0);
+	return true;
+}
+
+void BookModelCache::savePageMap(const std::string &bookFileName, const std::string &signature, const std::vector<unsigned int> &pageMap) {
+	std::string key;
+	const std::string path = fileName(bookFileName + '\n' + signature, PAGE_MAP_EXTENSION);
+	if (path.empty() || !pageMapKey(bookFileName, signature, key)) {
+		return;
+	}
+
+	std::string data(PAGE_MAP_MAGIC, 4);
+	writeString(data, key);
+	writeNumber(data, pageMap.size());
+	if (!pageMap.empty()) {
+		data.append((const char*)&pageMap.front(), pageMap.size() * sizeof(unsigned int));
+	}
+
+	const std::string directory = directoryName();
+	mkdir(directory.substr(0, directory.rfind(ZLibrary::FileNameDelimiter)).c_str(), 0755);
+	mkdir(directory.c_str(), 0755);
+
+	const std::string *parts[] = { &data };
+	if (writeFile(path, parts, 1)) {
+		shrink(path);
+	}
+}
+
+struct CachedFile {
+	CachedFile(const std::string &path, time_t time, size_t size) : Path(path), Time(time), Size(size) {}
+	bool operator < (const CachedFile &file) const { return Time < file.Time; }
+
+	std::string Path;
+	time_t Time;
+	size_t Size;
+};
+
+void BookModelCache::shrink(const std::string &keptFileName) {
+	const std::string directory = directoryName();
+	DIR *dir = opendir(directory.c_str());
+	if (dir == 0) {
+		return;
+	}
+
+	std::vector<CachedFile> files;
+	size_t totalSize = 0;
+	for (struct dirent *entry = readdir(dir); entry != 0; entry = readdir(dir)) {
+		const std::string name = entry->d_name;
+		if (!ZLStringUtil::stringEndsWith(name, EXTENSION) && !ZLStringUtil::stringEndsWith(name, PAGE_MAP_EXTENSION)) {
+			continue;
+		}
+		const std::string path = directory + ZLibrary::FileNameDelimiter + name;
+		struct stat info;
+		if (stat(path.c_str(), &info) == 0) {
+			files.push_back(CachedFile(path, info.st_mtime, info.st_size));
+			totalSize += info.st_size;
+		}
+	}
+	closedir(dir);
+
+	// remove the least recently used files, a mapped snapshot stays
+	// valid until it is unmapped
+	std::sort(files.begin(), files.end());
+	for (std::vector<CachedFile>::const_iterator it = files.begin(); (it != files.end()) && (totalSize > MAX_CACHE_SIZE); ++it) {
+		if ((it->Path != keptFileName) && (unlink(it->Path.c_str()) == 0)) {
+			totalSize -= it->Size;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2004-2009 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __BOOKMODELCACHE_H__
+#define __BOOKMODELCACHE_H__
+
+#include <string>
+#include <vector>
+
+#include <shared_ptr.h>
+
+class BookDescription;
+class BookModel;
+class FormatPlugin;
+class ZLUserData;
+
+// Snapshots of the book models, reopening a book maps its snapshot instead
+// of reading the book again. Snapshots are keyed by the file fingerprint and
+// the plugin version, the least recently used ones are removed when the
+// cache directory grows too large. The page maps of the book text view are
+// kept in the same directory, one per book and layout signature.
+class BookModelCache {
+
+public:
+	static bool load(const BookDescription &description, const FormatPlugin &plugin, BookModel &model);
+	static void save(const BookDescription &description, const FormatPlugin &plugin, const BookModel &model);
+
+	static bool loadPageMap(const std::string &bookFileName, const std::string &signature, std::vector<unsigned int> &pageMap);
+	static void savePageMap(const std::string &bookFileName, const std::string &signature, const std::vector<unsigned int> &pageMap);
+
+private:
+	static std::string directoryName();
+	static std::string fileName(const std::string &key, const std::string &extension);
+	static bool pageMapKey(const std::string &bookFileName, const std::string &signature, std::string &key);
+	static bool fingerprint(const BookDescription &description, const FormatPlugin &plugin, std::string &key);
+	static bool read(const std::string &key, shared_ptr<ZLUserData> snapshot, BookModel &model);
+	static void clear(BookModel &model);
+	static void shrink(const std::string &keptFileName);
+};
+
+#endif /* __BOOKMODELCACHE_H__ */
@@ -31,6 +31,7 @@
 
 #include "../bookmodel/FBTextKind.h"
 #include "../bookmodel/BookModel.h"
+#include "../bookmodel/BookModelCache.h"
 
 static const std::string PARAGRAPH_OPTION_NAME = "Paragraph";
 static const std::string WORD_OPTION_NAME = "Word";
@@ -42,7 +43,8 @@ static const char * const BUFFER_WORD_PREFIX = "Word_";
 
 BookTextView::BookTextView(FBReader &reader, shared_ptr<ZLPaintContext> context) :
 	FBView(reader, context),
-	ShowTOCMarksOption(ZLCategoryKey::LOOK_AND_FEEL, "Indicator", "ShowTOCMarks", false) {
+	ShowTOCMarksOption(ZLCategoryKey::LOOK_AND_FEEL, "Indicator", "ShowTOCMarks", false),
+	PaginationOption(ZLCategoryKey::LOOK_AND_FEEL, "Indicator", "ExactPages", true) {
 	myCurrentPointInStack = 0;
 	myMaxStackSize = 20;
 	myLockUndoStackChanges = false;
@@ -56,6 +58,7 @@ void BookTextView::setModel(shared_ptr<ZLTextModel> model, const std::string &la
 	FBView::setModel(model, language);
 
 	myFileName = fileName;
+	setPaginationEnabled(PaginationOption.value());
 
 	gotoPosition(
 		ZLIntegerOption(ZLCategoryKey::STATE, fileName, PARAGRAPH_OPTION_NAME, 0).value(),
@@ -94,6 +97,10 @@ void BookTextView::setContentsModel(shared_ptr<ZLTextModel> contentsModel) {
 	myContentsModel = contentsModel;
 }
 
+int BookTextView::savedParagraph(const std::string &fileName) const {
+	return ZLIntegerOption(ZLCategoryKey::STATE, fileName, PARAGRAPH_OPTION_NAME, 0).value();
+}
+
 void BookTextView::saveState() {
 	const ZLTextWordCursor &cursor = startCursor();
 
@@ -440,3 +447,11 @@ void BookTextView::paint() {
 	ZLStringUtil::appendNumber(pn, pageIndex());
 	fbreader().setVisualParameter(FBReader::PageIndexParameter, pn);
 }
+
+bool BookTextView::loadPageMap(const std::string &signature, std::vector<unsigned int> &pageMap) {
+	return BookModelCache::loadPageMap(myFileName, signature, pageMap);
+}
+
+void BookTextView::savePageMap(const std::string &signature, const std::vector<unsigned int> &pageMap) {
+	BookModelCache::savePageMap(myFileName, signature, pageMap);
+}
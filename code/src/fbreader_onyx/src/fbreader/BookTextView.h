@@ -30,6 +30,7 @@ class BookTextView : public FBView {
 
 public:
 	ZLBooleanOption ShowTOCMarksOption;
+	ZLBooleanOption PaginationOption;
 
 public:
 	BookTextView(FBReader &reader, shared_ptr<ZLPaintContext> context);
@@ -38,6 +39,7 @@ public:
 	void setModel(shared_ptr<ZLTextModel> model, const std::string &language, const std::string &fileName);
 	void setContentsModel(shared_ptr<ZLTextModel> contentsModel);
 	void saveState();
+	int savedParagraph(const std::string &fileName) const;
 
 	void gotoParagraph(int num, bool end = false);
 	bool canUndoPageMove();
@@ -70,6 +72,9 @@ private:
 
 	void paint();
 
+	bool loadPageMap(const std::string &signature, std::vector<unsigned int> &pageMap);
+	void savePageMap(const std::string &signature, const std::vector<unsigned int> &pageMap);
+
 private:
 	class PositionIndicatorWithLabels : public PositionIndicator {
 
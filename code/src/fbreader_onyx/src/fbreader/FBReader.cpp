@@ -188,6 +188,7 @@ FBReader::FBReader(const std::string &bookToOpen)
 }
 
 FBReader::~FBReader() {
+    stopBookLoading();
     if (myModel != 0) {
         delete myModel;
     }
@@ -294,6 +295,19 @@ class OpenBookRunnable : public ZLRunnable {
     BookDescriptionPtr myDescription;
 };
 
+// the rest of a large book is read in slices between user events
+static const int BOOK_LOADING_INTERVAL = 100;
+
+class LoadBookRunnable : public ZLRunnable {
+
+  public:
+    LoadBookRunnable(FBReader &reader) : myReader(reader) {}
+    void run() { myReader.loadBookSlice(); }
+
+  private:
+    FBReader &myReader;
+};
+
 void FBReader::openBook(BookDescriptionPtr description) {
     OpenBookRunnable runnable(*this, description);
     ZLDialogManager::instance().wait(ZLResourceKey("loadingBook"), runnable);
@@ -309,6 +323,7 @@ void FBReader::openBookInternal(BookDescriptionPtr description) {
         bookTextView.setModel(shared_ptr<ZLTextModel>(), "", "");
         bookTextView.setContentsModel(shared_ptr<ZLTextModel>());
         contentsView.setModel(shared_ptr<ZLTextModel>(), "");
+        stopBookLoading();
         if (myModel != 0) {
             delete myModel;
         }
@@ -336,6 +351,11 @@ void FBReader::openBookInternal(BookDescriptionPtr description) {
         ZLStringOption(ZLCategoryKey::STATE, STATE, BOOK, std::string()).setValue(myModel->fileName());
         const std::string &lang = description->language();
         ZLTextHyphenator::instance().load(lang);
+        if (myModel->isLoading()) {
+            // the book is shown before it is read to the end, but not
+            // before the position it was left at
+            myModel->loadParagraphs(bookTextView.savedParagraph(description->fileName()));
+        }
         bookTextView.setModel(myModel->bookTextModel(), lang, description->fileName());
         bookTextView.setCaption(description->title());
         bookTextView.setContentsModel(myModel->contentsModel());
@@ -343,6 +363,40 @@ void FBReader::openBookInternal(BookDescriptionPtr description) {
         footnoteView.setCaption(description->title());
         contentsView.setModel(myModel->contentsModel(), lang);
         contentsView.setCaption(description->title());
+
+        if (myModel->isLoading()) {
+            // pages are counted when the whole text is known
+            bookTextView.setPaginationEnabled(false);
+            myBookLoader.reset(new LoadBookRunnable(*this));
+            ZLTimeManager::instance().addTask(myBookLoader, BOOK_LOADING_INTERVAL);
+        }
+    }
+}
+
+void FBReader::loadBookSlice() {
+    if ((myModel == 0) || !myModel->isLoading()) {
+        ZLTimeManager::instance().removeTask(myBookLoader);
+        return;
+    }
+
+    const bool loading = myModel->loadSlice();
+    BookTextView &bookTextView = (BookTextView&)*myBookTextView;
+    const bool pageChanged = bookTextView.appendParagraphs();
+    ((ContentsView&)*myContentsView).appendParagraphs();
+    if (!loading) {
+        // the runnable is being run, it's released by stopBookLoading
+        ZLTimeManager::instance().removeTask(myBookLoader);
+        bookTextView.setPaginationEnabled(bookTextView.PaginationOption.value());
+    }
+    if (pageChanged && (myMode == BOOK_TEXT_MODE)) {
+        refreshWindow();
+    }
+}
+
+void FBReader::stopBookLoading() {
+    if (myBookLoader) {
+        ZLTimeManager::instance().removeTask(myBookLoader);
+        myBookLoader.reset();
     }
 }
 
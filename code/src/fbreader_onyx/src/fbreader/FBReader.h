@@ -124,6 +124,9 @@ class FBReader : public ZLApplication {
   private:
     void openBookInternal(BookDescriptionPtr description);
     friend class OpenBookRunnable;
+    void loadBookSlice();
+    void stopBookLoading();
+    friend class LoadBookRunnable;
     void rebuildCollectionInternal();
     friend class RebuildCollectionRunnable;
     friend class OptionsApplyRunnable;
@@ -139,6 +142,7 @@ class FBReader : public ZLApplication {
     ZLTime myLastScrollingTime;
 
     BookModel *myModel;
+    shared_ptr<ZLRunnable> myBookLoader;
 
     shared_ptr<ZLKeyBindings> myBindings0;
     shared_ptr<ZLKeyBindings> myBindings90;
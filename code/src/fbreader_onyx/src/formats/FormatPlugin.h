@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include <shared_ptr.h>
 #include <ZLOptions.h>
 
 class BookDescription;
@@ -41,6 +42,19 @@ public:
 	virtual ~FormatInfoPage();
 };
 
+class ModelLoader {
+
+protected:
+	ModelLoader();
+
+public:
+	virtual ~ModelLoader();
+
+	// reads at least size more bytes of the book into the model,
+	// returns false when the model is complete
+	virtual bool readSlice(size_t size) = 0;
+};
+
 class FormatPlugin {
 
 protected:
@@ -57,6 +71,13 @@ public:
 	virtual const std::string &tryOpen(const std::string &path) const;
 	virtual bool readDescription(const std::string &path, BookDescription &description) const = 0;
 	virtual bool readModel(const BookDescription &description, BookModel &model) const = 0;
+	// returns a loader filling the model piece by piece, or null if the
+	// format can only be read at once by readModel
+	virtual shared_ptr<ModelLoader> createModelLoader(const BookDescription &description, BookModel &model) const;
+
+	// increase when the model read by the plugin changes, cached models
+	// of the older versions are dropped
+	virtual int modelVersion() const;
 
 protected:
 	static void detectEncodingAndLanguage(BookDescription &description, ZLInputStream &stream);
@@ -89,8 +110,12 @@ private:
 
 inline FormatInfoPage::FormatInfoPage() {}
 inline FormatInfoPage::~FormatInfoPage() {}
+inline ModelLoader::ModelLoader() {}
+inline ModelLoader::~ModelLoader() {}
 inline FormatPlugin::FormatPlugin() {}
 inline FormatPlugin::~FormatPlugin() {}
 inline FormatInfoPage *FormatPlugin::createInfoPage(ZLOptionsDialog&, const std::string&) { return 0; }
+inline shared_ptr<ModelLoader> FormatPlugin::createModelLoader(const BookDescription&, BookModel&) const { return shared_ptr<ModelLoader>(); }
+inline int FormatPlugin::modelVersion() const { return 1; }
 
 #endif /* __FORMATPLUGIN_H__ */
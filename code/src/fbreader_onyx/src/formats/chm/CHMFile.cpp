@@ -67,94 +67,136 @@ static unsigned long long readEncodedInteger(ZLInputStream &stream) {
 	return result;
 }
 
-CHMInputStream::CHMInputStream(shared_ptr<ZLInputStream> base, const CHMFileInfo::SectionInfo &sectionInfo, size_t offset, size_t size) : myBase(base), mySectionInfo(sectionInfo), mySize(size) {
-	myBaseStartIndex = offset / 0x8000;
-	myBaseStartIndex -= myBaseStartIndex % sectionInfo.ResetInterval;
-	myBytesToSkip = offset - myBaseStartIndex * 0x8000;
-	myOutData = new unsigned char[0x8000];
+const size_t CHMBlockCache::BLOCK_SIZE;
+
+CHMBlockCache::CHMBlockCache(size_t maxSize) : myMaxSize(maxSize), mySize(0) {
+}
+
+shared_ptr<std::string> CHMBlockCache::block(ZLInputStream &base, const CHMFileInfo::SectionInfo &info, size_t section, size_t index) {
+	const Key key(section, index);
+	std::map<Key,BlockList::iterator>::iterator it = myIndex.find(key);
+	if (it != myIndex.end()) {
+		myBlocks.splice(myBlocks.begin(), myBlocks, it->second);
+		return it->second->second;
+	}
+	if (index >= info.ResetTable.size() || info.ResetInterval == 0) {
+		return shared_ptr<std::string>();
+	}
+
+	Decoder &decoder = myDecoders[section];
+	const size_t resetIndex = index - index % info.ResetInterval;
+	if (decoder.NextBlock < resetIndex || decoder.NextBlock > index) {
+		decoder.NextBlock = resetIndex;
+	}
+	while (decoder.NextBlock <= index) {
+		if (!decodeNext(base, info, section)) {
+			decoder.NextBlock = (size_t)-1;
+			return shared_ptr<std::string>();
+		}
+	}
+	return myBlocks.front().second;
+}
+
+bool CHMBlockCache::decodeNext(ZLInputStream &base, const CHMFileInfo::SectionInfo &info, size_t section) {
+	Decoder &decoder = myDecoders[section];
+	const size_t index = decoder.NextBlock;
+	const bool isTail = index + 1 == info.ResetTable.size();
+	const size_t start = info.ResetTable[index];
+	const size_t end = isTail ? info.CompressedSize : info.ResetTable[index + 1];
+	if (end < start || index * BLOCK_SIZE >= info.UncompressedSize) {
+		return false;
+	}
+
+	myInData.erase();
+	myInData.append(end - start, '\0');
+	base.seek(info.Offset + start, true);
+	if (base.read((char*)myInData.data(), myInData.length()) != myInData.length()) {
+		return false;
+	}
+
+	if (!decoder.Decompressor) {
+		decoder.Decompressor.reset(new LZXDecompressor(info.WindowSizeIndex));
+	} else if (index % info.ResetInterval == 0) {
+		decoder.Decompressor->reset();
+	}
+
+	const size_t length = std::min(BLOCK_SIZE, info.UncompressedSize - index * BLOCK_SIZE);
+	shared_ptr<std::string> data(new std::string(length, '\0'));
+	if (!decoder.Decompressor->decompress(myInData, (unsigned char*)data->data(), length)) {
+		return false;
+	}
+	++decoder.NextBlock;
+	add(section, index, data);
+	return true;
+}
+
+void CHMBlockCache::add(size_t section, size_t index, shared_ptr<std::string> data) {
+	const Key key(section, index);
+	std::map<Key,BlockList::iterator>::iterator it = myIndex.find(key);
+	if (it != myIndex.end()) {
+		mySize -= it->second->second->size();
+		myBlocks.erase(it->second);
+		myIndex.erase(it);
+	}
+	myBlocks.push_front(std::make_pair(key, data));
+	myIndex[key] = myBlocks.begin();
+	mySize += data->size();
+	while (mySize > myMaxSize && myBlocks.size() > 1) {
+		mySize -= myBlocks.back().second->size();
+		myIndex.erase(myBlocks.back().first);
+		myBlocks.pop_back();
+	}
+}
+
+CHMInputStream::CHMInputStream(shared_ptr<ZLInputStream> base, shared_ptr<CHMBlockCache> cache, const CHMFileInfo::SectionInfo &sectionInfo, size_t section, size_t offset, size_t size) : myBase(base), myCache(cache), mySectionInfo(sectionInfo), mySection(section), myStartOffset(offset), mySize(size), myOffset(0), myBlockIndex((size_t)-1) {
 }
 
 CHMInputStream::~CHMInputStream() {
 	close();
-	delete[] myOutData;
 }
 
 bool CHMInputStream::open() {
 	myOffset = 0;
-	myDoSkip = true;
-	myBaseIndex = myBaseStartIndex;
-	if (!myDecompressor) {
-          myDecompressor.reset(new LZXDecompressor(mySectionInfo.WindowSizeIndex));
-	} else {
-		myDecompressor->reset();
-	}
-	myOutDataOffset = 0;
-	myOutDataLength = 0;
 	return true;
 }
 
 size_t CHMInputStream::read(char *buffer, size_t maxSize) {
-	if (myDoSkip) {
-		do_read(0, myBytesToSkip);
-		myDoSkip = false;
-	}
-	size_t realSize = do_read(buffer, std::min(maxSize, mySize - myOffset));
-	myOffset += realSize;
-	return realSize;
-}
-
-size_t CHMInputStream::do_read(char *buffer, size_t maxSize) {
+	maxSize = std::min(maxSize, mySize - myOffset);
 	size_t realSize = 0;
-	do {
-		if (myOutDataLength == 0) {
-			if (myBaseIndex >= mySectionInfo.ResetTable.size()) {
-				break;
-			}
-			const bool isTail = myBaseIndex + 1 == mySectionInfo.ResetTable.size();
-			const size_t start = mySectionInfo.ResetTable[myBaseIndex];
-			const size_t end = isTail ? mySectionInfo.CompressedSize : mySectionInfo.ResetTable[myBaseIndex + 1];
-			myOutDataLength = isTail ? mySectionInfo.UncompressedSize % 0x8000 : 0x8000;
-			myOutDataOffset = 0;
-
-			myInData.erase();
-			myInData.append(end - start, '\0');
-			myBase->seek(mySectionInfo.Offset + start, true);
-			myBase->read((char*)myInData.data(), myInData.length());
-			if (myBaseIndex % mySectionInfo.ResetInterval == 0) {
-				myDecompressor->reset();
-			}
-			++myBaseIndex;
-
-			if (!myDecompressor->decompress(myInData, myOutData, myOutDataLength)) {
+	while (realSize < maxSize) {
+		const size_t position = myStartOffset + myOffset;
+		const size_t index = position / CHMBlockCache::BLOCK_SIZE;
+		if (!myBlock || myBlockIndex != index) {
+			myBlock = myCache->block(*myBase, mySectionInfo, mySection, index);
+			myBlockIndex = index;
+			if (!myBlock) {
 				break;
 			}
 		}
-		const size_t partSize = std::min(myOutDataLength, maxSize);
+		const size_t blockOffset = position % CHMBlockCache::BLOCK_SIZE;
+		if (blockOffset >= myBlock->size()) {
+			break;
+		}
+		const size_t partSize = std::min(maxSize - realSize, myBlock->size() - blockOffset);
 		if (buffer != 0) {
-			memcpy(buffer + realSize, myOutData + myOutDataOffset, partSize);
+			memcpy(buffer + realSize, myBlock->data() + blockOffset, partSize);
 		}
-		maxSize -= partSize;
 		realSize += partSize;
-		myOutDataLength -= partSize;
-		myOutDataOffset += partSize;
-	} while (maxSize != 0);
+		myOffset += partSize;
+	}
 	return realSize;
 }
 
 void CHMInputStream::close() {
-  myDecompressor.reset();
+	myBlock.reset();
+	myBlockIndex = (size_t)-1;
 }
 
 void CHMInputStream::seek(int offset, bool absoluteOffset) {
-	if (absoluteOffset) {
-		offset -= myOffset;
-	}
-	if (offset > 0) {
-		read(0, offset);
-	} else if (offset < 0) {
-		open();
-		read(0, std::max(offset + (int)myOffset, 0));
+	if (!absoluteOffset) {
+		offset += myOffset;
 	}
+	myOffset = std::min((size_t)std::max(offset, 0), mySize);
 }
 
 size_t CHMInputStream::offset() const {
@@ -186,10 +228,10 @@ shared_ptr<ZLInputStream> CHMFileInfo::entryStream(shared_ptr<ZLInputStream> bas
           return shared_ptr<ZLInputStream>();
 	}
 
-	return shared_ptr<ZLInputStream>(new CHMInputStream(base, sectionInfo, recordInfo.Offset, recordInfo.Length));
+	return shared_ptr<ZLInputStream>(new CHMInputStream(base, myBlockCache, sectionInfo, recordInfo.Section, recordInfo.Offset, recordInfo.Length));
 }
 
-CHMFileInfo::CHMFileInfo(const std::string &fileName) : myFileName(fileName) {
+CHMFileInfo::CHMFileInfo(const std::string &fileName) : myFileName(fileName), myBlockCache(new CHMBlockCache(2 * 1024 * 1024)) {
 }
 
 bool CHMFileInfo::moveToEntry(ZLInputStream &stream, const std::string &entryName) {
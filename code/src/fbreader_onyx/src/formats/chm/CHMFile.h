@@ -22,12 +22,14 @@
 
 #include <string>
 #include <map>
+#include <list>
 #include <vector>
 
 #include <shared_ptr.h>
 #include <ZLInputStream.h>
 
 class LZXDecompressor;
+class CHMBlockCache;
 
 class CHMFileInfo {
 
@@ -79,18 +81,57 @@ private:
 	std::vector<SectionInfo> mySectionInfos;
 
 	const std::string myFileName;
+	shared_ptr<CHMBlockCache> myBlockCache;
 
 private:
 	CHMFileInfo(const CHMFileInfo&);
 	const CHMFileInfo &operator= (const CHMFileInfo&);
 
 friend class CHMInputStream;
+friend class CHMBlockCache;
+};
+
+// Decompressed 0x8000-byte blocks shared by all entry streams of a file.
+// LZX blocks can only be decoded in order from a reset point, so decoders
+// are kept per section and continue from where the previous read stopped.
+class CHMBlockCache {
+
+public:
+	static const size_t BLOCK_SIZE = 0x8000;
+
+	CHMBlockCache(size_t maxSize);
+
+	shared_ptr<std::string> block(ZLInputStream &base, const CHMFileInfo::SectionInfo &info, size_t section, size_t index);
+
+private:
+	bool decodeNext(ZLInputStream &base, const CHMFileInfo::SectionInfo &info, size_t section);
+	void add(size_t section, size_t index, shared_ptr<std::string> data);
+
+private:
+	struct Decoder {
+		Decoder() : NextBlock((size_t)-1) {}
+		shared_ptr<LZXDecompressor> Decompressor;
+		size_t NextBlock;
+	};
+	std::map<size_t,Decoder> myDecoders;
+	std::string myInData;
+
+	typedef std::pair<size_t,size_t> Key;
+	typedef std::list<std::pair<Key,shared_ptr<std::string> > > BlockList;
+	BlockList myBlocks;
+	std::map<Key,BlockList::iterator> myIndex;
+	const size_t myMaxSize;
+	size_t mySize;
+
+private:
+	CHMBlockCache(const CHMBlockCache&);
+	const CHMBlockCache &operator= (const CHMBlockCache&);
 };
 
 class CHMInputStream : public ZLInputStream {
 
 public:
-	CHMInputStream(shared_ptr<ZLInputStream> base, const CHMFileInfo::SectionInfo &sectionInfo, size_t offset, size_t size);
+	CHMInputStream(shared_ptr<ZLInputStream> base, shared_ptr<CHMBlockCache> cache, const CHMFileInfo::SectionInfo &sectionInfo, size_t section, size_t offset, size_t size);
 	~CHMInputStream();
 
 	bool open();
@@ -101,26 +142,17 @@ public:
 	size_t offset() const;
 	size_t sizeOfOpened();
 
-private:
-	size_t do_read(char *buffer, size_t maxSize);
-
 private:
 	shared_ptr<ZLInputStream> myBase;
+	shared_ptr<CHMBlockCache> myCache;
 	const CHMFileInfo::SectionInfo mySectionInfo;
-	size_t myBaseStartIndex;
-	size_t myBaseIndex;
-	size_t myBytesToSkip;
+	const size_t mySection;
+	const size_t myStartOffset;
 	const size_t mySize;
 
 	size_t myOffset;
-	bool myDoSkip;
-
-	shared_ptr<LZXDecompressor> myDecompressor;
-	std::string myInData;
-	
-	unsigned char *myOutData;
-	size_t myOutDataOffset;
-	size_t myOutDataLength;
+	size_t myBlockIndex;
+	shared_ptr<std::string> myBlock;
 };
 
 #endif /* __CHMFILE_H__ */
@@ -29,32 +29,40 @@ void HuffmanDecoder::reset() {
 }
 
 bool HuffmanDecoder::buildTable() {
+	// canonical code: count codes of every length once instead of
+	// scanning all the symbols for each length
+	unsigned int lengthCounts[17] = { 0 };
 	myMaxBitsNumber = 0;
 	for (unsigned short symbol = 0; symbol < CodeLengths.size(); symbol++) {
-		myMaxBitsNumber = std::max(CodeLengths[symbol], myMaxBitsNumber);
-	}
-	if (myMaxBitsNumber > 16) {
-		return false;
+		const unsigned char length = CodeLengths[symbol];
+		if (length > 16) {
+			return false;
+		}
+		++lengthCounts[length];
+		myMaxBitsNumber = std::max(length, myMaxBitsNumber);
 	}
 
-	unsigned int tableSize = 1 << myMaxBitsNumber;
-	mySymbols.clear();
-	mySymbols.reserve(tableSize);
-
+	const unsigned int tableSize = 1 << myMaxBitsNumber;
+	unsigned int nextOffset[17];
+	unsigned int offset = 0;
 	for (unsigned char i = 1; i <= myMaxBitsNumber; ++i) {
-		for (unsigned short symbol = 0; symbol < CodeLengths.size(); symbol++) {
-			if (CodeLengths[symbol] == i) {
-				mySymbols.insert(mySymbols.end(), 1 << (myMaxBitsNumber - i), symbol);
-				if (mySymbols.size() > tableSize) {
-					return false;
-				}
-			}
-		}
+		nextOffset[i] = offset;
+		offset += lengthCounts[i] << (myMaxBitsNumber - i);
+	}
+	if (offset > tableSize) {
+		return false;
 	}
 
-	if (mySymbols.size() < tableSize) {
-		mySymbols.insert(mySymbols.end(), tableSize - mySymbols.size(), 0);
+	mySymbols.resize(tableSize);
+	for (unsigned short symbol = 0; symbol < CodeLengths.size(); symbol++) {
+		const unsigned char length = CodeLengths[symbol];
+		if (length != 0) {
+			const unsigned int span = 1 << (myMaxBitsNumber - length);
+			std::fill(mySymbols.begin() + nextOffset[length], mySymbols.begin() + nextOffset[length] + span, symbol);
+			nextOffset[length] += span;
+		}
 	}
+	std::fill(mySymbols.begin() + offset, mySymbols.end(), 0);
 
 	return true;
 }
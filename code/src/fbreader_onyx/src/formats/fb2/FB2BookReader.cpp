@@ -22,11 +22,11 @@
 
 #include <ZLInputStream.h>
 #include <ZLStringUtil.h>
+#include <ZLFileImage.h>
 
 #include <ZLTextParagraph.h>
 
 #include "FB2BookReader.h"
-#include "Base64EncodedImage.h"
 #include "../../bookmodel/BookModel.h"
 #include "../../constants/XMLNamespace.h"
 
@@ -37,22 +37,19 @@ FB2BookReader::FB2BookReader(BookModel &model) : myModelReader(model) {
 	mySectionDepth = 0;
 	myBodyCounter = 0;
 	myReadMainText = false;
-	myCurrentImage = 0;
 	myProcessingImage = false;
+	myImageOffset = 0;
 	mySectionStarted = false;
 	myInsideTitle = false;
 }
 
 void FB2BookReader::characterDataHandler(const char *text, size_t len) {
-	if ((len > 0) && (myProcessingImage || myModelReader.paragraphIsOpen())) {
+	// binary data is not kept, images are read from the file on demand
+	if ((len > 0) && !myProcessingImage && myModelReader.paragraphIsOpen()) {
 		std::string str(text, len);
-		if (myProcessingImage) {
-			myImageBuffer.push_back(str);
-		} else {
-			myModelReader.addData(str);
-			if (myInsideTitle) {
-				myModelReader.addContentsData(str);
-			}
+		myModelReader.addData(str);
+		if (myInsideTitle) {
+			myModelReader.addContentsData(str);
 		}
 	}
 }
@@ -198,9 +195,11 @@ void FB2BookReader::startElementHandler(int tag, const char **xmlattributes) {
 		case _BINARY:
 		{
 			const char *contentType = attributeValue(xmlattributes, "content-type");
-			if ((contentType != 0) && (id != 0)) {
-				myCurrentImage = new Base64EncodedImage(contentType);
-				myModelReader.addImage(id, shared_ptr<const ZLImage>(myCurrentImage));
+			const size_t offset = eventOffset();
+			if ((contentType != 0) && (id != 0) && (offset != (size_t)-1)) {
+				myImageId = id;
+				myImageType = contentType;
+				myImageOffset = offset + eventLength();
 				myProcessingImage = true;
 			}
 			break;
@@ -299,10 +298,13 @@ void FB2BookReader::endElementHandler(int tag) {
 			myModelReader.addControl(myHyperlinkType, false);
 			break;
 		case _BINARY:
-			if (!myImageBuffer.empty() && (myCurrentImage != 0)) {
-				myCurrentImage->addData(myImageBuffer);
-				myImageBuffer.clear();
-				myCurrentImage = 0;
+			if (myProcessingImage) {
+				const size_t offset = eventOffset();
+				if ((offset != (size_t)-1) && (offset > myImageOffset)) {
+					myModelReader.addImage(myImageId, shared_ptr<const ZLImage>(
+						new ZLFileImage(myImageType, myFileName, myImageOffset, offset - myImageOffset, ZLFileImage::BASE64_ENCODING)
+					));
+				}
 			}
 			myProcessingImage = false;
 			break;
@@ -333,5 +335,6 @@ void FB2BookReader::namespaceListChangedHandler() {
 
 bool FB2BookReader::readBook(const std::string &fileName) {
 	myHrefAttributeName = "";
+	myFileName = fileName;
 	return readDocument(fileName);
 }
@@ -24,7 +24,6 @@
 #include "../../bookmodel/BookReader.h"
 
 class BookModel;
-class Base64EncodedImage;
 
 class FB2BookReader : public FB2Reader {
 
@@ -49,9 +48,11 @@ private:
 	bool myInsidePoem;
 	BookReader myModelReader;
 
-	Base64EncodedImage *myCurrentImage;
+	std::string myFileName;
 	bool myProcessingImage;
-	std::vector<std::string> myImageBuffer;
+	std::string myImageId;
+	std::string myImageType;
+	size_t myImageOffset;
 
 	bool mySectionStarted;
 	bool myInsideTitle;
@@ -29,6 +29,35 @@
 #include "../../description/BookDescription.h"
 #include "../util/MiscUtil.h"
 
+class HtmlModelLoader : public ModelLoader {
+
+public:
+	HtmlModelLoader(const BookDescription &description, BookModel &model, shared_ptr<ZLInputStream> stream);
+	bool start();
+	bool readSlice(size_t size);
+
+private:
+	shared_ptr<ZLInputStream> myStream;
+	PlainTextFormat myFormat;
+	HtmlBookReader myReader;
+};
+
+HtmlModelLoader::HtmlModelLoader(const BookDescription &description, BookModel &model, shared_ptr<ZLInputStream> stream) : myStream(stream), myFormat(description.fileName()), myReader(MiscUtil::htmlDirectoryPrefix(description.fileName()), model, myFormat, description.encoding()) {
+	if (!myFormat.initialized()) {
+		PlainTextFormatDetector detector;
+		detector.detect(*myStream, myFormat);
+	}
+	myReader.setFileName(MiscUtil::htmlFileName(description.fileName()));
+}
+
+bool HtmlModelLoader::start() {
+	return myReader.startReading(*myStream);
+}
+
+bool HtmlModelLoader::readSlice(size_t size) {
+	return myReader.readSlice(size);
+}
+
 bool HtmlPlugin::acceptsFile(const ZLFile &file) const {
 	const std::string &extension = file.extension();
 	return ZLStringUtil::stringEndsWith(extension, "html") || (extension == "htm");
@@ -72,6 +101,17 @@ bool HtmlPlugin::readModel(const BookDescription &description, BookModel &model)
 	return true;
 }
 
+shared_ptr<ModelLoader> HtmlPlugin::createModelLoader(const BookDescription &description, BookModel &model) const {
+	shared_ptr<ZLInputStream> stream = ZLFile(description.fileName()).inputStream();
+	if (!stream) {
+		return shared_ptr<ModelLoader>();
+	}
+
+	HtmlModelLoader *loader = new HtmlModelLoader(description, model, stream);
+	shared_ptr<ModelLoader> result(loader);
+	return loader->start() ? result : shared_ptr<ModelLoader>();
+}
+
 const std::string &HtmlPlugin::iconName() const {
 	static const std::string ICON_NAME = "html";
 	return ICON_NAME;
@@ -29,10 +29,7 @@
 #include "HtmlReader.h"
 #include "HtmlEntityCollection.h"
 
-HtmlReader::HtmlReader(const std::string &encoding) : EncodedTextReader(encoding) {
-}
-
-HtmlReader::~HtmlReader() {
+HtmlReader::HtmlReader(const std::string &encoding) : EncodedTextReader(encoding), myStream(0), myContext(0) {
 }
 
 void HtmlReader::setTag(HtmlTag &tag, const std::string &name) {
@@ -76,6 +73,41 @@ enum SpecialType {
 	ST_HEX
 };
 
+static const size_t BUFSIZE = 2048;
+
+// the parser state kept between the slices of the document
+struct HtmlReader::ParseContext {
+	ParseContext();
+	~ParseContext();
+
+	ParseState State;
+	SpecialType StateSpecial;
+	std::string CurrentString;
+	std::string AttributeValueString;
+	std::string SpecialString;
+	int QuotationCounter;
+	HtmlTag CurrentTag;
+	char EndOfComment[2];
+	char *Buffer;
+	size_t Offset;
+};
+
+HtmlReader::ParseContext::ParseContext() : State(PS_TEXT), StateSpecial(ST_UNKNOWN), QuotationCounter(0), Buffer(new char[BUFSIZE]), Offset(0) {
+	EndOfComment[0] = '\0';
+	EndOfComment[1] = '\0';
+}
+
+HtmlReader::ParseContext::~ParseContext() {
+	delete[] Buffer;
+}
+
+HtmlReader::~HtmlReader() {
+	if (myStream != 0) {
+		myStream->close();
+		delete myContext;
+	}
+}
+
 static bool allowSymbol(SpecialType type, char ch) {
 	return
 		((type == ST_NAME) && isalpha(ch)) ||
@@ -108,27 +140,44 @@ void HtmlReader::appendString(std::string &to, std::string &from) {
 }
 
 void HtmlReader::readDocument(ZLInputStream &stream) {
+	if (startReading(stream)) {
+		while (readSlice(65536)) {
+		}
+	}
+}
+
+bool HtmlReader::startReading(ZLInputStream &stream) {
 	if (!stream.open()) {
-		return;
+		return false;
 	}
 
+	myStream = &stream;
+	myContext = new ParseContext();
 	startDocumentHandler();
+	return true;
+}
 
-	ParseState state = PS_TEXT;
-	SpecialType state_special = ST_UNKNOWN;
-	std::string currentString;
-	std::string attributeValueString;
-	std::string specialString;
-	int quotationCounter = 0;
-	HtmlTag currentTag;
-	char endOfComment[2] = "\0";
+bool HtmlReader::readSlice(size_t size) {
+	if (myStream == 0) {
+		return false;
+	}
+
+	ParseState &state = myContext->State;
+	SpecialType &state_special = myContext->StateSpecial;
+	std::string &currentString = myContext->CurrentString;
+	std::string &attributeValueString = myContext->AttributeValueString;
+	std::string &specialString = myContext->SpecialString;
+	int &quotationCounter = myContext->QuotationCounter;
+	HtmlTag &currentTag = myContext->CurrentTag;
+	char *endOfComment = myContext->EndOfComment;
 
-	const size_t BUFSIZE = 2048;
-	char *buffer = new char[BUFSIZE];
+	char *buffer = myContext->Buffer;
+	size_t &offset = myContext->Offset;
 	size_t length;
-	size_t offset = 0;
+	size_t total = 0;
 	do {
-		length = stream.read(buffer, BUFSIZE);
+		length = myStream->read(buffer, BUFSIZE);
+		total += length;
 		char *start = buffer;
 		char *endOfBuffer = buffer + length;
 		for (char *ptr = buffer; ptr < endOfBuffer; ++ptr) {
@@ -328,11 +377,22 @@ void HtmlReader::readDocument(ZLInputStream &stream) {
 			}
 		}
 		offset += length;
-	} while (length == BUFSIZE);
+	} while ((length == BUFSIZE) && (total < size));
+
+	if (length == BUFSIZE) {
+		return true;
+	}
 endOfProcessing:
-	delete[] buffer;
+	finishReading();
+	return false;
+}
+
+void HtmlReader::finishReading() {
+	delete myContext;
+	myContext = 0;
 
 	endDocumentHandler();
 
-	stream.close();
+	myStream->close();
+	myStream = 0;
 }
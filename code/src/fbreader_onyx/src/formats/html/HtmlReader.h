@@ -63,6 +63,11 @@ private:
 public:
 	virtual void readDocument(ZLInputStream &stream);
 
+	// reads the document piece by piece: startReading, then readSlice
+	// until it returns false; the stream must live until the end
+	bool startReading(ZLInputStream &stream);
+	bool readSlice(size_t size);
+
 protected:
 	HtmlReader(const std::string &encoding);
 	virtual ~HtmlReader();
@@ -78,6 +83,13 @@ protected:
 
 private:
 	void appendString(std::string &to, std::string &from);
+	void finishReading();
+
+private:
+	struct ParseContext;
+
+	ZLInputStream *myStream;
+	ParseContext *myContext;
 };
 
 inline HtmlReader::HtmlAttribute::HtmlAttribute(const std::string &name) : Name(name), HasValue(false) {}
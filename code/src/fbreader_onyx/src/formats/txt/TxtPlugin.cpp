@@ -25,6 +25,34 @@
 #include "PlainTextFormat.h"
 #include "../../description/BookDescription.h"
 
+class TxtModelLoader : public ModelLoader {
+
+public:
+	TxtModelLoader(const BookDescription &description, BookModel &model, shared_ptr<ZLInputStream> stream);
+	bool start();
+	bool readSlice(size_t size);
+
+private:
+	shared_ptr<ZLInputStream> myStream;
+	PlainTextFormat myFormat;
+	TxtBookReader myReader;
+};
+
+TxtModelLoader::TxtModelLoader(const BookDescription &description, BookModel &model, shared_ptr<ZLInputStream> stream) : myStream(stream), myFormat(description.fileName()), myReader(model, myFormat, description.encoding()) {
+	if (!myFormat.initialized()) {
+		PlainTextFormatDetector detector;
+		detector.detect(*myStream, myFormat);
+	}
+}
+
+bool TxtModelLoader::start() {
+	return myReader.startReading(*myStream);
+}
+
+bool TxtModelLoader::readSlice(size_t size) {
+	return myReader.readSlice(size);
+}
+
 TxtPlugin::~TxtPlugin() {
 }
 
@@ -67,6 +95,17 @@ bool TxtPlugin::readModel(const BookDescription &description, BookModel &model)
 	return true;
 }
 
+shared_ptr<ModelLoader> TxtPlugin::createModelLoader(const BookDescription &description, BookModel &model) const {
+	shared_ptr<ZLInputStream> stream = ZLFile(description.fileName()).inputStream();
+	if (!stream) {
+		return shared_ptr<ModelLoader>();
+	}
+
+	TxtModelLoader *loader = new TxtModelLoader(description, model, stream);
+	shared_ptr<ModelLoader> result(loader);
+	return loader->start() ? result : shared_ptr<ModelLoader>();
+}
+
 const std::string &TxtPlugin::iconName() const {
 	static const std::string ICON_NAME = "unknown";
 	return ICON_NAME;
@@ -30,6 +30,7 @@ public:
 	bool acceptsFile(const ZLFile &file) const;
 	bool readDescription(const std::string &path, BookDescription &description) const;
 	bool readModel(const BookDescription &description, BookModel &model) const;
+	shared_ptr<ModelLoader> createModelLoader(const BookDescription &description, BookModel &model) const;
 	const std::string &iconName() const;
 	FormatInfoPage *createInfoPage(ZLOptionsDialog &dialog, const std::string &fileName);
 };
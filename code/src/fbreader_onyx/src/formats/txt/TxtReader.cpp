@@ -23,27 +23,49 @@
 
 #include "TxtReader.h"
 
-TxtReader::TxtReader(const std::string &encoding) : EncodedTextReader(encoding) {
+static const size_t BUFSIZE = 2048;
+
+TxtReader::TxtReader(const std::string &encoding) : EncodedTextReader(encoding), myStream(0), myBuffer(0) {
 }
 
 TxtReader::~TxtReader() {
+	if (myStream != 0) {
+		myStream->close();
+		delete[] myBuffer;
+	}
 }
 
 void TxtReader::readDocument(ZLInputStream &stream) {
+	if (startReading(stream)) {
+		while (readSlice(65536)) {
+		}
+	}
+}
+
+bool TxtReader::startReading(ZLInputStream &stream) {
 	if (!stream.open()) {
-		return;
+		return false;
 	}
 
+	myStream = &stream;
+	myBuffer = new char[BUFSIZE];
 	startDocumentHandler();
+	return true;
+}
+
+bool TxtReader::readSlice(size_t size) {
+	if (myStream == 0) {
+		return false;
+	}
 
-	const size_t BUFSIZE = 2048;
-	char *buffer = new char[BUFSIZE];
 	std::string str;
 	size_t length;
+	size_t total = 0;
 	do {
-		length = stream.read(buffer, BUFSIZE);
-		char *start = buffer;
-		const char *end = buffer + length;
+		length = myStream->read(myBuffer, BUFSIZE);
+		total += length;
+		char *start = myBuffer;
+		const char *end = myBuffer + length;
 		for (char *ptr = start; ptr != end; ++ptr) {
 			if (*ptr == '\n') {
 				if (start != ptr) {
@@ -65,10 +87,21 @@ void TxtReader::readDocument(ZLInputStream &stream) {
 			myConverter->convert(str, start, end);
 			characterDataHandler(str);
 		}
-	} while (length == BUFSIZE);
-	delete[] buffer;
+	} while ((length == BUFSIZE) && (total < size));
+
+	if (length == BUFSIZE) {
+		return true;
+	}
+	finishReading();
+	return false;
+}
+
+void TxtReader::finishReading() {
+	delete[] myBuffer;
+	myBuffer = 0;
 
 	endDocumentHandler();
 
-	stream.close();
+	myStream->close();
+	myStream = 0;
 }
@@ -33,6 +33,11 @@ class TxtReader : public EncodedTextReader {
 public:
 	void readDocument(ZLInputStream &stream);
 
+	// reads the document piece by piece: startReading, then readSlice
+	// until it returns false; the stream must live until the end
+	bool startReading(ZLInputStream &stream);
+	bool readSlice(size_t size);
+
 protected:
 	TxtReader(const std::string &encoding);
 	virtual ~TxtReader();
@@ -43,6 +48,13 @@ protected:
 
 	virtual bool characterDataHandler(std::string &str) = 0;
 	virtual bool newLineHandler() = 0;
+
+private:
+	void finishReading();
+
+private:
+	ZLInputStream *myStream;
+	char *myBuffer;
 };
 
 #endif /* __TXTREADER_H__ */
@@ -17,6 +17,9 @@
  * 02110-1301, USA.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -28,10 +31,35 @@
 
 #include "MyEncodingConverter.h"
 
+// compiled charset maps are kept in the user directory, they replace
+// the XML descriptions that are slow to parse for multibyte encodings
+static const char TABLE_MAGIC[4] = { 'Z', 'L', 'E', 'T' };
+static const unsigned int TABLE_VERSION = 1;
+
+static const size_t ONE_BYTE_TABLE_SIZE = 256;
+static const size_t TWO_BYTES_TABLE_SIZE = 32768;
+
+struct MyEncodingTable {
+	MyEncodingTable();
+
+	bool read(const std::string &fileName, size_t sourceSize);
+	void write(const std::string &fileName, size_t sourceSize) const;
+	void build();
+
+	int BytesNumber;
+	// UCS-2 codes by the byte (one byte encodings) or by
+	// 0x100 * (lead & 0x7F) + trail (two bytes encodings), 0 if unmapped
+	std::vector<unsigned short> Codes;
+	// UTF-8 forms of the codes, 4 bytes per code: the length, then the bytes
+	std::vector<char> Utf8;
+	// all the 7-bit characters except 0 map to themselves
+	bool AsciiIsIdentity;
+};
+
 class MyOneByteEncodingConverter : public ZLEncodingConverter {
 
 private:
-	MyOneByteEncodingConverter(const std::string &encoding, char **encodingMap);
+	MyOneByteEncodingConverter(shared_ptr<MyEncodingTable> table);
 
 public:
 	~MyOneByteEncodingConverter();
@@ -40,8 +68,7 @@ public:
 	bool fillTable(int *map);
 
 private:
-	const std::string myEncoding;
-	char *myEncodingMap;
+	shared_ptr<MyEncodingTable> myTable;
 
 friend class MyEncodingConverterProvider;
 };
@@ -49,7 +76,7 @@ friend class MyEncodingConverterProvider;
 class MyTwoBytesEncodingConverter : public ZLEncodingConverter {
 
 private:
-	MyTwoBytesEncodingConverter(char **encodingMap);
+	MyTwoBytesEncodingConverter(shared_ptr<MyEncodingTable> table);
 
 public:
 	~MyTwoBytesEncodingConverter();
@@ -58,7 +85,7 @@ public:
 	bool fillTable(int *map);
 
 private:
-	char **myEncodingMap;
+	shared_ptr<MyEncodingTable> myTable;
 
 	char myLastChar;
 	bool myLastCharIsNotProcessed;
@@ -66,50 +93,18 @@ private:
 friend class MyEncodingConverterProvider;
 };
 
-class EncodingReader : public ZLXMLReader {
-
-protected:
-	EncodingReader(const std::string &encoding);
-
-public:
-	virtual ~EncodingReader();
-
-public:
-	virtual void startElementHandler(const char *tag, const char **attributes);
-	int bytesNumber() const { return myBytesNumber; }
-
-protected:
-	const std::string myFilePath;
-	int myBytesNumber;
-};
-
-class EncodingIntReader : public EncodingReader {
+class EncodingTableReader : public ZLXMLReader {
 
 public:
-	EncodingIntReader(const std::string &encoding);
-	~EncodingIntReader();
-	bool fillTable(int *map);
+	EncodingTableReader(MyEncodingTable &table);
+	~EncodingTableReader();
+	bool readTable(const std::string &fileName);
 
 public:
 	void startElementHandler(const char *tag, const char **attributes);
 
 private:
-	int *myMap;
-};
-
-class EncodingCharReader : public EncodingReader {
-
-public:
-	EncodingCharReader(const std::string &encoding);
-	~EncodingCharReader();
-	char **createTable();
-
-public:
-	void startElementHandler(const char *tag, const char **attributes);
-
-private:
-	char **myMap;
-	char myBuffer[3];
+	MyEncodingTable &myTable;
 };
 
 MyEncodingConverterProvider::MyEncodingConverterProvider() {
@@ -127,35 +122,145 @@ bool MyEncodingConverterProvider::providesConverter(const std::string &encoding)
 }
 
 shared_ptr<ZLEncodingConverter> MyEncodingConverterProvider::createConverter(const std::string &encoding) {
-	EncodingCharReader er(encoding);
-	char **encodingMap = er.createTable();
-	if (encodingMap != 0) {
-		if (er.bytesNumber() == 1) {
-                  return shared_ptr<ZLEncodingConverter>(new MyOneByteEncodingConverter(encoding, encodingMap));
-		} else if (er.bytesNumber() == 2) {
-                  return shared_ptr<ZLEncodingConverter>(new MyTwoBytesEncodingConverter(encodingMap));
+	shared_ptr<MyEncodingTable> table = this->table(encoding);
+	if (table) {
+		if (table->BytesNumber == 1) {
+			return shared_ptr<ZLEncodingConverter>(new MyOneByteEncodingConverter(table));
+		} else if (table->BytesNumber == 2) {
+			return shared_ptr<ZLEncodingConverter>(new MyTwoBytesEncodingConverter(table));
 		}
 	}
 	return shared_ptr<ZLEncodingConverter>();
 }
 
-MyOneByteEncodingConverter::MyOneByteEncodingConverter(const std::string &encoding, char **encodingMap) : myEncoding(encoding) {
-	myEncodingMap = new char[1024];
-	memset(myEncodingMap, '\0', 1024);
-	for (int i = 0; i < 256; ++i) {
-		ZLUnicodeUtil::ucs4ToUtf8(myEncodingMap + 4 * i, i);
+static std::string tableFileName(const std::string &encoding) {
+	const char *home = getenv("HOME");
+	if (home == 0) {
+		return std::string();
 	}
-	if (encodingMap != 0) {
-		for (int i = 0; i < 256; ++i) {
-			if (encodingMap[i] != 0) {
-				strcpy(myEncodingMap + 4 * i, encodingMap[i]);
-			}
+	return std::string(home) + ZLibrary::FileNameDelimiter + ZLibrary::ApplicationName() + ZLibrary::FileNameDelimiter + "encodings" + ZLibrary::FileNameDelimiter + encoding;
+}
+
+shared_ptr<MyEncodingTable> MyEncodingConverterProvider::table(const std::string &encoding) {
+	std::map<std::string,shared_ptr<MyEncodingTable> >::const_iterator it = myTables.find(encoding);
+	if (it != myTables.end()) {
+		return it->second;
+	}
+
+	const std::string sourceName = ZLEncodingCollection::encodingDescriptionPath() + ZLibrary::FileNameDelimiter + encoding;
+	const size_t sourceSize = ZLFile(sourceName).size();
+	const std::string fileName = tableFileName(encoding);
+
+	shared_ptr<MyEncodingTable> table(new MyEncodingTable());
+	if (fileName.empty() || !table->read(fileName, sourceSize)) {
+		if (!EncodingTableReader(*table).readTable(sourceName)) {
+			return shared_ptr<MyEncodingTable>();
+		}
+		if (!fileName.empty()) {
+			const std::string directory = fileName.substr(0, fileName.rfind(ZLibrary::FileNameDelimiter));
+			mkdir(directory.substr(0, directory.rfind(ZLibrary::FileNameDelimiter)).c_str(), 0755);
+			mkdir(directory.c_str(), 0755);
+			table->write(fileName, sourceSize);
 		}
 	}
+	table->build();
+	myTables[encoding] = table;
+	return table;
+}
+
+MyEncodingTable::MyEncodingTable() : BytesNumber(0), AsciiIsIdentity(false) {
+}
+
+bool MyEncodingTable::read(const std::string &fileName, size_t sourceSize) {
+	FILE *file = fopen(fileName.c_str(), "rb");
+	if (file == 0) {
+		return false;
+	}
+
+	char magic[4];
+	unsigned int header[3];
+	bool ok =
+		(fread(magic, 1, 4, file) == 4) && (memcmp(magic, TABLE_MAGIC, 4) == 0) &&
+		(fread(header, sizeof(unsigned int), 3, file) == 3) &&
+		(header[0] == TABLE_VERSION) && (header[1] == sourceSize) &&
+		((header[2] == 1) || (header[2] == 2));
+	if (ok) {
+		BytesNumber = header[2];
+		Codes.resize((BytesNumber == 1) ? ONE_BYTE_TABLE_SIZE : TWO_BYTES_TABLE_SIZE);
+		ok = fread(&Codes[0], sizeof(unsigned short), Codes.size(), file) == Codes.size();
+	}
+	fclose(file);
+
+	if (!ok) {
+		BytesNumber = 0;
+		Codes.clear();
+	}
+	return ok;
+}
+
+void MyEncodingTable::write(const std::string &fileName, size_t sourceSize) const {
+	const std::string temporaryName = fileName + ".tmp";
+	FILE *file = fopen(temporaryName.c_str(), "wb");
+	if (file == 0) {
+		return;
+	}
+	const unsigned int header[3] = { TABLE_VERSION, (unsigned int)sourceSize, (unsigned int)BytesNumber };
+	bool ok =
+		(fwrite(TABLE_MAGIC, 1, 4, file) == 4) &&
+		(fwrite(header, sizeof(unsigned int), 3, file) == 3) &&
+		(fwrite(&Codes[0], sizeof(unsigned short), Codes.size(), file) == Codes.size());
+	ok = (fclose(file) == 0) && ok;
+	if (!ok || (rename(temporaryName.c_str(), fileName.c_str()) != 0)) {
+		remove(temporaryName.c_str());
+	}
+}
+
+void MyEncodingTable::build() {
+	Utf8.assign(4 * Codes.size(), '\0');
+	for (size_t i = 0; i < Codes.size(); ++i) {
+		if (Codes[i] != 0) {
+			Utf8[4 * i] = ZLUnicodeUtil::ucs4ToUtf8(&Utf8[4 * i + 1], Codes[i]);
+		}
+	}
+
+	AsciiIsIdentity = BytesNumber == 1;
+	for (unsigned short i = 1; AsciiIsIdentity && (i < 128); ++i) {
+		AsciiIsIdentity = Codes[i] == i;
+	}
+}
+
+// returns the end of the run of characters 0x01-0x7F starting at ptr,
+// the run is checked a machine word at a time
+static const char *asciiRunEnd(const char *ptr, const char *end) {
+	static const unsigned long ONES = ~0UL / 0xFF;
+	static const unsigned long HIGH_BITS = ONES * 0x80;
+
+	while (end - ptr >= (long)sizeof(unsigned long)) {
+		unsigned long word;
+		memcpy(&word, ptr, sizeof(unsigned long));
+		// a byte is 0 or has the high bit set
+		if (((word - ONES) | word) & HIGH_BITS) {
+			break;
+		}
+		ptr += sizeof(unsigned long);
+	}
+	while ((ptr != end) && ((unsigned char)(*ptr - 1) < 0x7F)) {
+		++ptr;
+	}
+	return ptr;
+}
+
+static inline char *appendUtf8(char *dstPtr, const char *entry) {
+	dstPtr[0] = entry[1];
+	dstPtr[1] = entry[2];
+	dstPtr[2] = entry[3];
+	return dstPtr + entry[0];
+}
+
+MyOneByteEncodingConverter::MyOneByteEncodingConverter(shared_ptr<MyEncodingTable> table) : myTable(table) {
 }
 
 MyOneByteEncodingConverter::~MyOneByteEncodingConverter() {
-	delete[] myEncodingMap;
 }
 
 void MyOneByteEncodingConverter::convert(std::string &dst, const char *srcStart, const char *srcEnd) {
@@ -163,10 +268,20 @@ void MyOneByteEncodingConverter::convert(std::string &dst, const char *srcStart,
 	dst.append(3 * (srcEnd - srcStart), '\0');
 	char *dstStartPtr = (char*)dst.data() + oldLength;
 	char *dstPtr = dstStartPtr;
-	const char *p;
-	for (const char *ptr = srcStart; ptr != srcEnd; ++ptr) {
-		for (p = myEncodingMap + 4 * (unsigned char)*ptr; *p != '\0'; ++p) {
-			*(dstPtr++) = *p;
+	const char *utf8 = &myTable->Utf8[0];
+	const bool asciiIsIdentity = myTable->AsciiIsIdentity;
+	if (!asciiIsIdentity) {
+		for (const char *ptr = srcStart; ptr != srcEnd; ++ptr) {
+			dstPtr = appendUtf8(dstPtr, utf8 + 4 * (unsigned char)*ptr);
+		}
+	} else {
+		for (const char *ptr = srcStart; ptr != srcEnd; ) {
+			const char *runEnd = asciiRunEnd(ptr, srcEnd);
+			memcpy(dstPtr, ptr, runEnd - ptr);
+			dstPtr += runEnd - ptr;
+			for (ptr = runEnd; (ptr != srcEnd) && ((unsigned char)(*ptr - 1) >= 0x7F); ++ptr) {
+				dstPtr = appendUtf8(dstPtr, utf8 + 4 * (unsigned char)*ptr);
+			}
 		}
 	}
 	dst.erase(dstPtr - dstStartPtr + oldLength);
@@ -176,19 +291,16 @@ void MyOneByteEncodingConverter::reset() {
 }
 
 bool MyOneByteEncodingConverter::fillTable(int *map) {
-	return EncodingIntReader(myEncoding).fillTable(map);
+	for (size_t i = 0; i < ONE_BYTE_TABLE_SIZE; ++i) {
+		map[i] = myTable->Codes[i];
+	}
+	return true;
 }
 
-MyTwoBytesEncodingConverter::MyTwoBytesEncodingConverter(char **encodingMap) : myEncodingMap(encodingMap), myLastCharIsNotProcessed(false) {
+MyTwoBytesEncodingConverter::MyTwoBytesEncodingConverter(shared_ptr<MyEncodingTable> table) : myTable(table), myLastCharIsNotProcessed(false) {
 }
 
 MyTwoBytesEncodingConverter::~MyTwoBytesEncodingConverter() {
-	for (int i = 0; i < 32768; ++i) {
-		if (myEncodingMap[i] != 0) {
-			delete[] myEncodingMap[i];
-		}
-	}
-	delete[] myEncodingMap;
 }
 
 void MyTwoBytesEncodingConverter::convert(std::string &dst, const char *srcStart, const char *srcEnd) {
@@ -196,29 +308,40 @@ void MyTwoBytesEncodingConverter::convert(std::string &dst, const char *srcStart
 		return;
 	}
 
-	dst.reserve(dst.length() + 3 * (srcEnd - srcStart) / 2);
+	// a pair gives at most 3 bytes, the pending byte with the first one too
+	size_t oldLength = dst.length();
+	dst.append(3 * (srcEnd - srcStart) / 2 + 3, '\0');
+	char *dstStartPtr = (char*)dst.data() + oldLength;
+	char *dstPtr = dstStartPtr;
+	const char *utf8 = &myTable->Utf8[0];
+
 	if (myLastCharIsNotProcessed) {
-		const char *utf8 = myEncodingMap[0x100 * (myLastChar & 0x7F) + (unsigned char)*srcStart];
-		if (utf8 != 0) {
-			dst += utf8;
-		}
+		dstPtr = appendUtf8(dstPtr, utf8 + 4 * (0x100 * (myLastChar & 0x7F) + (unsigned char)*srcStart));
 		++srcStart;
 		myLastCharIsNotProcessed = false;
 	}
-	for (const char *ptr = srcStart; ptr != srcEnd; ++ptr) {
+	for (const char *ptr = srcStart; ptr != srcEnd; ) {
+		const char *runEnd = asciiRunEnd(ptr, srcEnd);
+		memcpy(dstPtr, ptr, runEnd - ptr);
+		dstPtr += runEnd - ptr;
+		ptr = runEnd;
+		if (ptr == srcEnd) {
+			break;
+		}
+
 		if (((*ptr) & 0x80) == 0) {
-			dst += *ptr;
+			*(dstPtr++) = *ptr;
+			++ptr;
 		} else if (ptr + 1 == srcEnd) {
 			myLastChar = *ptr;
 			myLastCharIsNotProcessed = true;
-		} else {
-			const char *utf8 = myEncodingMap[0x100 * ((*ptr) & 0x7F) + (unsigned char)*(ptr + 1)];
-			if (utf8 != 0) {
-				dst += utf8;
-			}
 			++ptr;
+		} else {
+			dstPtr = appendUtf8(dstPtr, utf8 + 4 * (0x100 * ((*ptr) & 0x7F) + (unsigned char)*(ptr + 1)));
+			ptr += 2;
 		}
 	}
+	dst.erase(dstPtr - dstStartPtr + oldLength);
 }
 
 void MyTwoBytesEncodingConverter::reset() {
@@ -229,94 +352,48 @@ bool MyTwoBytesEncodingConverter::fillTable(int*) {
 	return false;
 }
 
-EncodingReader::EncodingReader(const std::string &encoding) : myFilePath(ZLEncodingCollection::encodingDescriptionPath() + ZLibrary::FileNameDelimiter + encoding) {
+EncodingTableReader::EncodingTableReader(MyEncodingTable &table) : myTable(table) {
 }
 
-EncodingReader::~EncodingReader() {
+EncodingTableReader::~EncodingTableReader() {
+}
+
+bool EncodingTableReader::readTable(const std::string &fileName) {
+	return readDocument(fileName) && (myTable.BytesNumber != 0);
 }
 
 static const std::string ENCODING = "encoding";
 static const std::string CHAR = "char";
 
-void EncodingReader::startElementHandler(const char *tag, const char **attributes) {
-  static const std::string BYTES = "bytes";
+void EncodingTableReader::startElementHandler(const char *tag, const char **attributes) {
+	static const std::string BYTES = "bytes";
 
 	if (ENCODING == tag) {
-		myBytesNumber = 1;
+		myTable.BytesNumber = 1;
 		if ((attributes[0] != 0) && (BYTES == attributes[0])) {
-			myBytesNumber = atoi(attributes[1]);
-		}
-	}
-}
-
-EncodingIntReader::EncodingIntReader(const std::string &encoding) : EncodingReader(encoding) {
-}
-
-EncodingIntReader::~EncodingIntReader() {
-}
-
-bool EncodingIntReader::fillTable(int *map) {
-	myMap = map;
-	for (int i = 0; i < 256; ++i) {
-		myMap[i] = i;
-	}
-	return readDocument(myFilePath);
-}
-
-void EncodingIntReader::startElementHandler(const char *tag, const char **attributes) {
-	EncodingReader::startElementHandler(tag, attributes);
-	if ((CHAR == tag) && (attributes[0] != 0) && (attributes[2] != 0)) {
-		char *ptr = 0;
-		myMap[strtol(attributes[1], &ptr, 16)] = strtol(attributes[3], &ptr, 16);
-	}
-}
-
-EncodingCharReader::EncodingCharReader(const std::string &encoding) : EncodingReader(encoding) {
-}
-
-EncodingCharReader::~EncodingCharReader() {
-}
-
-char **EncodingCharReader::createTable() {
-	myMap = 0;
-	if (!readDocument(myFilePath) && (myMap != 0)) {
-		int length = (myBytesNumber == 1) ? 256 : 32768;
-		for (int i = 0; i < length; ++i) {
-			if (myMap[i] != 0) {
-				delete[] myMap[i];
-			}
+			myTable.BytesNumber = atoi(attributes[1]);
 		}
-		delete[] myMap;
-		myMap = 0;
-	}
-
-	return myMap;
-}
-
-void EncodingCharReader::startElementHandler(const char *tag, const char **attributes) {
-	EncodingReader::startElementHandler(tag, attributes);
-
-	if (ENCODING == tag) {
-		int length = (myBytesNumber == 1) ? 256 : 32768;
-		myMap = new char*[length];
-		memset(myMap, 0, length * sizeof(char*));
-	} else if ((CHAR == tag) && (attributes[0] != 0) && (attributes[2] != 0)) {
-		static char *ptr = 0;
-		int index = strtol(attributes[1], &ptr, 16);
-		if (myBytesNumber == 1) {
-			if ((index < 0) || (index >= 256)) {
-				return;
+		if (myTable.BytesNumber == 1) {
+			// unlisted characters are Latin-1
+			myTable.Codes.resize(ONE_BYTE_TABLE_SIZE);
+			for (size_t i = 0; i < ONE_BYTE_TABLE_SIZE; ++i) {
+				myTable.Codes[i] = i;
 			}
+		} else if (myTable.BytesNumber == 2) {
+			myTable.Codes.assign(TWO_BYTES_TABLE_SIZE, 0);
 		} else {
+			myTable.BytesNumber = 0;
+		}
+	} else if ((CHAR == tag) && (myTable.BytesNumber != 0) && (attributes[0] != 0) && (attributes[2] != 0)) {
+		char *ptr = 0;
+		long index = strtol(attributes[1], &ptr, 16);
+		if (myTable.BytesNumber == 2) {
 			index -= 32768;
-			if ((index < 0) || (index >= 32768)) {
-				return;
-			}
 		}
-		int value = strtol(attributes[3], &ptr, 16);
-		int len = ZLUnicodeUtil::ucs4ToUtf8(myBuffer, value);
-		myMap[index] = new char[len + 1];
-		memcpy(myMap[index], myBuffer, len);
-		myMap[index][len] = '\0';
+		if ((index < 0) || (index >= (long)myTable.Codes.size())) {
+			return;
+		}
+		const long value = strtol(attributes[3], &ptr, 16);
+		myTable.Codes[index] = ((value > 0) && (value <= 0xFFFF)) ? value : 0;
 	}
 }
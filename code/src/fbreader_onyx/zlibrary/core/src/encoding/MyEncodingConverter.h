@@ -24,6 +24,9 @@
 #include "ZLEncodingConverterProvider.h"
 
 #include <set>
+#include <map>
+
+struct MyEncodingTable;
 
 class MyEncodingConverterProvider : public ZLEncodingConverterProvider {
 
@@ -32,8 +35,12 @@ public:
 	bool providesConverter(const std::string &encoding);
 	shared_ptr<ZLEncodingConverter> createConverter(const std::string &encoding);
 
+private:
+	shared_ptr<MyEncodingTable> table(const std::string &encoding);
+
 private:
 	std::set<std::string> myProvidedEncodings;
+	std::map<std::string,shared_ptr<MyEncodingTable> > myTables;
 };
 
 #endif /* __MYENCODINGCONVERTER_H__ */
@@ -20,7 +20,7 @@
 #ifndef __ZLZIP_H__
 #define __ZLZIP_H__
 
-#include <map>
+#include <vector>
 
 #include <shared_ptr.h>
 
@@ -39,7 +39,7 @@ public:
 	struct Info {
 		Info();
 
-		int Offset;
+		int Offset; // offset of the local header
 		int CompressionMethod;
 		int CompressedSize;
 		int UncompressedSize;
@@ -51,7 +51,14 @@ public:
 	void collectFileNames(std::vector<std::string> &names) const;
 
 private:
-	std::map<std::string,Info> myInfoMap;
+	bool readCentralDirectory(ZLInputStream &baseStream);
+	void scanLocalHeaders(ZLInputStream &baseStream);
+	void sortEntries();
+
+private:
+	typedef std::pair<std::string,Info> Entry;
+	// sorted by name
+	std::vector<Entry> myEntries;
 };
 
 class ZLZipInputStream : public ZLInputStream {
@@ -73,6 +80,8 @@ public:
 
 private:
 	shared_ptr<ZLInputStream> myBaseStream;
+	// stream of the archive, holds the entry cache shared by all its entries
+	shared_ptr<ZLInputStream> myArchiveStream;
 	std::string myEntryName;
 	bool myIsDeflated;
 
@@ -17,9 +17,53 @@
  * 02110-1301, USA.
  */
 
+#include <algorithm>
+
 #include "ZLZip.h"
 #include "ZLZipHeader.h"
 
+static const unsigned long END_OF_CENTRAL_DIRECTORY = 0x06054B50;
+static const unsigned long ZIP64_END_OF_CENTRAL_DIRECTORY = 0x06064B50;
+static const unsigned long ZIP64_LOCATOR = 0x07064B50;
+static const unsigned long CENTRAL_DIRECTORY_ENTRY = 0x02014B50;
+
+static const size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+static const size_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE = 56;
+static const size_t ZIP64_LOCATOR_SIZE = 20;
+static const size_t CENTRAL_DIRECTORY_ENTRY_SIZE = 46;
+static const size_t MAX_COMMENT_LENGTH = 0xFFFF;
+
+static unsigned short readShort(const char *data) {
+	return ((((unsigned short)data[1]) & 0xFF) << 8) + ((unsigned short)data[0] & 0xFF);
+}
+
+static unsigned long readLong(const char *data) {
+	return
+		((((unsigned long)data[3]) & 0xFF) << 24) +
+		((((unsigned long)data[2]) & 0xFF) << 16) +
+		((((unsigned long)data[1]) & 0xFF) << 8) +
+		((unsigned long)data[0] & 0xFF);
+}
+
+static unsigned long long readLongLong(const char *data) {
+	return ((unsigned long long)readLong(data + 4) << 32) + readLong(data);
+}
+
+static bool readBlock(ZLInputStream &stream, size_t offset, std::string &block) {
+	stream.seek(offset, true);
+	return
+		(stream.offset() == offset) &&
+		(stream.read((char*)block.data(), block.size()) == block.size());
+}
+
+static bool entryNameLess(const std::pair<std::string,ZLZipEntryCache::Info> &entry, const std::string &name) {
+	return entry.first < name;
+}
+
+static bool entryLess(const std::pair<std::string,ZLZipEntryCache::Info> &entry0, const std::pair<std::string,ZLZipEntryCache::Info> &entry1) {
+	return entry0.first < entry1.first;
+}
+
 ZLZipEntryCache::Info::Info() : Offset(-1) {
 }
 
@@ -38,28 +82,182 @@ ZLZipEntryCache::ZLZipEntryCache(ZLInputStream &baseStream) {
 		return;
 	}
 
+	// the central directory lists all the entries at the end of the archive,
+	// walking the local headers is only needed for broken archives
+	if (!readCentralDirectory(baseStream)) {
+		myEntries.clear();
+		baseStream.seek(0, true);
+		scanLocalHeaders(baseStream);
+	}
+	sortEntries();
+	baseStream.close();
+}
+
+bool ZLZipEntryCache::readCentralDirectory(ZLInputStream &baseStream) {
+	const size_t fileSize = baseStream.sizeOfOpened();
+	if (fileSize < END_OF_CENTRAL_DIRECTORY_SIZE) {
+		return false;
+	}
+
+	// the end of central directory record is followed by a comment of at most 64K
+	const size_t tailSize = std::min(fileSize, END_OF_CENTRAL_DIRECTORY_SIZE + MAX_COMMENT_LENGTH);
+	const size_t tailOffset = fileSize - tailSize;
+	std::string tail(tailSize, '\0');
+	if (!readBlock(baseStream, tailOffset, tail)) {
+		return false;
+	}
+
+	int eocd = tailSize - END_OF_CENTRAL_DIRECTORY_SIZE;
+	for (; eocd >= 0; --eocd) {
+		if ((readLong(tail.data() + eocd) == END_OF_CENTRAL_DIRECTORY) &&
+				(eocd + END_OF_CENTRAL_DIRECTORY_SIZE + readShort(tail.data() + eocd + 20) <= tailSize)) {
+			break;
+		}
+	}
+	if (eocd < 0) {
+		return false;
+	}
+
+	const char *record = tail.data() + eocd;
+	unsigned long long entryCount = readShort(record + 10);
+	unsigned long long directorySize = readLong(record + 12);
+	unsigned long long directoryOffset = readLong(record + 16);
+
+	// ZIP64 archives keep the real values in the zip64 end of central directory record
+	if ((entryCount == 0xFFFF) || (directorySize == 0xFFFFFFFF) || (directoryOffset == 0xFFFFFFFF)) {
+		if ((eocd < (int)ZIP64_LOCATOR_SIZE) ||
+				(readLong(tail.data() + eocd - ZIP64_LOCATOR_SIZE) != ZIP64_LOCATOR)) {
+			return false;
+		}
+		unsigned long long zip64Offset = readLongLong(tail.data() + eocd - ZIP64_LOCATOR_SIZE + 8);
+		if (zip64Offset + ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE > fileSize) {
+			return false;
+		}
+		std::string zip64Record(ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE, '\0');
+		if (!readBlock(baseStream, (size_t)zip64Offset, zip64Record) ||
+				(readLong(zip64Record.data()) != ZIP64_END_OF_CENTRAL_DIRECTORY)) {
+			return false;
+		}
+		entryCount = readLongLong(zip64Record.data() + 32);
+		directorySize = readLongLong(zip64Record.data() + 40);
+		directoryOffset = readLongLong(zip64Record.data() + 48);
+	}
+
+	if ((directoryOffset + directorySize > fileSize) ||
+			(entryCount * CENTRAL_DIRECTORY_ENTRY_SIZE > directorySize)) {
+		return false;
+	}
+
+	std::string directory((size_t)directorySize, '\0');
+	if (!readBlock(baseStream, (size_t)directoryOffset, directory)) {
+		return false;
+	}
+
+	myEntries.reserve((size_t)entryCount);
+	const char *data = directory.data();
+	size_t position = 0;
+	for (unsigned long long i = 0; i < entryCount; ++i) {
+		if ((position + CENTRAL_DIRECTORY_ENTRY_SIZE > directory.size()) ||
+				(readLong(data + position) != CENTRAL_DIRECTORY_ENTRY)) {
+			return false;
+		}
+		const char *header = data + position;
+		const unsigned short nameLength = readShort(header + 28);
+		const unsigned short extraLength = readShort(header + 30);
+		const unsigned short commentLength = readShort(header + 32);
+		const size_t entrySize = CENTRAL_DIRECTORY_ENTRY_SIZE + nameLength + extraLength + commentLength;
+		if (position + entrySize > directory.size()) {
+			return false;
+		}
+
+		unsigned long long compressedSize = readLong(header + 20);
+		unsigned long long uncompressedSize = readLong(header + 24);
+		unsigned long long offset = readLong(header + 42);
+
+		// the zip64 extra field holds the values that do not fit into the header
+		const char *extra = header + CENTRAL_DIRECTORY_ENTRY_SIZE + nameLength;
+		const char *extraEnd = extra + extraLength;
+		while (extra + 4 <= extraEnd) {
+			const unsigned short tag = readShort(extra);
+			const unsigned short size = readShort(extra + 2);
+			const char *field = extra + 4;
+			extra = field + size;
+			if ((tag != 0x0001) || (extra > extraEnd)) {
+				continue;
+			}
+			if ((uncompressedSize == 0xFFFFFFFF) && (field + 8 <= extra)) {
+				uncompressedSize = readLongLong(field);
+				field += 8;
+			}
+			if ((compressedSize == 0xFFFFFFFF) && (field + 8 <= extra)) {
+				compressedSize = readLongLong(field);
+				field += 8;
+			}
+			if ((offset == 0xFFFFFFFF) && (field + 8 <= extra)) {
+				offset = readLongLong(field);
+			}
+		}
+
+		// streams address the archive with int offsets, larger entries are unreachable
+		if ((nameLength != 0) &&
+				(offset + compressedSize < 0x7FFFFFFF) &&
+				(uncompressedSize < 0x7FFFFFFF)) {
+			myEntries.push_back(Entry(std::string(header + CENTRAL_DIRECTORY_ENTRY_SIZE, nameLength), Info()));
+			Info &info = myEntries.back().second;
+			info.Offset = (int)offset;
+			info.CompressionMethod = readShort(header + 10);
+			info.CompressedSize = (int)compressedSize;
+			info.UncompressedSize = (int)uncompressedSize;
+		}
+		position += entrySize;
+	}
+	return true;
+}
+
+void ZLZipEntryCache::scanLocalHeaders(ZLInputStream &baseStream) {
 	ZLZipHeader header;
+	size_t headerOffset = baseStream.offset();
 	while (header.readFrom(baseStream)) {
 		std::string entryName(header.NameLength, '\0');
 		if ((unsigned int)baseStream.read((char*)entryName.data(), header.NameLength) == header.NameLength) {
-			Info &info = myInfoMap[entryName];
-			info.Offset = baseStream.offset() + header.ExtraLength;
+			myEntries.push_back(Entry(entryName, Info()));
+			Info &info = myEntries.back().second;
+			info.Offset = headerOffset;
 			info.CompressionMethod = header.CompressionMethod;
 			info.CompressedSize = header.CompressedSize;
 			info.UncompressedSize = header.UncompressedSize;
 		}
 		ZLZipHeader::skipEntry(baseStream, header);
+		headerOffset = baseStream.offset();
 	}
-	baseStream.close();
+}
+
+void ZLZipEntryCache::sortEntries() {
+	// the last of the entries with the same name wins, as it did when
+	// the entries were collected into a map
+	std::stable_sort(myEntries.begin(), myEntries.end(), entryLess);
+	std::vector<Entry>::iterator out = myEntries.begin();
+	for (std::vector<Entry>::iterator it = myEntries.begin(); it != myEntries.end(); ++it) {
+		if ((it + 1 != myEntries.end()) && ((it + 1)->first == it->first)) {
+			continue;
+		}
+		if (out != it) {
+			*out = *it;
+		}
+		++out;
+	}
+	myEntries.erase(out, myEntries.end());
 }
 
 ZLZipEntryCache::Info ZLZipEntryCache::info(const std::string &entryName) const {
-	std::map<std::string,Info>::const_iterator it = myInfoMap.find(entryName);
-	return (it != myInfoMap.end()) ? it->second : Info();
+	std::vector<Entry>::const_iterator it =
+		std::lower_bound(myEntries.begin(), myEntries.end(), entryName, entryNameLess);
+	return ((it != myEntries.end()) && (it->first == entryName)) ? it->second : Info();
 }
 
 void ZLZipEntryCache::collectFileNames(std::vector<std::string> &names) const {
-	for (std::map<std::string,Info>::const_iterator it = myInfoMap.begin(); it != myInfoMap.end(); ++it) {
+	names.reserve(names.size() + myEntries.size());
+	for (std::vector<Entry>::const_iterator it = myEntries.begin(); it != myEntries.end(); ++it) {
 		names.push_back(it->first);
 	}
 }
@@ -27,6 +27,7 @@
 ZLZipInputStream::ZLZipInputStream(shared_ptr<ZLInputStream> &base,
         const std::string &entryName)
     : myBaseStream(new ZLInputStreamDecorator(base))
+    , myArchiveStream(base)
     , myEntryName(entryName)
     , myUncompressedSize(0)
 {
@@ -39,7 +40,7 @@ ZLZipInputStream::~ZLZipInputStream() {
 bool ZLZipInputStream::open() {
 	close();
 
-	const ZLZipEntryCache &cache = ZLZipEntryCache::cache(*myBaseStream);
+	const ZLZipEntryCache &cache = ZLZipEntryCache::cache(*myArchiveStream);
 	ZLZipEntryCache::Info info = cache.info(myEntryName);
 
 	if (!myBaseStream->open()) {
@@ -52,6 +53,14 @@ bool ZLZipInputStream::open() {
 	}
 	myBaseStream->seek(info.Offset, true);
 
+	// the extra field of the local header may differ from the central one
+	ZLZipHeader header;
+	if (!header.readFrom(*myBaseStream)) {
+		close();
+		return false;
+	}
+	myBaseStream->seek(header.NameLength + header.ExtraLength, false);
+
 	if (info.CompressionMethod == 0) {
 		myIsDeflated = false;
 	} else if (info.CompressionMethod == 8) {
@@ -18,9 +18,17 @@
  */
 
 #include <ZLFile.h>
+#include <ZLStringUtil.h>
 
 #include "ZLFileImage.h"
 
 shared_ptr<ZLInputStream> ZLFileImage::inputStream() const {
 	return ZLFile(myPath).inputStream();
 }
+
+std::string ZLFileImage::cacheKey() const {
+	std::string key = myPath;
+	key += ':';
+	ZLStringUtil::appendNumber(key, offset());
+	return key;
+}
@@ -25,7 +25,9 @@
 class ZLFileImage : public ZLStreamImage {
 
 public:
-	ZLFileImage(const std::string &mimeType, const std::string &path, size_t offset, size_t size = 0);
+	ZLFileImage(const std::string &mimeType, const std::string &path, size_t offset, size_t size = 0, Encoding encoding = NO_ENCODING);
+	const std::string &path() const;
+	std::string cacheKey() const;
 
 protected:
 	shared_ptr<ZLInputStream> inputStream() const;
@@ -34,6 +36,7 @@ private:
 	std::string myPath;
 };
 
-inline ZLFileImage::ZLFileImage(const std::string &mimeType, const std::string &path, size_t offset, size_t size) : ZLStreamImage(mimeType, offset, size), myPath(path) {}
+inline ZLFileImage::ZLFileImage(const std::string &mimeType, const std::string &path, size_t offset, size_t size, Encoding encoding) : ZLStreamImage(mimeType, offset, size, encoding), myPath(path) {}
+inline const std::string &ZLFileImage::path() const { return myPath; }
 
 #endif /* __ZLFILEIMAGE_H__ */
@@ -44,6 +44,9 @@ public:
 	bool isSingle() const { return true; }
 	const std::string &mimeType() const;
 	virtual const shared_ptr<std::string> stringData() const = 0;
+	// identifies the decoded image in the image manager cache,
+	// images with an empty key are decoded on every request
+	virtual std::string cacheKey() const;
 	
 private:
 	std::string myMimeType;
@@ -68,6 +71,7 @@ inline ZLImage::~ZLImage() {}
 inline ZLSingleImage::ZLSingleImage(const std::string &mimeType) : myMimeType(mimeType) {}
 inline ZLSingleImage::~ZLSingleImage() {}
 inline const std::string &ZLSingleImage::mimeType() const { return myMimeType; }
+inline std::string ZLSingleImage::cacheKey() const { return std::string(); }
 
 inline ZLMultiImage::ZLMultiImage() : ZLImage() {}
 inline ZLMultiImage::~ZLMultiImage() {}
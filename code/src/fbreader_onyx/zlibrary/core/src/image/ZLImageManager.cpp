@@ -25,6 +25,11 @@
 
 ZLImageManager *ZLImageManager::ourInstance = 0;
 
+static const size_t DEFAULT_CACHE_LIMIT = 8 * 1024 * 1024;
+
+ZLImageManager::ZLImageManager() : myCacheSize(0), myCacheLimit(DEFAULT_CACHE_LIMIT) {
+}
+
 void ZLImageManager::deleteInstance() {
 	if (ourInstance != 0) {
 		delete ourInstance;
@@ -283,7 +288,22 @@ void ZLImageManager::convertMultiImage(const ZLMultiImage &multiImage, ZLImageDa
 	}
 }
 
+static size_t dataSize(const ZLImageData &data) {
+	return 4 * data.width() * data.height();
+}
+
 shared_ptr<ZLImageData> ZLImageManager::imageData(const ZLImage &image) const {
+	std::string key;
+	if (image.isSingle()) {
+		key = ((const ZLSingleImage&)image).cacheKey();
+		if (!key.empty()) {
+			shared_ptr<ZLImageData> data = cachedData(key);
+			if (data) {
+				return data;
+			}
+		}
+	}
+
 	shared_ptr<ZLImageData> data = createData();
 
 	if (image.isSingle()) {
@@ -300,5 +320,48 @@ shared_ptr<ZLImageData> ZLImageManager::imageData(const ZLImage &image) const {
 		convertMultiImage((const ZLMultiImage&)image, *data);
 	}
 
+	if (!key.empty()) {
+		cacheData(key, data);
+	}
 	return data;
 }
+
+void ZLImageManager::setCacheLimit(size_t limit) {
+	myCacheLimit = limit;
+	shrinkCache();
+}
+
+void ZLImageManager::clearCache() const {
+	myCache.clear();
+	myCacheIndex.clear();
+	myCacheSize = 0;
+}
+
+shared_ptr<ZLImageData> ZLImageManager::cachedData(const std::string &key) const {
+	std::map<std::string,CacheList::iterator>::const_iterator it = myCacheIndex.find(key);
+	if (it == myCacheIndex.end()) {
+		return shared_ptr<ZLImageData>();
+	}
+	myCache.splice(myCache.begin(), myCache, it->second);
+	return it->second->second;
+}
+
+void ZLImageManager::cacheData(const std::string &key, shared_ptr<ZLImageData> data) const {
+	const size_t size = dataSize(*data);
+	if ((size == 0) || (size > myCacheLimit / 2)) {
+		return;
+	}
+	myCache.push_front(CacheEntry(key, data));
+	myCacheIndex[key] = myCache.begin();
+	myCacheSize += size;
+	shrinkCache();
+}
+
+void ZLImageManager::shrinkCache() const {
+	while ((myCacheSize > myCacheLimit) && !myCache.empty()) {
+		const CacheEntry &entry = myCache.back();
+		myCacheSize -= dataSize(*entry.second);
+		myCacheIndex.erase(entry.first);
+		myCache.pop_back();
+	}
+}
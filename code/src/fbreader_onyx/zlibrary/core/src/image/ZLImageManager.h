@@ -21,6 +21,8 @@
 #define __ZLIMAGEMANAGER_H__
 
 #include <string>
+#include <list>
+#include <map>
 
 #include <shared_ptr.h>
 
@@ -60,8 +62,11 @@ protected:
 public:
 	shared_ptr<ZLImageData> imageData(const ZLImage &image) const;
 
+	void setCacheLimit(size_t limit);
+	void clearCache() const;
+
 protected:
-	ZLImageManager() {}
+	ZLImageManager();
 	virtual ~ZLImageManager() {}
 
 	virtual shared_ptr<ZLImageData> createData() const = 0;
@@ -70,6 +75,20 @@ protected:
 private:
 	void convertMultiImage(const ZLMultiImage &multiImage, ZLImageData &imageData) const;
 	void convertFromPalmImageFormat(const std::string &imageString, ZLImageData &imageData) const;
+
+	shared_ptr<ZLImageData> cachedData(const std::string &key) const;
+	void cacheData(const std::string &key, shared_ptr<ZLImageData> data) const;
+	void shrinkCache() const;
+
+private:
+	typedef std::pair<std::string,shared_ptr<ZLImageData> > CacheEntry;
+	typedef std::list<CacheEntry> CacheList;
+
+	// decoded images, most recently used first
+	mutable CacheList myCache;
+	mutable std::map<std::string,CacheList::iterator> myCacheIndex;
+	mutable size_t myCacheSize;
+	size_t myCacheLimit;
 };
 
 inline void ZLImageData::setGrayPixel(unsigned char c) { setPixel(c, c, c); }
@@ -17,11 +17,84 @@
  * 02110-1301, USA.
  */
 
+#include <algorithm>
+
 #include <ZLFile.h>
 #include <ZLInputStream.h>
 
 #include "ZLStreamImage.h"
 
+static const size_t BUFFER_SIZE = 32768;
+static const unsigned char SKIP = 0xFF;
+static const unsigned char PAD = 0xFE;
+
+static const unsigned char *base64Table() {
+	static unsigned char table[256];
+	static bool initialized = false;
+	if (!initialized) {
+		for (int i = 0; i < 256; ++i) {
+			table[i] = SKIP;
+		}
+		for (int i = 0; i < 26; ++i) {
+			table['A' + i] = i;
+			table['a' + i] = 26 + i;
+		}
+		for (int i = 0; i < 10; ++i) {
+			table['0' + i] = 52 + i;
+		}
+		table[(unsigned char)'+'] = 62;
+		table[(unsigned char)'/'] = 63;
+		table[(unsigned char)'='] = PAD;
+		initialized = true;
+	}
+	return table;
+}
+
+static void readBase64(ZLInputStream &stream, size_t size, std::string &data) {
+	const unsigned char *table = base64Table();
+	data.reserve(size / 4 * 3);
+
+	char *buffer = new char[BUFFER_SIZE];
+	unsigned int quad = 0;
+	int count = 0;
+	bool finished = false;
+	while ((size > 0) && !finished) {
+		size_t length = stream.read(buffer, std::min(size, BUFFER_SIZE));
+		if (length == 0) {
+			break;
+		}
+		size -= length;
+		const unsigned char *ptr = (const unsigned char*)buffer;
+		const unsigned char *end = ptr + length;
+		for (; ptr < end; ++ptr) {
+			const unsigned char number = table[*ptr];
+			if (number == SKIP) {
+				continue;
+			}
+			if (number == PAD) {
+				finished = true;
+				break;
+			}
+			quad = (quad << 6) | number;
+			if (++count == 4) {
+				const char triple[3] = { (char)(quad >> 16), (char)(quad >> 8), (char)quad };
+				data.append(triple, 3);
+				quad = 0;
+				count = 0;
+			}
+		}
+	}
+	delete[] buffer;
+
+	// trailing 2 or 3 symbols carry 1 or 2 bytes
+	if (count == 2) {
+		data += (char)(quad >> 4);
+	} else if (count == 3) {
+		data += (char)(quad >> 10);
+		data += (char)(quad >> 2);
+	}
+}
+
 const shared_ptr<std::string> ZLStreamImage::stringData() const {
 	shared_ptr<ZLInputStream> stream = inputStream();
 
@@ -32,10 +105,14 @@ const shared_ptr<std::string> ZLStreamImage::stringData() const {
 			mySize = stream->sizeOfOpened();
 		}
 		stream->seek(myOffset, false);
-		char *buffer = new char[mySize];
-		stream->read(buffer, mySize);
-		imageData->append(buffer, mySize);
-		delete[] buffer;
+		if (myEncoding == BASE64_ENCODING) {
+			readBase64(*stream, mySize, *imageData);
+		} else {
+			char *buffer = new char[mySize];
+			stream->read(buffer, mySize);
+			imageData->append(buffer, mySize);
+			delete[] buffer;
+		}
 	}
 
 	return imageData;
@@ -28,17 +28,31 @@
 class ZLStreamImage : public ZLSingleImage {
 
 public:
-	ZLStreamImage(const std::string &mimeType, size_t offset, size_t size = 0);
+	enum Encoding {
+		NO_ENCODING = 0,
+		BASE64_ENCODING = 1,
+	};
+
+public:
+	ZLStreamImage(const std::string &mimeType, size_t offset, size_t size = 0, Encoding encoding = NO_ENCODING);
 	const shared_ptr<std::string> stringData() const;
 
+	size_t offset() const;
+	size_t size() const;
+	Encoding encoding() const;
+
 private:
 	virtual shared_ptr<ZLInputStream> inputStream() const = 0;
 
 private:
 	size_t myOffset;
 	mutable size_t mySize;
+	Encoding myEncoding;
 };
 
-inline ZLStreamImage::ZLStreamImage(const std::string &mimeType, size_t offset, size_t size) : ZLSingleImage(mimeType), myOffset(offset), mySize(size) {}
+inline ZLStreamImage::ZLStreamImage(const std::string &mimeType, size_t offset, size_t size, Encoding encoding) : ZLSingleImage(mimeType), myOffset(offset), mySize(size), myEncoding(encoding) {}
+inline size_t ZLStreamImage::offset() const { return myOffset; }
+inline size_t ZLStreamImage::size() const { return mySize; }
+inline ZLStreamImage::Encoding ZLStreamImage::encoding() const { return myEncoding; }
 
 #endif /* __ZLSTREAMIMAGE_H__ */
@@ -120,6 +120,14 @@ bool ZLXMLReader::readFromBuffer(const char *data, int len) {
 	return myInternalReader->parseBuffer(data, len);
 }
 
+size_t ZLXMLReader::eventOffset() const {
+	return myInternalReader->eventOffset();
+}
+
+size_t ZLXMLReader::eventLength() const {
+	return myInternalReader->eventLength();
+}
+
 bool ZLXMLReader::processNamespaces() const {
 	return false;
 }
@@ -59,6 +59,12 @@ protected:
 
 	bool isInterrupted() const;
 
+	// byte offset in the document stream and byte length of the markup
+	// being handled, valid inside the handlers only; offset is (size_t)-1
+	// when the parser cannot tell it
+	size_t eventOffset() const;
+	size_t eventLength() const;
+
 protected:
 	void interrupt();
 
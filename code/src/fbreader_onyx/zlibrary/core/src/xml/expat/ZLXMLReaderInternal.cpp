@@ -141,3 +141,12 @@ void ZLXMLReaderInternal::init(const char *encoding) {
 bool ZLXMLReaderInternal::parseBuffer(const char *buffer, size_t len) {
 	return XML_Parse(myParser, buffer, len, 0) != XML_STATUS_ERROR;
 }
+
+size_t ZLXMLReaderInternal::eventOffset() const {
+	const XML_Index index = XML_GetCurrentByteIndex(myParser);
+	return (index >= 0) ? (size_t)index : (size_t)-1;
+}
+
+size_t ZLXMLReaderInternal::eventLength() const {
+	return XML_GetCurrentByteCount(myParser);
+}
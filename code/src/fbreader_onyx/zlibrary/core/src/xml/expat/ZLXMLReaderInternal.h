@@ -38,6 +38,8 @@ public:
 	~ZLXMLReaderInternal();
 	void init(const char *encoding = 0);
 	bool parseBuffer(const char *buffer, size_t len);
+	size_t eventOffset() const;
+	size_t eventLength() const;
 
 private:
 	ZLXMLReader &myReader;
@@ -17,6 +17,12 @@
  * 02110-1301, USA.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <algorithm>
 #include <vector>
 
@@ -40,132 +46,291 @@ static const std::string POSTFIX = ".pattern";
 static const std::string NONE = "none";
 static const std::string UNKNOWN = "unknown";
 
+static const char TRIE_MAGIC[4] = { 'Z', 'L', 'H', 'T' };
+static const unsigned int TRIE_VERSION = 1;
+static const unsigned int ROOT_NODE = 1;
+static const unsigned int NO_NODE = 0;
+static const unsigned int NO_VALUES = (unsigned int)-1;
+static const size_t MEMO_SIZE = 1024;
+
 const std::string ZLTextTeXHyphenator::PatternZip() {
 	return ZLibrary::ZLibraryDirectory() + ZLibrary::FileNameDelimiter + "hyphenationPatterns.zip";
 }
 
-ZLTextTeXHyphenationPattern::ZLTextTeXHyphenationPattern(ZLUnicodeUtil::Ucs4Char *ucs4String, int length) {
-	myLength = length;
-	mySymbols = ucs4String;
-	myValues = NULL;
+ZLTextTeXPatternTrie::ZLTextTeXPatternTrie() {
 }
 
-ZLTextTeXHyphenationPattern::ZLTextTeXHyphenationPattern(const std::string &utf8String) {
-	myLength = 0;
-
+void ZLTextTeXPatternTrie::addPattern(const std::string &utf8String) {
 	ZLUnicodeUtil::Ucs4String ucs4String;
 	ZLUnicodeUtil::utf8ToUcs4(ucs4String, utf8String);
 
-	const int len = ucs4String.size();
-	for (int i = 0; i < len; ++i) {
-		if ((ucs4String[i] < '0') || (ucs4String[i] > '9')) {
-			++myLength;
+	// a digit is the value before the next symbol
+	ZLUnicodeUtil::Ucs4String symbols;
+	std::string values(1, '\0');
+	for (ZLUnicodeUtil::Ucs4String::const_iterator it = ucs4String.begin(); it != ucs4String.end(); ++it) {
+		if ((*it >= '0') && (*it <= '9')) {
+			values[values.size() - 1] = *it - '0';
+		} else {
+			symbols.push_back(*it);
+			values += '\0';
 		}
 	}
+	if (!symbols.empty()) {
+		myPatterns.push_back(std::make_pair(symbols, values));
+	}
+}
 
-	mySymbols = new ZLUnicodeUtil::Ucs4Char[myLength];
-	myValues = new unsigned char[myLength + 1];
+// writes the node of the patterns in [begin, end) sharing their first depth
+// symbols, returns the index of the node
+static unsigned int emitNode(const std::vector<std::pair<ZLUnicodeUtil::Ucs4String,std::string> > &patterns, size_t begin, size_t end, size_t depth, std::vector<unsigned int> &data, std::string &values) {
+	const unsigned int node = data.size();
 
-	myValues[0] = 0;
-	for (int j = 0, k = 0; j < len; ++j) {
-		if ((ucs4String[j] >= '0') && (ucs4String[j] <= '9')) {
-			myValues[k] = ucs4String[j] - '0';
-		} else {
-			mySymbols[k] = ucs4String[j];
-			++k;
-			myValues[k] = 0;
+	// the pattern ending at this node is the first of the sorted range
+	unsigned int valueOffset = NO_VALUES;
+	if ((begin < end) && (patterns[begin].first.size() == depth)) {
+		valueOffset = values.size();
+		values += patterns[begin].second;
+		while ((begin < end) && (patterns[begin].first.size() == depth)) {
+			++begin;
+		}
+	}
+
+	unsigned int childNumber = 0;
+	for (size_t i = begin; i < end; ++i) {
+		if ((i == begin) || (patterns[i].first[depth] != patterns[i - 1].first[depth])) {
+			++childNumber;
+		}
+	}
+
+	data.push_back(valueOffset);
+	data.push_back(childNumber);
+	const size_t pairs = data.size();
+	data.resize(pairs + 2 * childNumber);
+
+	size_t index = pairs;
+	for (size_t i = begin; i < end; index += 2) {
+		const ZLUnicodeUtil::Ucs4Char symbol = patterns[i].first[depth];
+		size_t j = i + 1;
+		while ((j < end) && (patterns[j].first[depth] == symbol)) {
+			++j;
 		}
+		const unsigned int child = emitNode(patterns, i, j, depth + 1, data, values);
+		data[index] = symbol;
+		data[index + 1] = child;
+		i = j;
 	}
+	return node;
 }
 
-ZLTextTeXHyphenationPattern::~ZLTextTeXHyphenationPattern() {
-	if (myValues != NULL) {
-		delete[] mySymbols;
-		delete[] myValues;
+void ZLTextTeXPatternTrie::compile() {
+	myData.clear();
+	if (myPatterns.empty()) {
+		return;
+	}
+	std::sort(myPatterns.begin(), myPatterns.end());
+
+	// the first word is the size of the node area, the values follow it
+	std::string values;
+	myData.push_back(0);
+	emitNode(myPatterns, 0, myPatterns.size(), 0, myData, values);
+	myData[0] = myData.size();
+	myData.resize(myData.size() + (values.size() + sizeof(unsigned int) - 1) / sizeof(unsigned int));
+	if (!values.empty()) {
+		memcpy(&myData[myData[0]], values.data(), values.size());
 	}
+
+	std::vector<std::pair<ZLUnicodeUtil::Ucs4String,std::string> >().swap(myPatterns);
+}
+
+void ZLTextTeXPatternTrie::clear() {
+	std::vector<unsigned int>().swap(myData);
+	std::vector<std::pair<ZLUnicodeUtil::Ucs4String,std::string> >().swap(myPatterns);
 }
 
-void ZLTextTeXHyphenationPattern::apply(unsigned char *values) const {
-	for (int i = 0; i <= myLength; ++i) {
-		if (values[i] < myValues[i]) {
-			values[i] = myValues[i];
+bool ZLTextTeXPatternTrie::empty() const {
+	return myData.empty();
+}
+
+unsigned int ZLTextTeXPatternTrie::child(unsigned int node, ZLUnicodeUtil::Ucs4Char symbol) const {
+	const unsigned int *pairs = &myData[node + 2];
+	int low = 0;
+	int high = (int)myData[node + 1] - 1;
+	while (low <= high) {
+		const int middle = (low + high) / 2;
+		const unsigned int current = pairs[2 * middle];
+		if (current == symbol) {
+			return pairs[2 * middle + 1];
+		} else if (current < symbol) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
 		}
 	}
+	return NO_NODE;
 }
 
-bool ZLTextTeXPatternComparator::operator() (const ZLTextTeXHyphenationPattern *p1, const ZLTextTeXHyphenationPattern *p2) const {
-	bool firstIsShorter = p1->myLength < p2->myLength;
-	int minLength = firstIsShorter ? p1->myLength : p2->myLength;
-	const ZLUnicodeUtil::Ucs4Char *symbols1 = p1->mySymbols;
-	const ZLUnicodeUtil::Ucs4Char *symbols2 = p2->mySymbols;
-	for (int i = 0; i < minLength; ++i) {
-		if (symbols1[i] < symbols2[i]) {
-			return true;
-		} else if (symbols1[i] > symbols2[i]) {
-			return false;
+void ZLTextTeXPatternTrie::apply(const ZLUnicodeUtil::Ucs4Char *symbols, int length, unsigned char *values) const {
+	const unsigned char *patternValues = (const unsigned char*)&myData[myData[0]];
+	unsigned int node = ROOT_NODE;
+	for (int k = 0; k < length; ++k) {
+		node = child(node, symbols[k]);
+		if (node == NO_NODE) {
+			return;
+		}
+		const unsigned int offset = myData[node];
+		if (offset != NO_VALUES) {
+			const unsigned char *patternValue = patternValues + offset;
+			for (int i = 0; i <= k + 1; ++i) {
+				if (values[i] < patternValue[i]) {
+					values[i] = patternValue[i];
+				}
+			}
 		}
 	}
-	return firstIsShorter;
 }
 
-static std::vector<unsigned char> values;
-static ZLTextTeXPatternComparator comparator = ZLTextTeXPatternComparator();
+bool ZLTextTeXPatternTrie::read(const std::string &fileName, const std::string &key) {
+	FILE *file = fopen(fileName.c_str(), "rb");
+	if (file == 0) {
+		return false;
+	}
+
+	char magic[4];
+	unsigned int header[3];
+	std::string storedKey;
+	bool ok =
+		(fread(magic, 1, 4, file) == 4) && (memcmp(magic, TRIE_MAGIC, 4) == 0) &&
+		(fread(header, sizeof(unsigned int), 3, file) == 3) &&
+		(header[0] == TRIE_VERSION) && (header[1] == key.size());
+	if (ok) {
+		storedKey.resize(header[1]);
+		ok = (fread(&storedKey[0], 1, header[1], file) == header[1]) && (storedKey == key);
+	}
+	if (ok) {
+		myData.resize(header[2]);
+		ok = (header[2] > 0) && (fread(&myData[0], sizeof(unsigned int), header[2], file) == header[2]) &&
+			(myData[0] <= header[2]);
+	}
+	fclose(file);
+
+	if (!ok) {
+		myData.clear();
+	}
+	return ok;
+}
+
+void ZLTextTeXPatternTrie::write(const std::string &fileName, const std::string &key) const {
+	const std::string temporaryName = fileName + ".tmp";
+	FILE *file = fopen(temporaryName.c_str(), "wb");
+	if (file == 0) {
+		return;
+	}
+	const unsigned int header[3] = { TRIE_VERSION, (unsigned int)key.size(), (unsigned int)myData.size() };
+	bool ok =
+		(fwrite(TRIE_MAGIC, 1, 4, file) == 4) &&
+		(fwrite(header, sizeof(unsigned int), 3, file) == 3) &&
+		(fwrite(key.data(), 1, key.size(), file) == key.size()) &&
+		(fwrite(&myData[0], sizeof(unsigned int), myData.size(), file) == myData.size());
+	ok = (fclose(file) == 0) && ok;
+	if (!ok || (rename(temporaryName.c_str(), fileName.c_str()) != 0)) {
+		remove(temporaryName.c_str());
+	}
+}
 
 void ZLTextTeXHyphenator::hyphenate(ZLUnicodeUtil::Ucs4String &ucs4String, std::vector<unsigned char> &mask, int length) const {
-	if (myPatternTable.empty()) {
+	if (myTrie.empty()) {
 		for (int i = 0; i < length - 1; ++i) {
 			mask[i] = false;
 		}
 		return;
 	}
-	
+
+	// FNV-1a hash of the word
+	unsigned int hash = 2166136261U;
+	for (int i = 0; i < length; ++i) {
+		hash = (hash ^ ucs4String[i]) * 16777619U;
+	}
+	MemoEntry &entry = myMemo[hash % MEMO_SIZE];
+	if ((entry.Word.size() == (size_t)length) && std::equal(entry.Word.begin(), entry.Word.end(), ucs4String.begin())) {
+		std::copy(entry.Mask.begin(), entry.Mask.end(), mask.begin());
+		return;
+	}
+
+	static std::vector<unsigned char> values;
 	values.assign(length + 1, 0);
-	
 	for (int j = 0; j < length - 2; ++j) {
-		ZLTextTeXHyphenator::PatternIterator dictionaryPattern = myPatternTable.begin();
-		for (int k = 1; k <= length - j; ++k) {
-			ZLTextTeXHyphenationPattern pattern(&ucs4String[j], k);
-			if (comparator(&pattern, *dictionaryPattern)) {
-				continue;
-			}
-			dictionaryPattern =
-				std::lower_bound(myPatternTable.begin(), myPatternTable.end(), &pattern, comparator);
-			if (dictionaryPattern == myPatternTable.end()) {
-				break;
-			}
-			if (!comparator(&pattern, *dictionaryPattern)) {
-				(*dictionaryPattern)->apply(&values[j]);
-			}
-		}
+		myTrie.apply(&ucs4String[j], length - j, &values[j]);
 	}
 
 	for (int i = 0; i < length - 1; ++i) {
 		mask[i] = values[i + 1] % 2 == 1;
 	}
+
+	entry.Word.assign(ucs4String.begin(), ucs4String.begin() + length);
+	entry.Mask.assign(mask.begin(), mask.begin() + length - 1);
+}
+
+ZLTextTeXHyphenator::ZLTextTeXHyphenator() : myMemo(MEMO_SIZE) {
 }
 
 ZLTextTeXHyphenator::~ZLTextTeXHyphenator() {
 	unload();
 }
 
+std::string ZLTextTeXHyphenator::cacheFileName() const {
+	const char *home = getenv("HOME");
+	if (home == 0) {
+		return std::string();
+	}
+	return std::string(home) + ZLibrary::FileNameDelimiter + ZLibrary::ApplicationName() + ZLibrary::FileNameDelimiter + "hyphenation" + ZLibrary::FileNameDelimiter + myLanguage + ".trie";
+}
+
+std::string ZLTextTeXHyphenator::cacheKey() const {
+	const ZLFile patternFile(PatternZip() + ":" + myLanguage + POSTFIX);
+	if (!patternFile.exists()) {
+		return std::string();
+	}
+	std::string key = PatternZip();
+	key += '\n';
+	ZLStringUtil::appendNumber(key, ZLFile(PatternZip()).size());
+	key += '\n';
+	key += myLanguage;
+	key += '\n';
+	ZLStringUtil::appendNumber(key, patternFile.size());
+	return key;
+}
+
 void ZLTextTeXHyphenator::load(const std::string &language) {
 	if (language == myLanguage) {
 		return;
 	}
 	myLanguage = language;
-	
+
 	unload();
 
+	const std::string fileName = cacheFileName();
+	const std::string key = cacheKey();
+	if (key.empty()) {
+		return;
+	}
+	if (!fileName.empty() && myTrie.read(fileName, key)) {
+		return;
+	}
+
 	ZLTextHyphenationReader(this).readDocument(PatternZip() + ":" + language + POSTFIX);
-	
-	std::sort(myPatternTable.begin(), myPatternTable.end(), ZLTextTeXPatternComparator());
+	myTrie.compile();
+
+	if (!fileName.empty() && !myTrie.empty()) {
+		const std::string directory = fileName.substr(0, fileName.rfind(ZLibrary::FileNameDelimiter));
+		mkdir(directory.substr(0, directory.rfind(ZLibrary::FileNameDelimiter)).c_str(), 0755);
+		mkdir(directory.c_str(), 0755);
+		myTrie.write(fileName, key);
+	}
 }
 
 void ZLTextTeXHyphenator::unload() {
-	for (PatternIterator it = myPatternTable.begin(); it != myPatternTable.end(); ++it) {
-		delete *it;
-	}
-	myPatternTable.clear();
+	myTrie.clear();
+	myMemo.assign(MEMO_SIZE, MemoEntry());
 }
 
 const std::string &ZLTextTeXHyphenator::language() const {
@@ -25,28 +25,31 @@
 
 #include "ZLTextHyphenator.h"
 
-class ZLTextTeXHyphenationPattern {
+// Patterns of a language compiled into a trie stored in one array:
+// a node is its value offset, the number of children and the sorted
+// (symbol, child node) pairs; the value bytes of the patterns follow
+// the nodes.
+class ZLTextTeXPatternTrie {
 
 public:
-	ZLTextTeXHyphenationPattern(ZLUnicodeUtil::Ucs4Char *ucs4String, int length);
-	ZLTextTeXHyphenationPattern(const std::string &utf8String);
-	~ZLTextTeXHyphenationPattern();
+	ZLTextTeXPatternTrie();
 
-	int length() const { return myLength; }
-	void apply(unsigned char *values) const;
+	void addPattern(const std::string &utf8String);
+	void compile();
+	void clear();
+	bool empty() const;
 
-private:
-	int myLength;
-	ZLUnicodeUtil::Ucs4Char *mySymbols;
-	unsigned char *myValues;
+	void apply(const ZLUnicodeUtil::Ucs4Char *symbols, int length, unsigned char *values) const;
 
-friend class ZLTextTeXPatternComparator;
-};
+	bool read(const std::string &fileName, const std::string &key);
+	void write(const std::string &fileName, const std::string &key) const;
 
-class ZLTextTeXPatternComparator {
+private:
+	unsigned int child(unsigned int node, ZLUnicodeUtil::Ucs4Char symbol) const;
 
-public:
-	bool operator() (const ZLTextTeXHyphenationPattern *p1, const ZLTextTeXHyphenationPattern *p2) const;
+private:
+	std::vector<unsigned int> myData;
+	std::vector<std::pair<ZLUnicodeUtil::Ucs4String,std::string> > myPatterns;
 };
 
 class ZLTextTeXHyphenator : public ZLTextHyphenator {
@@ -55,6 +58,7 @@ private:
 	static const std::string PatternZip();
 
 public:
+	ZLTextTeXHyphenator();
 	~ZLTextTeXHyphenator();
 
 	void load(const std::string &language);
@@ -65,10 +69,19 @@ protected:
 	void hyphenate(ZLUnicodeUtil::Ucs4String &ucs4String, std::vector<unsigned char> &mask, int length) const;
 
 private:
-	typedef std::vector<ZLTextTeXHyphenationPattern*>::const_iterator PatternIterator;
+	std::string cacheFileName() const;
+	std::string cacheKey() const;
+
+private:
+	// masks of the recently hyphenated words, indexed by a hash of the word
+	struct MemoEntry {
+		ZLUnicodeUtil::Ucs4String Word;
+		std::vector<unsigned char> Mask;
+	};
 
-	std::vector<ZLTextTeXHyphenationPattern*> myPatternTable;
+	ZLTextTeXPatternTrie myTrie;
 	std::string myLanguage;
+	mutable std::vector<MemoEntry> myMemo;
 
 friend class ZLTextHyphenationReader;
 };
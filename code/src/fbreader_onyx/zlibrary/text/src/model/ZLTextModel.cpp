@@ -26,7 +26,7 @@
 #include "ZLTextModel.h"
 #include "ZLTextParagraph.h"
 
-ZLTextModel::ZLTextModel(const size_t rowSize) : myAllocator(rowSize), myLastEntryStart(0) {
+ZLTextModel::ZLTextModel(const size_t rowSize) : myAllocator(rowSize), myLastEntryStart(0), myAdoptedEntries(0), myAdoptedLength(0) {
 }
 
 ZLTextModel::~ZLTextModel() {
@@ -272,6 +272,128 @@ void ZLTextModel::addImage(const std::string &id, const ZLImageMap &imageMap, sh
 	myParagraphs.back()->addEntry(myLastEntryStart);
 }
 
+void ZLTextModel::saveEntries(std::string &data, std::vector<size_t> &paragraphOffsets, std::vector<size_t> &imageEntries) const {
+	for (std::vector<ZLTextParagraph*>::const_iterator it = myParagraphs.begin(); it != myParagraphs.end(); ++it) {
+		paragraphOffsets.push_back(data.size());
+		const char *pointer = (*it)->myFirstEntryAddress;
+		const size_t entryNumber = (*it)->entryNumber();
+		for (size_t i = 0; i < entryNumber; ++i) {
+			if (*pointer == ZLTextParagraphEntry::IMAGE_ENTRY) {
+				imageEntries.push_back(data.size());
+			}
+			const size_t size = ZLTextParagraph::entrySize(pointer);
+			data.append(pointer, size);
+			pointer += size;
+			if ((i + 1 < entryNumber) && (*pointer == 0)) {
+				memcpy(&pointer, pointer + 1, sizeof(char*));
+			}
+		}
+	}
+}
+
+void ZLTextModel::adoptEntries(char *data, size_t length, shared_ptr<ZLUserData> storage) {
+	myAdoptedEntries = data;
+	myAdoptedLength = length;
+	myAdoptedStorage = storage;
+}
+
+// skips a zero terminated string, 0 if it does not end before end
+static const char *skipString(const char *pointer, const char *end) {
+	if (pointer >= end) {
+		return 0;
+	}
+	const char *zero = (const char*)memchr(pointer, '\0', end - pointer);
+	return (zero != 0) ? zero + 1 : 0;
+}
+
+// the same as ZLTextParagraph::entrySize, 0 if the entry is broken
+// or does not end before end
+static size_t adoptedEntrySize(const char *address, const char *end) {
+	const size_t available = end - address;
+	const char *pointer = address;
+	switch (*pointer) {
+		case ZLTextParagraphEntry::TEXT_ENTRY:
+		{
+			if (available < sizeof(size_t) + 1) {
+				return 0;
+			}
+			size_t len;
+			memcpy(&len, pointer + 1, sizeof(size_t));
+			if (len > available - sizeof(size_t) - 1) {
+				return 0;
+			}
+			pointer += len + sizeof(size_t) + 1;
+			break;
+		}
+		case ZLTextParagraphEntry::CONTROL_ENTRY:
+		case ZLTextParagraphEntry::FIXED_HSPACE_ENTRY:
+			pointer += 2;
+			break;
+		case ZLTextParagraphEntry::HYPERLINK_CONTROL_ENTRY:
+			pointer = skipString(pointer + 2, end);
+			pointer = (pointer != 0) ? skipString(pointer, end) : 0;
+			break;
+		case ZLTextParagraphEntry::IMAGE_ENTRY:
+			pointer = skipString(pointer + sizeof(const ZLImageMap*) + sizeof(short) + 1, end);
+			break;
+		case ZLTextParagraphEntry::STYLE_ENTRY:
+		{
+			const size_t size = sizeof(int) + ZLTextStyleEntry::NUMBER_OF_LENGTHS * (sizeof(short) + 1) + 4;
+			if (available < size) {
+				return 0;
+			}
+			int mask;
+			memcpy(&mask, pointer + 1, sizeof(int));
+			pointer += size;
+			if (mask & ZLTextStyleEntry::SUPPORT_FONT_FAMILY) {
+				pointer = skipString(pointer, end);
+			}
+			break;
+		}
+		case ZLTextParagraphEntry::RESET_BIDI_ENTRY:
+			++pointer;
+			break;
+		default:
+			return 0;
+	}
+	if ((pointer == 0) || (pointer > end)) {
+		return 0;
+	}
+	return pointer - address;
+}
+
+bool ZLTextModel::addParagraphEntries(size_t offset, size_t entryNumber) {
+	if (offset > myAdoptedLength) {
+		return false;
+	}
+	const char *end = myAdoptedEntries + myAdoptedLength;
+	const char *pointer = myAdoptedEntries + offset;
+	for (size_t i = 0; i < entryNumber; ++i) {
+		const size_t size = (pointer < end) ? adoptedEntrySize(pointer, end) : 0;
+		if (size == 0) {
+			return false;
+		}
+		pointer += size;
+	}
+
+	ZLTextParagraph *paragraph = myParagraphs.back();
+	paragraph->myFirstEntryAddress = myAdoptedEntries + offset;
+	paragraph->myEntryNumber = entryNumber;
+	myLastEntryStart = 0;
+	return true;
+}
+
+bool ZLTextModel::bindImageEntry(size_t offset, const ZLImageMap &imageMap) {
+	if ((offset >= myAdoptedLength) ||
+			(myAdoptedLength - offset < 1 + sizeof(const ZLImageMap*)) ||
+			(myAdoptedEntries[offset] != ZLTextParagraphEntry::IMAGE_ENTRY)) {
+		return false;
+	}
+	const ZLImageMap *imageMapAddress = &imageMap;
+	memcpy(myAdoptedEntries + offset + 1, &imageMapAddress, sizeof(const ZLImageMap*));
+	return true;
+}
+
 void ZLTextModel::addBidiReset() {
 	myLastEntryStart = myAllocator.allocate(1);
 	*myLastEntryStart = ZLTextParagraphEntry::RESET_BIDI_ENTRY;
@@ -28,6 +28,7 @@
 #include <ZLTextKind.h>
 #include <ZLTextMark.h>
 #include <ZLTextRowMemoryAllocator.h>
+#include <ZLUserData.h>
 
 using namespace std;
 
@@ -72,6 +73,15 @@ public:
 	void addFixedHSpace(unsigned char length);
 	void addBidiReset();
 
+	// The entries of all the paragraphs can be saved into one block and
+	// the block adopted back later instead of re-reading the book.
+	// Adopted entries are checked against the block length, false means
+	// a broken block.
+	void saveEntries(std::string &data, std::vector<size_t> &paragraphOffsets, std::vector<size_t> &imageEntries) const;
+	void adoptEntries(char *data, size_t length, shared_ptr<ZLUserData> storage);
+	bool addParagraphEntries(size_t offset, size_t entryNumber);
+	bool bindImageEntry(size_t offset, const ZLImageMap &imageMap);
+
 protected:
 	void addParagraphInternal(ZLTextParagraph *paragraph);
 	void removeParagraphInternal(int index);
@@ -83,6 +93,11 @@ private:
 
 	char *myLastEntryStart;
 
+	// adopted entries and the owner of their memory
+	char *myAdoptedEntries;
+	size_t myAdoptedLength;
+	shared_ptr<ZLUserData> myAdoptedStorage;
+
 private:
 	ZLTextModel(const ZLTextModel&);
 	const ZLTextModel &operator = (const ZLTextModel&);
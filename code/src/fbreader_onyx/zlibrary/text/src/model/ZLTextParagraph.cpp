@@ -113,60 +113,66 @@ const shared_ptr<ZLTextParagraphEntry> ZLTextParagraph::Iterator::entry() const
 	return myEntry;
 }
 
-void ZLTextParagraph::Iterator::next() {
-	++myIndex;
-	myEntry.reset();
-	if (myIndex != myEndIndex) {
-		switch (*myPointer) {
-			case ZLTextParagraphEntry::TEXT_ENTRY:
-			{
-				size_t len;
-				memcpy(&len, myPointer + 1, sizeof(size_t));
-				myPointer += len + sizeof(size_t) + 1;
-				break;
+size_t ZLTextParagraph::entrySize(const char *address) {
+	const char *pointer = address;
+	switch (*pointer) {
+		case ZLTextParagraphEntry::TEXT_ENTRY:
+		{
+			size_t len;
+			memcpy(&len, pointer + 1, sizeof(size_t));
+			pointer += len + sizeof(size_t) + 1;
+			break;
+		}
+		case ZLTextParagraphEntry::CONTROL_ENTRY:
+			pointer += 2;
+			break;
+		case ZLTextParagraphEntry::HYPERLINK_CONTROL_ENTRY:
+			pointer += 2;
+			while (*pointer != '\0') {
+				++pointer;
 			}
-			case ZLTextParagraphEntry::CONTROL_ENTRY:
-				myPointer += 2;
-				break;
-			case ZLTextParagraphEntry::HYPERLINK_CONTROL_ENTRY:
-				myPointer += 2;
-				while (*myPointer != '\0') {
-					++myPointer;
-				}
-				++myPointer;
-				while (*myPointer != '\0') {
-					++myPointer;
-				}
-				++myPointer;
-				break;
-			case ZLTextParagraphEntry::IMAGE_ENTRY:
-				myPointer += sizeof(const ZLImageMap*) + sizeof(short) + 1;
-				while (*myPointer != '\0') {
-					++myPointer;
-				}
-				++myPointer;
-				break;
-			case ZLTextParagraphEntry::STYLE_ENTRY:
-			{
-				int mask;
-				memcpy(&mask, myPointer + 1, sizeof(int));
-				bool withFontFamily = mask & ZLTextStyleEntry::SUPPORT_FONT_FAMILY;
-				myPointer += sizeof(int) + ZLTextStyleEntry::NUMBER_OF_LENGTHS * (sizeof(short) + 1) + 4;
-				if (withFontFamily) {
-					while (*myPointer != '\0') {
-						++myPointer;
-					}
-					++myPointer;
+			++pointer;
+			while (*pointer != '\0') {
+				++pointer;
+			}
+			++pointer;
+			break;
+		case ZLTextParagraphEntry::IMAGE_ENTRY:
+			pointer += sizeof(const ZLImageMap*) + sizeof(short) + 1;
+			while (*pointer != '\0') {
+				++pointer;
+			}
+			++pointer;
+			break;
+		case ZLTextParagraphEntry::STYLE_ENTRY:
+		{
+			int mask;
+			memcpy(&mask, pointer + 1, sizeof(int));
+			bool withFontFamily = mask & ZLTextStyleEntry::SUPPORT_FONT_FAMILY;
+			pointer += sizeof(int) + ZLTextStyleEntry::NUMBER_OF_LENGTHS * (sizeof(short) + 1) + 4;
+			if (withFontFamily) {
+				while (*pointer != '\0') {
+					++pointer;
 				}
-				break;
+				++pointer;
 			}
-			case ZLTextParagraphEntry::FIXED_HSPACE_ENTRY:
-				myPointer += 2;
-				break;
-			case ZLTextParagraphEntry::RESET_BIDI_ENTRY:
-				++myPointer;
-				break;
+			break;
 		}
+		case ZLTextParagraphEntry::FIXED_HSPACE_ENTRY:
+			pointer += 2;
+			break;
+		case ZLTextParagraphEntry::RESET_BIDI_ENTRY:
+			++pointer;
+			break;
+	}
+	return pointer - address;
+}
+
+void ZLTextParagraph::Iterator::next() {
+	++myIndex;
+	myEntry.reset();
+	if (myIndex != myEndIndex) {
+		myPointer += entrySize(myPointer);
 		if (*myPointer == 0) {
 			memcpy(&myPointer, myPointer + 1, sizeof(char*));
 		}
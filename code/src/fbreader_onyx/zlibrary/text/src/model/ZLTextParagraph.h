@@ -280,6 +280,7 @@ public:
 
 private:
 	void addEntry(char *address);
+	static size_t entrySize(const char *address);
 
 private:
 	char *myFirstEntryAddress;
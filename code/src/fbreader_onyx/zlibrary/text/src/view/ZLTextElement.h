@@ -130,7 +130,7 @@ private:
 private:
 	const shared_ptr<ZLTextParagraphEntry> myEntry;
 
-friend class ZLTextElementPool;
+friend class ZLTextElementVector;
 };
 
 inline ZLTextElement::ZLTextElement() {}
@@ -216,7 +216,9 @@ void ZLTextView::preparePaintInfo() {
 			if (!myStartCursor.paragraphCursor().isFirst() || !myStartCursor.isStartOfParagraph()) {
 				switch (myScrollingMode) {
 					case NO_OVERLAPPING:
-						myStartCursor = findStart(myStartCursor, PIXEL_UNIT, textAreaHeight());
+						if (!previousPageStart(myStartCursor)) {
+							myStartCursor = findStart(myStartCursor, PIXEL_UNIT, textAreaHeight());
+						}
 						break;
 					case KEEP_LINES:
 					{
@@ -269,6 +271,7 @@ void ZLTextView::preparePaintInfo() {
 	}
 	myPaintState = READY;
 	myLineInfoCache.clear();
+	updatePageMap();
 }
 
 ZLTextWordCursor ZLTextView::findStart(const ZLTextWordCursor &end, SizeUnit unit, int size) {
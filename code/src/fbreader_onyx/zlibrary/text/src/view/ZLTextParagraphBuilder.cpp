@@ -56,14 +56,13 @@ void ZLTextParagraphBuilder::updateBidiLevel(FriBidiLevel bidiLevel) {
 }
 
 void ZLTextParagraphBuilder::addWord(const char *ptr, int offset, int len) {
-	ZLTextWord *word = ZLTextElementPool::Pool.getWord(ptr, len, offset, myCurrentBidiLevel);
+	ZLTextWord *word = myElements.addWord(ptr, len, offset, myCurrentBidiLevel);
 	for (std::vector<ZLTextMark>::const_iterator mit = myFirstMark; mit != myLastMark; ++mit) {
 		ZLTextMark mark = *mit;
 		if ((mark.Offset < offset + len) && (mark.Offset + mark.Length > offset)) {
 			word->addMark(mark.Offset - offset, mark.Length);
 		}
 	}
-	myElements.push_back(word);
 }
 
 void ZLTextParagraphBuilder::fill() {
@@ -74,14 +73,14 @@ void ZLTextParagraphBuilder::fill() {
 	for (ZLTextParagraph::Iterator it = myParagraph; !it.isEnd(); it.next()) {
 		switch (it.entryKind()) {
 			case ZLTextParagraphEntry::STYLE_ENTRY:
-				myElements.push_back(new ZLTextStyleElement(it.entry()));
+				myElements.addStyleElement(it.entry());
 				break;
 			case ZLTextParagraphEntry::FIXED_HSPACE_ENTRY:
-				myElements.push_back(new ZLTextFixedHSpaceElement(((ZLTextFixedHSpaceEntry&)*it.entry()).length()));
+				myElements.addFixedHSpaceElement(((ZLTextFixedHSpaceEntry&)*it.entry()).length());
 				break;
 			case ZLTextParagraphEntry::CONTROL_ENTRY:
 			case ZLTextParagraphEntry::HYPERLINK_CONTROL_ENTRY:
-				myElements.push_back(ZLTextElementPool::Pool.getControlElement(it.entry()));
+				myElements.addControlElement(it.entry());
 				break;
 			case ZLTextParagraphEntry::IMAGE_ENTRY:
 			{
@@ -90,7 +89,7 @@ void ZLTextParagraphBuilder::fill() {
 				if (image) {
 					shared_ptr<ZLImageData> data = ZLImageManager::instance().imageData(*image);
 					if (data) {
-						myElements.push_back(new ZLTextImageElement(imageEntry.id(), data));
+						myElements.addImageElement(imageEntry.id(), data);
 					}
 				}
 				break;
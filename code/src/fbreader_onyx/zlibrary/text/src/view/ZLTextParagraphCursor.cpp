@@ -27,22 +27,91 @@
 
 ZLTextElementPool ZLTextElementPool::Pool;
 
-std::map<const ZLTextParagraph*, weak_ptr<ZLTextParagraphCursor> > ZLTextParagraphCursorCache::ourCache;
-ZLTextParagraphCursorPtr ZLTextParagraphCursorCache::ourLastAdded;
+// defined before the cursor cache: cached cursors give their chunks back
+// on destruction
+std::vector<char*> ZLTextElementVector::ourFreeChunks[CHUNK_LEVELS];
+std::vector<std::vector<ZLTextElement*> > ZLTextElementVector::ourFreeArrays;
+
+ZLTextParagraphCursorCache::CursorMap ZLTextParagraphCursorCache::ourCache;
+ZLTextParagraphCursorCache::RecentList ZLTextParagraphCursorCache::ourRecent;
+
+static const size_t MAX_RECENT_CURSORS = 16;
+static const size_t MAX_FREE_CHUNKS = 64;
+static const size_t MAX_FREE_ARRAYS = 32;
+static const size_t MAX_FREE_ARRAY_CAPACITY = 16384;
+
+ZLTextElementVector::ZLTextElementVector() : myFirstChunk(0), myChunk(0), myChunkIndex(0), myChunkOffset(0) {
+	if (!ourFreeArrays.empty()) {
+		swap(ourFreeArrays.back());
+		ourFreeArrays.pop_back();
+	}
+}
 
 ZLTextElementVector::~ZLTextElementVector() {
+	destroyElements();
+	if ((ourFreeArrays.size() < MAX_FREE_ARRAYS) && (capacity() <= MAX_FREE_ARRAY_CAPACITY)) {
+		std::vector<ZLTextElement*>::clear();
+		ourFreeArrays.push_back(std::vector<ZLTextElement*>());
+		ourFreeArrays.back().swap(*this);
+	}
+	size_t index = 0;
+	for (char *chunk = myFirstChunk; chunk != 0; ++index) {
+		char *next = *(char**)chunk;
+		std::vector<char*> &freeChunks = ourFreeChunks[chunkLevel(index)];
+		if (freeChunks.size() < MAX_FREE_CHUNKS) {
+			freeChunks.push_back(chunk);
+		} else {
+			delete[] chunk;
+		}
+		chunk = next;
+	}
+}
+
+void ZLTextElementVector::nextChunk() {
+	char *next;
+	if (myChunk == 0) {
+		next = myFirstChunk;
+		myChunkIndex = 0;
+	} else {
+		next = *(char**)myChunk;
+		++myChunkIndex;
+	}
+	if (next == 0) {
+		std::vector<char*> &freeChunks = ourFreeChunks[chunkLevel(myChunkIndex)];
+		if (freeChunks.empty()) {
+			next = new char[chunkSize(myChunkIndex)];
+		} else {
+			next = freeChunks.back();
+			freeChunks.pop_back();
+		}
+		*(char**)next = 0;
+		if (myChunk == 0) {
+			myFirstChunk = next;
+		} else {
+			*(char**)myChunk = next;
+		}
+	}
+	myChunk = next;
+	myChunkOffset = sizeof(char*);
+}
+
+void ZLTextElementVector::clear() {
+	destroyElements();
+	std::vector<ZLTextElement*>::clear();
+	myChunk = 0;
+	myChunkIndex = 0;
+	myChunkOffset = 0;
+}
+
+void ZLTextElementVector::destroyElements() {
 	for (ZLTextElementVector::const_iterator it = begin(); it != end(); ++it) {
 		switch ((*it)->kind()) {
 			case ZLTextElement::WORD_ELEMENT:
-				ZLTextElementPool::Pool.storeWord((ZLTextWord*)*it);
-				break;
 			case ZLTextElement::CONTROL_ELEMENT:
-				ZLTextElementPool::Pool.storeControlElement((ZLTextControlElement*)*it);
-				break;
 			case ZLTextElement::IMAGE_ELEMENT:
 			case ZLTextElement::FORCED_CONTROL_ELEMENT:
 			case ZLTextElement::FIXED_HSPACE_ELEMENT:
-				delete *it;
+				(*it)->~ZLTextElement();
 				break;
 			case ZLTextElement::INDENT_ELEMENT:
 			case ZLTextElement::HSPACE_ELEMENT:
@@ -206,7 +275,7 @@ ZLTextMark ZLTextWordCursor::position() const {
 
 void ZLTextParagraphCursor::processControlParagraph(const ZLTextParagraph &paragraph) {
 	for (ZLTextParagraph::Iterator it = paragraph; !it.isEnd(); it.next()) {
-		myElements.push_back(ZLTextElementPool::Pool.getControlElement(it.entry()));
+		myElements.addControlElement(it.entry());
 	}
 }
 
@@ -243,27 +312,73 @@ void ZLTextParagraphCursor::clear() {
 }
 
 void ZLTextParagraphCursorCache::put(const ZLTextParagraph *paragraph, ZLTextParagraphCursorPtr cursor) {
-	ourCache[paragraph] = cursor;
-	ourLastAdded = cursor;
+	if (ourCache.size() > 8 * MAX_RECENT_CURSORS) {
+		cleanup();
+	}
+	CursorMap::iterator it = ourCache.find(paragraph);
+	if (it == ourCache.end()) {
+		it = ourCache.insert(std::make_pair(paragraph, Entry())).first;
+		it->second.IsRecent = false;
+	}
+	it->second.Cursor = cursor;
+	touch(paragraph, cursor);
 }
 
 ZLTextParagraphCursorPtr ZLTextParagraphCursorCache::get(const ZLTextParagraph *paragraph) {
-  return ourCache[paragraph].lock();
+	CursorMap::iterator it = ourCache.find(paragraph);
+	if (it == ourCache.end()) {
+		return ZLTextParagraphCursorPtr();
+	}
+	ZLTextParagraphCursorPtr cursor = it->second.Cursor.lock();
+	if (cursor) {
+		touch(paragraph, cursor);
+	}
+	return cursor;
+}
+
+void ZLTextParagraphCursorCache::touch(const ZLTextParagraph *paragraph, ZLTextParagraphCursorPtr cursor) {
+	Entry &entry = ourCache[paragraph];
+	if (entry.IsRecent) {
+		entry.Recent->second = cursor;
+		ourRecent.splice(ourRecent.begin(), ourRecent, entry.Recent);
+		return;
+	}
+	ourRecent.push_front(std::make_pair(paragraph, cursor));
+	entry.Recent = ourRecent.begin();
+	entry.IsRecent = true;
+	while (ourRecent.size() > MAX_RECENT_CURSORS) {
+		CursorMap::iterator it = ourCache.find(ourRecent.back().first);
+		if (it != ourCache.end()) {
+			it->second.IsRecent = false;
+		}
+		ourRecent.pop_back();
+	}
+}
+
+void ZLTextParagraphCursorCache::remove(const ZLTextParagraph *paragraph) {
+	CursorMap::iterator it = ourCache.find(paragraph);
+	if (it == ourCache.end()) {
+		return;
+	}
+	if (it->second.IsRecent) {
+		ourRecent.erase(it->second.Recent);
+	}
+	ourCache.erase(it);
 }
 
 void ZLTextParagraphCursorCache::clear() {
-	ourLastAdded.reset();
+	ourRecent.clear();
 	ourCache.clear();
 }
 
 void ZLTextParagraphCursorCache::cleanup() {
-	std::map<const ZLTextParagraph*, weak_ptr<ZLTextParagraphCursor> > cleanedCache;
-	for (std::map<const ZLTextParagraph*, weak_ptr<ZLTextParagraphCursor> >::iterator it = ourCache.begin(); it != ourCache.end(); ++it) {
-          if (it->second.lock()) {
-                  cleanedCache.insert(*it);
+	for (CursorMap::iterator it = ourCache.begin(); it != ourCache.end();) {
+		if (!it->second.IsRecent && it->second.Cursor.expired()) {
+			ourCache.erase(it++);
+		} else {
+			++it;
 		}
 	}
-	ourCache.swap(cleanedCache);
 }
 
 void ZLTextWordCursor::rebuild() {
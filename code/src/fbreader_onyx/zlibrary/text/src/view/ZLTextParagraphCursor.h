@@ -20,12 +20,13 @@
 #ifndef __ZLTEXTPARAGRAPHCURSOR_H__
 #define __ZLTEXTPARAGRAPHCURSOR_H__
 
+#include <new>
 #include <vector>
-#include <map>
+#include <list>
 #include <string>
+#include <tr1/unordered_map>
 
 #include <shared_ptr.h>
-#include <allocator.h>
 
 #include <ZLTextModel.h>
 
@@ -34,11 +35,47 @@
 
 class ZLTextParagraph;
 
+// Elements of one paragraph. Words and other per-paragraph elements are
+// placed in a chain of chunks owned by the vector (1K, 2K, ... up to 16K,
+// so short paragraphs stay small). clear() keeps both the chunks and the
+// pointer array for the next fill; a destroyed vector leaves them (up to
+// a limit) to the next cursors.
 class ZLTextElementVector : public std::vector<ZLTextElement*> {
 
 public:
 	ZLTextElementVector();
 	~ZLTextElementVector();
+
+	void clear();
+
+	ZLTextWord *addWord(const char *data, unsigned short length, size_t paragraphOffset, unsigned char bidiLevel);
+	void addControlElement(shared_ptr<ZLTextParagraphEntry> entry);
+	void addStyleElement(shared_ptr<ZLTextParagraphEntry> entry);
+	void addFixedHSpaceElement(unsigned char length);
+	void addImageElement(const std::string &id, shared_ptr<ZLImageData> image);
+
+private:
+	enum { CHUNK_LEVELS = 5 };
+	static std::vector<char*> ourFreeChunks[CHUNK_LEVELS];
+	static std::vector<std::vector<ZLTextElement*> > ourFreeArrays;
+
+	static size_t chunkLevel(size_t index);
+	static size_t chunkSize(size_t index);
+
+	void *allocate(size_t size);
+	void nextChunk();
+	void destroyElements();
+
+private:
+	// every chunk starts with a pointer to the next one
+	char *myFirstChunk;
+	char *myChunk;
+	size_t myChunkIndex;
+	size_t myChunkOffset;
+
+private:
+	ZLTextElementVector(const ZLTextElementVector&);
+	const ZLTextElementVector &operator = (const ZLTextElementVector&);
 };
 
 class ZLTextElementPool {
@@ -58,15 +95,6 @@ public:
 	ZLTextElement *EmptyLineElement;
 	ZLTextElement *StartReversedSequenceElement;
 	ZLTextElement *EndReversedSequenceElement;
-
-	ZLTextWord *getWord(const char *data, unsigned short length, size_t paragraphOffset, unsigned char bidiLevel);
-	void storeWord(ZLTextWord *word);
-	ZLTextControlElement *getControlElement(shared_ptr<ZLTextParagraphEntry> entry);
-	void storeControlElement(ZLTextControlElement *element);
-
-private:
-	Allocator<sizeof(ZLTextWord),64> myWordAllocator;
-	Allocator<sizeof(ZLTextControlElement),32> myControlAllocator;
 };
 
 class ZLTextParagraphCursor;
@@ -122,12 +150,26 @@ public:
 	static void put(const ZLTextParagraph *paragraph, ZLTextParagraphCursorPtr cursor);
 	static ZLTextParagraphCursorPtr get(const ZLTextParagraph *paragraph);
 
+	static void remove(const ZLTextParagraph *paragraph);
 	static void clear();
 	static void cleanup();
 
 private:
-	static std::map<const ZLTextParagraph*, weak_ptr<ZLTextParagraphCursor> > ourCache;
-	static ZLTextParagraphCursorPtr ourLastAdded;
+	static void touch(const ZLTextParagraph *paragraph, ZLTextParagraphCursorPtr cursor);
+
+private:
+	// the most recently used cursors are kept alive, the others are
+	// found while somebody else holds them
+	typedef std::list<std::pair<const ZLTextParagraph*,ZLTextParagraphCursorPtr> > RecentList;
+	struct Entry {
+		weak_ptr<ZLTextParagraphCursor> Cursor;
+		RecentList::iterator Recent;
+		bool IsRecent;
+	};
+	typedef std::tr1::unordered_map<const ZLTextParagraph*,Entry> CursorMap;
+
+	static CursorMap ourCache;
+	static RecentList ourRecent;
 
 private:
 	// instance creation is disabled
@@ -205,21 +247,37 @@ public:
 friend class ZLTextParagraphCursor;
 };
 
-inline ZLTextElementVector::ZLTextElementVector() {}
-
-inline ZLTextWord *ZLTextElementPool::getWord(const char *data, unsigned short length, size_t paragraphOffset, unsigned char bidiLevel) {
-	return new (myWordAllocator.allocate()) ZLTextWord(data, length, paragraphOffset, bidiLevel);
+inline size_t ZLTextElementVector::chunkLevel(size_t index) {
+	return (index < CHUNK_LEVELS) ? index : CHUNK_LEVELS - 1;
+}
+inline size_t ZLTextElementVector::chunkSize(size_t index) {
+	return 1024 << chunkLevel(index);
+}
+inline void *ZLTextElementVector::allocate(size_t size) {
+	size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+	if ((myChunk == 0) || (myChunkOffset + size > chunkSize(myChunkIndex))) {
+		nextChunk();
+	}
+	void *ptr = myChunk + myChunkOffset;
+	myChunkOffset += size;
+	return ptr;
+}
+inline ZLTextWord *ZLTextElementVector::addWord(const char *data, unsigned short length, size_t paragraphOffset, unsigned char bidiLevel) {
+	ZLTextWord *word = new (allocate(sizeof(ZLTextWord))) ZLTextWord(data, length, paragraphOffset, bidiLevel);
+	push_back(word);
+	return word;
+}
+inline void ZLTextElementVector::addControlElement(shared_ptr<ZLTextParagraphEntry> entry) {
+	push_back(new (allocate(sizeof(ZLTextControlElement))) ZLTextControlElement(entry));
 }
-inline void ZLTextElementPool::storeWord(ZLTextWord *word) {
-	word->~ZLTextWord();
-	myWordAllocator.free((void*)word);
+inline void ZLTextElementVector::addStyleElement(shared_ptr<ZLTextParagraphEntry> entry) {
+	push_back(new (allocate(sizeof(ZLTextStyleElement))) ZLTextStyleElement(entry));
 }
-inline ZLTextControlElement *ZLTextElementPool::getControlElement(shared_ptr<ZLTextParagraphEntry> entry) {
-	return new (myControlAllocator.allocate()) ZLTextControlElement(entry);
+inline void ZLTextElementVector::addFixedHSpaceElement(unsigned char length) {
+	push_back(new (allocate(sizeof(ZLTextFixedHSpaceElement))) ZLTextFixedHSpaceElement(length));
 }
-inline void ZLTextElementPool::storeControlElement(ZLTextControlElement *element) {
-	element->~ZLTextControlElement();
-	myControlAllocator.free((void*)element);
+inline void ZLTextElementVector::addImageElement(const std::string &id, shared_ptr<ZLImageData> image) {
+	push_back(new (allocate(sizeof(ZLTextImageElement))) ZLTextImageElement(id, image));
 }
 
 inline size_t ZLTextParagraphCursor::index() const { return myIndex; }
@@ -33,7 +33,7 @@
 #include "ZLTextWord.h"
 #include "ZLTextSelectionModel.h"
 
-ZLTextView::ZLTextView(ZLApplication &application, shared_ptr<ZLPaintContext> context) : ZLView(application, context), myPaintState(NOTHING_TO_PAINT), myOldWidth(-1), myOldHeight(-1), myStyle(context), mySelectionModel(*this, application), myTreeStateIsFrozen(false), myDoUpdateScrollbar(false) {
+ZLTextView::ZLTextView(ZLApplication &application, shared_ptr<ZLPaintContext> context) : ZLView(application, context), myPaintState(NOTHING_TO_PAINT), myOldWidth(-1), myOldHeight(-1), myStyle(context), mySelectionModel(*this, application), myTreeStateIsFrozen(false), myDoUpdateScrollbar(false), myPaginationEnabled(false), myPageMapIsComplete(false) {
 }
 
 ZLTextView::~ZLTextView() {
@@ -57,6 +57,7 @@ void ZLTextView::clear() {
 	myTreeNodeMap.clear();
 	myTextSize.clear();
 	myTextBreaks.clear();
+	resetPageMap();
 
 	ZLTextParagraphCursorCache::clear();
 }
@@ -74,28 +75,74 @@ void ZLTextView::setModel(shared_ptr<ZLTextModel> model, const std::string &lang
 
 
 		setStartCursor(ZLTextParagraphCursor::cursor(*myModel, myLanguage));
+		countTextSize();
+	}
+}
 
-		size_t size = myModel->paragraphsNumber();
+void ZLTextView::countTextSize() {
+	size_t size = myModel->paragraphsNumber();
+	size_t first = 0;
+	if (myTextSize.empty()) {
 		myTextSize.reserve(size + 1);
 		myTextSize.push_back(0);
-		size_t currentSize = 0;
-		for (size_t i= 0; i < size; ++i) {
-			const ZLTextParagraph &para = *(*myModel)[i];
-			currentSize += para.characterNumber();
-			switch (para.kind()) {
-				case ZLTextParagraph::END_OF_TEXT_PARAGRAPH:
-					myTextBreaks.push_back(i);
-					currentSize = ((currentSize - 1) / 2048 + 1) * 2048;
-					break;
-				case ZLTextParagraph::END_OF_SECTION_PARAGRAPH:
-					currentSize = ((currentSize - 1) / 2048 + 1) * 2048;
-					break;
-				default:
-					break;
-			}
-			myTextSize.push_back(currentSize);
+	} else {
+		// the last counted paragraph could get more text
+		first = myTextSize.size() - 2;
+		myTextSize.pop_back();
+		if (!myTextBreaks.empty() && (myTextBreaks.back() == first)) {
+			myTextBreaks.pop_back();
 		}
 	}
+	size_t currentSize = myTextSize.back();
+	for (size_t i = first; i < size; ++i) {
+		const ZLTextParagraph &para = *(*myModel)[i];
+		currentSize += para.characterNumber();
+		switch (para.kind()) {
+			case ZLTextParagraph::END_OF_TEXT_PARAGRAPH:
+				myTextBreaks.push_back(i);
+				currentSize = ((currentSize - 1) / 2048 + 1) * 2048;
+				break;
+			case ZLTextParagraph::END_OF_SECTION_PARAGRAPH:
+				currentSize = ((currentSize - 1) / 2048 + 1) * 2048;
+				break;
+			default:
+				break;
+		}
+		myTextSize.push_back(currentSize);
+	}
+}
+
+bool ZLTextView::appendParagraphs() {
+	if (!myModel || (myModel->paragraphsNumber() == 0)) {
+		return false;
+	}
+	if (myTextSize.empty()) {
+		setStartCursor(ZLTextParagraphCursor::cursor(*myModel, myLanguage));
+		countTextSize();
+		return true;
+	}
+
+	const size_t knownNumber = myTextSize.size() - 1;
+	countTextSize();
+	resetPageMap();
+	myDoUpdateScrollbar = true;
+
+	// cursors and lines of the last known paragraph miss its new text
+	const size_t lastKnown = knownNumber - 1;
+	ZLTextParagraphCursorCache::remove((*myModel)[lastKnown]);
+	for (std::set<ZLTextLineInfoPtr>::iterator it = myLineInfoCache.begin(); it != myLineInfoCache.end();) {
+		if ((*it)->End.paragraphCursor().index() >= lastKnown) {
+			myLineInfoCache.erase(it++);
+		} else {
+			++it;
+		}
+	}
+	if ((myPaintState == READY) && !myEndCursor.isNull() &&
+			(myEndCursor.paragraphCursor().index() + 1 < knownNumber)) {
+		return false;
+	}
+	rebuildPaintInfo(true);
+	return true;
 }
 
 void ZLTextView::scrollPage(bool forward, ScrollingMode mode, unsigned int value) {
@@ -547,6 +594,7 @@ void ZLTextView::drawWord(int x, int y, const ZLTextWord &word, int start, int l
 }
 
 void ZLTextView::clearCaches() {
+	resetPageMap();
 	rebuildPaintInfo(true);
 }
 
@@ -625,6 +673,13 @@ void ZLTextView::gotoCharIndex(size_t charIndex) {
 }
 
 void ZLTextView::gotoPage(size_t index) {
+	size_t first, last;
+	if (pageRange(first, last)) {
+		const unsigned int *page = &myPageMap[3 * std::min(first + std::max(index, (size_t)1) - 1, last)];
+		gotoPosition(page[0], page[1], page[2]);
+		return;
+	}
+
 	size_t charIndex = (index - 1) * 2048;
 	std::vector<size_t>::const_iterator it = std::lower_bound(myTextSize.begin(), myTextSize.end(), charIndex);
 	const int paraIndex = it - myTextSize.begin();
@@ -644,6 +699,11 @@ size_t ZLTextView::pageIndex() {
   if (empty() || !positionIndicator() || endCursor().isNull()) {
 		return 0;
 	}
+	size_t first, last;
+	if (!startCursor().isNull() && pageRange(first, last)) {
+		const int page = pageByCursor(startCursor());
+		return std::min(std::max(page, (int)first), (int)last) - first + 1;
+	}
 	return positionIndicator()->sizeOfTextBeforeCursor(endCursor()) / 2048 + 1;
 }
 
@@ -651,6 +711,10 @@ size_t ZLTextView::pageNumber() const {
 	if (empty()) {
 		return 0;
 	}
+	size_t first, last;
+	if (pageRange(first, last)) {
+		return last - first + 1;
+	}
 	std::vector<size_t>::const_iterator i = nextBreakIterator();
 	const size_t startIndex = (i != myTextBreaks.begin()) ? *(i - 1) : 0;
 	const size_t endIndex = (i != myTextBreaks.end()) ? *i : myModel->paragraphsNumber();
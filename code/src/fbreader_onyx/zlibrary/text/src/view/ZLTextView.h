@@ -155,6 +155,9 @@ public:
 	size_t pageIndex();
 	size_t pageNumber() const;
 
+	void setPaginationEnabled(bool enabled);
+	bool pageMapIsComplete() const;
+
 	void scrollPage(bool forward, ScrollingMode mode, unsigned int value);
 	void scrollToStartOfText();
 	void scrollToEndOfText();
@@ -168,6 +171,9 @@ public:
 
 	virtual void setModel(shared_ptr<ZLTextModel> model, const std::string &language);
 	const shared_ptr<ZLTextModel> model() const;
+	// the model got paragraphs at its end and its last known paragraph may
+	// have grown; returns true if the visible page has been changed
+	bool appendParagraphs();
 
 	bool hasMultiSectionModel() const;
 	void search(const std::string &text, bool ignoreCase, bool wholeText, bool backward, bool thisSectionOnly);
@@ -213,6 +219,11 @@ protected:
 	virtual int topMargin() const = 0;
 	virtual int bottomMargin() const = 0;
 
+	// page map persistence, the signature describes the layout parameters
+	virtual std::string pageMapSignature() const;
+	virtual bool loadPageMap(const std::string &signature, std::vector<unsigned int> &pageMap);
+	virtual void savePageMap(const std::string &signature, const std::vector<unsigned int> &pageMap);
+
 private:
 	int lineStartMargin() const;
 	int lineEndMargin() const;
@@ -222,6 +233,7 @@ private:
 	void moveEndCursor(int paragraphNumber, int wordNumber = 0, int charNumber = 0);
 
 	void clear();
+	void countTextSize();
 
 	int areaBound(const ZLTextParagraphCursor &paragraph, const ZLTextElementArea &area, int toCharNumber, bool mainDir);
 	ZLTextLineInfoPtr processTextLine(const ZLTextWordCursor &start, const ZLTextWordCursor &end);
@@ -261,6 +273,14 @@ private:
 
 	void gotoCharIndex(size_t charIndex);
 
+	void resetPageMap();
+	void updatePageMap();
+	void paginate();
+	size_t pageMapSize() const;
+	int pageByCursor(const ZLTextWordCursor &cursor) const;
+	bool pageRange(size_t &first, size_t &last) const;
+	bool previousPageStart(ZLTextWordCursor &cursor) const;
+
 private:
 	shared_ptr<ZLTextModel> myModel;
 	std::string myLanguage;
@@ -298,6 +318,15 @@ private:
 	bool myTreeStateIsFrozen;
 	bool myDoUpdateScrollbar;
 
+	// paragraph, element and char index of each page start, built in the
+	// background by paging forward from the start of the text
+	bool myPaginationEnabled;
+	std::vector<unsigned int> myPageMap;
+	bool myPageMapIsComplete;
+	std::string myPageMapSignature;
+	ZLTextWordCursor myPaginationCursor;
+	shared_ptr<ZLRunnable> myPaginator;
+
 	struct DoubleClickInfo {
 		DoubleClickInfo();
 		void update(int x, int y, bool press);
@@ -309,6 +338,7 @@ private:
 	} myDoubleClickInfo;
 
 friend class ZLTextSelectionModel;
+friend class ZLTextPaginator;
 };
 
 inline ZLTextView::ViewStyle::~ViewStyle() {}
@@ -326,6 +356,8 @@ inline const ZLTextWordCursor &ZLTextView::endCursor() const { return myEndCurso
 inline const shared_ptr<ZLTextModel> ZLTextView::model() const { return myModel; }
 inline ZLTextSelectionModel &ZLTextView::selectionModel() { return mySelectionModel; }
 inline const ZLTextSelectionModel &ZLTextView::selectionModel() const { return mySelectionModel; }
+inline bool ZLTextView::pageMapIsComplete() const { return myPageMapIsComplete; }
+inline size_t ZLTextView::pageMapSize() const { return myPageMap.size() / 3; }
 
 inline int ZLTextView::viewWidth() const {
 	return max(myStyle.context().width() - leftMargin() - rightMargin(), 1);
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2004-2009 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <ZLStringUtil.h>
+#include <ZLTextModel.h>
+
+#include "ZLTextView.h"
+#include "ZLTextLineInfo.h"
+
+// the pagination runs in slices between user events
+static const int PAGINATION_INTERVAL = 100;
+static const long PAGINATION_SLICE = 50;
+
+class ZLTextPaginator : public ZLRunnable {
+
+public:
+	ZLTextPaginator(ZLTextView &view);
+	void run();
+
+private:
+	ZLTextView &myView;
+};
+
+ZLTextPaginator::ZLTextPaginator(ZLTextView &view) : myView(view) {
+}
+
+void ZLTextPaginator::run() {
+	myView.paginate();
+}
+
+static void appendPage(std::vector<unsigned int> &pageMap, const ZLTextWordCursor &cursor) {
+	pageMap.push_back(cursor.paragraphCursor().index());
+	pageMap.push_back(cursor.elementIndex());
+	pageMap.push_back(cursor.charIndex());
+}
+
+// the first page starting in the given paragraph or after it
+static size_t firstPageFrom(const std::vector<unsigned int> &pageMap, unsigned int paragraph) {
+	size_t low = 0;
+	size_t high = pageMap.size() / 3;
+	while (low < high) {
+		const size_t middle = (low + high) / 2;
+		if (pageMap[3 * middle] < paragraph) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+static int comparePosition(const unsigned int *page, const ZLTextWordCursor &cursor) {
+	const unsigned int position[3] = { (unsigned int)cursor.paragraphCursor().index(), cursor.elementIndex(), cursor.charIndex() };
+	for (int i = 0; i < 3; ++i) {
+		if (page[i] != position[i]) {
+			return (page[i] < position[i]) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+void ZLTextView::setPaginationEnabled(bool enabled) {
+	if (myPaginationEnabled != enabled) {
+		myPaginationEnabled = enabled;
+		resetPageMap();
+		if (enabled && (myPaintState == READY)) {
+			updatePageMap();
+		}
+	}
+}
+
+static void appendNumbers(std::string &signature, const long *numbers, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		signature += ',';
+		ZLStringUtil::appendNumber(signature, numbers[i]);
+	}
+}
+
+std::string ZLTextView::pageMapSignature() const {
+	const ZLTextStyleCollection &collection = ZLTextStyleCollection::instance();
+	const ZLTextBaseStyle &style = collection.baseStyle();
+	std::string signature = myLanguage;
+	signature += ',';
+	signature += style.fontFamily();
+	const long numbers[] = {
+		style.fontSize(),
+		style.lineSpacePercent(),
+		style.alignment(),
+		style.AutoHyphenationOption.value() ? 1 : 0,
+		collection.OverrideSpecifiedFontsOption.value() ? 1 : 0,
+		viewWidth(),
+		textAreaHeight(),
+		myModel ? (long)myModel->paragraphsNumber() : 0,
+	};
+	appendNumbers(signature, numbers, sizeof(numbers) / sizeof(numbers[0]));
+
+	for (int kind = 0; kind < 256; ++kind) {
+		const ZLTextStyleDecoration *decoration = collection.decoration((ZLTextKind)kind);
+		if (decoration == 0) {
+			continue;
+		}
+		signature += ';';
+		signature += decoration->FontFamilyOption.value();
+		const long decorationNumbers[] = {
+			kind,
+			decoration->FontSizeDeltaOption.value(),
+			decoration->BoldOption.value(),
+			decoration->ItalicOption.value(),
+			decoration->VerticalShiftOption.value(),
+			decoration->AllowHyphenationsOption.value(),
+		};
+		appendNumbers(signature, decorationNumbers, sizeof(decorationNumbers) / sizeof(decorationNumbers[0]));
+		if (decoration->isFullDecoration()) {
+			const ZLTextFullStyleDecoration *full = (const ZLTextFullStyleDecoration*)decoration;
+			const long fullNumbers[] = {
+				full->SpaceBeforeOption.value(),
+				full->SpaceAfterOption.value(),
+				full->LeftIndentOption.value(),
+				full->RightIndentOption.value(),
+				full->FirstLineIndentDeltaOption.value(),
+				full->AlignmentOption.value(),
+				full->LineSpacePercentOption.value(),
+			};
+			appendNumbers(signature, fullNumbers, sizeof(fullNumbers) / sizeof(fullNumbers[0]));
+		}
+	}
+	return signature;
+}
+
+bool ZLTextView::loadPageMap(const std::string&, std::vector<unsigned int>&) {
+	return false;
+}
+
+void ZLTextView::savePageMap(const std::string&, const std::vector<unsigned int>&) {
+}
+
+void ZLTextView::resetPageMap() {
+	if (myPaginator) {
+		ZLTimeManager::instance().removeTask(myPaginator);
+		myPaginator.reset();
+	}
+	myPageMap.clear();
+	myPageMapIsComplete = false;
+	myPageMapSignature.erase();
+	myPaginationCursor = ZLTextParagraphCursorPtr();
+}
+
+void ZLTextView::updatePageMap() {
+	if (!myPaginationEnabled || !myModel ||
+			(myModel->kind() == ZLTextModel::TREE_MODEL) || (myPaintState == NOTHING_TO_PAINT)) {
+		return;
+	}
+
+	const std::string signature = pageMapSignature();
+	if (signature == myPageMapSignature) {
+		return;
+	}
+	resetPageMap();
+	myPageMapSignature = signature;
+
+	if (loadPageMap(signature, myPageMap)) {
+		bool valid = !myPageMap.empty() && (myPageMap.size() % 3 == 0);
+		for (size_t i = 0; valid && (i < myPageMap.size()); i += 3) {
+			valid =
+				(myPageMap[i] < myModel->paragraphsNumber()) &&
+				((i == 0) || (myPageMap[i] >= myPageMap[i - 3]));
+		}
+		if (valid) {
+			myPageMapIsComplete = true;
+			return;
+		}
+		myPageMap.clear();
+	}
+
+	myPaginationCursor = ZLTextParagraphCursor::cursor(*myModel, myLanguage);
+	appendPage(myPageMap, myPaginationCursor);
+	myPaginator.reset(new ZLTextPaginator(*this));
+	ZLTimeManager::instance().addTask(myPaginator, PAGINATION_INTERVAL);
+}
+
+void ZLTextView::paginate() {
+	if (myPageMapIsComplete || myPaginationCursor.isNull()) {
+		return;
+	}
+
+	// pages are built by the same code as the visible one, keep its lines
+	// and drop the ones built for pagination only
+	std::vector<ZLTextLineInfoPtr> lineInfos;
+	lineInfos.swap(myLineInfos);
+	std::set<ZLTextLineInfoPtr> lineInfoCache;
+	lineInfoCache.swap(myLineInfoCache);
+
+	ZLTime start;
+	do {
+		const ZLTextWordCursor end = buildInfos(myPaginationCursor);
+		if ((end == myPaginationCursor) ||
+				(end.paragraphCursor().isLast() && end.isEndOfParagraph())) {
+			myPageMapIsComplete = true;
+			break;
+		}
+		appendPage(myPageMap, end);
+		myPaginationCursor = end;
+	} while (start.millisecondsTo(ZLTime()) < PAGINATION_SLICE);
+
+	myLineInfos.swap(lineInfos);
+	myLineInfoCache.swap(lineInfoCache);
+	ZLTextParagraphCursorCache::cleanup();
+
+	if (myPageMapIsComplete) {
+		ZLTimeManager::instance().removeTask(myPaginator);
+		myPaginationCursor = ZLTextParagraphCursorPtr();
+		savePageMap(myPageMapSignature, myPageMap);
+		myDoUpdateScrollbar = true;
+	}
+}
+
+int ZLTextView::pageByCursor(const ZLTextWordCursor &cursor) const {
+	// the last page starting before or at the cursor
+	int low = 0;
+	int high = pageMapSize();
+	while (low < high) {
+		const int middle = (low + high) / 2;
+		if (comparePosition(&myPageMap[3 * middle], cursor) <= 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low - 1;
+}
+
+bool ZLTextView::pageRange(size_t &first, size_t &last) const {
+	if (!myPageMapIsComplete || (pageMapSize() == 0)) {
+		return false;
+	}
+
+	std::vector<size_t>::const_iterator i = nextBreakIterator();
+	const unsigned int startIndex = (i != myTextBreaks.begin()) ? *(i - 1) + 1 : 0;
+	const unsigned int endIndex = (i != myTextBreaks.end()) ? *i : myModel->paragraphsNumber();
+
+	first = firstPageFrom(myPageMap, startIndex);
+	last = firstPageFrom(myPageMap, endIndex + 1);
+	if (first >= last) {
+		return false;
+	}
+	--last;
+	return true;
+}
+
+bool ZLTextView::previousPageStart(ZLTextWordCursor &cursor) const {
+	if (cursor.isNull() || myPageMap.empty()) {
+		return false;
+	}
+	const int page = pageByCursor(cursor);
+	if ((page <= 0) || (comparePosition(&myPageMap[3 * page], cursor) != 0)) {
+		return false;
+	}
+	const unsigned int *previous = &myPageMap[3 * (page - 1)];
+	cursor.moveToParagraph(previous[0]);
+	cursor.moveTo(previous[1], previous[2]);
+	return true;
+}
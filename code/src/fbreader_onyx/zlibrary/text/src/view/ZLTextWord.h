@@ -78,7 +78,7 @@ private:
 	ZLTextWord(const ZLTextWord&);
 	ZLTextWord &operator = (const ZLTextWord&);
 
-friend class ZLTextElementPool;
+friend class ZLTextElementVector;
 };
 
 inline ZLTextElement::Kind ZLTextWord::kind() const { return WORD_ELEMENT; }
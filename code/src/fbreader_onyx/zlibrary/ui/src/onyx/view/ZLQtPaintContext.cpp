@@ -28,11 +28,16 @@
 #include "ZLQtPaintContext.h"
 #include "../image/ZLQtImageManager.h"
 
+static const int MAX_CACHED_FONTS = 16;
+static const int MAX_CACHED_WORDS = 8192;
+
 ZLQtPaintContext::ZLQtPaintContext() {
 	myPainter = new QPainter();
 	myPixmap = 0;
 	mySpaceWidth = -1;
 	myDescent = 0;
+	myFontMetrics = 0;
+	myWidthCache = 0;
 	myFontIsStored = false;
 }
 
@@ -42,6 +47,41 @@ ZLQtPaintContext::~ZLQtPaintContext() {
 		delete myPixmap;
 	}
 	delete myPainter;
+	delete myFontMetrics;
+	qDeleteAll(myWidthCaches);
+}
+
+void ZLQtPaintContext::fontUpdated() {
+	const QFont &font = myPainter->font();
+	delete myFontMetrics;
+	myFontMetrics = new QFontMetrics(font, myPainter->device());
+	mySpaceWidth = -1;
+	myDescent = myFontMetrics->descent();
+
+	const QString key = font.key();
+	QHash<QString,WidthCache*>::const_iterator it = myWidthCaches.find(key);
+	if (it != myWidthCaches.end()) {
+		myWidthCache = it.value();
+		return;
+	}
+	if (myWidthCaches.size() >= MAX_CACHED_FONTS) {
+		qDeleteAll(myWidthCaches);
+		myWidthCaches.clear();
+	}
+	myWidthCache = new WidthCache();
+	myWidthCaches.insert(key, myWidthCache);
+}
+
+const QString &ZLQtPaintContext::qString(const char *str, int len) const {
+	const QByteArray key = QByteArray::fromRawData(str, len);
+	QHash<QByteArray,QString>::const_iterator it = myStringCache.find(key);
+	if (it != myStringCache.end()) {
+		return it.value();
+	}
+	if (myStringCache.size() >= MAX_CACHED_WORDS) {
+		myStringCache.clear();
+	}
+	return myStringCache.insert(QByteArray(str, len), QString::fromUtf8(str, len)).value();
 }
 
 void ZLQtPaintContext::setSize(int w, int h) {
@@ -55,6 +95,7 @@ void ZLQtPaintContext::setSize(int w, int h) {
 	if ((myPixmap == 0) && (w > 0) && (h > 0)) {
 		myPixmap = new QPixmap(w, h);
 		myPainter->begin(myPixmap);
+		fontUpdated();
 		if (myFontIsStored) {
 			myFontIsStored = false;
 			setFont(myStoredFamily, myStoredSize, myStoredBold, myStoredItalic);
@@ -122,8 +163,7 @@ void ZLQtPaintContext::setFont(const std::string &family, int size, bool bold, b
 
 		if (fontChanged) {
 			myPainter->setFont(font);
-			mySpaceWidth = -1;
-			myDescent = myPainter->fontMetrics().descent();
+			fontUpdated();
 		}
 	}
 }
@@ -144,12 +184,25 @@ void ZLQtPaintContext::setFillColor(ZLColor color, FillStyle style) {
 }
 
 int ZLQtPaintContext::stringWidth(const char *str, int len, bool) const {
-	return myPainter->fontMetrics().width(QString::fromUtf8(str, len));
+	if (myWidthCache == 0) {
+		return myPainter->fontMetrics().width(QString::fromUtf8(str, len));
+	}
+	const QByteArray key = QByteArray::fromRawData(str, len);
+	WidthCache::const_iterator it = myWidthCache->find(key);
+	if (it != myWidthCache->end()) {
+		return it.value();
+	}
+	if (myWidthCache->size() >= MAX_CACHED_WORDS) {
+		myWidthCache->clear();
+	}
+	const int width = myFontMetrics->width(qString(str, len));
+	myWidthCache->insert(QByteArray(str, len), width);
+	return width;
 }
 
 int ZLQtPaintContext::spaceWidth() const {
 	if (mySpaceWidth == -1) {
-		mySpaceWidth = myPainter->fontMetrics().width(' ');
+		mySpaceWidth = (myFontMetrics != 0) ? myFontMetrics->width(' ') : myPainter->fontMetrics().width(' ');
 	}
 	return mySpaceWidth;
 }
@@ -163,9 +216,8 @@ int ZLQtPaintContext::stringHeight() const {
 }
 
 void ZLQtPaintContext::drawString(int x, int y, const char *str, int len, bool rtl) {
-	QString qStr = QString::fromUtf8(str, len);
 	myPainter->setLayoutDirection(rtl ? Qt::RightToLeft : Qt::LeftToRight);
-	myPainter->drawText(x, y, qStr);
+	myPainter->drawText(x, y, qString(str, len));
 }
 
 void ZLQtPaintContext::drawImage(int x, int y, const ZLImageData &image) {
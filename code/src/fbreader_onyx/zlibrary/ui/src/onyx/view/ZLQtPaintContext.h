@@ -20,10 +20,15 @@
 #ifndef __ZLQTPAINTCONTEXT_H__
 #define __ZLQTPAINTCONTEXT_H__
 
+#include <QtCore/QHash>
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
 #include <ZLPaintContext.h>
 
 class QPainter;
 class QPixmap;
+class QFontMetrics;
 
 class ZLQtPaintContext : public ZLPaintContext {
 
@@ -60,11 +65,23 @@ public:
 	void drawFilledCircle(int x, int y, int r);
 
 private:
+	void fontUpdated();
+	const QString &qString(const char *str, int len) const;
+
+private:
+	// word widths are measured for every page build, cache them per font
+	typedef QHash<QByteArray,int> WidthCache;
+
 	QPainter *myPainter;
 	QPixmap *myPixmap;
 	mutable int mySpaceWidth;
 	int myDescent;
 
+	QFontMetrics *myFontMetrics;
+	QHash<QString,WidthCache*> myWidthCaches;
+	mutable WidthCache *myWidthCache;
+	mutable QHash<QByteArray,QString> myStringCache;
+
 	bool myFontIsStored;
 	std::string myStoredFamily;
 	int myStoredSize;
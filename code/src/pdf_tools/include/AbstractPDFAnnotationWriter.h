@@ -13,8 +13,15 @@ class AbstractPDFAnnotationWriter {
 
 public:
     virtual bool openPDF(std::string docPath) = 0;
-    virtual bool writeScribbles(std::vector<PageScribble> pageScribbles, PFunc_DeviceCoorTransformer pFuncDevCoortransformer = 0) = 0;
+    virtual int getPageCount() = 0;
+    // points of pageScribbles are transformed and simplified in place
+    virtual bool writeScribbles(std::vector<PageScribble> &pageScribbles, PFunc_DeviceCoorTransformer pFuncDevCoortransformer = 0) = 0;
     virtual bool saveAs(std::string dstPath) = 0;
+
+    // points closer than tolerance (in PDF units) to a stroke are dropped, 0 keeps all points
+    virtual void setSimplifyTolerance(double tolerance) = 0;
+    // number of threads used for preparing pages, 0 uses one per processor
+    virtual void setThreadCount(int threads) = 0;
 }; // class
 
 } // namespace
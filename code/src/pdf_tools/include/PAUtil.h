@@ -2,6 +2,9 @@
 #define PAUTIL_H
 
 #include <string>
+#include <vector>
+
+#include "PAPoint.h"
 
 namespace pdfanno {
 class PAUtil {
@@ -10,6 +13,14 @@ public:
     static std::string getMergeMarkAsPostfix();
     static std::string getTimeStamp();
     static std::string getSaveAsPath(const std::string &filePath);
+    // wall clock time in seconds, for timing the export
+    static double getTime();
+    // number of processors, at least 1
+    static int getProcessorCount();
+
+    // drop all points that are closer than tolerance to the polyline
+    // of the remaining points (Douglas-Peucker), the first and last point are kept
+    static void simplifyPolyLine(std::vector<PAPoint> &points, double tolerance);
 
     template<class T> static void internalSwap(T *a, T *b)
     {
@@ -13,14 +13,12 @@ struct PageScribble {
         std::vector<PAPoint> points_;
         double thickness_;
 
-        Stroke(std::vector<PAPoint> points, double thickness = 1.0)
+        Stroke(const std::vector<PAPoint> &points, double thickness = 1.0)
+            : rect_(points.front(), points.front()), points_(points), thickness_(thickness)
         {
-            rect_ = PARect(points.front(), points.front());
-            for (std::vector<PAPoint>::iterator it = points.begin(); it != points.end(); it++) {
-                points_.push_back(*it);
+            for (std::vector<PAPoint>::const_iterator it = points.begin(); it != points.end(); it++) {
                 rect_.inflateTo(*it);
             }
-            thickness_ = thickness;
         }
     };
 
@@ -33,18 +33,29 @@ public:
 
 public:
     bool openPDF(std::string docPath);
-    // write page scribbles infomation to PDF
+    int getPageCount();
+    // write page scribbles infomation to PDF, one ink annotation per page
     // because page scribbles coming from device, so may need transforming device's coor to PDF's
     // if so, pFuncDevCoortransformer is provided
-    bool writeScribbles(std::vector<PageScribble> pageScribbles, PFunc_DeviceCoorTransformer pFuncDevCoortransformer = 0);
+    // pages are transformed, simplified and compressed in parallel
+    bool writeScribbles(std::vector<PageScribble> &pageScribbles, PFunc_DeviceCoorTransformer pFuncDevCoortransformer = 0);
     bool saveAs(std::string dstPath);
 
+    void setSimplifyTolerance(double tolerance);
+    void setThreadCount(int threads);
+
 private:
     bool closeCore();
+    PoDoFo::PdfExtGState *getExtGState();
 
 private:
     std::string docPath_;
     PoDoFo::PdfMemDocument *doc_;
+    // graphics state shared by the appearance streams of all pages
+    PoDoFo::PdfExtGState *extGState_;
+
+    double tolerance_;
+    int threads_;
 }; // class
 
 } // namespace
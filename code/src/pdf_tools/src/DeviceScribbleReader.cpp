@@ -22,7 +22,6 @@
 
 using namespace pdfanno;
 
-static bool transformPointHelper(const PARect &cropBox, PAPoint &point);
 static bool tranformDeviceCoorToPDF(const PARect &cropBox, PageScribble &pageScribble);
 
 static bool getDeviceScribblePages(SketchDocument &sketch_document, sketch::Pages &pages);
@@ -76,17 +75,14 @@ static bool getDeviceScribblePages(SketchDocument &sketch_document, sketch::Page
     pages = sketch_document.pages();
     std::cout<<"pages: "<<pages.size()<<std::endl;
 
-    int i = 0;
     QMapIterator<PageKey, SketchPagePtr> it(pages);
     while (it.hasNext()) {
         it.next();
-        std::cout << "loading page " << i << std::endl;
-        i++;
 
         SketchPagePtr page = it.value();
 
         if (!sketch_io->loadPageData(page)) {
-            std::cerr<<"loading page failed"<<std::endl;
+            std::cerr<<"loading page failed: "<<it.key().toStdString()<<std::endl;
         }
     }
 
@@ -108,27 +104,19 @@ static bool parseDeviceScribblePage(const sketch::PageKey &key, const sketch::Sk
     parsedScribble.page_ = num_page;
 
     Strokes strokes = page.get()->strokes();
-    std::cout<<strokes.size()<<" strokes in page"<<std::endl;
+    parsedScribble.strokes_.reserve(strokes.size());
 
-    int i = 0;
+    std::vector<PAPoint> pa_points;
     for (StrokesIter it = strokes.begin(); it != strokes.end(); it++) {
-        std::cout<<"parsing stroke "<<i<<std::endl;
-        i++;
-
         const ZoomFactor stroke_zoom_factor = it->get()->zoom();
-
-        std::vector<PAPoint> pa_points;
+        const double scale = 1.0 / stroke_zoom_factor;
 
         Points points = (*it).get()->points();
-        std::cout<<points.size()<<" points in stroke"<<std::endl;
 
-        int j = 0;
+        pa_points.clear();
+        pa_points.reserve(points.size());
         for (PointsIter pit = points.begin(); pit != points.end(); pit++) {
-            std::cout<<"parsing point "<<j<<" ("<<pit->x() / stroke_zoom_factor<<", "<<
-                    pit->y() / stroke_zoom_factor<<")"<<std::endl;
-            j++;
-
-            pa_points.push_back(PAPoint(pit->x() / stroke_zoom_factor, pit->y() / stroke_zoom_factor));
+            pa_points.push_back(PAPoint(pit->x() * scale, pit->y() * scale));
         }
 
         if (pa_points.size() == 0) {
@@ -137,11 +125,8 @@ static bool parseDeviceScribblePage(const sketch::PageKey &key, const sketch::Sk
             continue;
         }
 
-        const double stroke_thickness = sketch::getPointSize(it->get()->shape(), 1.0 / stroke_zoom_factor);
+        const double stroke_thickness = sketch::getPointSize(it->get()->shape(), scale);
         parsedScribble.strokes_.push_back(PageScribble::Stroke(pa_points, stroke_thickness));
-
-        const PARect &rect = parsedScribble.strokes_.back().rect_;
-        std::cout<<"Rect: "<<rect.ll_.x_<<","<<rect.ll_.y_<<","<<rect.ur_.x_<<","<<rect.ur_.y_<<std::endl;
     }
 
     return true;
@@ -149,14 +134,12 @@ static bool parseDeviceScribblePage(const sketch::PageKey &key, const sketch::Sk
 
 static bool parseDeviceScribblePages(const sketch::Pages &pages, std::vector<PageScribble> &pageScribbles)
 {
-    int i = 0;
+    pageScribbles.reserve(pages.size());
+
     QMapIterator<PageKey, SketchPagePtr> it(pages);
     while (it.hasNext()) {
         it.next();
 
-        std::cout<<"parsing page "<<i<<std::endl;
-        i++;
-
         PageKey key = it.key();
         SketchPagePtr page = it.value();
 
@@ -166,58 +149,49 @@ static bool parseDeviceScribblePages(const sketch::Pages &pages, std::vector<Pag
             continue;
         }
 
-        PageScribble to_parse;
-        if (!parseDeviceScribblePage(key, page, to_parse)) {
+        pageScribbles.push_back(PageScribble());
+        if (!parseDeviceScribblePage(key, page, pageScribbles.back())) {
             return false;
         }
-
-        pageScribbles.push_back(to_parse);
     }
 
     return true;
 }
 
-static bool transformPointHelper(const PARect &cropBox, PAPoint &point)
+// implementer of PFunc_DeviceCoorTransformer
+static bool tranformDeviceCoorToPDF(const PARect &cropBox, PageScribble &pageScribble)
 {
     // device's origin is (left, top) = (0, 0)
-    // need transform to PDF's origin(cropBox.ll_.x_, cropBox.ll_.y_)
+    // need transform to PDF's origin(cropBox.ll_.x_, cropBox.ll_.y_),
+    // that is (x, y) becomes (x + left, bottom + height - y) for all points
     const int crop_box_height = cropBox.ur_.y_ - cropBox.ll_.y_;
-    if (point.y_ > crop_box_height) {
-        std::cerr<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<
-                "point's coor (" <<point.x_ <<", " << point.y_ <<") out of CropBox [ "<<
-                cropBox.ll_.x_<<" "<<cropBox.ll_.y_<<" "<<cropBox.ur_.x_<<" "<<cropBox.ur_.y_<<" ]"<<std::endl;
-        return false;
-    }
+    const double offset_x = cropBox.ll_.x_;
+    const double offset_y = cropBox.ll_.y_ + crop_box_height;
 
-    point.y_ = crop_box_height - point.y_;
-
-    point.x_ += cropBox.ll_.x_;
-    point.y_ += cropBox.ll_.y_;
-
-    return true;
-}
-
-// implementer of PFunc_DeviceCoorTransformer
-static bool tranformDeviceCoorToPDF(const PARect &cropBox, PageScribble &pageScribble)
-{
     for (std::vector<PageScribble::Stroke>::iterator it = pageScribble.strokes_.begin();
             it != pageScribble.strokes_.end();
             it++) {
-        if (!transformPointHelper(cropBox, it->rect_.ll_)) {
-            return false;
-        }
-        if (!transformPointHelper(cropBox, it->rect_.ur_)) {
+        // the rect bounds all points of the stroke, so it is enough to check it
+        PARect &rect = it->rect_;
+        if (rect.ur_.y_ > crop_box_height) {
+            std::cerr<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<
+                    "stroke's rect (" <<rect.ll_.x_ <<", " << rect.ll_.y_ <<", "<<rect.ur_.x_ <<", " << rect.ur_.y_ <<
+                    ") out of CropBox [ "<<cropBox.ll_.x_<<" "<<cropBox.ll_.y_<<" "<<cropBox.ur_.x_<<" "<<cropBox.ur_.y_<<" ]"<<std::endl;
             return false;
         }
 
-        PAUtil::internalSwap<double>(&(it->rect_.ll_.y_), &(it->rect_.ur_.y_));
+        rect.ll_.x_ += offset_x;
+        rect.ur_.x_ += offset_x;
+        rect.ll_.y_ = offset_y - rect.ll_.y_;
+        rect.ur_.y_ = offset_y - rect.ur_.y_;
+
+        PAUtil::internalSwap<double>(&(rect.ll_.y_), &(rect.ur_.y_));
 
-        for (std::vector<PAPoint>::iterator pit = (*it).points_.begin();
-                pit != it->points_.end();
-                pit++) {
-            if (!transformPointHelper(cropBox, *pit)) {
-                return false;
-            }
+        PAPoint *points = &it->points_[0];
+        const std::vector<PAPoint>::size_type count = it->points_.size();
+        for (std::vector<PAPoint>::size_type i = 0; i < count; i++) {
+            points[i].x_ += offset_x;
+            points[i].y_ = offset_y - points[i].y_;
         }
     }
 
@@ -10,6 +10,11 @@
 
 #include <string>
 #include <sstream>
+#include <utility>
+#include <vector>
+
+#include <sys/time.h>
+#include <unistd.h>
 
 #include "../include/PAUtil.h"
 
@@ -42,3 +47,80 @@ std::string PAUtil::getSaveAsPath(const std::string &filePath)
                 "." + filePath.substr(idx + 1, filePath.length() - idx - 1);
     }
 }
+
+double PAUtil::getTime()
+{
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+int PAUtil::getProcessorCount()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? static_cast<int>(cpus) : 1;
+}
+
+void PAUtil::simplifyPolyLine(std::vector<PAPoint> &points, double tolerance)
+{
+    const std::vector<PAPoint>::size_type count = points.size();
+    if (count < 3 || tolerance <= 0) {
+        return;
+    }
+
+    const double tolerance2 = tolerance * tolerance;
+
+    std::vector<char> keep(count, 0);
+    keep[0] = keep[count - 1] = 1;
+
+    // ranges still to be split, an explicit stack instead of recursion
+    // as strokes may have thousands of points
+    std::vector<std::pair<std::vector<PAPoint>::size_type, std::vector<PAPoint>::size_type> > ranges;
+    ranges.push_back(std::make_pair(0, count - 1));
+
+    while (!ranges.empty()) {
+        const std::vector<PAPoint>::size_type first = ranges.back().first;
+        const std::vector<PAPoint>::size_type last = ranges.back().second;
+        ranges.pop_back();
+
+        const double dx = points[last].x_ - points[first].x_;
+        const double dy = points[last].y_ - points[first].y_;
+        const double len2 = dx * dx + dy * dy;
+
+        // squared distance of every inner point to the segment first-last
+        double max_dist2 = 0;
+        std::vector<PAPoint>::size_type max_index = first;
+        for (std::vector<PAPoint>::size_type i = first + 1; i < last; i++) {
+            const double ex = points[i].x_ - points[first].x_;
+            const double ey = points[i].y_ - points[first].y_;
+
+            double dist2;
+            if (len2 > 0) {
+                const double cross = ex * dy - ey * dx;
+                dist2 = cross * cross / len2;
+            }
+            else {
+                dist2 = ex * ex + ey * ey;
+            }
+
+            if (dist2 > max_dist2) {
+                max_dist2 = dist2;
+                max_index = i;
+            }
+        }
+
+        if (max_dist2 > tolerance2) {
+            keep[max_index] = 1;
+            ranges.push_back(std::make_pair(first, max_index));
+            ranges.push_back(std::make_pair(max_index, last));
+        }
+    }
+
+    std::vector<PAPoint>::size_type kept = 0;
+    for (std::vector<PAPoint>::size_type i = 0; i < count; i++) {
+        if (keep[i]) {
+            points[kept++] = points[i];
+        }
+    }
+    points.resize(kept);
+}
@@ -10,6 +10,9 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <sstream>
+
+#include <pthread.h>
 
 #include "podofo/podofo.h"
 
@@ -17,15 +20,44 @@
 #include "../include/PAUtil.h"
 #include "../include/AbstractPDFAnnotationWriter.h"
 #include "../include/PASize.h"
+#include "../include/PAPoint.h"
+#include "../include/PARect.h"
 #include "../include/PageScribble.h"
 
 using namespace pdfanno;
 
-static bool createAnnotationPolyLine(PoDoFo::PdfDocument *document, PoDoFo::PdfPage *page, const PageScribble::Stroke &stroke);
+// points closer than a quarter point to a stroke are not visible on any device
+static const double DEFAULT_SIMPLIFY_TOLERANCE = 0.25;
+
+// one scribbled page, prepared on a worker thread without touching the document
+struct PageJob {
+    PageScribble *scribble_;
+    PoDoFo::PdfPage *page_;
+    PARect cropBox_;
+
+    bool ok_;
+    PARect rect_;            // bounds of all strokes, including their thickness
+    std::string content_;    // appearance stream of all strokes
+};
+
+struct PageJobs {
+    std::vector<PageJob> *jobs_;
+    PFunc_DeviceCoorTransformer transformer_;
+    double tolerance_;
+    int threads_;
+    int thread_;
+};
+
+static void preparePages(std::vector<PageJob> &jobs, PFunc_DeviceCoorTransformer transformer, double tolerance, int threads);
+static bool createAnnotationInk(PoDoFo::PdfDocument *document, PoDoFo::PdfExtGState *extGState,
+        PoDoFo::PdfStreamCompressor &compressor, const PageJob &job);
 
 PoDoFoAnnotationWriter::PoDoFoAnnotationWriter()
 {
     doc_ = 0;
+    extGState_ = 0;
+    tolerance_ = DEFAULT_SIMPLIFY_TOLERANCE;
+    threads_ = 0;
 }
 
 PoDoFoAnnotationWriter::~PoDoFoAnnotationWriter()
@@ -56,7 +88,17 @@ bool PoDoFoAnnotationWriter::openPDF(std::string docPath)
     return true;
 }
 
-bool PoDoFoAnnotationWriter::writeScribbles(std::vector<PageScribble> pageScribbles, PFunc_DeviceCoorTransformer pFuncDevCoortransformer)
+int PoDoFoAnnotationWriter::getPageCount()
+{
+    if (!doc_) {
+        assert(false);
+        return 0;
+    }
+
+    return doc_->GetPageCount();
+}
+
+bool PoDoFoAnnotationWriter::writeScribbles(std::vector<PageScribble> &pageScribbles, PFunc_DeviceCoorTransformer pFuncDevCoortransformer)
 {
     if (!doc_) {
         assert(false);
@@ -68,35 +110,36 @@ bool PoDoFoAnnotationWriter::writeScribbles(std::vector<PageScribble> pageScribb
     std::vector<PageScribble>::size_type num_pages = pageScribbles.size();
     std::cerr<< "["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]" << "scribbled pages: " << num_pages << std::endl;
 
+    // the document is not thread safe, so look up all pages first
+    std::vector<PageJob> jobs(num_pages);
     for (std::vector<PageScribble>::size_type i = 0; i < num_pages; i++) {
-        std::cerr<< "["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]" << "get page: " << i << std::endl;
-
         PoDoFo::PdfPage *page = doc_->GetPage(pageScribbles[i].page_);
         if (!page) {
             std::cerr<< "["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]" << "get page failed: " << i << std::endl;
             return false;
         }
 
-        if (pFuncDevCoortransformer) {
-            const PoDoFo::PdfRect &crop_box = page->GetCropBox();
-            std::cout<<"CropBox ("<<crop_box.GetLeft()<<", "<<crop_box.GetBottom()<<
-                    "), width: "<<crop_box.GetWidth()<<", height: "<<crop_box.GetHeight()<<std::endl;
+        const PoDoFo::PdfRect &crop_box = page->GetCropBox();
+        jobs[i].scribble_ = &pageScribbles[i];
+        jobs[i].page_ = page;
+        jobs[i].cropBox_ = PARect(PAPoint(crop_box.GetLeft(), crop_box.GetBottom()),
+                PAPoint(crop_box.GetLeft() + crop_box.GetWidth(), crop_box.GetBottom() + crop_box.GetHeight()));
+    }
+
+    preparePages(jobs, pFuncDevCoortransformer, tolerance_, threads_);
 
-            const PARect pdf_rect(PAPoint(crop_box.GetLeft(), crop_box.GetBottom()),
-                    PAPoint(crop_box.GetLeft() + crop_box.GetWidth(), crop_box.GetBottom() + crop_box.GetHeight()));
-            if (!pFuncDevCoortransformer(pdf_rect, pageScribbles[i])) {
-                continue;
-            }
+    // appearance streams are compressed on all threads, too
+    PoDoFo::PdfStreamCompressor compressor(threads_);
+    for (std::vector<PageJob>::const_iterator it = jobs.begin(); it != jobs.end(); it++) {
+        if (!it->ok_) {
+            continue;
         }
 
-        for (std::vector<PageScribble::Stroke>::iterator it = pageScribbles[i].strokes_.begin();
-                it != pageScribbles[i].strokes_.end();
-                it++) {
-            if (!createAnnotationPolyLine(doc_, page, *it)) {
-                continue;
-            }
+        if (!createAnnotationInk(doc_, this->getExtGState(), compressor, *it)) {
+            continue;
         }
     }
+    compressor.Run();
 
     std::cout<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<"combinePageScribbles finished"<<std::endl;
 
@@ -109,10 +152,14 @@ bool PoDoFoAnnotationWriter::saveAs(std::string dstPath)
 
     assert(doc_);
 
-    std::string new_title = std::string(doc_->GetInfo()->GetTitle().GetString()) + " - " + PAUtil::getMergeMarkAsPostfix();
+    // documents without a title return an invalid string
+    const PoDoFo::PdfString &title = doc_->GetInfo()->GetTitle();
+    std::string new_title = std::string(title.IsValid() ? title.GetString() : "") + " - " + PAUtil::getMergeMarkAsPostfix();
     doc_->GetInfo()->SetTitle(new_title.c_str());
 
-    doc_->Write(dstPath.c_str());
+    // Only the annotations and the objects they modify are appended to a
+    // copy of the original file, instead of rewriting every object of it.
+    doc_->WriteUpdate(dstPath.c_str());
 
     std::cout<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<"SaveAs finished"<<std::endl;
 
@@ -129,6 +176,9 @@ bool PoDoFoAnnotationWriter::closeCore()
         return true;
     }
 
+    delete extGState_;
+    extGState_ = 0;
+
     delete doc_;
     doc_ = 0;
 
@@ -137,48 +187,177 @@ bool PoDoFoAnnotationWriter::closeCore()
     return true;
 }
 
-static bool createAnnotationPolyLine(PoDoFo::PdfDocument *document, PoDoFo::PdfPage *page, const PageScribble::Stroke &stroke)
+void PoDoFoAnnotationWriter::setSimplifyTolerance(double tolerance)
 {
-    assert(document && page);
+    tolerance_ = tolerance;
+}
 
-    using namespace PoDoFo;
+void PoDoFoAnnotationWriter::setThreadCount(int threads)
+{
+    threads_ = threads;
+}
 
-    const PARect &rect = stroke.rect_;
-    const std::vector<PAPoint> &points = stroke.points_;
-    const double thickness = stroke.thickness_;
+PoDoFo::PdfExtGState *PoDoFoAnnotationWriter::getExtGState()
+{
+    assert(doc_);
 
-    PdfRect pdf_rect(rect.ll_.x_, rect.ll_.y_, rect.getWidth(), rect.getHeight());
+    if (!extGState_) {
+        // round caps and joins, so that strokes of a single point are drawn as dots
+        extGState_ = new PoDoFo::PdfExtGState(doc_);
+        extGState_->GetObject()->GetDictionary().AddKey(PoDoFo::PdfName("LC"), static_cast<PoDoFo::pdf_int64>(1));
+        extGState_->GetObject()->GetDictionary().AddKey(PoDoFo::PdfName("LJ"), static_cast<PoDoFo::pdf_int64>(1));
+    }
 
-    std::cout<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<"Create PolyLine"<<std::endl;
+    return extGState_;
+}
+
+static void preparePage(PageJob &job, PFunc_DeviceCoorTransformer transformer, double tolerance)
+{
+    job.ok_ = false;
 
-    PdfAnnotation *annot_polyline = page->CreateAnnotation(ePdfAnnotation_PolyLine, pdf_rect);
-    annot_polyline->SetColor(128, 0, 0);
-    //annot_polyline->SetFlags(4);
+    if (transformer && !transformer(job.cropBox_, *job.scribble_)) {
+        return;
+    }
 
-    PdfDictionary &dict = annot_polyline->GetObject()->GetDictionary();
-    PdfArray *vertices = new PdfArray();
-    for (std::vector<PAPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
-        vertices->push_back(it->x_);
-        vertices->push_back(it->y_);
+    std::vector<PageScribble::Stroke> &strokes = job.scribble_->strokes_;
+    if (strokes.empty()) {
+        return;
     }
-    dict.AddKey(PdfName("Vertices"), *vertices);
 
-    std::cout<<"PolyLine begins"<<std::endl;
-    std::cout<<"Rect: "<<rect.ll_.x_<<","<<rect.ll_.y_<<","<<rect.ur_.x_<<","<<rect.ur_.y_<<std::endl;
+    std::ostringstream content;
+    PoDoFo::PdfLocaleImbue(content);
+    content.setf(std::ios::fixed);
+    content.precision(2);
 
-    PdfXObject *xobj = new PdfXObject(pdf_rect, document);
-    PdfPainter pnt;
-    pnt.SetPage(xobj);
-    pnt.SetStrokeWidth(thickness);
-    for (int i = 0; i < points.size() - 1; i++) {
-        std::cout<<"Line " <<i<<": ("<<points[i].x_<<","<<points[i].y_<<"), ("<<points[i + 1].x_<<","<<points[i + 1].y_<<")"<<std::endl;
-        pnt.DrawLine(points[i].x_, points[i].y_, points[i + 1].x_, points[i + 1].y_);
+    content<<"q\n/GS0 gs\n";
+
+    double width = -1.0;
+    double max_width = 0.0;
+    job.rect_ = strokes.front().rect_;
+    for (std::vector<PageScribble::Stroke>::iterator it = strokes.begin(); it != strokes.end(); it++) {
+        PAUtil::simplifyPolyLine(it->points_, tolerance);
+
+        if (it->thickness_ != width) {
+            width = it->thickness_;
+            content<<width<<" w\n";
+        }
+        if (width > max_width) {
+            max_width = width;
+        }
+
+        const std::vector<PAPoint> &points = it->points_;
+        content<<points[0].x_<<" "<<points[0].y_<<" m\n";
+        if (points.size() == 1) {
+            content<<points[0].x_<<" "<<points[0].y_<<" l\n";
+        }
+        for (std::vector<PAPoint>::size_type i = 1; i < points.size(); i++) {
+            content<<points[i].x_<<" "<<points[i].y_<<" l\n";
+        }
+        content<<"S\n";
+
+        job.rect_.inflateTo(it->rect_.ll_);
+        job.rect_.inflateTo(it->rect_.ur_);
     }
-    pnt.FinishPage();
 
-    std::cout<<"PolyLine finished"<<std::endl;
+    content<<"Q\n";
+
+    job.rect_.ll_.x_ -= max_width / 2;
+    job.rect_.ll_.y_ -= max_width / 2;
+    job.rect_.ur_.x_ += max_width / 2;
+    job.rect_.ur_.y_ += max_width / 2;
+
+    job.content_ = content.str();
+    job.ok_ = true;
+}
+
+static void *preparePagesThread(void *data)
+{
+    const PageJobs *page_jobs = static_cast<const PageJobs *>(data);
+    std::vector<PageJob> &jobs = *page_jobs->jobs_;
+
+    // pages are interleaved between the threads, so no locking is needed
+    for (std::vector<PageJob>::size_type i = page_jobs->thread_; i < jobs.size(); i += page_jobs->threads_) {
+        preparePage(jobs[i], page_jobs->transformer_, page_jobs->tolerance_);
+    }
+
+    return 0;
+}
+
+static void preparePages(std::vector<PageJob> &jobs, PFunc_DeviceCoorTransformer transformer, double tolerance, int threads)
+{
+    if (threads <= 0) {
+        threads = PAUtil::getProcessorCount();
+    }
+    if (static_cast<std::vector<PageJob>::size_type>(threads) > jobs.size()) {
+        threads = static_cast<int>(jobs.size());
+    }
+    if (!threads) {
+        return;
+    }
+
+    std::vector<PageJobs> page_jobs(threads);
+    for (int i = 0; i < threads; i++) {
+        page_jobs[i].jobs_ = &jobs;
+        page_jobs[i].transformer_ = transformer;
+        page_jobs[i].tolerance_ = tolerance;
+        page_jobs[i].threads_ = threads;
+        page_jobs[i].thread_ = i;
+    }
+
+    // the calling thread is a worker, too
+    std::vector<pthread_t> thread_ids;
+    for (int i = 1; i < threads; i++) {
+        pthread_t thread_id;
+        if (pthread_create(&thread_id, 0, preparePagesThread, &page_jobs[i]) == 0) {
+            thread_ids.push_back(thread_id);
+        }
+        else {
+            preparePagesThread(&page_jobs[i]);
+        }
+    }
+
+    preparePagesThread(&page_jobs[0]);
+
+    for (std::vector<pthread_t>::iterator it = thread_ids.begin(); it != thread_ids.end(); it++) {
+        pthread_join(*it, 0);
+    }
+}
+
+static bool createAnnotationInk(PoDoFo::PdfDocument *document, PoDoFo::PdfExtGState *extGState,
+        PoDoFo::PdfStreamCompressor &compressor, const PageJob &job)
+{
+    assert(document && extGState && job.page_);
+
+    using namespace PoDoFo;
+
+    const PARect &rect = job.rect_;
+    PdfRect pdf_rect(rect.ll_.x_, rect.ll_.y_, rect.getWidth(), rect.getHeight());
+
+    PdfAnnotation *annot_ink = job.page_->CreateAnnotation(ePdfAnnotation_Ink, pdf_rect);
+    annot_ink->SetColor(128, 0, 0);
+
+    PdfArray ink_list;
+    const std::vector<PageScribble::Stroke> &strokes = job.scribble_->strokes_;
+    for (std::vector<PageScribble::Stroke>::const_iterator it = strokes.begin(); it != strokes.end(); it++) {
+        PdfArray path;
+        for (std::vector<PAPoint>::const_iterator pit = it->points_.begin(); pit != it->points_.end(); ++pit) {
+            path.push_back(pit->x_);
+            path.push_back(pit->y_);
+        }
+        ink_list.push_back(path);
+    }
+    annot_ink->GetObject()->GetDictionary().AddKey(PdfName("InkList"), ink_list);
+
+    // all strokes of the page in one appearance stream
+    PdfXObject xobj(pdf_rect, document);
+
+    PdfDictionary ext_g_states;
+    ext_g_states.AddKey(PdfName("GS0"), extGState->GetObject()->Reference());
+    xobj.GetResources()->GetDictionary().AddKey(PdfName("ExtGState"), ext_g_states);
+
+    compressor.AddData(xobj.GetContentsForAppending(), job.content_.data(), job.content_.length());
 
-    annot_polyline->SetAppearanceStream(xobj);
+    annot_ink->SetAppearanceStream(&xobj);
 
     return true;
 }
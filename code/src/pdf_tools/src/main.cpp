@@ -1,5 +1,7 @@
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 #include <string>
 #include <iostream>
@@ -13,17 +15,54 @@
 
 using namespace pdfanno;
 
+struct ExportOptions {
+    int threads_;
+    double tolerance_;
+    int benchStrokes_;   // strokes per page for the benchmark, 0 exports the device's scribbles
+
+    ExportOptions()
+        : threads_(0), tolerance_(-1.0), benchStrokes_(0)
+    {
+    }
+};
+
 void printUsage()
 {
-    std::cout<<"app xxx.pdf"<<std::endl;
+    std::cout<<"app [-j threads] [-t tolerance] [-b strokes] xxx.pdf"<<std::endl;
+    std::cout<<"    -j threads   number of threads, 0 uses one per processor (default)"<<std::endl;
+    std::cout<<"    -t tolerance drop points closer than tolerance to a stroke, 0 keeps all points"<<std::endl;
+    std::cout<<"    -b strokes   benchmark: scribble this many generated strokes on every page"<<std::endl;
+}
+
+// strokes like handwriting: 200 points per stroke, most of them on almost straight lines
+static void createBenchScribbles(int numPages, int numStrokes, std::vector<PageScribble> &pageScribbles)
+{
+    pageScribbles.resize(numPages);
+    for (int page = 0; page < numPages; page++) {
+        pageScribbles[page].page_ = page;
+        pageScribbles[page].strokes_.reserve(numStrokes);
+
+        std::vector<PAPoint> points(200);
+        for (int stroke = 0; stroke < numStrokes; stroke++) {
+            const double x = 50 + (stroke % 10) * 50;
+            const double y = 50 + (stroke / 10 % 14) * 50;
+            for (std::vector<PAPoint>::size_type i = 0; i < points.size(); i++) {
+                points[i] = PAPoint(x + i * 0.2, y + 10 * sin(i * 0.05 + stroke));
+            }
+
+            pageScribbles[page].strokes_.push_back(PageScribble::Stroke(points, 1.0 + stroke % 3));
+        }
+    }
 }
 
-bool testCombinePageScribbles(std::string docPath)
+bool testCombinePageScribbles(std::string docPath, const ExportOptions &options)
 {
+    const double start = PAUtil::getTime();
+
     std::vector<PageScribble> page_scribbles;
 
     DeviceScribbleReader device_reader;
-    if (!device_reader.getDocumentScribbles(docPath, page_scribbles)) {
+    if (!options.benchStrokes_ && !device_reader.getDocumentScribbles(docPath, page_scribbles)) {
         return false;
     }
 
@@ -36,12 +75,23 @@ bool testCombinePageScribbles(std::string docPath)
         return false;
     }
 
+    annot_writer->setThreadCount(options.threads_);
+    if (options.tolerance_ >= 0) {
+        annot_writer->setSimplifyTolerance(options.tolerance_);
+    }
+
     if (!annot_writer->openPDF(docPath)) {
         return false;
     }
 
+    if (options.benchStrokes_) {
+        createBenchScribbles(annot_writer->getPageCount(), options.benchStrokes_, page_scribbles);
+    }
+
+    const double read = PAUtil::getTime();
+
     std::cout<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<std::endl;
-    if (device_reader.getTransformer()) {
+    if (!options.benchStrokes_ && device_reader.getTransformer()) {
         if (!annot_writer->writeScribbles(page_scribbles, device_reader.getTransformer())) {
             return false;
         }
@@ -52,25 +102,51 @@ bool testCombinePageScribbles(std::string docPath)
         }
     }
 
+    const double written = PAUtil::getTime();
+
     std::cout<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<std::endl;
     if (!annot_writer->saveAs(PAUtil::getSaveAsPath(docPath))) {
         return false;
     }
 
+    const double saved = PAUtil::getTime();
+
     std::cout<<"["<<__FILE__<<", "<<__func__<<", "<<__LINE__<<"]"<<std::endl;
+    std::cout<<"read: "<<(read - start)<<" s, scribbles: "<<(written - read)<<" s, save: "<<(saved - written)<<
+            " s, total: "<<(saved - start)<<" s"<<std::endl;
 
     return true;
 }
 
 int main(int argc, char** argv)
 {
-    if (argc != 2) {
+    ExportOptions options;
+    std::string doc_path;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            options.threads_ = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            options.tolerance_ = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            options.benchStrokes_ = atoi(argv[++i]);
+        }
+        else if (doc_path.empty() && argv[i][0] != '-') {
+            doc_path = std::string(argv[i]);
+        }
+        else {
+            printUsage();
+            return -1;
+        }
+    }
+
+    if (doc_path.empty()) {
         printUsage();
         return -1;
     }
 
-    std::string doc_path = std::string(argv[1]);
-    if (!testCombinePageScribbles(doc_path)) {
+    if (!testCombinePageScribbles(doc_path, options)) {
         return -1;
     }
 
@@ -21,6 +21,7 @@
 /* #undef PODOFO_HAVE_WINSOCK2_H */
 /* #undef PODOFO_HAVE_MEM_H */
 /* #undef PODOFO_HAVE_CTYPE_H */
+#define PODOFO_HAVE_SYS_MMAN_H 1
 
 /* Integer types - headers */
 #define PODOFO_HAVE_STDINT_H 1
@@ -198,6 +198,93 @@ private:
 };
 
 
+/** The end of the filter chain of a PdfFilteredInputStream.
+ *
+ *  Decoded data is copied directly into the buffer of the
+ *  current Read() call. Data that does not fit into it is
+ *  kept for the next call.
+ */
+class PdfDecodeTarget : public PdfOutputStream {
+ public:
+    PdfDecodeTarget()
+        : m_pBuffer( NULL ), m_lLen( 0 ), m_lWritten( 0 ), m_lOverflowPos( 0 ), m_bDiscard( false )
+    {
+    }
+
+    /** Write all following data to this buffer
+     */
+    void SetBuffer( char* pBuffer, pdf_long lLen )
+    {
+        m_pBuffer  = pBuffer;
+        m_lLen     = lLen;
+        m_lWritten = 0;
+    }
+
+    /** Drop all data written from now on
+     */
+    void Discard()
+    {
+        m_bDiscard = true;
+    }
+
+    inline bool IsFull() const { return m_lWritten == m_lLen; }
+
+    inline pdf_long GetWritten() const { return m_lWritten; }
+
+    /** Copy data that did not fit into the last buffer
+     *
+     *  \returns the number of bytes copied to pBuffer
+     */
+    pdf_long TakeOverflow( char* pBuffer, pdf_long lLen )
+    {
+        lLen = PDF_MIN( lLen, static_cast<pdf_long>(m_overflow.size()) - m_lOverflowPos );
+        if( lLen > 0 ) 
+        {
+            memcpy( pBuffer, &(m_overflow[m_lOverflowPos]), lLen );
+            m_lOverflowPos += lLen;
+        }
+
+        if( m_lOverflowPos == static_cast<pdf_long>(m_overflow.size()) ) 
+        {
+            m_overflow.clear();
+            m_lOverflowPos = 0;
+        }
+
+        return lLen;
+    }
+
+    virtual pdf_long Write( const char* pBuffer, pdf_long lLen )
+    {
+        if( m_bDiscard ) 
+            return lLen;
+
+        pdf_long lCopy = PDF_MIN( lLen, m_lLen - m_lWritten );
+        if( lCopy > 0 ) 
+        {
+            memcpy( m_pBuffer + m_lWritten, pBuffer, lCopy );
+            m_lWritten += lCopy;
+        }
+
+        if( lCopy < lLen ) 
+            m_overflow.insert( m_overflow.end(), pBuffer + lCopy, pBuffer + lLen );
+
+        return lLen;
+    }
+
+    virtual void Close() 
+    {
+    }
+
+ private:
+    char*             m_pBuffer;
+    pdf_long          m_lLen;
+    pdf_long          m_lWritten;
+
+    std::vector<char> m_overflow;
+    pdf_long          m_lOverflowPos;
+    bool              m_bDiscard;
+};
+
 // -----------------------------------------------------
 // Actual PdfFilter code
 // -----------------------------------------------------
@@ -423,4 +510,144 @@ TVecFilters PdfFilterFactory::CreateFilterList( const PdfObject* pObject )
     return filters;
 }
 
+// -----------------------------------------------------
+// PdfFilteredInputStream code
+// -----------------------------------------------------
+
+PdfFilteredInputStream::PdfFilteredInputStream( PdfInputStream* pInputStream, const TVecFilters & filters,
+                                                const PdfDictionary* pDictionary )
+    : m_pInputStream( pInputStream ), m_pData( NULL ), m_lDataLen( 0 ), m_lDataPos( 0 )
+{
+    this->Init( filters, pDictionary );
+}
+
+PdfFilteredInputStream::PdfFilteredInputStream( const char* pBuffer, pdf_long lLen, const TVecFilters & filters,
+                                                const PdfDictionary* pDictionary )
+    : m_pInputStream( NULL ), m_pData( pBuffer ), m_lDataLen( lLen ), m_lDataPos( 0 )
+{
+    this->Init( filters, pDictionary );
+}
+
+void PdfFilteredInputStream::Init( const TVecFilters & filters, const PdfDictionary* pDictionary )
+{
+    m_pTarget       = NULL;
+    m_pDecodeStream = NULL;
+    m_pBlock        = NULL;
+    m_bEof          = false;
+
+    if( !filters.size() ) 
+        return;
+
+    m_pTarget       = new PdfDecodeTarget();
+    try {
+        m_pDecodeStream = PdfFilterFactory::CreateDecodeStream( filters, m_pTarget, pDictionary );
+    } catch( PdfError & e ) {
+        delete m_pTarget;
+        e.AddToCallstack( __FILE__, __LINE__ );
+        throw e;
+    }
+
+    if( m_pInputStream ) 
+    {
+        m_pBlock = static_cast<char*>(podofo_malloc( PODOFO_FILTER_INTERNAL_BUFFER_SIZE ));
+        if( !m_pBlock ) 
+        {
+            delete m_pDecodeStream;
+            delete m_pTarget;
+            PODOFO_RAISE_ERROR( ePdfError_OutOfMemory );
+        }
+    }
+}
+
+PdfFilteredInputStream::~PdfFilteredInputStream()
+{
+    if( m_pDecodeStream && !m_bEof ) 
+    {
+        // The filters have to be finished before they can be deleted,
+        // even if the caller was only interested in the first bytes.
+        m_pTarget->Discard();
+        try {
+            m_pDecodeStream->Close();
+        } catch( const PdfError & ) {
+            // Errors in data nobody is going to read are not of interest
+        }
+    }
+
+    delete m_pDecodeStream;
+    delete m_pTarget;
+    podofo_free( m_pBlock );
+}
+
+bool PdfFilteredInputStream::DecodeNextBlock()
+{
+    if( m_bEof ) 
+        return false;
+
+    const char* pBlock;
+    pdf_long    lLen;
+    if( m_pInputStream ) 
+    {
+        pBlock = m_pBlock;
+        lLen   = m_pInputStream->Read( m_pBlock, PODOFO_FILTER_INTERNAL_BUFFER_SIZE );
+    }
+    else
+    {
+        pBlock      = m_pData + m_lDataPos;
+        lLen        = PDF_MIN( static_cast<pdf_long>(PODOFO_FILTER_INTERNAL_BUFFER_SIZE), m_lDataLen - m_lDataPos );
+        m_lDataPos += lLen;
+    }
+
+    try {
+        if( lLen > 0 ) 
+            m_pDecodeStream->Write( pBlock, lLen );
+        else
+        {
+            // Flush the data the filters still hold
+            m_bEof = true;
+            m_pDecodeStream->Close();
+        }
+    } catch( PdfError & e ) {
+        // The filters have cleaned up already
+        m_bEof = true;
+        e.AddToCallstack( __FILE__, __LINE__ );
+        throw e;
+    }
+
+    return true;
+}
+
+pdf_long PdfFilteredInputStream::Read( char* pBuffer, pdf_long lLen )
+{
+    if( !pBuffer ) 
+    {
+        PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
+    }
+
+    if( !m_pDecodeStream ) 
+    {
+        // No filters, the data is passed through unchanged
+        if( m_pInputStream ) 
+            return m_pInputStream->Read( pBuffer, lLen );
+
+        lLen = PDF_MIN( lLen, m_lDataLen - m_lDataPos );
+        memcpy( pBuffer, m_pData + m_lDataPos, lLen );
+        m_lDataPos += lLen;
+        return lLen;
+    }
+
+    // Data left over from the last block comes first
+    pdf_long lRead = m_pTarget->TakeOverflow( pBuffer, lLen );
+    if( lRead == lLen ) 
+        return lRead;
+
+    m_pTarget->SetBuffer( pBuffer + lRead, lLen - lRead );
+    while( !m_pTarget->IsFull() && this->DecodeNextBlock() )
+        ;
+
+    lRead += m_pTarget->GetWritten();
+    m_pTarget->SetBuffer( NULL, 0 );
+
+    return lRead;
+}
+
 };
@@ -35,6 +35,7 @@ class PdfDictionary;
 class PdfName;
 class PdfObject;
 class PdfOutputStream;
+class PdfDecodeTarget;
 
 typedef std::vector<EPdfFilter>            TVecFilters;
 typedef TVecFilters::iterator              TIVecFilters;
@@ -497,6 +498,72 @@ class PODOFO_API PdfFilterFactory {
     static TVecFilters CreateFilterList( const PdfObject* pObject );
 };
 
+/** A PdfInputStream that decodes data on demand.
+ *
+ *  Encoded data is pushed in small blocks through a chain of filters
+ *  only as far as needed to fill the buffer passed to Read(). Decoded
+ *  data is written directly into this buffer, so a stream can be decoded
+ *  without holding the whole result in memory, and decoding the first
+ *  bytes of a large stream is cheap.
+ */
+class PODOFO_API PdfFilteredInputStream : public PdfInputStream {
+ public:
+    /** Decode data read from another input stream.
+     *
+     *  \param pInputStream read encoded data from this stream,
+     *                      it is not owned by the PdfFilteredInputStream
+     *  \param filters a list of filters to decode the data, may be empty
+     *  \param pDictionary a dictionary that might contain a DecodeParms key
+     *
+     *  \see PdfFilterFactory::CreateDecodeStream
+     */
+    PdfFilteredInputStream( PdfInputStream* pInputStream, const TVecFilters & filters,
+                            const PdfDictionary* pDictionary = NULL );
+
+    /** Decode data from a buffer in memory.
+     *
+     *  \param pBuffer encoded data, it is not copied and
+     *                 has to stay valid as long as this stream
+     *  \param lLen length of pBuffer
+     *  \param filters a list of filters to decode the data, may be empty
+     *  \param pDictionary a dictionary that might contain a DecodeParms key
+     */
+    PdfFilteredInputStream( const char* pBuffer, pdf_long lLen, const TVecFilters & filters,
+                            const PdfDictionary* pDictionary = NULL );
+
+    virtual ~PdfFilteredInputStream();
+
+    /** Decode data into a buffer.
+     *
+     *  \param pBuffer decoded data is written to this buffer
+     *  \param lLen read up to lLen bytes
+     *
+     *  \returns the number of bytes read, which is less than lLen
+     *            only at the end of the decoded data
+     */
+    virtual pdf_long Read( char* pBuffer, pdf_long lLen );
+
+ private:
+    void Init( const TVecFilters & filters, const PdfDictionary* pDictionary );
+
+    /** Push the next block of encoded data through the filters.
+     *
+     *  \returns false if all data has been decoded before
+     */
+    bool DecodeNextBlock();
+
+ private:
+    PdfInputStream*  m_pInputStream;
+    const char*      m_pData;
+    pdf_long         m_lDataLen;
+    pdf_long         m_lDataPos;
+
+    PdfDecodeTarget* m_pTarget;        ///< receives the output of the last filter
+    PdfOutputStream* m_pDecodeStream;  ///< first filter of the chain or NULL
+    char*            m_pBlock;         ///< buffer for blocks read from m_pInputStream
+    bool             m_bEof;
+};
+
 
 };
 
@@ -243,6 +243,8 @@ void PdfHexFilter::BeginDecodeImpl( const PdfDictionary* )
 void PdfHexFilter::DecodeBlockImpl( const char* pBuffer, pdf_long lLen )
 {
     char val;
+    char out[PODOFO_FILTER_INTERNAL_BUFFER_SIZE];
+    int  nOut = 0;
 
     while( lLen-- ) 
     {
@@ -263,11 +265,20 @@ void PdfHexFilter::DecodeBlockImpl( const char* pBuffer, pdf_long lLen )
             m_cDecodedByte = ((m_cDecodedByte << 4) | val);
             m_bLow         = true;
 
-            GetStream()->Write( &m_cDecodedByte, 1 );
+            // Collect the decoded bytes instead of writing them one by one
+            out[nOut++] = m_cDecodedByte;
+            if( nOut == PODOFO_FILTER_INTERNAL_BUFFER_SIZE ) 
+            {
+                GetStream()->Write( out, nOut );
+                nOut = 0;
+            }
         }
 
         ++pBuffer;
     }
+
+    if( nOut ) 
+        GetStream()->Write( out, nOut );
 }
 
 void PdfHexFilter::EndDecodeImpl()
@@ -609,31 +620,49 @@ void PdfRLEFilter::EndEncodeImpl()
 void PdfRLEFilter::BeginDecodeImpl( const PdfDictionary* )
 { 
     m_nCodeLen = 0;
+    m_bEod     = false;
 }
 
 void PdfRLEFilter::DecodeBlockImpl( const char* pBuffer, pdf_long lLen )
 {
-    while( lLen-- )
+    char run[128];
+
+    // m_nCodeLen > 0: number of bytes left to copy
+    // m_nCodeLen < 0: the next byte is repeated -m_nCodeLen times
+    // m_nCodeLen = 0: the next byte is a length byte
+    while( lLen && !m_bEod )
     {
-        if( !m_nCodeLen )
+        if( m_nCodeLen > 0 )
         {
-            m_nCodeLen = static_cast<int>(*pBuffer);
-        } else if( m_nCodeLen == 128 )
-            break;
-        else if( m_nCodeLen <= 127 )
-        {
-            GetStream()->Write( pBuffer, 1 );
-            m_nCodeLen--;
+            pdf_long lCopy = PDF_MIN( static_cast<pdf_long>(m_nCodeLen), lLen );
+            GetStream()->Write( pBuffer, lCopy );
+
+            m_nCodeLen -= static_cast<int>(lCopy);
+            pBuffer    += lCopy;
+            lLen       -= lCopy;
+            continue;
         }
-        else if( m_nCodeLen >= 129 )
+        
+        if( m_nCodeLen < 0 )
         {
-            m_nCodeLen = 257 - m_nCodeLen;
+            memset( run, *pBuffer, -m_nCodeLen );
+            GetStream()->Write( run, -m_nCodeLen );
 
-            while( m_nCodeLen-- ) 
-                GetStream()->Write( pBuffer, 1 );
+            m_nCodeLen = 0;
+        }
+        else
+        {
+            int nLength = static_cast<unsigned char>(*pBuffer);
+            if( nLength == 128 )
+                m_bEod = true;
+            else if( nLength < 128 )
+                m_nCodeLen = nLength + 1;
+            else
+                m_nCodeLen = nLength - 257;
         }
 
         ++pBuffer;
+        --lLen;
     }
 }
 
@@ -739,6 +768,8 @@ void PdfLZWFilter::DecodeBlockImpl( const char* pBuffer, pdf_long lLen )
             }
             else 
             {
+                // Known codes are written straight from the table
+                const std::vector<unsigned char>* pData;
                 if( code >= m_table.size() )
                 {
                     if (old >= m_table.size())
@@ -747,22 +778,24 @@ void PdfLZWFilter::DecodeBlockImpl( const char* pBuffer, pdf_long lLen )
                     }
                     data = m_table[old].value;
                     data.push_back( m_character );
+                    pData = &data;
                 }
                 else
-                    data = m_table[code].value;
+                    pData = &(m_table[code].value);
 
                 // Write data to the output device
                 if( m_pPredictor ) 
-                    m_pPredictor->Decode( reinterpret_cast<char*>(&(data[0])), data.size(), GetStream() );
+                    m_pPredictor->Decode( reinterpret_cast<const char*>(&((*pData)[0])), pData->size(), GetStream() );
                 else
-                    GetStream()->Write( reinterpret_cast<char*>(&(data[0])), data.size());
+                    GetStream()->Write( reinterpret_cast<const char*>(&((*pData)[0])), pData->size());
 
-                m_character = data[0];
+                m_character = (*pData)[0];
                 if( old < m_table.size() ) // fix the first loop
-                    data = m_table[old].value;
-                data.push_back( m_character );
+                    item.value = m_table[old].value;
+                else
+                    item.value = *pData;
+                item.value.push_back( m_character );
 
-                item.value = data;
                 m_table.push_back( item );
 
                 old = code;
@@ -511,7 +511,8 @@ class PdfRLEFilter : public PdfFilter {
     inline virtual EPdfFilter GetType() const;
 
  private:
-    int m_nCodeLen;
+    int  m_nCodeLen;
+    bool m_bEod;
 };
 
 // -----------------------------------------------------
@@ -0,0 +1,369 @@
+/***************************************************************************
+ *   Copyright (C) 2006 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "PdfHintStream.h"
+
+#include "PdfDefinesPrivate.h"
+
+#include "PdfDictionary.h"
+#include "PdfObject.h"
+#include "PdfStream.h"
+#include "PdfVariant.h"
+
+using namespace PoDoFo;
+
+namespace {
+
+/** \returns the number of bits required to write val
+ */
+pdf_uint16 GetBitCount( pdf_uint64 val )
+{
+    pdf_uint16 nBits = 0;
+    while( val )
+    {
+        ++nBits;
+        val >>= 1;
+    }
+
+    return nBits;
+}
+
+class PdfPageOffsetHeader {
+public:
+    PdfPageOffsetHeader()
+        : nLeastNumberOfObjects( 0 ),
+          nFirstPageObject( 0 ),
+          nBitsPageObject( 0 ),
+          nLeastPageLength( 0 ),
+          nBitsPageLength( 0 ),
+          nOffsetContentStream( 0 ),
+          nBitsContentStream( 0 ),
+          nLeastContentStreamLength( 0 ),
+          nBitsLeastContentStreamLength( 0 ),
+          nBitsNumSharedObjects( 0 ),
+          nBitsGreatestSharedObject( 0 ),
+          nItem12( 0 ),
+          nItem13( 0 )
+    {
+
+    }
+
+    // item1: The least number of objects in a page including the page itself
+    pdf_uint32 nLeastNumberOfObjects;
+    // item2: The location of the first pages page object
+    pdf_uint32 nFirstPageObject;
+    // item3: The number of bits needed to represent the difference between the 
+    //        greatest and least number of objects in a page
+    pdf_uint16 nBitsPageObject;
+    // item4: The least length of a page in bytes
+    pdf_uint32 nLeastPageLength;
+    // item5: The number of bits needed to represent the greatest difference 
+    //        between the greatest and the least length of a page in bytes
+    pdf_uint16 nBitsPageLength;
+    // item6: The least offset of the start of a content stream, relative
+    //        to the beginning of a file. 
+    // --> Always set to 0 by acrobat
+    pdf_uint32 nOffsetContentStream;
+    // item7: The number of bits needed to represent the greatest difference 
+    //        between the greatest and the least offset of a the start of a content
+    //        stream relative to the beginning of a file
+    // --> Always set to 0 by acrobat
+    pdf_uint16 nBitsContentStream;
+    // item8: The least content stream length
+    pdf_uint32 nLeastContentStreamLength;
+    // item9: The number of bits needed to represent the greatest difference 
+    //        between the greatest and the least length of a content stream
+    pdf_uint16 nBitsLeastContentStreamLength;
+    // item10: The number of bits needed to represent the greatest number
+    //         of shared object references.
+    pdf_uint16 nBitsNumSharedObjects;
+    // item11: The number of bits needed to represent the nummerically 
+    //         greatest shared object identifyer used by pages
+    pdf_uint16 nBitsGreatestSharedObject;
+    // item12: The number of bits needed to represent the numerator of 
+    //         the fractional position for each shared object reference
+    pdf_uint16 nItem12;
+    // item13: The denominator of the fractional position
+    pdf_uint16 nItem13;
+
+    void Write( PoDoFo::NonPublic::PdfHintStream* pHint )
+    {
+        pHint->WriteUInt32( nLeastNumberOfObjects );
+        pHint->WriteUInt32( nFirstPageObject );
+        pHint->WriteUInt16( nBitsPageObject );
+        pHint->WriteUInt32( nLeastPageLength );
+        pHint->WriteUInt16( nBitsPageLength );
+        pHint->WriteUInt32( nOffsetContentStream );
+        pHint->WriteUInt16( nBitsContentStream );
+        pHint->WriteUInt32( nLeastContentStreamLength );
+        pHint->WriteUInt16( nBitsLeastContentStreamLength );
+        pHint->WriteUInt16( nBitsNumSharedObjects );
+        pHint->WriteUInt16( nBitsGreatestSharedObject );
+        pHint->WriteUInt16( nItem12 );
+        pHint->WriteUInt16( nItem13 );
+    }
+
+};
+
+class PdfSharedObjectHeader {
+public:
+    PdfSharedObjectHeader() 
+        : nFirstObjectNumber( 0 ),
+          nFirstObjectLocation( 0 ),
+          nNumSharedObjectsFirstPage( 0 ),
+          nNumSharedObjects( 0 ),
+          nNumBits( 0 ),
+          nLeastLength( 0 ),
+          nNumBitsLengthDifference( 0 )
+    {
+    }
+
+    pdf_uint32 nFirstObjectNumber;
+    pdf_uint32 nFirstObjectLocation;
+    pdf_uint32 nNumSharedObjectsFirstPage;
+    pdf_uint32 nNumSharedObjects; // i.e. including nNumSharedObjectsFirstPage
+    pdf_uint16 nNumBits;
+    pdf_uint32 nLeastLength;
+    pdf_uint16 nNumBitsLengthDifference;
+
+public:
+    void Write( PoDoFo::NonPublic::PdfHintStream* pHint )
+    {
+        pHint->WriteUInt32( nFirstObjectNumber );
+        pHint->WriteUInt32( nFirstObjectLocation );
+        pHint->WriteUInt32( nNumSharedObjectsFirstPage );
+        pHint->WriteUInt32( nNumSharedObjects );
+        pHint->WriteUInt16( nNumBits );
+        pHint->WriteUInt32( nLeastLength );
+        pHint->WriteUInt16( nNumBitsLengthDifference );
+    }
+};
+
+}; // end anon namespace
+
+namespace PoDoFo {
+
+namespace NonPublic {
+
+PdfHintStream::PdfHintStream( PdfObject* pObject )
+    : m_pObject( pObject ), m_cByte( 0 ), m_nBits( 0 )
+{
+}
+
+PdfHintStream::~PdfHintStream()
+{
+}
+
+void PdfHintStream::Create( const TLinearizedLayout & rLayout, pdf_objnum nFirstShared )
+{
+    m_sData.clear();
+    m_cByte = 0;
+    m_nBits = 0;
+
+    this->CreatePageHintTable( rLayout );
+
+    // The offset of the shared object hint table in the decoded stream
+    m_pObject->GetDictionary().AddKey( "S", PdfVariant( static_cast<pdf_int64>(m_sData.length()) ) );
+
+    this->CreateSharedObjectHintTable( rLayout, nFirstShared );
+
+    PdfStream* pStream = m_pObject->GetStream();
+    pStream->BeginAppend();
+    pStream->Append( m_sData.data(), m_sData.length() );
+    pStream->EndAppend();
+}
+
+void PdfHintStream::CreatePageHintTable( const TLinearizedLayout & rLayout )
+{
+    const std::vector<TLinearizedPage> & rPages   = rLayout.vecPages;
+    const std::vector<pdf_uint64>      & rOffsets = rLayout.vecOffsets;
+    PODOFO_RAISE_LOGIC_IF( rPages.empty() || rPages.front().nCount != rLayout.nOtherPages - rLayout.nFirstPage,
+                           "The first page has to own all objects between the first and the other pages." );
+
+    std::vector<pdf_uint64> vecLengths( rPages.size() );
+    pdf_uint64 lMinLength  = 0;
+    pdf_uint64 lMaxLength  = 0;
+    size_t     nMinObjects = 0;
+    size_t     nMaxObjects = 0;
+    size_t     nMaxShared  = 0;
+    size_t     nMaxId      = 0;
+    size_t     i, j;
+
+    for( i=0;i<rPages.size();i++ )
+    {
+        const TLinearizedPage & rPage = rPages[i];
+
+        vecLengths[i] = rOffsets[rPage.nFirst + rPage.nCount] - rOffsets[rPage.nFirst];
+        if( !i || vecLengths[i] < lMinLength )
+            lMinLength = vecLengths[i];
+        if( !i || vecLengths[i] > lMaxLength )
+            lMaxLength = vecLengths[i];
+
+        if( !i || rPage.nCount < nMinObjects )
+            nMinObjects = rPage.nCount;
+        if( !i || rPage.nCount > nMaxObjects )
+            nMaxObjects = rPage.nCount;
+
+        if( rPage.vecShared.size() > nMaxShared )
+            nMaxShared = rPage.vecShared.size();
+        for( j=0;j<rPage.vecShared.size();j++ )
+        {
+            size_t nId = this->GetSharedId( rLayout, rPage.vecShared[j] );
+            if( nId > nMaxId )
+                nMaxId = nId;
+        }
+    }
+
+    PdfPageOffsetHeader header;
+    header.nLeastNumberOfObjects         = static_cast<pdf_uint32>(nMinObjects);
+    header.nFirstPageObject              = static_cast<pdf_uint32>(rOffsets[rLayout.nFirstPage]);
+    header.nBitsPageObject               = GetBitCount( nMaxObjects - nMinObjects );
+    header.nLeastPageLength              = static_cast<pdf_uint32>(lMinLength);
+    header.nBitsPageLength               = GetBitCount( lMaxLength - lMinLength );
+    // Like Acrobat we do not give the offsets of the content streams
+    // and use the page length as content stream length
+    header.nOffsetContentStream          = 0;
+    header.nBitsContentStream            = 0;
+    header.nLeastContentStreamLength     = header.nLeastPageLength;
+    header.nBitsLeastContentStreamLength = header.nBitsPageLength;
+    header.nBitsNumSharedObjects         = GetBitCount( nMaxShared );
+    header.nBitsGreatestSharedObject     = GetBitCount( nMaxId );
+    header.nItem12                       = 0;
+    header.nItem13                       = 1;
+    header.Write( this );
+
+    // Each item is written for all pages before the next item
+    for( i=0;i<rPages.size();i++ )
+        this->WriteBits( static_cast<pdf_uint32>(rPages[i].nCount - nMinObjects), header.nBitsPageObject );
+    this->Flush();
+
+    for( i=0;i<rPages.size();i++ )
+        this->WriteBits( static_cast<pdf_uint32>(vecLengths[i] - lMinLength), header.nBitsPageLength );
+    this->Flush();
+
+    for( i=0;i<rPages.size();i++ )
+        this->WriteBits( static_cast<pdf_uint32>(rPages[i].vecShared.size()), header.nBitsNumSharedObjects );
+    this->Flush();
+
+    for( i=0;i<rPages.size();i++ )
+        for( j=0;j<rPages[i].vecShared.size();j++ )
+            this->WriteBits( static_cast<pdf_uint32>(this->GetSharedId( rLayout, rPages[i].vecShared[j] )), 
+                             header.nBitsGreatestSharedObject );
+    this->Flush();
+
+    // The numerators and the content stream offsets use no bits,
+    // so only the content stream lengths are left
+    for( i=0;i<rPages.size();i++ )
+        this->WriteBits( static_cast<pdf_uint32>(vecLengths[i] - lMinLength), header.nBitsLeastContentStreamLength );
+    this->Flush();
+}
+
+void PdfHintStream::CreateSharedObjectHintTable( const TLinearizedLayout & rLayout, pdf_objnum nFirstShared )
+{
+    const std::vector<pdf_uint64> & rOffsets = rLayout.vecOffsets;
+
+    // Every object of the first page and every shared object is a group of its own
+    std::vector<pdf_uint64> vecLengths;
+    size_t i;
+
+    for( i=rLayout.nFirstPage;i<rLayout.nOtherPages;i++ )
+        vecLengths.push_back( rOffsets[i+1] - rOffsets[i] );
+    for( i=rLayout.nShared;i<rLayout.nOther;i++ )
+        vecLengths.push_back( rOffsets[i+1] - rOffsets[i] );
+
+    pdf_uint64 lMinLength = 0;
+    pdf_uint64 lMaxLength = 0;
+    for( i=0;i<vecLengths.size();i++ )
+    {
+        if( !i || vecLengths[i] < lMinLength )
+            lMinLength = vecLengths[i];
+        if( !i || vecLengths[i] > lMaxLength )
+            lMaxLength = vecLengths[i];
+    }
+
+    PdfSharedObjectHeader header;
+    if( rLayout.nOther > rLayout.nShared ) 
+    {
+        header.nFirstObjectNumber   = static_cast<pdf_uint32>(nFirstShared);
+        header.nFirstObjectLocation = static_cast<pdf_uint32>(rOffsets[rLayout.nShared]);
+    }
+    header.nNumSharedObjectsFirstPage = static_cast<pdf_uint32>(rLayout.nOtherPages - rLayout.nFirstPage);
+    header.nNumSharedObjects          = static_cast<pdf_uint32>(vecLengths.size());
+    header.nNumBits                   = 0;
+    header.nLeastLength               = static_cast<pdf_uint32>(lMinLength);
+    header.nNumBitsLengthDifference   = GetBitCount( lMaxLength - lMinLength );
+    header.Write( this );
+
+    for( i=0;i<vecLengths.size();i++ )
+        this->WriteBits( static_cast<pdf_uint32>(vecLengths[i] - lMinLength), header.nNumBitsLengthDifference );
+    this->Flush();
+
+    // No group has a MD5 signature
+    for( i=0;i<vecLengths.size();i++ )
+        this->WriteBits( 0, 1 );
+    this->Flush();
+}
+
+size_t PdfHintStream::GetSharedId( const TLinearizedLayout & rLayout, size_t nIndex )
+{
+    if( nIndex < rLayout.nOtherPages )
+        return nIndex - rLayout.nFirstPage;
+    else
+        return nIndex - rLayout.nShared + rLayout.nOtherPages - rLayout.nFirstPage;
+}
+
+void PdfHintStream::WriteUInt16( pdf_uint16 val )
+{
+    this->Flush();
+
+    val = ::PoDoFo::compat::podofo_htons(val);
+    m_sData.append( reinterpret_cast<char*>(&val), 2 );
+}
+
+void PdfHintStream::WriteUInt32( pdf_uint32 val )
+{
+    this->Flush();
+
+    val = ::PoDoFo::compat::podofo_htonl(val);
+    m_sData.append( reinterpret_cast<char*>(&val), 4 );
+}
+
+void PdfHintStream::WriteBits( pdf_uint32 val, int nBits )
+{
+    while( nBits-- )
+    {
+        m_cByte = static_cast<unsigned char>((m_cByte << 1) | ((val >> nBits) & 1));
+        if( ++m_nBits == 8 ) 
+        {
+            m_sData.push_back( static_cast<char>(m_cByte) );
+            m_cByte = 0;
+            m_nBits = 0;
+        }
+    }
+}
+
+void PdfHintStream::Flush()
+{
+    if( m_nBits )
+        this->WriteBits( 0, 8 - m_nBits );
+}
+
+}; // end namespace PoDoFo::NonPublic
+}; // end namespace PoDoFo
@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2006 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _PDF_HINT_STREAM_H_
+#define _PDF_HINT_STREAM_H_
+
+#include "PdfDefines.h"
+#include "PdfReference.h"
+
+#include <string>
+#include <vector>
+
+namespace PoDoFo {
+
+class PdfObject;
+
+namespace NonPublic {
+
+// PdfHintStream is not part of the public API and is NOT exported as part of
+// the DLL/shared library interface. Do not rely on it.
+
+/** The objects of one page in a linearized PDF file
+ */
+struct TLinearizedPage {
+    size_t              nFirst;    ///< index of the page object in TLinearizedLayout::vecObjects
+    size_t              nCount;    ///< number of objects of the page, including the page object
+    std::vector<size_t> vecShared; ///< indices of the objects of the first page and the 
+                                   ///< shared objects used by this page
+};
+
+/** The order of the objects in a linearized PDF file and their positions.
+ *
+ *  vecObjects contains all objects in the order they are written, except
+ *  the linearization dictionary and the hint stream. It starts with
+ *  the catalog and the objects required to open the document, followed
+ *  by the objects of the first page, the objects of each other page,
+ *  the objects shared by several pages and all other objects.
+ *
+ *  The objects of the first page are numbered after all others, the 
+ *  remaining objects are numbered from 1 in the order they are written.
+ */
+struct TLinearizedLayout {
+    std::vector<PdfObject*>      vecObjects;  ///< all written objects in the order they are written
+    std::vector<PdfObject*>      vecSkipped;  ///< objects of the document which are not written
+    size_t                       nFirstPage;  ///< index of the first page object
+    size_t                       nOtherPages; ///< index of the first object after the first page
+    size_t                       nShared;     ///< index of the first shared object
+    size_t                       nOther;      ///< index of the first object not used by any page
+    std::vector<TLinearizedPage> vecPages;    ///< all pages in order
+
+    /** Offsets of all objects in vecObjects, followed by the offset of the main
+     *  XRef section, which follows the last object. As required for the hint tables
+     *  all offsets are computed as if the hint stream was not written.
+     */
+    std::vector<pdf_uint64>      vecOffsets;
+    pdf_uint64                   lFirstXRef;       ///< offset of the XRef section of the first page
+    pdf_uint64                   lFirstEntry;      ///< offset of the whitespace before the first entry of the main XRef section
+    pdf_uint64                   lLength;          ///< length of the file without the hint stream
+    size_t                       nLinearizeLength; ///< bytes reserved for the linearization dictionary
+    size_t                       nTrailerLength;   ///< bytes reserved for the trailer of the first page
+};
+
+/** The primary hint stream of a linearized PDF file. It contains 
+ *  the page offset hint table and the shared object hint table.
+ *
+ *  Each object of the first page and each shared object forms a 
+ *  shared object group of its own.
+ */
+class PdfHintStream {
+ public:
+    /** Create the hint tables in a stream object
+     *  \param pObject the hint stream object
+     */
+    PdfHintStream( PdfObject* pObject );
+    ~PdfHintStream();
+
+    /** Create the hint tables
+     *  \param rLayout the layout of the linearized file
+     *  \param nFirstShared object number of the first shared object
+     */
+    void Create( const TLinearizedLayout & rLayout, pdf_objnum nFirstShared );
+
+    /** Write a pdf_uint16 to the stream in big endian format.
+     *  \param val the value to write to the stream
+     */
+    void WriteUInt16( pdf_uint16 val );
+
+    /** Write a pdf_uint32 to the stream in big endian format.
+     *  \param val the value to write to the stream
+     */
+    void WriteUInt32( pdf_uint32 val );
+
+    /** Write the lowest bits of a value to the stream,
+     *  starting with the most significant one.
+     *  \param val the value to write to the stream
+     *  \param nBits number of bits to write
+     */
+    void WriteBits( pdf_uint32 val, int nBits );
+
+    /** Fill the current byte with zero bits, so that 
+     *  the next value starts at a byte boundary.
+     */
+    void Flush();
+
+ private:
+    void CreatePageHintTable( const TLinearizedLayout & rLayout );
+    void CreateSharedObjectHintTable( const TLinearizedLayout & rLayout, pdf_objnum nFirstShared );
+
+    /** \returns the index of an object in the shared object hint table
+     *  \param nIndex index of an object of the first page or a shared object in TLinearizedLayout::vecObjects
+     */
+    size_t GetSharedId( const TLinearizedLayout & rLayout, size_t nIndex );
+ 
+ private:
+    PdfObject*    m_pObject;
+    std::string   m_sData;
+    unsigned char m_cByte;  ///< bits written to the current byte
+    int           m_nBits;  ///< number of bits written to m_cByte
+};
+
+}; // end namespace NonPublic
+
+}; // end namespace PoDoFo
+
+#endif /* _PDF_HINT_STREAM_H_ */
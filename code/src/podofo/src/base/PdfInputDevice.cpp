@@ -25,6 +25,23 @@
 #include <sstream>
 #include "PdfDefinesPrivate.h"
 
+#include <limits>
+#include <string.h>
+
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // PODOFO_HAVE_SYS_MMAN_H
+
+/** Size of the read buffer for files and streams
+ */
+#define PDF_INPUT_BUFFER_SIZE 32768
+
+/** Size of the window of a memory mapped file,
+ *  a multiple of any page size.
+ */
+#define PDF_INPUT_MAP_SIZE 1048576
+
 namespace PoDoFo {
 
 PdfInputDevice::PdfInputDevice()
@@ -55,6 +72,13 @@ PdfInputDevice::PdfInputDevice( const char* pszFilename )
         PODOFO_RAISE_ERROR_INFO( ePdfError_FileNotFound, pszFilename );
     }
     //PdfLocaleImbue(*m_pStream);
+
+    if( !this->MapFile() )
+    {
+        // All reads go through our own buffer
+        setvbuf( m_pFile, NULL, _IONBF, 0 );
+        this->InitBuffer();
+    }
 }
 
 #ifdef _WIN32
@@ -86,6 +110,9 @@ PdfInputDevice::PdfInputDevice( const wchar_t* pszFilename )
         e.SetErrorInformation( pszFilename );
         throw e;
     }
+
+    setvbuf( m_pFile, NULL, _IONBF, 0 );
+    this->InitBuffer();
 }
 #endif
 #endif // _WIN32
@@ -99,20 +126,17 @@ PdfInputDevice::PdfInputDevice( const char* pBuffer, size_t lLen )
         PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
     }
 
-    try {
-        m_pStream = static_cast< std::istream* >( 
-            new std::istringstream( std::string( pBuffer, lLen ), std::ios::binary ) );
-        if( !m_pStream || !m_pStream->good() )
-        {
-            PODOFO_RAISE_ERROR( ePdfError_FileNotFound );
-        }
-        m_StreamOwned = true;
-    }
-    catch(...) {
-        // should probably check the exact error, but for now it's a good error
-        PODOFO_RAISE_ERROR( ePdfError_FileNotFound );
+    // The copy of the data is the read buffer,
+    // so there is never anything to refill.
+    m_pBuffer = static_cast<char*>(podofo_malloc( lLen ? lLen : 1 ));
+    if( !m_pBuffer )
+    {
+        PODOFO_RAISE_ERROR( ePdfError_OutOfMemory );
     }
-    PdfLocaleImbue(*m_pStream);
+
+    memcpy( m_pBuffer, pBuffer, lLen );
+    m_lBufferSize = lLen;
+    m_lBufferLen  = lLen;
 }
 
 PdfInputDevice::PdfInputDevice( const std::istream* pInStream )
@@ -125,6 +149,10 @@ PdfInputDevice::PdfInputDevice( const std::istream* pInStream )
         PODOFO_RAISE_ERROR( ePdfError_FileNotFound );
     }
     PdfLocaleImbue(*m_pStream);
+
+    std::streamoff lOffset = m_pStream->tellg();
+    m_lBufferOffset = lOffset < 0 ? 0 : lOffset;
+    this->InitBuffer();
 }
 
 PdfInputDevice::~PdfInputDevice()
@@ -138,6 +166,16 @@ PdfInputDevice::~PdfInputDevice()
 			if (m_pFile)
 				fclose(m_pFile);
     }
+
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+    if( m_bMapped )
+    {
+        if( m_pBuffer )
+            munmap( m_pBuffer, m_lBufferSize );
+    }
+    else
+#endif // PODOFO_HAVE_SYS_MMAN_H
+        podofo_free( m_pBuffer );
 }
 
 void PdfInputDevice::Init()
@@ -146,6 +184,97 @@ void PdfInputDevice::Init()
 		m_pFile = 0;
     m_StreamOwned = false;
     m_bIsSeekable = true;
+
+    m_pBuffer       = NULL;
+    m_lBufferSize   = 0;
+    m_lBufferLen    = 0;
+    m_lBufferPos    = 0;
+    m_lBufferOffset = 0;
+    m_bEof          = false;
+    m_bMapped       = false;
+    m_lFileSize     = 0;
+}
+
+void PdfInputDevice::InitBuffer()
+{
+    m_pBuffer = static_cast<char*>(podofo_malloc( PDF_INPUT_BUFFER_SIZE ));
+    if( !m_pBuffer )
+    {
+        PODOFO_RAISE_ERROR( ePdfError_OutOfMemory );
+    }
+
+    m_lBufferSize = PDF_INPUT_BUFFER_SIZE;
+}
+
+bool PdfInputDevice::MapFile()
+{
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+    struct stat st;
+    if( fstat( fileno( m_pFile ), &st ) != 0 || st.st_size <= 0 ||
+        static_cast<pdf_uint64>(st.st_size) > static_cast<pdf_uint64>(std::numeric_limits<size_t>::max()) )
+    {
+        // Not a regular file or too large for the address space
+        return false;
+    }
+
+    m_lFileSize = st.st_size;
+    m_bMapped   = true;
+    if( !this->MapWindow( 0 ) )
+    {
+        m_bMapped = false;
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif // PODOFO_HAVE_SYS_MMAN_H
+}
+
+bool PdfInputDevice::MapWindow( std::streamoff lOffset ) const
+{
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+    // Only a window of the file is mapped at any time,
+    // so that the resident size does not grow with the file.
+    if( m_pBuffer )
+        munmap( m_pBuffer, m_lBufferSize );
+
+    std::streamoff lStart = lOffset - lOffset % PDF_INPUT_MAP_SIZE;
+
+    m_pBuffer     = NULL;
+    m_lBufferSize = 0;
+    m_lBufferLen  = 0;
+    m_lBufferPos  = 0;
+
+    if( lOffset < 0 || lOffset >= m_lFileSize )
+    {
+        // Positions at or after the end of the file read nothing.
+        // lStart may still be inside the file if its size is not
+        // a multiple of PDF_INPUT_MAP_SIZE, so check lOffset.
+        m_lBufferOffset = lOffset;
+        m_bEof          = true;
+        return true;
+    }
+
+    size_t lLen = static_cast<size_t>(PDF_MIN( static_cast<std::streamoff>(PDF_INPUT_MAP_SIZE), m_lFileSize - lStart ));
+    void*  pMap = mmap( NULL, lLen, PROT_READ, MAP_PRIVATE, fileno( m_pFile ), static_cast<off_t>(lStart) );
+    if( pMap == MAP_FAILED )
+    {
+        m_lBufferOffset = lOffset;
+        return false;
+    }
+
+    m_pBuffer       = static_cast<char*>(pMap);
+    m_lBufferSize   = lLen;
+    m_lBufferLen    = lLen;
+    m_lBufferOffset = lStart;
+    m_lBufferPos    = static_cast<size_t>(lOffset - lStart);
+
+    return true;
+#else
+    (void)lOffset;
+    return false;
+#endif // PODOFO_HAVE_SYS_MMAN_H
 }
 
 void PdfInputDevice::Close()
@@ -153,78 +282,227 @@ void PdfInputDevice::Close()
     // nothing to do here, but maybe necessary for inheriting classes
 }
 
+size_t PdfInputDevice::ReadSource( char* pBuffer, size_t lLen ) const
+{
+    if( m_pStream )
+    {
+        m_pStream->read( pBuffer, lLen );
+        return static_cast<size_t>(m_pStream->gcount());
+    }
+
+    if( m_pFile )
+        return fread( pBuffer, 1, lLen, m_pFile );
+
+    return 0;
+}
+
+size_t PdfInputDevice::FillBuffer() const
+{
+    if( m_bMapped )
+    {
+        if( !this->MapWindow( m_lBufferOffset + static_cast<std::streamoff>(m_lBufferLen) ) )
+        {
+            PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDeviceOperation, "Cannot map the input file." );
+        }
+
+        // The new window may start before the requested position
+        size_t lAvail = m_lBufferLen - m_lBufferPos;
+        if( !lAvail )
+            m_bEof = true;
+
+        return lAvail;
+    }
+
+    if( !m_pStream && !m_pFile )
+    {
+        // A memory device has all its data in the buffer
+        m_bEof = true;
+        return 0;
+    }
+
+    // The file or stream is always positioned right 
+    // after the last byte in the buffer
+    m_lBufferOffset += m_lBufferLen;
+    m_lBufferPos     = 0;
+    m_lBufferLen     = this->ReadSource( m_pBuffer, m_lBufferSize );
+
+    if( !m_lBufferLen )
+        m_bEof = true;
+
+    return m_lBufferLen;
+}
+
 int PdfInputDevice::GetChar() const
 {
-	if (m_pStream)
-    return m_pStream->get();
-	if (m_pFile)
-		return fgetc(m_pFile);
-	return 0;
+    if( m_lBufferPos == m_lBufferLen && !this->FillBuffer() )
+        return EOF;
+
+    return static_cast<unsigned char>(m_pBuffer[m_lBufferPos++]);
 }
 
 int PdfInputDevice::Look() const 
 {
-	if (m_pStream)
-    return m_pStream->peek();
-	if (m_pFile) {
-		pdf_long lOffset = ftello( m_pFile );
-		int ch = GetChar();
-		fseeko( m_pFile, lOffset, SEEK_SET );
-		return ch;
-	}
+    if( m_lBufferPos == m_lBufferLen && !this->FillBuffer() )
+        return EOF;
 
-	return 0;
+    return static_cast<unsigned char>(m_pBuffer[m_lBufferPos]);
 }
 
-std::streamoff PdfInputDevice::Tell() const
+size_t PdfInputDevice::GetWindow( const char** ppBuffer ) const
 {
-	if (m_pStream)
-    return m_pStream->tellg();
-	if (m_pFile)
-		return ftello(m_pFile);
-	return 0;
+    if( m_lBufferPos == m_lBufferLen && !this->FillBuffer() )
+        return 0;
+
+    *ppBuffer = m_pBuffer + m_lBufferPos;
+    return m_lBufferLen - m_lBufferPos;
 }
-/*
-void PdfInputDevice::Seek( std::streamoff off, std::ios_base::seekdir dir )
+
+void PdfInputDevice::Advance( size_t lLen ) const
 {
-    if (m_bIsSeekable)
-        m_pStream->seekg( off, dir );
-    else
-        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDeviceOperation, "Tried to seek an unseekable input device." );
+    m_lBufferPos = PDF_MIN( m_lBufferPos + lLen, m_lBufferLen );
+}
+
+std::streamoff PdfInputDevice::Tell() const
+{
+    return m_lBufferOffset + static_cast<std::streamoff>(m_lBufferPos);
 }
-*/
 
 void PdfInputDevice::Seek( std::streamoff off, std::ios_base::seekdir dir )
 {
-    if (m_bIsSeekable)
+    if (!m_bIsSeekable)
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDeviceOperation, "Tried to seek an unseekable input device." );
+    }
+
+    m_bEof = false;
+
+    std::streamoff lOffset = off;
+    if( dir == std::ios_base::cur )
+        lOffset += this->Tell();
+    else if( dir == std::ios_base::end )
     {
-        if (m_pStream)
+        if( m_bMapped )
+            lOffset += m_lFileSize;
+        else if( m_pStream )
+        {
+            m_pStream->clear();
+            m_pStream->seekg( 0, std::ios_base::end );
+            lOffset += m_pStream->tellg();
+        }
+        else if( m_pFile )
         {
-            m_pStream->seekg( off, dir );
+            fseeko( m_pFile, 0, SEEK_END );
+            lOffset += ftello( m_pFile );
         }
+        else
+            lOffset += m_lBufferLen;
+    }
 
-        if (m_pFile)
+    // If the file or stream was moved to its end above,
+    // the buffer has to be dropped even if lOffset is inside of it.
+    bool bSourceMoved = dir == std::ios_base::end && !m_bMapped && (m_pStream || m_pFile);
+    if( !bSourceMoved && lOffset >= m_lBufferOffset 
+        && lOffset <= m_lBufferOffset + static_cast<std::streamoff>(m_lBufferLen) )
+    {
+        // Seeking inside of the buffer is cheap
+        m_lBufferPos = static_cast<size_t>(lOffset - m_lBufferOffset);
+        return;
+    }
+
+    if( m_bMapped )
+    {
+        if( !this->MapWindow( lOffset ) )
         {
-            fseeko( m_pFile, off, dir );
+            PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDeviceOperation, "Cannot map the input file." );
         }
+
+        return;
+    }
+
+    if( m_pStream )
+    {
+        m_pStream->clear();
+        m_pStream->seekg( lOffset, std::ios_base::beg );
+    }
+    else if( m_pFile )
+    {
+        fseeko( m_pFile, lOffset, SEEK_SET );
     }
     else
     {
-        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDeviceOperation, "Tried to seek an unseekable input device." );
+        // Memory device, the buffer holds all data.
+        // Positions outside of it are at the end of the input.
+        m_lBufferPos = m_lBufferLen;
+        return;
     }
-}
 
+    m_lBufferOffset = lOffset;
+    m_lBufferPos    = 0;
+    m_lBufferLen    = 0;
+}
 
 std::streamoff PdfInputDevice::Read( char* pBuffer, std::streamsize lLen )
 {
-	if (m_pStream) {
-    m_pStream->read( pBuffer, lLen );
-    return m_pStream->gcount();
-	}
-	else 
-	{
-		return fread(pBuffer, 1, lLen, m_pFile);
-	}
+    std::streamoff lRead = 0;
+
+    while( lLen > 0 ) 
+    {
+        size_t lAvail = m_lBufferLen - m_lBufferPos;
+        if( !lAvail )
+        {
+            if( static_cast<size_t>(lLen) >= m_lBufferSize && !m_bMapped && (m_pStream || m_pFile) )
+            {
+                // Large reads go directly into the callers buffer
+                size_t lDirect = this->ReadSource( pBuffer, static_cast<size_t>(lLen) );
+                m_lBufferOffset += m_lBufferLen + lDirect;
+                m_lBufferPos     = 0;
+                m_lBufferLen     = 0;
+                if( lDirect < static_cast<size_t>(lLen) )
+                    m_bEof = true;
+
+                return lRead + lDirect;
+            }
+
+            lAvail = this->FillBuffer();
+            if( !lAvail )
+                break;
+        }
+
+        size_t lCopy = PDF_MIN( lAvail, static_cast<size_t>(lLen) );
+        memcpy( pBuffer, m_pBuffer + m_lBufferPos, lCopy );
+        m_lBufferPos += lCopy;
+        pBuffer      += lCopy;
+        lLen         -= lCopy;
+        lRead        += lCopy;
+    }
+
+    return lRead;
+}
+
+bool PdfInputDevice::Eof() const
+{
+    return m_bEof;
+}
+
+bool PdfInputDevice::Bad() const
+{
+    if( m_pStream )
+        return m_pStream->bad();
+
+    if( m_pFile )
+        return ferror( m_pFile ) != 0;
+
+    return false;
+}
+
+void PdfInputDevice::Clear( std::ios_base::iostate state ) const
+{
+    m_bEof = (state & std::ios_base::eofbit) != 0;
+
+    if( m_pStream )
+        m_pStream->clear( state );
+    else if( m_pFile )
+        clearerr( m_pFile );
 }
 
 }; // namespace PoDoFo
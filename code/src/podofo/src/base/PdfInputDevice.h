@@ -31,6 +31,11 @@ namespace PoDoFo {
 /** This class provides an Input device which operates 
  *  either on a file, a buffer in memory or any arbitrary std::istream
  *
+ *  Files and streams are read through an internal buffer, so that
+ *  GetChar() and Look() do not have to access the underlying FILE*
+ *  or std::istream for every single byte. Callers which scan many bytes
+ *  at once can access this buffer directly using GetWindow() and Advance().
+ *
  *  This class is suitable for inheritance to provide input 
  *  devices of your own for PoDoFo.
  *  Just overide the required virtual methods.
@@ -39,6 +44,10 @@ class PODOFO_API PdfInputDevice {
  public:
 
     /** Construct a new PdfInputDevice that reads all data from a file.
+     *
+     *  Regular files are mapped into memory window by window if the
+     *  system supports it, so that reads are served from the page cache
+     *  without copying. Otherwise the file is read through a buffer.
      *
      *  \param pszFilename path to a file that will be opened and all data
      *                     is read from this file.
@@ -119,21 +128,43 @@ class PODOFO_API PdfInputDevice {
      */
     virtual std::streamoff Read( char* pBuffer, std::streamsize lLen );
 
+    /** Get direct access to the buffered bytes at the current position.
+     *  The buffer is refilled from the file or stream if all buffered
+     *  bytes have been consumed.
+     *
+     *  \param ppBuffer set to the next unread byte. The data is owned by
+     *                  the device and only valid until the next call of
+     *                  any other method of this device.
+     *  \returns the number of bytes available at ppBuffer. 0 is returned
+     *           at the end of the input and by devices that do not buffer
+     *           their input, use GetChar() in this case.
+     *
+     *  \see Advance
+     */
+    virtual size_t GetWindow( const char** ppBuffer ) const;
+
+    /** Consume bytes returned by GetWindow().
+     *
+     *  \param lLen number of bytes to consume, must not be larger than
+     *              the value returned by the last call to GetWindow()
+     */
+    virtual void Advance( size_t lLen ) const;
+
     /**
      * \return True if the stream is at EOF
      */
-    PODOFO_NOTHROW inline virtual bool Eof() const;
+    PODOFO_NOTHROW virtual bool Eof() const;
 
     /**
      * \return True if there was an error in an I/O operation
      */
-    PODOFO_NOTHROW inline virtual bool Bad() const;
+    PODOFO_NOTHROW virtual bool Bad() const;
 
     /**
      * Set the stream error state. By default, clears badbit, eofbit
      * and failbit.
      */
-    PODOFO_NOTHROW inline virtual void Clear( std::ios_base::iostate state = std::ios_base::goodbit) const;
+    PODOFO_NOTHROW virtual void Clear( std::ios_base::iostate state = std::ios_base::goodbit) const;
 
     /**
      * \return True if the stream is seekable. Subclasses can control
@@ -157,11 +188,50 @@ class PODOFO_API PdfInputDevice {
      */
     void Init();
 
+    /** Allocate the read buffer used for files and streams.
+     */
+    void InitBuffer();
+
+    /** Map the first window of the opened file into memory.
+     *
+     *  \returns false if the file cannot be mapped and has to be read through a buffer
+     */
+    bool MapFile();
+
+    /** Replace the mapped window by the one holding lOffset
+     *  and position the device at lOffset.
+     *
+     *  \returns false if mmap failed
+     */
+    bool MapWindow( std::streamoff lOffset ) const;
+
+    /** Read the next block of the file or stream into the read buffer.
+     *  All bytes in the buffer have to be consumed before.
+     *
+     *  \returns the number of bytes read into the buffer
+     */
+    size_t FillBuffer() const;
+
+    /** Read bytes from the file or stream, bypassing the read buffer.
+     *
+     *  \returns the number of bytes read
+     */
+    size_t ReadSource( char* pBuffer, size_t lLen ) const;
+
  private:
     std::istream* m_pStream;
 	  FILE *				m_pFile;
     bool          m_StreamOwned;
     bool          m_bIsSeekable;
+
+    mutable char*          m_pBuffer;       ///< read buffer, mapped window, or the complete data of a memory device
+    mutable size_t         m_lBufferSize;   ///< allocated or mapped size of m_pBuffer
+    mutable size_t         m_lBufferLen;    ///< number of valid bytes in m_pBuffer
+    mutable size_t         m_lBufferPos;    ///< current read position in m_pBuffer
+    mutable std::streamoff m_lBufferOffset; ///< position of m_pBuffer[0] in the input
+    mutable bool           m_bEof;          ///< a read or a mapped window has hit the end of the input
+    bool                   m_bMapped;       ///< m_pBuffer is a mapped window of the file
+    std::streamoff         m_lFileSize;     ///< size of a mapped file
 };
 
 bool PdfInputDevice::IsSeekable() const
@@ -174,21 +244,6 @@ void PdfInputDevice::SetSeekable(bool bIsSeekable)
     m_bIsSeekable = bIsSeekable;
 }
 
-bool PdfInputDevice::Bad() const
-{
-    return m_pStream->bad();
-}
-
-bool PdfInputDevice::Eof() const
-{
-    return m_pStream->eof();
-}
-
-void PdfInputDevice::Clear(std::ios_base::iostate state) const
-{
-    m_pStream->clear(state);
-}
-
 };
 
 #endif // _PDF_INPUT_DEVICE_H_
@@ -28,6 +28,7 @@
 #include "PdfVecObjects.h"
 
 #include <algorithm>
+#include <sstream>
 
 #if defined(PODOFO_VERBOSE_DEBUG)
 #include <iostream>
@@ -59,8 +60,9 @@ void PdfObjectStreamParserObject::Parse(ObjectIdList const & list)
         this->ReadObjectsFromStream( pBuffer, lBufferLen, lNum, lFirst, list );
         free( pBuffer );
 
-        // the object stream is not needed anymore in the final PDF
-        delete m_vecObjects->RemoveObject( m_pParser->Reference() );
+        // the object stream is not needed anymore in the final PDF,
+        // but its number must not be reused by an incremental update
+        delete m_vecObjects->RemoveObject( m_pParser->Reference(), false );
         m_pParser = NULL;
 
     } catch( const PdfError & rError ) {
@@ -111,4 +113,142 @@ void PdfObjectStreamParserObject::ReadObjectsFromStream( char* pBuffer, pdf_long
     }
 }
 
+PdfObjectStreamCache::PdfObjectStreamCache( PdfVecObjects* pVecObjects, const PdfRefCountedBuffer & rBuffer, 
+                                            PdfEncrypt* pEncrypt, size_t nMaxStreams )
+    : m_vecObjects( pVecObjects ), m_buffer( rBuffer ), m_pEncrypt( pEncrypt ), m_nMaxStreams( nMaxStreams )
+{
+    m_vecObjects->Attach( this );
+}
+
+PdfObjectStreamCache::~PdfObjectStreamCache()
+{
+    TStreamMap::iterator it = m_mapStreams.begin();
+    while( it != m_mapStreams.end() )
+    {
+        delete (*it).second;
+        ++it;
+    }
+}
+
+bool PdfObjectStreamCache::HasStream( unsigned int nStreamObjNo ) const
+{
+    return m_mapStreams.find( nStreamObjNo ) != m_mapStreams.end();
+}
+
+void PdfObjectStreamCache::AddStream( PdfParserObject* pStream )
+{
+    // Allows to free the raw stream data after decoding
+    pStream->SetLoadOnDemand( true );
+    m_mapStreams[pStream->Reference().ObjectNumber()] = pStream;
+}
+
+void PdfObjectStreamCache::ReadObject( unsigned int nStreamObjNo, const PdfReference & rRef, PdfVariant & rVariant )
+{
+    TDecodedStream & decoded = this->GetDecodedStream( nStreamObjNo );
+
+    std::map<unsigned int, pdf_long>::const_iterator it = decoded.offsets.find( rRef.ObjectNumber() );
+    if( it == decoded.offsets.end() )
+    {
+        std::ostringstream oss;
+        oss << "Object " << rRef.ObjectNumber() << " 0 R not found in object stream " 
+            << nStreamObjNo << " 0 R." << std::endl;
+
+        PODOFO_RAISE_ERROR_INFO( ePdfError_NoObject, oss.str().c_str() );
+    }
+
+    decoded.device.Device()->Seek( static_cast<std::streamoff>((*it).second) );
+
+    PdfTokenizer tokenizer( decoded.device, m_buffer );
+    tokenizer.GetNextVariant( rVariant, m_pEncrypt );
+}
+
+PdfObjectStreamCache::TDecodedStream & PdfObjectStreamCache::GetDecodedStream( unsigned int nStreamObjNo )
+{
+    TDecodedStreamList::iterator itDecoded = m_lstDecoded.begin();
+    while( itDecoded != m_lstDecoded.end() )
+    {
+        if( (*itDecoded).nObjNo == nStreamObjNo )
+        {
+            m_lstDecoded.splice( m_lstDecoded.begin(), m_lstDecoded, itDecoded );
+            return m_lstDecoded.front();
+        }
+
+        ++itDecoded;
+    }
+
+    TStreamMap::iterator it = m_mapStreams.find( nStreamObjNo );
+    if( it == m_mapStreams.end() )
+    {
+        std::ostringstream oss;
+        oss << "Loading of object stream " << nStreamObjNo << " 0 R failed!" << std::endl;
+
+        PODOFO_RAISE_ERROR_INFO( ePdfError_NoObject, oss.str().c_str() );
+    }
+
+    PdfParserObject* pStream = (*it).second;
+    long long        lNum    = pStream->GetDictionary().GetKeyAsLong( "N", 0 );
+    long long        lFirst  = pStream->GetDictionary().GetKeyAsLong( "First", 0 );
+
+    char*    pBuffer;
+    pdf_long lBufferLen;
+    pStream->GetStream()->GetFilteredCopy( &pBuffer, &lBufferLen );
+
+    m_lstDecoded.push_front( TDecodedStream() );
+    TDecodedStream & decoded = m_lstDecoded.front();
+    decoded.nObjNo = nStreamObjNo;
+
+    try {
+        decoded.device = PdfRefCountedInputDevice( pBuffer, lBufferLen );
+        free( pBuffer );
+
+        // read the table of contents
+        PdfTokenizer tokenizer( decoded.device, m_buffer );
+        for( long long i = 0; i < lNum; i++ )
+        {
+            const pdf_long lObj = tokenizer.GetNextNumber();
+            const pdf_long lOff = tokenizer.GetNextNumber();
+
+            decoded.offsets[static_cast<unsigned int>(lObj)] = static_cast<pdf_long>(lFirst) + lOff;
+        }
+    } catch( const PdfError & rError ) {
+        if( !decoded.device.Device() )
+            free( pBuffer );
+
+        m_lstDecoded.pop_front();
+        throw rError;
+    }
+
+    // The raw stream data is read again if the stream has to be decoded again
+    pStream->FreeObjectMemory( true );
+
+    // Never drop the stream which is returned
+    if( m_lstDecoded.size() > 1 && m_lstDecoded.size() > m_nMaxStreams )
+        m_lstDecoded.pop_back();
+
+    return m_lstDecoded.front();
+}
+
+void PdfObjectStreamCache::ParentDestructed()
+{
+    m_vecObjects->Detach( this );
+    delete this;
+}
+
+PdfCompressedParserObject::PdfCompressedParserObject( PdfVecObjects* pCreator, PdfObjectStreamCache* pCache, 
+                                                      const PdfReference & rRef, unsigned int nStreamObjNo, 
+                                                      const PdfRefCountedBuffer & rBuffer )
+    : PdfParserObject( rBuffer ), m_pCache( pCache ), m_nStreamObjNo( nStreamObjNo )
+{
+    m_pOwner    = pCreator;
+    m_reference = rRef;
+
+    this->SetLoadOnDemand( true );
+}
+
+void PdfCompressedParserObject::DelayedLoadImpl()
+{
+    m_pCache->ReadObject( m_nStreamObjNo, m_reference, *this );
+    this->SetDirty( false );
+}
+
 }; 
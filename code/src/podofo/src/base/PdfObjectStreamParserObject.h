@@ -23,13 +23,20 @@
 
 #include "PdfDefines.h"
 
+#include "PdfParserObject.h"
 #include "PdfRefCountedBuffer.h"
+#include "PdfRefCountedInputDevice.h"
+#include "PdfVecObjects.h"
+
+#include <list>
+
+/** Number of decoded object streams kept by PdfObjectStreamCache
+ */
+#define PDF_OBJECT_STREAM_CACHE_SIZE 8
 
 namespace PoDoFo {
 
 class PdfEncrypt;
-class PdfParserObject;
-class PdfVecObjects;
 
 /**
  * A utility class for PdfParser that can parse
@@ -66,6 +73,119 @@ private:
     PdfEncrypt* m_pEncrypt;
 };
 
+/**
+ * Decodes the object streams of a document when one of their objects
+ * is accessed for the first time, instead of reading all of them
+ * while parsing. The most recently used decoded object streams are 
+ * kept in memory.
+ *
+ * The cache owns the object streams added to it. It is attached
+ * to a PdfVecObjects and deletes itself when the PdfVecObjects is
+ * cleared or deleted.
+ *
+ * \see PdfCompressedParserObject
+ */
+class PdfObjectStreamCache : public PdfVecObjects::Observer {
+public:
+    /**
+     * Create a new PdfObjectStreamCache and attach it to pVecObjects.
+     *
+     * \param pVecObjects the objects of the document
+     * \param rBuffer use this allocated buffer for caching
+     * \param pEncrypt encryption object used to decrypt strings
+     * \param nMaxStreams number of decoded object streams kept in memory
+     */
+    PdfObjectStreamCache( PdfVecObjects* pVecObjects, const PdfRefCountedBuffer & rBuffer, PdfEncrypt* pEncrypt, 
+                          size_t nMaxStreams = PDF_OBJECT_STREAM_CACHE_SIZE );
+
+    virtual ~PdfObjectStreamCache();
+
+    /**
+     * \param nStreamObjNo object number of an object stream
+     * \returns true if the object stream was added to the cache
+     */
+    bool HasStream( unsigned int nStreamObjNo ) const;
+
+    /**
+     * Add an object stream to the cache. The object stream
+     * has to be removed from the PdfVecObjects before and is
+     * deleted by the cache.
+     *
+     * \param pStream an object stream
+     */
+    void AddStream( PdfParserObject* pStream );
+
+    /**
+     * Read an object from an object stream, the object stream 
+     * is decoded if it is not in the cache.
+     *
+     * \param nStreamObjNo object number of the object stream containing the object
+     * \param rRef reference of the object to read
+     * \param rVariant store the object into this variant
+     */
+    void ReadObject( unsigned int nStreamObjNo, const PdfReference & rRef, PdfVariant & rVariant );
+
+    virtual void WriteObject( const PdfObject* ) { }
+    virtual void ParentDestructed();
+    virtual void BeginAppendStream( const PdfStream* ) { }
+    virtual void EndAppendStream( const PdfStream* ) { }
+    virtual void Finish() { }
+
+private:
+    /** A decoded object stream
+     */
+    struct TDecodedStream {
+        unsigned int                     nObjNo;
+        PdfRefCountedInputDevice         device;  ///< the decoded data
+        std::map<unsigned int, pdf_long> offsets; ///< offsets of the objects in device by object number
+    };
+
+    typedef std::list<TDecodedStream>                 TDecodedStreamList;
+    typedef std::map<unsigned int, PdfParserObject*>  TStreamMap;
+
+    /** Get a decoded object stream and make it the most recently used one.
+     */
+    TDecodedStream & GetDecodedStream( unsigned int nStreamObjNo );
+
+private:
+    PdfVecObjects*      m_vecObjects;
+    PdfRefCountedBuffer m_buffer;
+    PdfEncrypt*         m_pEncrypt;
+    size_t              m_nMaxStreams;
+
+    TStreamMap          m_mapStreams;   ///< all object streams by object number
+    TDecodedStreamList  m_lstDecoded;   ///< the most recently used decoded stream is first
+};
+
+/**
+ * A PdfParserObject for an object stored in an object stream.
+ * The object is read from the decoded object stream when it is 
+ * accessed for the first time, so it can be freed using 
+ * FreeObjectMemory() like any other object loaded on demand.
+ */
+class PdfCompressedParserObject : public PdfParserObject {
+public:
+    /**
+     * \param pCreator the PdfVecObjects the object belongs to
+     * \param pCache the PdfObjectStreamCache of pCreator
+     * \param rRef reference of the object
+     * \param nStreamObjNo object number of the object stream containing the object
+     * \param rBuffer use this allocated buffer for caching
+     */
+    PdfCompressedParserObject( PdfVecObjects* pCreator, PdfObjectStreamCache* pCache, const PdfReference & rRef,
+                               unsigned int nStreamObjNo, const PdfRefCountedBuffer & rBuffer );
+
+protected:
+    /** Read the object from its object stream.
+     *  Reimplemented from PdfParserObject.
+     */
+    virtual void DelayedLoadImpl();
+
+private:
+    PdfObjectStreamCache* m_pCache;
+    unsigned int          m_nStreamObjNo;
+};
+
 };
 
 #endif // _PDF_OBJECT_STREAM_PARSER_OBJECT_H_
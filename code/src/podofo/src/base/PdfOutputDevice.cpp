@@ -34,7 +34,7 @@ PdfOutputDevice::PdfOutputDevice()
     this->Init();
 }
 
-PdfOutputDevice::PdfOutputDevice( const char* pszFilename )
+PdfOutputDevice::PdfOutputDevice( const char* pszFilename, bool bTruncate )
 {
     this->Init();
 
@@ -43,14 +43,27 @@ PdfOutputDevice::PdfOutputDevice( const char* pszFilename )
         PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
     }
 
-	std::fstream *pStream = new std::fstream(pszFilename, std::fstream::binary|std::ios_base::in | std::ios_base::out | std::ios_base::trunc);
+	std::ios_base::openmode mode = std::fstream::binary|std::ios_base::in | std::ios_base::out;
+	if( bTruncate )
+		mode |= std::ios_base::trunc;
+
+	std::fstream *pStream = new std::fstream(pszFilename, mode);
 	if(pStream->fail()) {
+		delete pStream;
 		PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
 	}
 	m_pStream = pStream;
 	m_pReadStream = pStream;
     PdfLocaleImbue(*m_pStream);
 
+    if( !bTruncate )
+    {
+        // Append to the existing contents
+        m_pStream->seekp( 0, std::ios_base::end );
+        m_ulLength   = static_cast<size_t>(m_pStream->tellp());
+        m_ulPosition = m_ulLength;
+    }
+
     /*
     m_hFile = fopen( pszFilename, "wb" );
     if( !m_hFile )
@@ -52,8 +52,10 @@ class PODOFO_API PdfOutputDevice {
      *
      *  \param pszFilename path to a file that will be opened and all data
      *                     is written to this file.
+     *  \param bTruncate if false an existing file is kept and all data
+     *                   is appended to it, e.g. for incremental updates
      */
-    PdfOutputDevice( const char* pszFilename );
+    PdfOutputDevice( const char* pszFilename, bool bTruncate = true );
 
 #ifdef _WIN32
     /** Construct a new PdfOutputDevice that writes all data to a file.
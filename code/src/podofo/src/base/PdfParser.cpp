@@ -114,6 +114,7 @@ void PdfParser::Init()
     m_ePdfVersion     = ePdfVersion_Default;
 
     m_nXRefOffset     = 0;
+    m_bXRefStream     = false;
     m_nFirstObject    = 0;
     m_nNumObjects     = 0;
     m_nXRefLinearizedOffset = 0;
@@ -608,6 +609,9 @@ void PdfParser::ReadXRefContents( pdf_long lOffset, bool bPositionAtEnd )
         }
         else
         {
+            if( lOffset == m_nXRefOffset )
+                m_bXRefStream = true;
+
             ReadXRefStreamContents( lOffset, bPositionAtEnd );
             return;
         }
@@ -1006,18 +1010,20 @@ void PdfParser::ReadObjectsInternal()
     // all normal objects including object streams are available now,
     // we can parse the object streams safely now.
     //
-    // Note that even if demand loading is enabled we still currently read all
-    // objects from the stream into memory then free the stream.
+    // If demand loading is enabled, an object stream is only decoded
+    // when one of its objects is accessed.
     //
-    for( i = 0; i < m_nNumObjects; i++ )
+    if( m_bLoadOnDemand )
+        CreateCompressedObjects();
+    else
     {
-        if( m_offsets[i].bParsed && m_offsets[i].cUsed == 's' ) // we have an object stream
+        for( i = 0; i < m_nNumObjects; i++ )
         {
-#if defined(PODOFO_VERBOSE_DEBUG)
-            if (m_bLoadOnDemand) cerr << "Demand loading on, but can't demand-load from object stream." << endl;
-#endif
-            ReadObjectFromStream( static_cast<int>(m_offsets[i].lGeneration), 
-                                  static_cast<int>(m_offsets[i].lOffset) );
+            if( m_offsets[i].bParsed && m_offsets[i].cUsed == 's' ) // we have an object stream
+            {
+                ReadObjectFromStream( static_cast<int>(m_offsets[i].lGeneration), 
+                                      static_cast<int>(m_offsets[i].lOffset) );
+            }
         }
     }
 
@@ -1101,6 +1107,61 @@ void PdfParser::ReadObjectFromStream( int nObjNo, int )
     pParserObject.Parse( list );
 }
 
+void PdfParser::CreateCompressedObjects()
+{
+    PdfObjectStreamCache*     pCache = NULL;
+    std::vector<PdfObject*>   vecCompressed;
+
+    for( int i = 0; i < m_nNumObjects; i++ ) 
+    {
+        if( !m_offsets[i].bParsed || m_offsets[i].cUsed != 's' )
+            continue;
+
+        if( !pCache ) 
+        {
+            // The cache is owned by m_vecObjects
+            pCache = new PdfObjectStreamCache( m_vecObjects, m_buffer, m_pEncrypt );
+        }
+
+        const unsigned int nStreamObjNo = static_cast<unsigned int>(m_offsets[i].lGeneration);
+        if( !pCache->HasStream( nStreamObjNo ) ) 
+        {
+            // generation number of object streams is always 0
+            PdfParserObject* pStream = dynamic_cast<PdfParserObject*>(m_vecObjects->GetObject( PdfReference( nStreamObjNo, 0 ) ) );
+            if( !pStream )
+            {
+                std::ostringstream oss;
+                oss << "Loading of object " << nStreamObjNo << " 0 R failed!" << std::endl;
+
+                PODOFO_RAISE_ERROR_INFO( ePdfError_NoObject, oss.str().c_str() );
+            }
+
+            // the object stream is not needed anymore in the final PDF,
+            // but its number must not be reused by an incremental update
+            m_vecObjects->RemoveObject( pStream->Reference(), false );
+            pCache->AddStream( pStream );
+        }
+
+        PdfReference ref( static_cast<unsigned int>(i), 0 );
+        if( m_vecObjects->GetObject( ref ) )
+        {
+            PdfError::LogMessage( eLogSeverity_Warning, "Object: %i 0 R will be deleted and loaded again.\n", i );
+            delete m_vecObjects->RemoveObject( ref, false );
+        }
+
+        vecCompressed.push_back( new PdfCompressedParserObject( m_vecObjects, pCache, ref, nStreamObjNo, m_buffer ) );
+    }
+
+    // Add the objects when all lookups are done, 
+    // as adding them might unsort m_vecObjects.
+    std::vector<PdfObject*>::iterator it = vecCompressed.begin();
+    while( it != vecCompressed.end() )
+    {
+        m_vecObjects->push_back( *it );
+        ++it;
+    }
+}
+
 const char* PdfParser::GetPdfVersionString() const
 {
     return s_szPdfVersions[static_cast<int>(m_ePdfVersion)];
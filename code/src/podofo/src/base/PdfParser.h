@@ -26,7 +26,7 @@
 #include "PdfVecObjects.h"
 
 #define W_ARRAY_SIZE 3
-#define W_MAX_BYTES  4
+#define W_MAX_BYTES  8
 
 namespace PoDoFo {
 
@@ -290,6 +290,19 @@ class PODOFO_API PdfParser : public PdfTokenizer {
      */
     size_t GetFileSize() const { return m_nFileSize; }
 
+    /** \returns the offset of the last XRef section in the file,
+     *           i.e. the value following the startxref keyword
+     */
+    pdf_long GetXRefOffset() const { return m_nXRefOffset; }
+
+    /** \returns true if the last XRef section of the file is a XRef stream
+     */
+    bool HasXRefStream() const { return m_bXRefStream; }
+
+    /** \returns the device the parsed file is read from
+     */
+    const PdfRefCountedInputDevice & GetDevice() const { return m_device; }
+
     /** 
      * \returns true if this PdfWriter creates an encrypted PDF file
      */
@@ -483,6 +496,14 @@ class PODOFO_API PdfParser : public PdfTokenizer {
      */
     void ReadObjectFromStream( int nObjNo, int nIndex );
 
+    /** Add all objects stored in object streams to the objects vector
+     *  as PdfCompressedParserObjects, which decode their object stream
+     *  when they are accessed for the first time.
+     *
+     *  Used instead of ReadObjectFromStream if demand loading is enabled.
+     */
+    void CreateCompressedObjects();
+
     /** Checks the magic number at the start of the pdf file
      *  and sets the m_ePdfVersion member to the correct version
      *  of the pdf file.
@@ -534,6 +555,7 @@ class PODOFO_API PdfParser : public PdfTokenizer {
     bool          m_bLoadOnDemand;
 
     pdf_long      m_nXRefOffset;
+    bool          m_bXRefStream;
     long          m_nFirstObject;
     long          m_nNumObjects;
     pdf_long      m_nXRefLinearizedOffset;
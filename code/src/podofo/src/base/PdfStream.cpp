@@ -96,6 +96,15 @@ void PdfStream::GetFilteredCopy( char** ppBuffer, pdf_long* lLen ) const
     *ppBuffer = stream.TakeBuffer();
 }
 
+pdf_long PdfStream::GetFilteredCopy( char* pBuffer, pdf_long lLen ) const
+{
+    TVecFilters            vecFilters = PdfFilterFactory::CreateFilterList( m_pParent );
+    PdfFilteredInputStream stream( this->GetInternalBuffer(), this->GetInternalBufferSize(), vecFilters,
+                                   m_pParent ? &(m_pParent->GetDictionary()) : NULL );
+
+    return stream.Read( pBuffer, lLen );
+}
+
 const PdfStream & PdfStream::operator=( const PdfStream & rhs )
 {
     PdfMemoryInputStream stream( rhs.GetInternalBuffer(), rhs.GetInternalBufferSize() );
@@ -243,6 +243,21 @@ class PODOFO_API PdfStream {
      *  \param pStream filtered data is written to this stream.
      */
     void GetFilteredCopy( PdfOutputStream* pStream ) const;
+
+    /** Decode the beginning of the stream into a buffer.
+     *
+     *  Only as much data is decoded as is needed to fill the buffer,
+     *  which makes it cheap to look at the first bytes of large streams.
+     *
+     *  \param pBuffer decoded data is written to this buffer
+     *  \param lLen size of pBuffer
+     *
+     *  \returns the number of bytes written to pBuffer, which is less
+     *            than lLen only if the decoded stream is shorter
+     *
+     *  \see PdfFilteredInputStream
+     */
+    pdf_long GetFilteredCopy( char* pBuffer, pdf_long lLen ) const;
     
     /** Create a copy of a PdfStream object
      *  \param rhs the object to clone
@@ -0,0 +1,276 @@
+/***************************************************************************
+ *   Copyright (C) 2006 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "PdfStreamCompressor.h"
+
+#include "PdfInputStream.h"
+#include "PdfObject.h"
+#include "PdfOutputStream.h"
+#include "PdfStream.h"
+#include "util/PdfMutexWrapper.h"
+#include "PdfDefinesPrivate.h"
+
+#include <string.h>
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/** Size of the blocks passed from the decoder to the encoder
+ */
+#define PDF_COMPRESSOR_BLOCK_SIZE 65536
+
+namespace PoDoFo {
+
+PdfStreamCompressor::PdfStreamCompressor( unsigned int nThreads )
+    : m_nThreads( nThreads ), m_nNextJob( 0 ), m_mutex( new Util::PdfMutex() ),
+      m_lInput( 0 ), m_lOutput( 0 )
+{
+    if( !m_nThreads )
+    {
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+        long lCpus = sysconf( _SC_NPROCESSORS_ONLN );
+        m_nThreads = lCpus > 0 ? static_cast<unsigned int>(lCpus) : 1;
+#else
+        m_nThreads = 1;
+#endif
+    }
+
+#if !defined(PODOFO_MULTI_THREAD) || defined(_WIN32)
+    m_nThreads = 1;
+#endif
+}
+
+PdfStreamCompressor::~PdfStreamCompressor()
+{
+    this->Clear();
+    delete m_mutex;
+}
+
+void PdfStreamCompressor::Clear()
+{
+    std::vector<TJob*>::iterator it = m_vecJobs.begin();
+    while( it != m_vecJobs.end() )
+    {
+        std::vector<TSource*>::iterator itSource = (*it)->sources.begin();
+        while( itSource != (*it)->sources.end() )
+        {
+            podofo_free( (*itSource)->pData );
+            delete *itSource;
+            ++itSource;
+        }
+
+        podofo_free( (*it)->pResult );
+        delete *it;
+        ++it;
+    }
+
+    m_vecJobs.clear();
+    m_nNextJob = 0;
+}
+
+PdfStreamCompressor::TJob* PdfStreamCompressor::GetJob( PdfObject* pTarget )
+{
+    // Sources of one target are usually added one after the other
+    if( m_vecJobs.size() && m_vecJobs.back()->pTarget == pTarget )
+        return m_vecJobs.back();
+
+    TJob* pJob    = new TJob();
+    pJob->pTarget = pTarget;
+    pJob->lInput  = 0;
+    pJob->pResult = NULL;
+    pJob->lResult = 0;
+    pJob->eError  = ePdfError_ErrOk;
+
+    m_vecJobs.push_back( pJob );
+    return pJob;
+}
+
+void PdfStreamCompressor::AddStream( PdfObject* pTarget, const PdfObject* pSource )
+{
+    TSource* pData = new TSource();
+
+    try {
+        pSource->GetStream()->GetCopy( &pData->pData, &pData->lLen );
+        pData->filters    = PdfFilterFactory::CreateFilterList( pSource );
+        pData->dictionary = pSource->GetDictionary();
+    } catch( PdfError & e ) {
+        podofo_free( pData->pData );
+        delete pData;
+        e.AddToCallstack( __FILE__, __LINE__ );
+        throw e;
+    }
+
+    this->GetJob( pTarget )->sources.push_back( pData );
+}
+
+void PdfStreamCompressor::AddData( PdfObject* pTarget, const char* pBuffer, pdf_long lLen )
+{
+    TSource* pData = new TSource();
+    pData->pData   = static_cast<char*>(podofo_malloc( lLen ? lLen : 1 ));
+    pData->lLen    = lLen;
+    if( !pData->pData )
+    {
+        delete pData;
+        PODOFO_RAISE_ERROR( ePdfError_OutOfMemory );
+    }
+
+    memcpy( pData->pData, pBuffer, lLen );
+    this->GetJob( pTarget )->sources.push_back( pData );
+}
+
+void PdfStreamCompressor::Compress( TJob* pJob )
+{
+    TVecFilters vecFlate;
+    vecFlate.push_back( ePdfFilter_FlateDecode );
+
+    char*                 pBlock = NULL;
+    PdfMemoryOutputStream output;
+    try {
+        std::auto_ptr<PdfOutputStream> pEncodeStream( PdfFilterFactory::CreateEncodeStream( vecFlate, &output ) );
+
+        pBlock = static_cast<char*>(podofo_malloc( PDF_COMPRESSOR_BLOCK_SIZE ));
+        if( !pBlock )
+        {
+            PODOFO_RAISE_ERROR( ePdfError_OutOfMemory );
+        }
+
+        // Decoded data goes directly into the encoder, one block at a time
+        std::vector<TSource*>::const_iterator it = pJob->sources.begin();
+        while( it != pJob->sources.end() )
+        {
+            PdfFilteredInputStream input( (*it)->pData, (*it)->lLen, (*it)->filters, &(*it)->dictionary );
+            pdf_long               lRead;
+            while( (lRead = input.Read( pBlock, PDF_COMPRESSOR_BLOCK_SIZE )) > 0 )
+            {
+                pEncodeStream->Write( pBlock, lRead );
+                pJob->lInput += lRead;
+            }
+
+            ++it;
+        }
+
+        pEncodeStream->Close();
+    } catch( const PdfError & e ) {
+        pJob->eError = e.GetError();
+    }
+
+    podofo_free( pBlock );
+
+    if( pJob->eError == ePdfError_ErrOk )
+    {
+        pJob->lResult = output.GetLength();
+        pJob->pResult = output.TakeBuffer();
+    }
+}
+
+void PdfStreamCompressor::Work()
+{
+    for( ;; )
+    {
+        TJob* pJob;
+        {
+            Util::PdfMutexWrapper mutex( *m_mutex );
+            if( m_nNextJob == m_vecJobs.size() )
+                return;
+
+            pJob = m_vecJobs[m_nNextJob++];
+        }
+
+        Compress( pJob );
+    }
+}
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+void* PdfStreamCompressor::WorkerThread( void* pData )
+{
+    static_cast<PdfStreamCompressor*>(pData)->Work();
+    return NULL;
+}
+#endif
+
+void PdfStreamCompressor::Run()
+{
+    m_nNextJob = 0;
+    m_lInput   = 0;
+    m_lOutput  = 0;
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+    // The calling thread is a worker, too
+    std::vector<pthread_t> vecThreads;
+    size_t                 nThreads = PDF_MIN( static_cast<size_t>(m_nThreads), m_vecJobs.size() );
+    for( size_t i=1;i<nThreads;i++ )
+    {
+        pthread_t thread;
+        if( pthread_create( &thread, NULL, &PdfStreamCompressor::WorkerThread, this ) == 0 )
+            vecThreads.push_back( thread );
+    }
+
+    this->Work();
+
+    std::vector<pthread_t>::iterator itThread = vecThreads.begin();
+    while( itThread != vecThreads.end() )
+    {
+        pthread_join( *itThread, NULL );
+        ++itThread;
+    }
+#else
+    this->Work();
+#endif
+
+    // Store the results in the order the jobs were added
+    EPdfError eError = ePdfError_ErrOk;
+    try {
+        std::vector<TJob*>::iterator it = m_vecJobs.begin();
+        while( it != m_vecJobs.end() )
+        {
+            TJob* pJob = *it++;
+            if( pJob->eError != ePdfError_ErrOk )
+            {
+                if( eError == ePdfError_ErrOk )
+                    eError = pJob->eError;
+
+                continue;
+            }
+
+            PdfMemoryInputStream stream( pJob->pResult, pJob->lResult );
+            pJob->pTarget->GetStream()->SetRawData( &stream, pJob->lResult );
+            pJob->pTarget->GetDictionary().AddKey( PdfName::KeyFilter, PdfName( "FlateDecode" ) );
+            pJob->pTarget->GetDictionary().RemoveKey( "DecodeParms" );
+
+            m_lInput  += pJob->lInput;
+            m_lOutput += pJob->lResult;
+        }
+    } catch( PdfError & e ) {
+        this->Clear();
+        e.AddToCallstack( __FILE__, __LINE__ );
+        throw e;
+    }
+
+    this->Clear();
+
+    if( eError != ePdfError_ErrOk )
+    {
+        PODOFO_RAISE_ERROR_INFO( eError, "Compressing a stream failed." );
+    }
+}
+
+};
@@ -0,0 +1,170 @@
+/***************************************************************************
+ *   Copyright (C) 2006 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _PDF_STREAM_COMPRESSOR_H_
+#define _PDF_STREAM_COMPRESSOR_H_
+
+#include "PdfDefines.h"
+#include "PdfDictionary.h"
+#include "PdfFilter.h"
+#include "util/PdfMutex.h"
+
+#include <vector>
+
+namespace PoDoFo {
+
+class PdfObject;
+
+/** PdfStreamCompressor flate compresses the streams of many objects
+ *  on a pool of worker threads.
+ *
+ *  Jobs are collected with AddStream() and AddData() and executed
+ *  by Run(). The worker threads do not access any PdfObject: all input
+ *  data is copied when a job is added and the compressed results are
+ *  stored in the target objects by the thread calling Run(). So the
+ *  documents involved do not need to be thread safe.
+ *
+ *  If PoDoFo was built without thread support, all jobs
+ *  are executed on the calling thread.
+ */
+class PODOFO_API PdfStreamCompressor {
+ public:
+    /** Create a new PdfStreamCompressor
+     *
+     *  \param nThreads number of worker threads, 0 uses one
+     *                  thread per available processor
+     */
+    PdfStreamCompressor( unsigned int nThreads = 0 );
+
+    ~PdfStreamCompressor();
+
+    /** Decode the stream of pSource and append it to the
+     *  stream of pTarget. Adding several sources for the same target
+     *  one after the other concatenates them, which is used to merge
+     *  page content arrays.
+     *
+     *  \param pTarget the stream of this object is replaced by the
+     *                 flate compressed data when Run() is called
+     *  \param pSource an object with a stream whose data is decoded
+     */
+    void AddStream( PdfObject* pTarget, const PdfObject* pSource );
+
+    /** Append already decoded data to the stream of pTarget.
+     *
+     *  \param pTarget the stream of this object is replaced by the
+     *                 flate compressed data when Run() is called
+     *  \param pBuffer decoded data, it is copied
+     *  \param lLen length of pBuffer
+     */
+    void AddData( PdfObject* pTarget, const char* pBuffer, pdf_long lLen );
+
+    /** Compress all added streams and store them in their target objects.
+     *  All jobs are removed afterwards.
+     *
+     *  If any job fails, its error is thrown after all
+     *  other jobs have been stored.
+     */
+    void Run();
+
+    /** \returns the number of worker threads
+     */
+    inline unsigned int GetThreadCount() const;
+
+    /** \returns the number of bytes passed to the compressor by the last Run()
+     */
+    inline pdf_long GetInputLength() const;
+
+    /** \returns the number of compressed bytes stored by the last Run()
+     */
+    inline pdf_long GetOutputLength() const;
+
+ private:
+    /** One source of a job: encoded data and how to decode it
+     */
+    struct TSource {
+        char*        pData;
+        pdf_long     lLen;
+        TVecFilters  filters;
+        PdfDictionary dictionary; ///< copy of the stream dictionary for the DecodeParms
+    };
+
+    /** All data that is compressed into the stream of one object
+     */
+    struct TJob {
+        PdfObject*            pTarget;
+        std::vector<TSource*> sources;
+
+        pdf_long              lInput;
+        char*                 pResult;
+        pdf_long              lResult;
+        EPdfError             eError;
+    };
+
+    TJob* GetJob( PdfObject* pTarget );
+
+    void Clear();
+
+    /** Execute jobs until none is left, called on each worker thread
+     */
+    void Work();
+
+    static void Compress( TJob* pJob );
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+    static void* WorkerThread( void* pData );
+#endif
+
+ private:
+    unsigned int       m_nThreads;
+    std::vector<TJob*> m_vecJobs;
+    size_t             m_nNextJob;  ///< next job to be executed by a worker
+    Util::PdfMutex*    m_mutex;     ///< protects m_nNextJob
+
+    pdf_long           m_lInput;
+    pdf_long           m_lOutput;
+};
+
+// -----------------------------------------------------
+//
+// -----------------------------------------------------
+unsigned int PdfStreamCompressor::GetThreadCount() const
+{
+    return m_nThreads;
+}
+
+// -----------------------------------------------------
+//
+// -----------------------------------------------------
+pdf_long PdfStreamCompressor::GetInputLength() const
+{
+    return m_lInput;
+}
+
+// -----------------------------------------------------
+//
+// -----------------------------------------------------
+pdf_long PdfStreamCompressor::GetOutputLength() const
+{
+    return m_lOutput;
+}
+
+};
+
+#endif // _PDF_STREAM_COMPRESSOR_H_
@@ -48,37 +48,27 @@ namespace PoDoFo {
 namespace PdfTokenizerNameSpace{
 
 static const int g_MapAllocLen = 256;
-static char g_DelMap[g_MapAllocLen] = { 0 };
-static char g_WsMap[g_MapAllocLen] = { 0 };
+static char g_ClassMap[g_MapAllocLen] = { 0 };
 static char g_EscMap[g_MapAllocLen] = { 0 };
 static char g_hexMap[g_MapAllocLen] = { 0 };
 
-// Generate the delimiter character map at runtime
+// Generate the character class map at runtime
 // so that it can be derived from the more easily
 // maintainable structures in PdfDefines.h
-const char * genDelMap()
+const char * genClassMap()
 {
-    char* map = static_cast<char*>(g_DelMap);
-    memset( map, 0, sizeof(char) * g_MapAllocLen );
+    char* map = static_cast<char*>(g_ClassMap);
+    memset( map, PdfTokenizer::eCharClass_Regular, sizeof(char) * g_MapAllocLen );
     for (int i = 0; i < PoDoFo::s_nNumDelimiters; ++i)
     {
-        map[static_cast<int>(PoDoFo::s_cDelimiters[i])] = 1;
+        map[static_cast<unsigned char>(PoDoFo::s_cDelimiters[i])] = PdfTokenizer::eCharClass_Delimiter;
     }
 
-    return map;
-}
-
-// Generate the whitespace character map at runtime
-// so that it can be derived from the more easily
-// maintainable structures in PdfDefines.h
-const char * genWsMap()
-{
-    char* map = static_cast<char*>(g_WsMap);
-    memset( map, 0, sizeof(char) * g_MapAllocLen );
     for (int i = 0; i < PoDoFo::s_nNumWhiteSpaces; ++i)
     {
-        map[static_cast<int>(PoDoFo::s_cWhiteSpaces[i])] = 1;
+        map[static_cast<unsigned char>(PoDoFo::s_cWhiteSpaces[i])] = PdfTokenizer::eCharClass_Whitespace;
     }
+
     return map;
 }
 
@@ -135,8 +125,7 @@ const char* genHexMap()
 };
 
 const unsigned int PdfTokenizer::HEX_NOT_FOUND   = std::numeric_limits<unsigned int>::max();
-const char * const PdfTokenizer::s_delimiterMap  = PdfTokenizerNameSpace::genDelMap();
-const char * const PdfTokenizer::s_whitespaceMap = PdfTokenizerNameSpace::genWsMap();
+const char * const PdfTokenizer::s_charClassMap  = PdfTokenizerNameSpace::genClassMap();
 const char * const PdfTokenizer::s_escMap        = PdfTokenizerNameSpace::genEscMap();
 const char * const PdfTokenizer::s_hexMap        = PdfTokenizerNameSpace::genHexMap();
 
@@ -193,8 +182,10 @@ PdfTokenizer::~PdfTokenizer()
 
 bool PdfTokenizer::GetNextToken( const char*& pszToken , EPdfTokenType* peType )
 {
-    int  c; 
-    long long  counter  = 0;
+    int      c; 
+    pdf_long counter  = 0;
+    // Leave room for the terminating zero
+    const pdf_long lMaxLen = static_cast<pdf_long>(m_buffer.GetSize()) - 1;
 
     // check first if there are quequed tokens and return them first
     if( m_deqQueque.size() )
@@ -219,29 +210,21 @@ bool PdfTokenizer::GetNextToken( const char*& pszToken , EPdfTokenType* peType )
         *peType = ePdfTokenType_Token;
 
     while( (c = m_device.Device()->Look()) != EOF
-           && counter < static_cast<long long>(m_buffer.GetSize()) )
+           && counter < lMaxLen )
     {
         // ignore leading whitespaces
         if( !counter && IsWhitespace( c ) )
         {
-            // Consume the whitespace character
+            // Consume the whitespace character and all following ones
             c = m_device.Device()->GetChar();
+            this->SkipWhitespace();
             continue;
         }
         // ignore comments
         else if( c == '%' ) 
         {
-            // Consume all characters before the next line break
-			// 2011-04-19 Ulrich Arnold: accept 0x0D, 0x0A and oX0D 0x0A as one EOL
-            do {
-                c = m_device.Device()->GetChar();
-            } while( c != EOF && c != 0x0D  && c != 0x0A );
-			
-            if ( c == 0x0D )
-			{
-                if ( m_device.Device()->Look() == 0x0A )
-	                c = m_device.Device()->GetChar();
-			}
+            this->SkipComment();
+
             // If we've already read one or more chars of a token, return them, since
             // comments are treated as token-delimiting whitespace. Otherwise keep reading
             // at the start of the next line.
@@ -293,6 +276,9 @@ bool PdfTokenizer::GetNextToken( const char*& pszToken , EPdfTokenType* peType )
                     *peType = ePdfTokenType_Delimiter;
                 break;
             }
+
+            // Add the rest of the token at once
+            this->ReadRegular( counter );
         }
     }
 
@@ -311,6 +297,82 @@ bool PdfTokenizer::GetNextToken( const char*& pszToken , EPdfTokenType* peType )
     return true;
 }
 
+void PdfTokenizer::ReadRegular( pdf_long & lCounter )
+{
+    PdfInputDevice* pDevice = m_device.Device();
+    const pdf_long  lMaxLen = static_cast<pdf_long>(m_buffer.GetSize()) - 1;
+    const char*     pWindow;
+    size_t          lAvail;
+
+    while( lCounter < lMaxLen && (lAvail = pDevice->GetWindow( &pWindow )) > 0 )
+    {
+        size_t lLen = PDF_MIN( lAvail, static_cast<size_t>(lMaxLen - lCounter) );
+        size_t i    = 0;
+        while( i < lLen && IsRegular( pWindow[i] ) )
+            ++i;
+
+        memcpy( m_buffer.GetBuffer() + lCounter, pWindow, i );
+        pDevice->Advance( i );
+        lCounter += i;
+
+        if( i < lAvail )
+            break;
+    }
+}
+
+void PdfTokenizer::SkipWhitespace()
+{
+    PdfInputDevice* pDevice = m_device.Device();
+    const char*     pWindow;
+    size_t          lAvail;
+
+    while( (lAvail = pDevice->GetWindow( &pWindow )) > 0 )
+    {
+        size_t i = 0;
+        while( i < lAvail && IsWhitespace( pWindow[i] ) )
+            ++i;
+
+        pDevice->Advance( i );
+
+        if( i < lAvail )
+            break;
+    }
+}
+
+void PdfTokenizer::SkipComment()
+{
+    PdfInputDevice* pDevice = m_device.Device();
+    const char*     pWindow;
+    size_t          lAvail;
+    int             c       = EOF;
+
+    // Consume all characters before the next line break
+    // 2011-04-19 Ulrich Arnold: accept 0x0D, 0x0A and oX0D 0x0A as one EOL
+    while( c == EOF && (lAvail = pDevice->GetWindow( &pWindow )) > 0 )
+    {
+        size_t i = 0;
+        while( i < lAvail && pWindow[i] != 0x0D && pWindow[i] != 0x0A )
+            ++i;
+
+        if( i < lAvail )
+            c = pWindow[i++];
+
+        pDevice->Advance( i );
+    }
+
+    // Input devices which do not buffer their data
+    // are read one character at a time
+    if( c == EOF )
+    {
+        do {
+            c = pDevice->GetChar();
+        } while( c != EOF && c != 0x0D  && c != 0x0A );
+    }
+
+    if ( c == 0x0D && pDevice->Look() == 0x0A )
+        pDevice->GetChar();
+}
+
 bool PdfTokenizer::IsNextToken( const char* pszToken )
 {
     if( !pszToken )
@@ -642,6 +704,20 @@ void PdfTokenizer::ReadString( PdfVariant& rVariant, PdfEncrypt* pEncrypt )
         // end of stream reached
         if( !bEscape ) 
         {
+            // Copy all characters without a special meaning at once
+            const char* pWindow;
+            size_t      lAvail = m_device.Device()->GetWindow( &pWindow );
+            size_t      i      = 0;
+            while( i < lAvail && pWindow[i] != '(' && pWindow[i] != ')' && pWindow[i] != '\\' )
+                ++i;
+
+            if( i ) 
+            {
+                m_vecBuffer.insert( m_vecBuffer.end(), pWindow, pWindow + i );
+                m_device.Device()->Advance( i );
+                continue;
+            }
+
             // Handle raw characters
             c = m_device.Device()->GetChar();
             if( !nBalanceCount && c == ')' )
@@ -727,8 +803,31 @@ void PdfTokenizer::ReadHexString( PdfVariant& rVariant, PdfEncrypt* pEncrypt )
 
     m_vecBuffer.clear();
 
-    while( (c = m_device.Device()->GetChar()) != EOF )
+    while( (c = m_device.Device()->Look()) != EOF )
     {
+        // Collect the hex digits of all buffered characters at once
+        const char* pWindow;
+        size_t      lAvail = m_device.Device()->GetWindow( &pWindow );
+        size_t      i      = 0;
+        while( i < lAvail && pWindow[i] != '>' )
+        {
+            // only a hex digits
+            const char ch = pWindow[i];
+            if( ( ch >= '0' && ch <= '9') ||
+                ( ch >= 'A' && ch <= 'F') ||
+                ( ch >= 'a' && ch <= 'f'))
+                m_vecBuffer.push_back( ch );
+            ++i;
+        }
+
+        if( i )
+        {
+            m_device.Device()->Advance( i );
+            continue;
+        }
+
+        c = m_device.Device()->GetChar();
+
         // end of stream reached
         if( c == '>' )
             break;
@@ -51,6 +51,15 @@ typedef TTokenizerQueque::const_iterator     TCITokenizerQueque;
  */
 class PODOFO_API PdfTokenizer {
  public:
+    /** Character classes according to the PDF reference
+     *  (Section 3.1.1, Character Set)
+     */
+    enum ECharClass {
+        eCharClass_Regular    = 0,
+        eCharClass_Whitespace = 1,
+        eCharClass_Delimiter  = 2
+    };
+
     PdfTokenizer();
 
     PdfTokenizer( const char* pBuffer, size_t lLen );
@@ -141,6 +150,16 @@ class PODOFO_API PdfTokenizer {
      */
     PODOFO_NOTHROW inline static bool IsPrintable(const unsigned char ch);
 
+    /** Get the class of a character from a static map.
+     *  This allows scanning for the end of a token with
+     *  a single table lookup per character.
+     *
+     *  \param ch a character
+     *
+     *  \returns whether ch is a regular, whitespace or delimiter character
+     */
+    PODOFO_NOTHROW inline static ECharClass GetCharClass(const unsigned char ch);
+
     /**
      * Get the hex value from a static map of a given hex character (0-9, A-F, a-f).
      *
@@ -232,16 +251,33 @@ class PODOFO_API PdfTokenizer {
      */
     void QuequeToken( const char* pszToken, EPdfTokenType eType );
 
+ private:
+    /** Consume all regular characters at the current position
+     *  of the input device and append them to m_buffer.
+     *
+     *  \param lCounter number of characters already in m_buffer,
+     *                  is increased by the number of appended characters
+     */
+    void ReadRegular( pdf_long & lCounter );
+
+    /** Consume all whitespace characters at the current position
+     *  of the input device.
+     */
+    void SkipWhitespace();
+
+    /** Consume all characters up to the next end of line character
+     *  at the current position of the input device.
+     */
+    void SkipComment();
+
  protected:
     PdfRefCountedInputDevice m_device;
     PdfRefCountedBuffer      m_buffer;
 
  private:
-    // 256-byte array mapping character ordinal values to a truth value
-    // indicating whether or not they are whitespace according to the PDF
-    // standard.
-    static const char * const s_delimiterMap;
-    static const char * const s_whitespaceMap;
+    // 256-byte array mapping character ordinal values to their 
+    // ECharClass according to the PDF standard.
+    static const char * const s_charClassMap;
     static const char s_octMap[]; ///< Map of bool values, if a certain char
                                   ///< is a valid octal digit
     static const char * const s_escMap; ///< Mapping of escape sequences to there value
@@ -267,7 +303,7 @@ class PODOFO_API PdfTokenizer {
 // -----------------------------------------------------
 inline bool PdfTokenizer::IsWhitespace(const unsigned char ch)
 {
-    return ( PdfTokenizer::s_whitespaceMap[static_cast<size_t>(ch)] != 0 );
+    return ( PdfTokenizer::s_charClassMap[static_cast<size_t>(ch)] == eCharClass_Whitespace );
 }
 
 // -----------------------------------------------------
@@ -275,7 +311,7 @@ inline bool PdfTokenizer::IsWhitespace(const unsigned char ch)
 // -----------------------------------------------------
 inline bool PdfTokenizer::IsDelimiter(const unsigned char ch)
 {
-    return ( PdfTokenizer::s_delimiterMap[ch] != 0 );
+    return ( PdfTokenizer::s_charClassMap[static_cast<size_t>(ch)] == eCharClass_Delimiter );
 }
 
 // -----------------------------------------------------
@@ -283,7 +319,7 @@ inline bool PdfTokenizer::IsDelimiter(const unsigned char ch)
 // -----------------------------------------------------
 inline bool PdfTokenizer::IsRegular(const unsigned char ch)
 {
-    return !IsWhitespace(ch) && !IsDelimiter(static_cast<size_t>(ch));
+    return ( PdfTokenizer::s_charClassMap[static_cast<size_t>(ch)] == eCharClass_Regular );
 }
 
 // -----------------------------------------------------
@@ -302,6 +338,14 @@ inline int PdfTokenizer::GetHexValue(const unsigned char ch)
     return PdfTokenizer::s_hexMap[static_cast<size_t>(ch)];
 }
 
+// -----------------------------------------------------
+// 
+// -----------------------------------------------------
+inline PdfTokenizer::ECharClass PdfTokenizer::GetCharClass(const unsigned char ch)
+{
+    return static_cast<ECharClass>(PdfTokenizer::s_charClassMap[static_cast<size_t>(ch)]);
+}
+
 
 };
 
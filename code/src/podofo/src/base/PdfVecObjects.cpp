@@ -30,6 +30,13 @@
 
 #include <algorithm>
 
+/** Objects with larger numbers are not stored in the lookup table.
+ *  This is the largest object number allowed by the PDF Reference
+ *  (implementation limits), it protects against broken files with
+ *  huge object numbers.
+ */
+#define PDF_VEC_OBJECTS_MAX_LOOKUP 8388607
+
 namespace {
 
 inline bool ObjectLittle( const PoDoFo::PdfObject* p1, const PoDoFo::PdfObject* p2 )
@@ -88,7 +95,8 @@ private:
 };
 
 PdfVecObjects::PdfVecObjects()
-    : m_bAutoDelete( false ), m_nObjectCount( 1 ), m_bSorted( true ), m_pDocument( NULL ), m_pStreamFactory( NULL )
+    : m_bAutoDelete( false ), m_nObjectCount( 1 ), m_bSorted( true ), m_bLookupAmbiguous( false ),
+      m_pDocument( NULL ), m_pStreamFactory( NULL )
 {
 }
 
@@ -122,7 +130,9 @@ void PdfVecObjects::Clear()
     }
 
     m_vector.clear();
+    m_vecLookup.clear();
 
+    m_bLookupAmbiguous = false;
     m_bAutoDelete    = false;
     m_nObjectCount   = 1;
     m_bSorted        = true; // an emtpy vector is sorted
@@ -131,6 +141,20 @@ void PdfVecObjects::Clear()
 }
 
 PdfObject* PdfVecObjects::GetObject( const PdfReference & ref ) const
+{
+    const pdf_objnum nObj = ref.ObjectNumber();
+    if( nObj < m_vecLookup.size() ) 
+    {
+        PdfObject* pObj = m_vecLookup[nObj];
+        if( pObj && pObj->Reference() == ref ) 
+            return pObj;
+    }
+
+    // Without ambiguous object numbers the lookup table is complete
+    return m_bLookupAmbiguous ? this->FindSorted( ref ) : NULL;
+}
+
+PdfObject* PdfVecObjects::FindSorted( const PdfReference & ref ) const
 {
     if( !m_bSorted )
         const_cast<PdfVecObjects*>(this)->Sort();
@@ -142,15 +166,51 @@ PdfObject* PdfVecObjects::GetObject( const PdfReference & ref ) const
     if( it.first != it.second )
         return *(it.first);
 
-    /*
-    const TCIVecObjects it ( std::find_if( this->begin(), this->end(), ObjectsComparator( ref ) ) );
-    if( it != this->end() )
-        return (*it);
-    */
-
     return NULL;
 }
 
+void PdfVecObjects::AddToLookup( PdfObject* pObj )
+{
+    const pdf_objnum nObj = pObj->Reference().ObjectNumber();
+    if( nObj > PDF_VEC_OBJECTS_MAX_LOOKUP ) 
+    {
+        m_bLookupAmbiguous = true;
+        return;
+    }
+
+    if( nObj >= m_vecLookup.size() )
+        m_vecLookup.resize( nObj + 1, NULL );
+
+    if( m_vecLookup[nObj] && m_vecLookup[nObj] != pObj ) 
+    {
+        // Keep the first object, the other one is found by FindSorted
+        m_bLookupAmbiguous = true;
+        return;
+    }
+
+    m_vecLookup[nObj] = pObj;
+}
+
+void PdfVecObjects::RemoveFromLookup( const PdfObject* pObj )
+{
+    const pdf_objnum nObj = pObj->Reference().ObjectNumber();
+    if( nObj < m_vecLookup.size() && m_vecLookup[nObj] == pObj ) 
+        m_vecLookup[nObj] = NULL;
+}
+
+void PdfVecObjects::RebuildLookup()
+{
+    m_vecLookup.clear();
+    m_bLookupAmbiguous = false;
+
+    TCIVecObjects it = m_vector.begin();
+    while( it != m_vector.end() )
+    {
+        this->AddToLookup( *it );
+        ++it;
+    }
+}
+
 size_t PdfVecObjects::GetIndex( const PdfReference & ref ) const
 {
     if( !m_bSorted )
@@ -170,6 +230,11 @@ size_t PdfVecObjects::GetIndex( const PdfReference & ref ) const
 
 PdfObject* PdfVecObjects::RemoveObject( const PdfReference & ref, bool bMarkAsFree )
 {
+    // Most removed references do not exist, e.g. when the parser
+    // checks for duplicates, so avoid sorting in this case.
+    if( !this->GetObject( ref ) )
+        return NULL;
+
     if( !m_bSorted )
         this->Sort();
 
@@ -185,6 +250,7 @@ PdfObject* PdfVecObjects::RemoveObject( const PdfReference & ref, bool bMarkAsFr
         if( bMarkAsFree )
             this->AddFreeObject( pObj->Reference() );
         m_vector.erase( it.first );
+        this->RemoveFromLookup( pObj );
         return pObj;
     }
     
@@ -195,6 +261,7 @@ PdfObject* PdfVecObjects::RemoveObject( const TIVecObjects & it )
 {
     PdfObject* pObj = *it;
     m_vector.erase( it );
+    this->RemoveFromLookup( pObj );
     return pObj;
 }
 
@@ -226,6 +293,9 @@ PdfObject* PdfVecObjects::CreateObject( const char* pszType )
     PdfReference ref = this->GetNextFreeObject();
     PdfObject*  pObj = new PdfObject( ref, pszType );
     pObj->SetOwner( this );
+    // The reference might be reused from a deleted object,
+    // so mark the object as modified for incremental updates
+    pObj->SetDirty( true );
 
     this->push_back( pObj );
 
@@ -237,6 +307,7 @@ PdfObject* PdfVecObjects::CreateObject( const PdfVariant & rVariant )
     PdfReference ref = this->GetNextFreeObject();
     PdfObject*  pObj = new PdfObject( ref, rVariant );
     pObj->SetOwner( this );    
+    pObj->SetDirty( true );
 
     this->push_back( pObj );
 
@@ -245,6 +316,14 @@ PdfObject* PdfVecObjects::CreateObject( const PdfVariant & rVariant )
 
 void PdfVecObjects::AddFreeObject( const PdfReference & rReference )
 {
+    // Free objects are usually added in ascending order by the parser
+    if( m_lstFreeObjects.empty() || m_lstFreeObjects.back() < rReference ) 
+    {
+        SetObjectCount( rReference );
+        m_lstFreeObjects.push_back( rReference );
+        return;
+    }
+
     std::pair<TIPdfReferenceList,TIPdfReferenceList> it = 
         std::equal_range( m_lstFreeObjects.begin(), m_lstFreeObjects.end(), rReference, ReferenceComparatorPredicate() );
 
@@ -275,6 +354,7 @@ void PdfVecObjects::push_back( PdfObject* pObj )
 
     pObj->SetOwner( this );
     m_vector.push_back( pObj );
+    this->AddToLookup( pObj );
 }
 
 void PdfVecObjects::insert_sorted( PdfObject* pObj )
@@ -286,7 +366,8 @@ void PdfVecObjects::insert_sorted( PdfObject* pObj )
       TVecObjects::iterator i_pos = std::lower_bound(m_vector.begin(),m_vector.end(),pObj,ObjectLittle);
       m_vector.insert(i_pos, pObj );
     } else m_vector.push_back( pObj );
- 
+
+    this->AddToLookup( pObj );
 }
 
 void PdfVecObjects::RenumberObjects( PdfObject* pTrailer, TPdfReferenceSet* pNotDelete, bool bDoGarbageCollection )
@@ -329,7 +410,44 @@ void PdfVecObjects::RenumberObjects( PdfObject* pTrailer, TPdfReferenceSet* pNot
         ++it;
     }
 
-    
+    this->RebuildLookup();
+}
+
+void PdfVecObjects::ChangeReferences( PdfObject* pTrailer, const TVecObjects & rvecObjects, 
+                                      const std::vector<PdfReference> & rvecReferences )
+{
+    TVecReferencePointerList list;
+    std::vector<size_t>      vecIndex( rvecObjects.size() );
+
+    PODOFO_RAISE_LOGIC_IF( rvecObjects.size() != m_vector.size() || rvecReferences.size() != m_vector.size(),
+                           "PdfVecObjects::ChangeReferences requires a new reference for each object!" );
+
+    if( !m_bSorted )
+        this->Sort();
+
+    BuildReferenceCountVector( &list );
+    InsertReferencesIntoVector( pTrailer, &list );
+
+    // Find all objects before the first one is changed
+    for( size_t i = 0; i < rvecObjects.size(); i++ )
+        vecIndex[i] = this->GetIndex( rvecObjects[i]->Reference() );
+
+    for( size_t i = 0; i < rvecObjects.size(); i++ )
+    {
+        const PdfReference & ref = rvecReferences[i];
+        m_vector[vecIndex[i]]->m_reference = ref;
+
+        TIReferencePointerList itList = list[vecIndex[i]].begin();
+        while( itList != list[vecIndex[i]].end() )
+        {
+            *(*itList) = ref;
+            ++itList;
+        }
+    }
+
+    m_bSorted = false;
+    this->Sort();
+    this->RebuildLookup();
 }
 
 void PdfVecObjects::InsertOneReferenceIntoVector( const PdfObject* pObj, TVecReferencePointerList* pList )  
@@ -340,12 +458,13 @@ void PdfVecObjects::InsertOneReferenceIntoVector( const PdfObject* pObj, TVecRef
                            "PdfVecObjects must be sorted before calling PdfVecObjects::InsertOneReferenceIntoVector!" );
     
     // we asume that pObj is a reference - no checking here because of speed
+    PdfObject refObj( pObj->GetReference(), NULL );
     std::pair<TCIVecObjects,TCIVecObjects> it = 
-        std::equal_range( m_vector.begin(), m_vector.end(), pObj, ObjectComparatorPredicate() );
+        std::equal_range( m_vector.begin(), m_vector.end(), &refObj, ObjectComparatorPredicate() );
 
-    if( it.first != it.second )
+    if( it.first == it.second )
     {
-        // ignore this reference
+        // ignore references to objects which do not exist
         return;
         //PODOFO_RAISE_ERROR( ePdfError_NoObject );
     }
@@ -397,52 +516,61 @@ void PdfVecObjects::InsertReferencesIntoVector( const PdfObject* pObj, TVecRefer
 
 void PdfVecObjects::GetObjectDependencies( const PdfObject* pObj, TPdfReferenceList* pList ) const
 {
-    PdfArray::const_iterator   itArray;
-    TCIKeyMap                  itKeys;
-  
-    if( pObj->IsReference() )
+    // References already in the list are not followed again.
+    // An explicit stack is used, as the recursion could be very
+    // deep for long chains of references, e.g. in the pages tree.
+    TPdfReferenceSet                setDependencies( pList->begin(), pList->end() );
+    std::vector<const PdfObject*>   stack;
+    PdfArray::const_iterator        itArray;
+    TCIKeyMap                       itKeys;
+
+    stack.push_back( pObj );
+    while( !stack.empty() )
     {
-        std::pair<TPdfReferenceList::iterator, TPdfReferenceList::iterator> itEqualRange
-            = std::equal_range( pList->begin(), pList->end(), pObj->GetReference() );
-        if( itEqualRange.first == itEqualRange.second )
-        {
-            pList->insert(itEqualRange.first, pObj->GetReference() );
+        pObj = stack.back();
+        stack.pop_back();
 
-            const PdfObject* referencedObject = this->GetObject(pObj->GetReference());
-            if( referencedObject != NULL )
+        if( pObj->IsReference() )
+        {
+            if( setDependencies.insert( pObj->GetReference() ).second )
             {
-                this->GetObjectDependencies( referencedObject, pList );
+                const PdfObject* referencedObject = this->GetObject( pObj->GetReference() );
+                if( referencedObject != NULL )
+                    stack.push_back( referencedObject );
             }
         }
-    }
-    else if( pObj->IsArray() )
-    {
-        itArray = pObj->GetArray().begin(); 
-        while( itArray != pObj->GetArray().end() )
+        else if( pObj->IsArray() )
         {
-            if( (*itArray).IsArray() ||
-                (*itArray).IsDictionary() ||
-                (*itArray).IsReference() )
-                GetObjectDependencies( &(*itArray), pList );
+            itArray = pObj->GetArray().begin(); 
+            while( itArray != pObj->GetArray().end() )
+            {
+                if( (*itArray).IsArray() ||
+                    (*itArray).IsDictionary() ||
+                    (*itArray).IsReference() )
+                    stack.push_back( &(*itArray) );
 
-            ++itArray;
+                ++itArray;
+            }
         }
-    }
-    else if( pObj->IsDictionary() )
-    {
-        itKeys = pObj->GetDictionary().GetKeys().begin();
-        while( itKeys != pObj->GetDictionary().GetKeys().end() )
+        else if( pObj->IsDictionary() )
         {
-            // optimization as this is really slow:
-            // Call only for dictionaries, references and arrays
-            if( (*itKeys).second->IsArray() ||
-                (*itKeys).second->IsDictionary() ||
-                (*itKeys).second->IsReference() )
-                GetObjectDependencies( (*itKeys).second, pList );
+            itKeys = pObj->GetDictionary().GetKeys().begin();
+            while( itKeys != pObj->GetDictionary().GetKeys().end() )
+            {
+                // optimization as this is really slow:
+                // Call only for dictionaries, references and arrays
+                if( (*itKeys).second->IsArray() ||
+                    (*itKeys).second->IsDictionary() ||
+                    (*itKeys).second->IsReference() )
+                    stack.push_back( (*itKeys).second );
             
-            ++itKeys;
+                ++itKeys;
+            }
         }
     }
+
+    // the set is sorted, just like the list has to be
+    pList->assign( setDependencies.begin(), setDependencies.end() );
 }
 
 void PdfVecObjects::BuildReferenceCountVector( TVecReferencePointerList* pList )
@@ -450,7 +578,7 @@ void PdfVecObjects::BuildReferenceCountVector( TVecReferencePointerList* pList )
     TCIVecObjects      it      = this->begin();
 
     pList->clear();
-    pList->resize( !m_vector.empty() );
+    pList->resize( m_vector.size() );
 
     while( it != this->end() )
     {
@@ -193,8 +193,12 @@ class PODOFO_API PdfVecObjects {
      */
     size_t GetObjectCount() const { return m_nObjectCount; }
 
-    /** Finds the object with the given reference in m_vecOffsets 
+    /** Finds the object with the given reference
      *  and returns a pointer to it if it is found.
+     *
+     *  Objects are looked up by their object number in constant time,
+     *  the vector does not have to be sorted for this.
+     *
      *  \param ref the object to be found
      *  \returns the found object or NULL if no object was found.
      */
@@ -265,6 +269,22 @@ class PODOFO_API PdfVecObjects {
      */
     void RenumberObjects( PdfObject* pTrailer, TPdfReferenceSet* pNotDelete = NULL, bool bDoGarbageCollection = false );
 
+    /** 
+     *  Give all objects new references and update all references to them,
+     *  including the ones in the trailer. The free list is not changed.
+     *
+     *  This is used by PdfWriter to write linearized PDF files, which
+     *  require the objects to be numbered in the order they are written.
+     *  Calling it again with the old references restores the document.
+     *
+     *  \param pTrailer the trailer object
+     *  \param rvecObjects all objects in this vector, in any order
+     *  \param rvecReferences the new reference of each object in rvecObjects,
+     *                        no reference may be used twice
+     */
+    void ChangeReferences( PdfObject* pTrailer, const TVecObjects & rvecObjects, 
+                           const std::vector<PdfReference> & rvecReferences );
+
     /** Insert a object into this vector.
      *  Overwritten from std::vector so that 
      *  m_bObjectCount can be increased for each object.
@@ -412,6 +432,26 @@ class PODOFO_API PdfVecObjects {
      */
     PdfReference GetNextFreeObject();
 
+    /** Add an object to m_vecLookup
+     *  \param pObj an object that was added to m_vector
+     */
+    void AddToLookup( PdfObject* pObj );
+
+    /** Remove an object from m_vecLookup
+     *  \param pObj an object that was removed from m_vector
+     */
+    void RemoveFromLookup( const PdfObject* pObj );
+
+    /** Recreate m_vecLookup from m_vector, e.g. after renumbering
+     */
+    void RebuildLookup();
+
+    /** Find an object using a binary search in the sorted vector
+     *  \param ref the object to be found
+     *  \returns the found object or NULL
+     */
+    PdfObject* FindSorted( const PdfReference & ref ) const;
+
     /** 
      * Create a list of all references that point to the object
      * for each object in this vector.
@@ -446,6 +486,11 @@ class PODOFO_API PdfVecObjects {
     bool                m_bSorted;
     TVecObjects         m_vector;
 
+    TVecObjects         m_vecLookup;         ///< the objects of m_vector indexed by object number
+    bool                m_bLookupAmbiguous;  ///< true if m_vecLookup can't hold every object, because
+                                             ///< several objects share an object number or a number is too large.
+                                             ///< Lookups that miss search m_vector then.
+
 
     TVecObservers       m_vecObservers;
     TPdfReferenceList   m_lstFreeObjects;
@@ -472,6 +517,7 @@ inline size_t PdfVecObjects::GetSize() const
 inline void PdfVecObjects::Reserve( size_t size )
 {
     m_vector.reserve( size );
+    m_vecLookup.reserve( size + 1 );
 }
 
 // -----------------------------------------------------
@@ -23,7 +23,7 @@
 #include "PdfData.h"
 #include "PdfDate.h"
 #include "PdfDictionary.h"
-//#include "PdfHintStream.h"
+#include "PdfHintStream.h"
 #include "PdfObject.h"
 #include "PdfParser.h"
 #include "PdfStream.h"
@@ -36,17 +36,44 @@
 #define PDF_MAGIC           "\xe2\xe3\xcf\xd3\n"
 // 10 spaces
 #define LINEARIZATION_PADDING "          " 
+// Maximum number of objects in one object stream
+#define PDF_OBJECT_STREAM_SIZE 100
 
 #include <iostream>
 #include <stdlib.h>
 
 namespace PoDoFo {
 
+/** Owners of the objects in a linearized PDF file.
+ *  Objects used by a single page are owned by the page number.
+ */
+enum ELinearizedOwner {
+    eLinearizedOwner_None      = -1, ///< not reached yet
+    eLinearizedOwner_Open      = -2, ///< required to open the document
+    eLinearizedOwner_Shared    = -3, ///< used by several pages
+    eLinearizedOwner_Page      = -4, ///< a page object
+    eLinearizedOwner_PagesTree = -5, ///< a node of the pages tree
+    eLinearizedOwner_Other     = -6, ///< not used by any page
+    eLinearizedOwner_Skipped   = -7  ///< a replaced object or XRef stream
+};
+
+/** Append an object to the order of a linearized PDF file
+ *  \param rvecOrder the indices of all objects in the order they are written
+ *  \param rvecPlaced set to true for each index in rvecOrder
+ *  \param nIndex index of the object in the vector of objects
+ */
+static void AppendLinearizedObject( std::vector<size_t> & rvecOrder, std::vector<bool> & rvecPlaced, size_t nIndex )
+{
+    rvecOrder.push_back( nIndex );
+    rvecPlaced[nIndex] = true;
+}
+
 PdfWriter::PdfWriter( PdfParser* pParser )
-    : m_bXRefStream( false ), m_pEncrypt( NULL ), 
+    : m_bXRefStream( false ), m_bObjectStreams( false ), m_pEncrypt( NULL ), 
       m_pEncryptObj( NULL ), 
+      m_lPrevXRefOffset( 0 ), m_lPrevSize( 0 ),
       m_eWriteMode( ePdfWriteMode_Compact ),
-      m_bLinearized( false ), m_lFirstInXRef( 0 )
+      m_bLinearized( false )
 {
     if( !(pParser && pParser->GetTrailer()) )
     {
@@ -59,10 +86,11 @@ PdfWriter::PdfWriter( PdfParser* pParser )
 }
 
 PdfWriter::PdfWriter( PdfVecObjects* pVecObjects, const PdfObject* pTrailer )
-    : m_bXRefStream( false ), m_pEncrypt( NULL ), 
+    : m_bXRefStream( false ), m_bObjectStreams( false ), m_pEncrypt( NULL ), 
       m_pEncryptObj( NULL ), 
+      m_lPrevXRefOffset( 0 ), m_lPrevSize( 0 ),
       m_eWriteMode( ePdfWriteMode_Compact ),
-      m_bLinearized( false ), m_lFirstInXRef( 0 )
+      m_bLinearized( false )
 {
     if( !pVecObjects || !pTrailer )
     {
@@ -75,10 +103,11 @@ PdfWriter::PdfWriter( PdfVecObjects* pVecObjects, const PdfObject* pTrailer )
 }
 
 PdfWriter::PdfWriter( PdfVecObjects* pVecObjects )
-    : m_bXRefStream( false ), m_pEncrypt( NULL ), 
+    : m_bXRefStream( false ), m_bObjectStreams( false ), m_pEncrypt( NULL ), 
       m_pEncryptObj( NULL ), 
+      m_lPrevXRefOffset( 0 ), m_lPrevSize( 0 ),
       m_eWriteMode( ePdfWriteMode_Compact ), 
-      m_bLinearized( false ), m_lFirstInXRef( 0 )
+      m_bLinearized( false )
 {
     m_eVersion     = ePdfVersion_Default;
     m_pTrailer     = new PdfObject();
@@ -135,27 +164,50 @@ void PdfWriter::Write( PdfOutputDevice* pDevice )
     }
     else
     {
+        // Objects in object streams cannot be encrypted one by one
+        const bool bObjectStreams = m_bObjectStreams && !m_pEncrypt;
+        if( bObjectStreams )
+        {
+            m_bXRefStream = true;
+            if( m_eVersion < ePdfVersion_1_5 )
+                m_eVersion = ePdfVersion_1_5;
+        }
+
+        // Must be called before the XRef stream object is created
+        TPdfReferenceList lstReplaced;
+        if( bObjectStreams )
+            this->GetReplacedStreams( lstReplaced );
+
         PdfXRef* pXRef = m_bXRefStream ? new PdfXRefStream( m_vecObjects, this ) : new PdfXRef();
 
+        // Objects are written in the order of their object numbers
+        m_vecObjects->Sort();
+
         try {
             WritePdfHeader  ( pDevice );
-            WritePdfObjects ( pDevice, *m_vecObjects, pXRef );
-
-            pXRef->Write( pDevice );
-            
-            // XRef streams contain the trailer in the XRef
-            if( !m_bXRefStream ) 
+            if( bObjectStreams ) 
             {
-                PdfObject  trailer;
-                
-                // if we have a dummy offset we write also a prev entry to the trailer
-                FillTrailerObject( &trailer, pXRef->GetSize(), false, false );
-                
-                pDevice->Print("trailer\n");
-                trailer.WriteObject( pDevice, m_eWriteMode, NULL ); // Do not encrypt the trailer dicionary!!!
+                std::vector<bool> vecSkip( m_vecObjects->GetObjectCount(), false );
+
+                TCIPdfReferenceList it = lstReplaced.begin();
+                while( it != lstReplaced.end() )
+                {
+                    vecSkip[(*it).ObjectNumber()] = true;
+                    pXRef->AddObject( PdfReference( (*it).ObjectNumber(), (*it).GenerationNumber() + 1 ), 0, false );
+                    ++it;
+                }
+
+                std::vector<PdfObject*> vecOrder;
+                GetObjectStreamOrder( vecOrder );
+
+                WriteObjectStreams( pDevice, pXRef, vecOrder, vecSkip );
+                WriteUnpackedObjects( pDevice, pXRef, vecSkip );
             }
-            
-            pDevice->Print( "startxref\n%li\n%%%%EOF\n", pXRef->GetOffset() );
+            else
+                WritePdfObjects ( pDevice, *m_vecObjects, pXRef );
+
+            WriteXRefAndTrailer( pDevice, pXRef );
+
             delete pXRef;
         } catch( PdfError & e ) {
             // Make sure pXRef is always deleted
@@ -166,81 +218,581 @@ void PdfWriter::Write( PdfOutputDevice* pDevice )
     }
 }
 
-void PdfWriter::WriteLinearized( PdfOutputDevice* /* pDevice */ )
+void PdfWriter::WriteUpdate( PdfOutputDevice* pDevice, const TPdfReferenceList & rOriginal,
+                             pdf_long lPrevXRefOffset, pdf_long lPrevSize )
 {
-    /*
-    PdfObject*      pLinearize  = NULL;
-    PdfPage*        pPage;
-    PdfObject*      pLast;
-    NonPublic::PdfHintStream*  pHint;
-    PdfOutputDevice length;
-    TVecXRefTable   vecXRef;
-    TVecXRefOffset  vecXRefOffset;
-    TIVecOffsets    it;
+    if( !pDevice )
+    {
+        PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
+    }
 
-    // prepare the document for linearization
-    this->FetchPagesTree();
-    pPage = m_pPagesTree->GetPage( 0 );
-    
-    pLinearize = CreateLinearizationDictionary();
-    pHint      = new NonPublic::PdfHintStream( m_vecObjects, m_pPagesTree );
-    
-    this->ReorderObjectsLinearized( pLinearize, pHint, pPage, &pLast );
+    // The first identifier is permanent, only the second one
+    // changes with an incremental update
+    CreateFileIdentifier( m_identifier, m_pTrailer );
 
-    // The file is prepared for linearization,
-    // so write it now.
-    WritePdfHeader( pDevice );
+    const PdfObject* pId = m_pTrailer->GetDictionary().GetKey( "ID" );
+    if( pId && pId->IsArray() && pId->GetArray().GetSize() &&
+        (pId->GetArray()[0].IsString() || pId->GetArray()[0].IsHexString()) )
+        m_originalIdentifier = pId->GetArray()[0].GetString();
+
+    // Reuse the encryption of the original file, the key is already known.
+    // The encryption dictionary itself must never be encrypted.
+    if( m_pEncrypt )
+    {
+        const PdfObject* pEncrypt = m_pTrailer->GetDictionary().GetKey( "Encrypt" );
+        if( pEncrypt && pEncrypt->IsReference() )
+            m_pEncryptObj = m_vecObjects->GetObject( pEncrypt->GetReference() );
+    }
+
+    m_lPrevXRefOffset = lPrevXRefOffset;
+    m_lPrevSize       = lPrevSize;
+
+    PdfXRef* pXRef = m_bXRefStream ? new PdfXRefStream( m_vecObjects, this ) : new PdfXRef();
 
-    m_lLinearizedOffset = pDevice->GetLength();
-    pLinearize->WriteObject( pDevice );
+    try {
+        // The original file might not end with an end of line marker
+        pDevice->Print( "\n" );
 
-    // fill the XRef table with the objects
+        WriteUpdatedObjects( pDevice, rOriginal, pXRef );
+        WriteXRefAndTrailer( pDevice, pXRef );
+
+        delete pXRef;
+    } catch( PdfError & e ) {
+        // Make sure pXRef is always deleted
+        delete pXRef;
+        e.AddToCallstack( __FILE__, __LINE__ );
+        throw e;
+    }
+}
+
+void PdfWriter::WriteXRefAndTrailer( PdfOutputDevice* pDevice, PdfXRef* pXRef )
+{
+    pXRef->Write( pDevice );
+
+    // XRef streams contain the trailer in the XRef
+    if( !m_bXRefStream ) 
     {
-        // Use nested scope and stack local for PdfOutputDevice
-        // rather than using a temporary to stop gcc's whining.
-        PdfOutputDevice o;
-        WritePdfObjects(&o, m_vecLinearized, &vecXRef );
+        PdfObject  trailer;
+
+        // if we have a dummy offset we write also a prev entry to the trailer
+        FillTrailerObject( &trailer, pXRef->GetSize(), false, false );
+
+        pDevice->Print("trailer\n");
+        trailer.WriteObject( pDevice, m_eWriteMode, NULL ); // Do not encrypt the trailer dicionary!!!
     }
 
-    // prepend the linearization dictionary to the XRef table
-    TXRefEntry entry;
-    entry.lOffset     = m_lLinearizedOffset;
-    entry.lGeneration = pLinearize->Reference().GenerationNumber();
-    entry.cUsed       = 'n';
-    
-    vecXRef[0].nCount++;
-    vecXRef[0].nFirst--; 
-    vecXRef[0].vecOffsets.insert( vecXRef[0].vecOffsets.begin(), entry );
+    pDevice->Print( "startxref\n%li\n%%%%EOF\n", pXRef->GetOffset() );
+}
 
-    // Calculate the length of the xref table
-    WritePdfTableOfContents( &vecXRef, &length, &vecXRefOffset, true, false );
-    
-    it = vecXRef[0].vecOffsets.begin(); 
-    it++; // skip the linearization dictionary, as it was written before the XRef table
-          // and does already have a correct offset
-    while( it != vecXRef[0].vecOffsets.end() )
+void PdfWriter::WriteLinearized( PdfOutputDevice* pDevice )
+{
+    NonPublic::TLinearizedLayout layout;
+    this->GetLinearizedLayout( layout );
+
+    // Number the objects in the order they are written. The objects of
+    // the first page follow the ones in the main XRef section, the
+    // linearization dictionary and the hint stream are not in the document.
+    const size_t     nMain      = layout.vecObjects.size() - layout.nOtherPages;
+    const pdf_objnum nLinearize = static_cast<pdf_objnum>(nMain + 1);
+    const pdf_objnum nHint      = static_cast<pdf_objnum>(nLinearize + 1 + layout.nFirstPage);
+    const pdf_objnum nSize      = static_cast<pdf_objnum>(layout.vecObjects.size() + 3);
+
+    TVecObjects               vecObjects;
+    std::vector<PdfReference> vecOld;
+    std::vector<PdfReference> vecNew;
+    size_t                    i;
+
+    vecObjects.reserve( m_vecObjects->GetSize() );
+    vecOld.reserve( m_vecObjects->GetSize() );
+    vecNew.reserve( m_vecObjects->GetSize() );
+    for( i=0;i<layout.vecObjects.size();i++ )
     {
-        (*it).lOffset += pDevice->GetLength() + length.GetLength();
-        m_lLinearizedLastOffset = (*it).lOffset;
-        ++it;
+        pdf_objnum nObj;
+        if( i < layout.nFirstPage )
+            nObj = static_cast<pdf_objnum>(nLinearize + 1 + i);
+        else if( i < layout.nOtherPages )
+            nObj = static_cast<pdf_objnum>(nHint + 1 + i - layout.nFirstPage);
+        else
+            nObj = static_cast<pdf_objnum>(i - layout.nOtherPages + 1);
+
+        vecObjects.push_back( layout.vecObjects[i] );
+        vecOld.push_back( layout.vecObjects[i]->Reference() );
+        vecNew.push_back( PdfReference( nObj, 0 ) );
     }
-    
-    vecXRefOffset.clear();
-    WritePdfTableOfContents( &vecXRef, pDevice, &vecXRefOffset, true, false );
-    vecXRef.clear();
 
-    WritePdfObjects( pDevice, m_vecLinearized, &vecXRef );
-    vecXRef.clear();
+    // Objects which are not written must not use any of the new numbers
+    for( i=0;i<layout.vecSkipped.size();i++ )
+    {
+        vecObjects.push_back( layout.vecSkipped[i] );
+        vecOld.push_back( layout.vecSkipped[i]->Reference() );
+        vecNew.push_back( PdfReference( static_cast<pdf_objnum>(nSize + i), 0 ) );
+    }
+
+    m_vecObjects->ChangeReferences( m_pTrailer, vecObjects, vecNew );
+
+    try {
+        // Measure the file without the hint stream, as the
+        // hint tables need the offsets of such a file
+        PdfOutputDevice length;
+        this->WriteLinearizedFile( &length, layout, NULL );
+
+        PdfObject hint( PdfReference( nHint, 0 ), static_cast<const char*>(NULL) );
+        hint.SetOwner( m_vecObjects );
 
-    WritePdfObjects( pDevice, *m_vecObjects, &vecXRef );
+        NonPublic::PdfHintStream hintStream( &hint );
+        hintStream.Create( layout, layout.nShared < layout.nOther ? 
+                           layout.vecObjects[layout.nShared]->Reference().ObjectNumber() : 0 );
+
+        this->WriteLinearizedFile( pDevice, layout, &hint );
+    } catch( PdfError & e ) {
+        // Always give the document its original object numbers back
+        m_vecObjects->ChangeReferences( m_pTrailer, vecObjects, vecOld );
+        e.AddToCallstack( __FILE__, __LINE__ );
+        throw e;
+    }
+
+    m_vecObjects->ChangeReferences( m_pTrailer, vecObjects, vecOld );
+}
+
+void PdfWriter::GetLinearizedLayout( NonPublic::TLinearizedLayout & rLayout )
+{
+    const size_t            nObjects = m_vecObjects->GetSize();
+    std::vector<int>        vecOwner( nObjects, eLinearizedOwner_None );
+    std::vector<int>        vecStamp( nObjects, -1 );
+    std::vector<PdfObject*> vecPages;
+    std::vector<size_t>     vecOpen;
+    std::vector<size_t>     vecOther;
+    TCIPdfReferenceList     itList;
+    int                     nStamp = 0;
+    size_t                  i, j;
+
+    m_vecObjects->Sort();
+
+    TPdfReferenceList lstReplaced;
+    this->GetReplacedStreams( lstReplaced );
+    for( itList = lstReplaced.begin(); itList != lstReplaced.end(); ++itList )
+        vecOwner[m_vecObjects->GetIndex( *itList )] = eLinearizedOwner_Skipped;
+
+    const PdfObject* pRootRef = m_pTrailer->GetDictionary().GetKey( "Root" );
+    PdfObject*       pRoot    = pRootRef && pRootRef->IsReference() ? m_vecObjects->GetObject( pRootRef->GetReference() ) : NULL;
+    if( !pRoot || !pRoot->IsDictionary() )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_NoObject, "A linearized PDF file requires a catalog dictionary." );
+    }
+
+    // Find all pages in order, the nodes of the pages tree are not part of any page
+    std::vector<PdfObject*> stack;
+    PdfObject* pNode = pRoot->GetIndirectKey( "Pages" );
+    if( pNode )
+        stack.push_back( pNode );
+    while( !stack.empty() )
+    {
+        pNode = stack.back();
+        stack.pop_back();
 
-    if( m_bXRefStream )
-        WriteXRefStream( &vecXRef, pDevice );
+        int & rOwner = vecOwner[m_vecObjects->GetIndex( pNode->Reference() )];
+        if( rOwner != eLinearizedOwner_None || !pNode->IsDictionary() )
+            continue;
+
+        const PdfObject* pKids = pNode->GetDictionary().GetKey( "Kids" );
+        if( pKids && pKids->IsArray() ) 
+        {
+            rOwner = eLinearizedOwner_PagesTree;
+
+            PdfArray::const_reverse_iterator it = pKids->GetArray().rbegin();
+            while( it != pKids->GetArray().rend() )
+            {
+                PdfObject* pKid = (*it).IsReference() ? m_vecObjects->GetObject( (*it).GetReference() ) : NULL;
+                if( pKid )
+                    stack.push_back( pKid );
+
+                ++it;
+            }
+        }
+        else
+        {
+            rOwner = eLinearizedOwner_Page;
+            vecPages.push_back( pNode );
+        }
+    }
+
+    if( vecPages.empty() )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_PageNotFound, "A linearized PDF file requires at least one page." );
+    }
+
+    // The objects required to open the document
+    const size_t nRoot = m_vecObjects->GetIndex( pRoot->Reference() );
+    vecOwner[nRoot] = eLinearizedOwner_Open;
+    vecStamp[nRoot] = nStamp;
+    vecOpen.push_back( nRoot );
+
+    static const char* apszOpenKeys[] = { "ViewerPreferences", "PageMode", "Threads", "OpenAction", "AcroForm", NULL };
+    static const bool  abOpenDependencies[] = { true, true, false, true, false };
+    for( i=0;apszOpenKeys[i];i++ )
+    {
+        const PdfObject* pValue = pRoot->GetDictionary().GetKey( apszOpenKeys[i] );
+        if( !pValue )
+            continue;
+
+        if( abOpenDependencies[i] )
+            this->CollectLinearizedObjects( pValue, eLinearizedOwner_Open, vecOwner, vecStamp, nStamp, vecOpen );
+        else if( pValue->IsReference() && m_vecObjects->GetObject( pValue->GetReference() ) )
+        {
+            // Only the dictionary itself is required
+            const size_t nIndex = m_vecObjects->GetIndex( pValue->GetReference() );
+            if( vecOwner[nIndex] == eLinearizedOwner_None ) 
+            {
+                vecOwner[nIndex] = eLinearizedOwner_Open;
+                vecOpen.push_back( nIndex );
+            }
+        }
+    }
+
+    if( m_pEncryptObj )
+    {
+        const size_t nIndex = m_vecObjects->GetIndex( m_pEncryptObj->Reference() );
+        vecOwner[nIndex] = eLinearizedOwner_Open;
+        vecOpen.push_back( nIndex );
+    }
+
+    // The objects of each page. Objects used by several pages become shared, 
+    // but the first page keeps all of its objects.
+    std::vector< std::vector<size_t> > vecReached( vecPages.size() );
+    static const char* apszInheritedKeys[] = { "Resources", "MediaBox", "CropBox", "Rotate", NULL };
+    for( i=0;i<vecPages.size();i++ )
+    {
+        PdfObject* pPage = vecPages[i];
+        ++nStamp;
+        vecStamp[m_vecObjects->GetIndex( pPage->Reference() )] = nStamp;
+
+        this->CollectLinearizedObjects( pPage, static_cast<int>(i), vecOwner, vecStamp, nStamp, vecReached[i] );
+
+        for( j=0;apszInheritedKeys[j];j++ )
+        {
+            if( pPage->GetDictionary().HasKey( apszInheritedKeys[j] ) )
+                continue;
+
+            // Stop at the root of the pages tree or a broken parent
+            PdfObject* pParent = pPage->GetIndirectKey( "Parent" );
+            for( size_t nDepth = 0; pParent && pParent->IsDictionary() && nDepth < nObjects; nDepth++ )
+            {
+                const PdfObject* pValue = pParent->GetDictionary().GetKey( apszInheritedKeys[j] );
+                if( pValue ) 
+                {
+                    this->CollectLinearizedObjects( pValue, static_cast<int>(i), vecOwner, vecStamp, nStamp, vecReached[i] );
+                    break;
+                }
+
+                pParent = pParent->GetIndirectKey( "Parent" );
+            }
+        }
+
+        // Outlines are displayed with the first page if requested
+        const PdfObject* pPageMode = pRoot->GetDictionary().GetKey( "PageMode" );
+        if( !i && pPageMode && pPageMode->IsName() && pPageMode->GetName() == PdfName( "UseOutlines" ) &&
+            pRoot->GetDictionary().HasKey( "Outlines" ) )
+            this->CollectLinearizedObjects( pRoot->GetDictionary().GetKey( "Outlines" ), 0, 
+                                            vecOwner, vecStamp, nStamp, vecReached[i] );
+    }
+
+    // All other objects which can be reached from the trailer
+    ++nStamp;
+    this->CollectLinearizedObjects( m_pTrailer, eLinearizedOwner_Other, vecOwner, vecStamp, nStamp, vecOther );
+
+    // Order the objects
+    std::vector<size_t> vecOrder;
+    std::vector<bool>   vecPlaced( nObjects, false );
+
+    for( i=0;i<vecOpen.size();i++ )
+        AppendLinearizedObject( vecOrder, vecPlaced, vecOpen[i] );
+
+    rLayout.vecPages.resize( vecPages.size() );
+    for( i=0;i<vecPages.size();i++ )
+    {
+        if( !i )
+            rLayout.nFirstPage = vecOrder.size();
+        else if( i == 1 )
+            rLayout.nOtherPages = vecOrder.size();
+
+        rLayout.vecPages[i].nFirst = vecOrder.size();
+        AppendLinearizedObject( vecOrder, vecPlaced, m_vecObjects->GetIndex( vecPages[i]->Reference() ) );
+
+        for( j=0;j<vecReached[i].size();j++ )
+            if( vecOwner[vecReached[i][j]] == static_cast<int>(i) )
+                AppendLinearizedObject( vecOrder, vecPlaced, vecReached[i][j] );
+
+        rLayout.vecPages[i].nCount = vecOrder.size() - rLayout.vecPages[i].nFirst;
+    }
+
+    if( vecPages.size() == 1 )
+        rLayout.nOtherPages = vecOrder.size();
+
+    rLayout.nShared = vecOrder.size();
+    for( i=1;i<vecPages.size();i++ )
+        for( j=0;j<vecReached[i].size();j++ )
+            if( vecOwner[vecReached[i][j]] == eLinearizedOwner_Shared && !vecPlaced[vecReached[i][j]] )
+                AppendLinearizedObject( vecOrder, vecPlaced, vecReached[i][j] );
+
+    rLayout.nOther = vecOrder.size();
+    for( i=0;i<vecOther.size();i++ )
+        AppendLinearizedObject( vecOrder, vecPlaced, vecOther[i] );
+
+    std::vector<size_t> vecPosition( nObjects, 0 );
+    TVecObjects::const_iterator itObjects = m_vecObjects->begin();
+    for( i=0;i<vecOrder.size();i++ )
+    {
+        vecPosition[vecOrder[i]] = i;
+        rLayout.vecObjects.push_back( *(itObjects + vecOrder[i]) );
+    }
+
+    // The objects of the first page and the shared objects used by each page
+    for( i=1;i<vecPages.size();i++ )
+        for( j=0;j<vecReached[i].size();j++ )
+            if( vecOwner[vecReached[i][j]] == eLinearizedOwner_Shared || vecOwner[vecReached[i][j]] == 0 )
+                rLayout.vecPages[i].vecShared.push_back( vecPosition[vecReached[i][j]] );
+
+    // Replaced streams and objects which cannot be reached are not written
+    for( i=0;i<nObjects;i++ )
+        if( !vecPlaced[i] )
+            rLayout.vecSkipped.push_back( *(itObjects + i) );
+}
+
+void PdfWriter::CollectLinearizedObjects( const PdfVariant* pVariant, int nOwner, std::vector<int> & rvecOwner, 
+                                          std::vector<int> & rvecStamp, int nStamp, std::vector<size_t> & rvecReached )
+{
+    std::vector<const PdfVariant*> stack;
+
+    // Walk depth first like GetObjectStreamOrder, so the objects
+    // are written in the order they are used
+    stack.push_back( pVariant );
+    while( !stack.empty() )
+    {
+        pVariant = stack.back();
+        stack.pop_back();
+
+        if( pVariant->IsReference() )
+        {
+            PdfObject* pObj = m_vecObjects->GetObject( pVariant->GetReference() );
+            if( !pObj )
+                continue;
+
+            const size_t nIndex = m_vecObjects->GetIndex( pObj->Reference() );
+            if( rvecStamp[nIndex] == nStamp )
+                continue;
+
+            rvecStamp[nIndex] = nStamp;
+
+            int & rOwner = rvecOwner[nIndex];
+            if( nOwner == eLinearizedOwner_Other )
+            {
+                // Follow everything which was not collected before
+                if( rOwner == eLinearizedOwner_None || rOwner == eLinearizedOwner_PagesTree )
+                {
+                    if( rOwner == eLinearizedOwner_None )
+                        rOwner = eLinearizedOwner_Other;
+                    rvecReached.push_back( nIndex );
+                }
+                else if( rOwner != eLinearizedOwner_Open )
+                    continue;
+            }
+            else if( rOwner == eLinearizedOwner_None )
+            {
+                rOwner = nOwner;
+                rvecReached.push_back( nIndex );
+            }
+            else if( rOwner == 0 && nOwner > 0 )
+            {
+                // Objects of the first page are never moved and all objects
+                // reached from them belong to the first page, too
+                rvecReached.push_back( nIndex );
+                continue;
+            }
+            else if( nOwner >= 0 && rOwner != nOwner && (rOwner > 0 || rOwner == eLinearizedOwner_Shared) )
+            {
+                rOwner = eLinearizedOwner_Shared;
+                rvecReached.push_back( nIndex );
+            }
+            else
+                continue;
+
+            stack.push_back( pObj );
+        }
+        else if( pVariant->IsDictionary() )
+        {
+            const TKeyMap & keys = pVariant->GetDictionary().GetKeys();
+            TKeyMap::const_reverse_iterator it = keys.rbegin();
+            while( it != keys.rend() )
+            {
+                if( (*it).first != PdfName( "Parent" ) )
+                    stack.push_back( (*it).second );
+
+                ++it;
+            }
+        }
+        else if( pVariant->IsArray() )
+        {
+            const PdfArray & array = pVariant->GetArray();
+            PdfArray::const_reverse_iterator it = array.rbegin();
+            while( it != array.rend() )
+            {
+                stack.push_back( &(*it) );
+                ++it;
+            }
+        }
+    }
+}
+
+void PdfWriter::WriteLinearizedFile( PdfOutputDevice* pDevice, NonPublic::TLinearizedLayout & rLayout, PdfObject* pHint )
+{
+    const std::vector<PdfObject*> & rObjects   = rLayout.vecObjects;
+    const size_t                    nMain      = rObjects.size() - rLayout.nOtherPages;
+    const pdf_objnum                nLinearize = static_cast<pdf_objnum>(nMain + 1);
+    const pdf_objnum                nHint      = static_cast<pdf_objnum>(nLinearize + 1 + rLayout.nFirstPage);
+    const pdf_long                  lSize      = static_cast<pdf_long>(rObjects.size() + 3);
+    // All offsets after the hint stream are moved by its length
+    pdf_uint64                      lHint      = 0;
+    size_t                          i;
+
+    if( pHint )
+    {
+        PdfOutputDevice length;
+        pHint->WriteObject( &length, m_eWriteMode, m_pEncrypt );
+        lHint = length.GetLength();
+    }
+
+    WritePdfHeader( pDevice );
+
+    // The values of the linearization dictionary and the trailer of the first page
+    // are only known after measuring the file. They are written with placeholders
+    // and padded to the same length later.
+    PdfObject  linearize( PdfReference( nLinearize, 0 ), static_cast<const char*>(NULL) );
+    PdfVariant place_holder( PdfData( LINEARIZATION_PADDING ) );
+    PdfArray   hints;
+
+    linearize.GetDictionary().AddKey( "Linearized", 1.0 );
+    if( pHint ) 
+    {
+        hints.push_back( static_cast<pdf_int64>(rLayout.vecOffsets[rLayout.nFirstPage]) );
+        hints.push_back( static_cast<pdf_int64>(lHint) );
+        // File length
+        linearize.GetDictionary().AddKey( "L", static_cast<pdf_int64>(rLayout.lLength + lHint) );
+        // Hint stream offset and length
+        linearize.GetDictionary().AddKey( "H", hints );
+        // Object number of the first page
+        linearize.GetDictionary().AddKey( "O", static_cast<pdf_int64>(nHint + 1) );
+        // Offset of end of first page
+        linearize.GetDictionary().AddKey( "E", static_cast<pdf_int64>(rLayout.vecOffsets[rLayout.nOtherPages] + lHint) );
+        // Number of pages in the document 
+        linearize.GetDictionary().AddKey( "N", static_cast<pdf_int64>(rLayout.vecPages.size()) );
+        // Offset of first entry in main cross reference table
+        linearize.GetDictionary().AddKey( "T", static_cast<pdf_int64>(rLayout.lFirstEntry + lHint) );
+    }
     else
-        WritePdfTableOfContents( &vecXRef, pDevice, &vecXRefOffset, false, m_bLinearized );
+    {
+        hints.push_back( place_holder );
+        hints.push_back( place_holder );
+        linearize.GetDictionary().AddKey( "L", place_holder );
+        linearize.GetDictionary().AddKey( "H", hints );
+        linearize.GetDictionary().AddKey( "O", place_holder );
+        linearize.GetDictionary().AddKey( "E", place_holder );
+        linearize.GetDictionary().AddKey( "N", place_holder );
+        linearize.GetDictionary().AddKey( "T", place_holder );
+    }
+
+    const pdf_uint64 lLinearize = pDevice->Tell();
+    linearize.WriteObject( pDevice, m_eWriteMode, NULL );
+    if( pHint )
+        this->WriteLinearizedPadding( pDevice, lLinearize + rLayout.nLinearizeLength );
+    else
+        rLayout.nLinearizeLength = static_cast<size_t>(pDevice->Tell() - lLinearize);
+
+    // The XRef section and trailer of the first page. 
+    // The real offsets are only known in the second pass.
+    const pdf_uint64 lFirstXRef = pDevice->Tell();
+    PdfXRef firstXRef;
+    firstXRef.AddObject( linearize.Reference(), lLinearize, true );
+    for( i=0;i<rLayout.nOtherPages;i++ )
+    {
+        if( i == rLayout.nFirstPage )
+            firstXRef.AddObject( PdfReference( nHint, 0 ), pHint ? rLayout.vecOffsets[i] : 0, true );
 
-    this->FillLinearizationDictionary( pLinearize, pDevice, pPage, pLast, pHint, &vecXRefOffset );
-    */
+        firstXRef.AddObject( rObjects[i]->Reference(), 
+                             pHint ? rLayout.vecOffsets[i] + (i < rLayout.nFirstPage ? 0 : lHint) : 0, true );
+    }
+    firstXRef.Write( pDevice );
+
+    PdfObject trailer;
+    FillTrailerObject( &trailer, lSize, !pHint, false );
+    if( pHint )
+        trailer.GetDictionary().AddKey( "Prev", static_cast<pdf_int64>(rLayout.vecOffsets.back() + lHint) );
+
+    const pdf_uint64 lTrailer = pDevice->Tell();
+    pDevice->Print("trailer\n");
+    trailer.WriteObject( pDevice, m_eWriteMode, NULL ); // Do not encrypt the trailer dicionary!!!
+    if( pHint )
+        this->WriteLinearizedPadding( pDevice, lTrailer + rLayout.nTrailerLength );
+    else
+        rLayout.nTrailerLength = static_cast<size_t>(pDevice->Tell() - lTrailer);
+
+    // A linearized file is read starting at the first XRef section
+    pDevice->Print( "startxref\n0\n%%%%EOF\n" );
+
+    if( !pHint )
+        rLayout.vecOffsets.resize( rObjects.size() + 1 );
+
+    for( i=0;i<rObjects.size();i++ )
+    {
+        if( i == rLayout.nFirstPage && pHint ) 
+            pHint->WriteObject( pDevice, m_eWriteMode, m_pEncrypt );
+
+        if( !pHint )
+            rLayout.vecOffsets[i] = pDevice->Tell();
+
+        // Make sure that we do not encrypt the encryption dictionary!
+        rObjects[i]->WriteObject( pDevice, m_eWriteMode, 
+                                  (rObjects[i] == m_pEncryptObj ? NULL : m_pEncrypt) );
+    }
+
+    // The main XRef section contains all objects after the first page
+    PdfXRef xref;
+    for( i=rLayout.nOtherPages;i<rObjects.size();i++ )
+        xref.AddObject( rObjects[i]->Reference(), rLayout.vecOffsets[i] + (pHint ? lHint : 0), true );
+
+    if( !pHint )
+    {
+        std::ostringstream oss;
+        oss << "xref\n0 " << nMain + 1 << "\n";
+
+        rLayout.vecOffsets.back() = pDevice->Tell();
+        rLayout.lFirstEntry       = pDevice->Tell() + oss.str().length() - 1;
+    }
+
+    xref.Write( pDevice );
+
+    PdfObject mainTrailer;
+    FillTrailerObject( &mainTrailer, lSize, false, true );
+    pDevice->Print("trailer\n");
+    mainTrailer.WriteObject( pDevice, m_eWriteMode, NULL );
+    pDevice->Print( "startxref\n%li\n%%%%EOF\n", static_cast<long>(lFirstXRef) );
+
+    if( !pHint )
+    {
+        rLayout.lFirstXRef = lFirstXRef;
+        rLayout.lLength    = pDevice->Tell();
+    }
+    else if( pDevice->Tell() != rLayout.lLength + lHint )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_InternalLogic, "The linearized file does not have the measured length." );
+    }
+}
+
+void PdfWriter::WriteLinearizedPadding( PdfOutputDevice* pDevice, pdf_uint64 lEnd )
+{
+    PODOFO_RAISE_LOGIC_IF( pDevice->Tell() > lEnd, "Linearization value does not fit into its placeholder." );
+
+    while( pDevice->Tell() < lEnd )
+        pDevice->Print( " " );
 }
 
 void PdfWriter::WritePdfHeader( PdfOutputDevice* pDevice )
@@ -270,6 +822,233 @@ void PdfWriter::WritePdfObjects( PdfOutputDevice* pDevice, const PdfVecObjects&
     }
 }
 
+void PdfWriter::GetObjectStreamOrder( std::vector<PdfObject*> & rOrder )
+{
+    std::vector<bool>              vecVisited( m_vecObjects->GetObjectCount(), false );
+    std::vector<const PdfVariant*> stack;
+
+    // Walk depth first, so all objects used by a page
+    // follow each other before the next page is reached
+    stack.push_back( m_pTrailer );
+    while( !stack.empty() )
+    {
+        const PdfVariant* pVariant = stack.back();
+        stack.pop_back();
+
+        if( pVariant->IsReference() )
+        {
+            pdf_objnum nObj = pVariant->GetReference().ObjectNumber();
+            if( nObj >= vecVisited.size() || vecVisited[nObj] )
+                continue;
+
+            vecVisited[nObj] = true;
+
+            PdfObject* pObj = m_vecObjects->GetObject( pVariant->GetReference() );
+            if( !pObj )
+                continue;
+
+            if( !pObj->HasStream() && !pObj->Reference().GenerationNumber() ) 
+                rOrder.push_back( pObj );
+
+            stack.push_back( pObj );
+        }
+        else if( pVariant->IsDictionary() )
+        {
+            const TKeyMap & keys = pVariant->GetDictionary().GetKeys();
+            TKeyMap::const_reverse_iterator it = keys.rbegin();
+            while( it != keys.rend() )
+            {
+                // Parent is always reached before its children
+                if( (*it).first != PdfName( "Parent" ) )
+                    stack.push_back( (*it).second );
+
+                ++it;
+            }
+        }
+        else if( pVariant->IsArray() )
+        {
+            const PdfArray & array = pVariant->GetArray();
+            PdfArray::const_reverse_iterator it = array.rbegin();
+            while( it != array.rend() )
+            {
+                stack.push_back( &(*it) );
+                ++it;
+            }
+        }
+    }
+
+    TCIVecObjects itObjects = m_vecObjects->begin();
+    while( itObjects != m_vecObjects->end() )
+    {
+        PdfObject* pObj = *itObjects++;
+        pdf_objnum nObj = pObj->Reference().ObjectNumber();
+        if( (nObj >= vecVisited.size() || !vecVisited[nObj]) &&
+            !pObj->HasStream() && !pObj->Reference().GenerationNumber() ) 
+            rOrder.push_back( pObj );
+    }
+}
+
+void PdfWriter::GetReplacedStreams( TPdfReferenceList & rReplaced ) const
+{
+    TCIVecObjects itObjects = m_vecObjects->begin();
+    while( itObjects != m_vecObjects->end() )
+    {
+        const PdfObject* pType = (*itObjects)->IsDictionary() ? 
+            (*itObjects)->GetDictionary().GetKey( PdfName::KeyType ) : NULL;
+        if( pType && pType->IsName() && 
+            (pType->GetName() == PdfName( "ObjStm" ) || pType->GetName() == PdfName( "XRef" )) &&
+            (*itObjects)->Reference().GenerationNumber() < EMPTY_OBJECT_OFFSET - 1 )
+        {
+            rReplaced.push_back( (*itObjects)->Reference() );
+        }
+
+        ++itObjects;
+    }
+}
+
+void PdfWriter::WriteObjectStreams( PdfOutputDevice* pDevice, PdfXRef* pXref, 
+                                    const std::vector<PdfObject*> & vecOrder, std::vector<bool> & rPacked )
+{
+    // The object streams get numbers after all objects of the document
+    // including the XRef stream, they are not added to the document.
+    pdf_objnum nStream = static_cast<pdf_objnum>(m_vecObjects->GetObjectCount());
+    for( size_t i = 0; i < vecOrder.size(); i += PDF_OBJECT_STREAM_SIZE, ++nStream )
+    {
+        const size_t        nCount = PDF_MIN( static_cast<size_t>(PDF_OBJECT_STREAM_SIZE), vecOrder.size() - i );
+        PdfRefCountedBuffer header;
+        PdfRefCountedBuffer body;
+        PdfOutputDevice     headerDevice( &header );
+        PdfOutputDevice     bodyDevice( &body );
+
+        for( size_t j = 0; j < nCount; j++ )
+        {
+            PdfObject* pObj = vecOrder[i + j];
+
+            headerDevice.Print( "%u %lu ", pObj->Reference().ObjectNumber(), 
+                                static_cast<unsigned long>(bodyDevice.Tell()) );
+            pObj->Write( &bodyDevice, m_eWriteMode, NULL );
+            bodyDevice.Print( "\n" );
+
+            pXref->AddCompressedObject( pObj->Reference(), nStream, static_cast<pdf_uint32>(j) );
+            rPacked[pObj->Reference().ObjectNumber()] = true;
+        }
+
+        PdfObject objectStream( PdfReference( nStream, 0 ), "ObjStm" );
+        objectStream.SetOwner( m_vecObjects );
+        objectStream.GetDictionary().AddKey( "N", static_cast<pdf_int64>(nCount) );
+        objectStream.GetDictionary().AddKey( "First", static_cast<pdf_int64>(headerDevice.GetLength()) );
+
+        PdfStream* pStream = objectStream.GetStream();
+        pStream->BeginAppend();
+        pStream->Append( header.GetBuffer(), headerDevice.GetLength() );
+        pStream->Append( body.GetBuffer(), bodyDevice.GetLength() );
+        pStream->EndAppend();
+
+        pXref->AddObject( objectStream.Reference(), pDevice->Tell(), true );
+        objectStream.WriteObject( pDevice, m_eWriteMode, NULL );
+    }
+}
+
+void PdfWriter::WriteUnpackedObjects( PdfOutputDevice* pDevice, PdfXRef* pXref, const std::vector<bool> & rPacked )
+{
+    TCIVecObjects       itObjects  = m_vecObjects->begin();
+    TCIPdfReferenceList itFree     = m_vecObjects->GetFreeObjects().begin();
+
+    while( itObjects != m_vecObjects->end() )
+    {
+        pdf_objnum nObj = (*itObjects)->Reference().ObjectNumber();
+        if( nObj >= rPacked.size() || !rPacked[nObj] )
+        {
+            pXref->AddObject( (*itObjects)->Reference(), pDevice->Tell(), true );
+            (*itObjects)->WriteObject( pDevice, m_eWriteMode, NULL );
+        }
+
+        ++itObjects;
+    }
+
+    while( itFree != m_vecObjects->GetFreeObjects().end() )
+    {
+        pXref->AddObject( *itFree, 0, false );
+        ++itFree;
+    }
+}
+
+void PdfWriter::WriteUpdatedObjects( PdfOutputDevice* pDevice, const TPdfReferenceList & rOriginal, PdfXRef* pXref )
+{
+    m_vecObjects->Sort();
+
+    TCIVecObjects       itObjects  = m_vecObjects->begin();
+    TCIPdfReferenceList itOriginal = rOriginal.begin();
+
+    std::vector<PdfObject*> vecModified;
+
+    // Both lists are sorted, so walk them side by side
+    while( itObjects != m_vecObjects->end() || itOriginal != rOriginal.end() )
+    {
+        if( itObjects == m_vecObjects->end() ||
+            (itOriginal != rOriginal.end() && 
+             (*itOriginal).ObjectNumber() < (*itObjects)->Reference().ObjectNumber()) )
+        {
+            // The object was removed from the document, the next 
+            // object using this number gets a new generation number
+            pdf_gennum nGen = (*itOriginal).GenerationNumber();
+            if( nGen < EMPTY_OBJECT_OFFSET )
+                ++nGen;
+
+            pXref->AddObject( PdfReference( (*itOriginal).ObjectNumber(), nGen ), 0, false );
+            ++itOriginal;
+            continue;
+        }
+
+        bool bModified = true;
+        if( itOriginal != rOriginal.end() && 
+            (*itOriginal).ObjectNumber() == (*itObjects)->Reference().ObjectNumber() )
+        {
+            bModified = (*itOriginal) != (*itObjects)->Reference() || (*itObjects)->IsDirty();
+            ++itOriginal;
+        }
+
+        if( bModified ) 
+            vecModified.push_back( *itObjects );
+
+        ++itObjects;
+    }
+
+    // Object streams can only be used if the original
+    // file has a XRef stream, too
+    std::vector<bool> vecPacked( m_vecObjects->GetObjectCount(), false );
+    if( m_bObjectStreams && m_bXRefStream && !m_pEncrypt ) 
+    {
+        std::vector<PdfObject*> vecPack;
+        std::vector<PdfObject*>::const_iterator it = vecModified.begin();
+        while( it != vecModified.end() )
+        {
+            if( !(*it)->HasStream() && !(*it)->Reference().GenerationNumber() ) 
+                vecPack.push_back( *it );
+
+            ++it;
+        }
+
+        // A single object does not get any smaller
+        if( vecPack.size() > 1 )
+            WriteObjectStreams( pDevice, pXref, vecPack, vecPacked );
+    }
+
+    std::vector<PdfObject*>::const_iterator it = vecModified.begin();
+    while( it != vecModified.end() )
+    {
+        if( !vecPacked[(*it)->Reference().ObjectNumber()] )
+        {
+            pXref->AddObject( (*it)->Reference(), pDevice->Tell(), true );
+            // Make sure that we do not encrypt the encryption dictionary!
+            (*it)->WriteObject( pDevice, m_eWriteMode, 
+                                ((*it) == m_pEncryptObj ? NULL : m_pEncrypt) );
+        }
+
+        ++it;
+    }
+}
+
 void PdfWriter::GetByteOffset( PdfObject* pObject, pdf_long* pulOffset )
 {
     TCIVecObjects   it     = m_vecObjects->begin();
@@ -316,129 +1095,15 @@ void PdfWriter::WriteToBuffer( char** ppBuffer, pdf_long* pulLen )
     this->Write( &memDevice );
 }
 
-/*
-PdfObject* PdfWriter::CreateLinearizationDictionary()
-{
-    PdfObject*       pLinearize        = m_vecObjects->CreateObject();
-
-    // This will be overwritten later with valid data!
-    PdfVariant place_holder( PdfData( LINEARIZATION_PADDING ) );
-
-    PdfArray array;
-    array.push_back( place_holder );
-    array.push_back( place_holder );
-
-    pLinearize->GetDictionary().AddKey( "Linearized", 1.0 );  // Version
-    pLinearize->GetDictionary().AddKey( "L", place_holder );  // File length
-    pLinearize->GetDictionary().AddKey( "H", array );         // Hint stream offset and length as PdfArray
-    pLinearize->GetDictionary().AddKey( "E", place_holder );  // Offset of end of first page
-    pLinearize->GetDictionary().AddKey( "N",                  // Number of pages in the document 
-                                        static_cast<pdf_int64>(m_pPagesTree->GetTotalNumberOfPages()) );             
-    pLinearize->GetDictionary().AddKey( "O", place_holder );  // Object number of the first page
-    pLinearize->GetDictionary().AddKey( "T", place_holder );  // Offset of first entry in main cross reference table
-
-    return pLinearize;
-    }*/
-
-/*
-void PdfWriter::ReorderObjectsLinearized( PdfObject* pLinearize, NonPublic::PdfHintStream* pHint, PdfPage* pPage, PdfObject** ppLast ) 
-{
-    TPdfReferenceList   lstLinearizedGroup;
-    TPdfReferenceSet    setLinearizedGroup;
-    TCIPdfReferenceList it;
-    TIVecObjects        itObjects;
-    PdfObject*          pRoot;
-    PdfObject*          pTmp = NULL;
-    size_t        index, i;
-
-    // get the dependend objects that are required to display
-    // the first page. I.e. get all objects that have to be written
-    // at the start of the file.
-    // Add all depencies to lstLinearizedGroup
-    m_vecObjects->GetObjectDependencies( pPage->GetObject(), &lstLinearizedGroup );
-
-    // get the root dictionary, it has to be written at the top of the file too.
-    pRoot = m_vecObjects->GetObject( m_pTrailer->GetDictionary().GetKey( "Root" )->GetReference() );
-    // add the root dictionary
-    lstLinearizedGroup.push_back( pRoot->Reference() );
-    // add the first page itself
-    lstLinearizedGroup.push_back( pPage->GetObject()->Reference() );
-
-    // add several dependencies of the root dictionary
-    this->FindCatalogDependencies( pRoot, "ViewerPreferences", &lstLinearizedGroup, true );
-    this->FindCatalogDependencies( pRoot, "PageMode", &lstLinearizedGroup, true );
-    this->FindCatalogDependencies( pRoot, "Threads", &lstLinearizedGroup, false );
-    this->FindCatalogDependencies( pRoot, "OpenAction", &lstLinearizedGroup, true );
-    this->FindCatalogDependencies( pRoot, "AcroForm", &lstLinearizedGroup, false );
-    this->FindCatalogDependencies( pRoot, "Encrypt", &lstLinearizedGroup, true );
-
-    // add the hint stream
-    lstLinearizedGroup.push_back( pHint->GetObject()->Reference() );
-    // add the linearization dictionary
-    lstLinearizedGroup.push_back( pLinearize->Reference() );
-
-
-    // move all objects which are required to display the first page
-    // at the front of the vector of objects.
-    // We only swap objects inside of the vector to avoid reallocations.
-    // This is a fast operation therefore
-    i  = m_vecObjects->GetSize()-1;
-    it = lstLinearizedGroup.begin();
-
-    while( it != lstLinearizedGroup.end() )
-    {
-        index = m_vecObjects->GetIndex( *it );
-
-        if( index < i ) 
-        {
-            pTmp                   = (*m_vecObjects)[index];
-            (*m_vecObjects)[index] = (*m_vecObjects)[i];
-            (*m_vecObjects)[i]     = pTmp;
-        }
-
-        i--;
-        ++it;
-    }
-
-    // Renumber all objects according to their position in the vector.
-    // This is the slowest (only slow) operation when creating a 
-    // linearized PDF file. Garbage collection goes along with this step.
-    std::copy( lstLinearizedGroup.begin(), lstLinearizedGroup.end(), std::inserter(setLinearizedGroup, setLinearizedGroup.begin()) );
-    m_vecObjects->RenumberObjects( m_pTrailer, &setLinearizedGroup );
-
-    // reorder the objects in the file
-    itObjects = m_vecObjects->begin();
-    itObjects += m_vecObjects->GetSize() - setLinearizedGroup.size();
-    m_vecObjects->RemoveObject( itObjects );
-
-    while( itObjects != m_vecObjects->end() )
-    {
-        m_vecLinearized.push_back( *itObjects );
-        // reset the owner
-        (*itObjects)->SetOwner( m_vecObjects );
-        m_vecObjects->RemoveObject( itObjects ); 
-    }
-    
-    *ppLast = m_vecLinearized.GetBack();
-    }*/
-
- /*
-void PdfWriter::FindCatalogDependencies( PdfObject* pCatalog, const PdfName & rName, TPdfReferenceList* pList, bool bWithDependencies )
-{
-    if( pCatalog->GetDictionary().HasKey( rName ) && pCatalog->GetDictionary().GetKey( rName )->IsReference() )
-    {
-        if( bWithDependencies )
-            m_vecObjects->GetObjectDependencies( pCatalog->GetIndirectKey( rName ), pList );
-        else
-            pList->push_back( pCatalog->GetIndirectKey( rName )->Reference() );
-    }
-    }*/
-
 void PdfWriter::FillTrailerObject( PdfObject* pTrailer, pdf_long lSize, bool bPrevEntry, bool bOnlySizeKey ) const
 {
     // this will be overwritten later with valid data
     PdfVariant place_holder( PdfData( LINEARIZATION_PADDING ) );
 
+    // An incremental update might not contain the objects with the highest numbers
+    if( lSize < m_lPrevSize )
+        lSize = m_lPrevSize;
+
     pTrailer->GetDictionary().AddKey( PdfName::KeySize, static_cast<pdf_int64>(lSize) );
 
     if( !bOnlySizeKey ) 
@@ -457,11 +1122,14 @@ void PdfWriter::FillTrailerObject( PdfObject* pTrailer, pdf_long lSize, bool bPr
 
         if( m_pEncryptObj ) 
             pTrailer->GetDictionary().AddKey( PdfName("Encrypt"), m_pEncryptObj->Reference() );
+        else if( m_lPrevXRefOffset && m_pEncrypt && m_pTrailer->GetDictionary().HasKey( "Encrypt" ) )
+            // a direct encryption dictionary of the original file
+            pTrailer->GetDictionary().AddKey( "Encrypt", *(m_pTrailer->GetDictionary().GetKey( "Encrypt" )) );
 
         // maybe only call this function if bPrevEntry is false
         PdfArray array;
         // The ID is the same unless the PDF was incrementally updated
-        array.push_back( m_identifier );
+        array.push_back( m_originalIdentifier.IsValid() ? m_originalIdentifier : m_identifier );
         array.push_back( m_identifier );
 
         // finally add the key to the trailer dictionary
@@ -471,74 +1139,12 @@ void PdfWriter::FillTrailerObject( PdfObject* pTrailer, pdf_long lSize, bool bPr
         {
             pTrailer->GetDictionary().AddKey( "Prev", place_holder );
         }
-    }
-}
-
-/*
-void PdfWriter::FetchPagesTree() 
-{
-    if( !m_pPagesTree )
-    {
-        // try to find the pages tree
-        PdfObject* pRoot = m_pTrailer->GetDictionary().GetKey( "Root" );
-
-        if( !pRoot || !pRoot->IsReference() )
-        {
-            PODOFO_RAISE_ERROR( ePdfError_InvalidDataType );
-        }
-
-        //printf("Fetching: %lu\n", pRoot->GetReference().ObjectNumber() );
-        //printf("Size    : %i\n", static_cast<int>(m_vecObjects->GetSize()) );
-        pRoot            = m_vecObjects->GetObject( pRoot->GetReference() );
-        if( !pRoot ) 
+        else if( m_lPrevXRefOffset )
         {
-            PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
+            pTrailer->GetDictionary().AddKey( "Prev", static_cast<pdf_int64>(m_lPrevXRefOffset) );
         }
-
-        m_pPagesTree     = new PdfPagesTree( pRoot->GetIndirectKey( "Pages" ) );
     }
 }
-*/
-
-/*
-void PdfWriter::FillLinearizationDictionary( PdfObject* pLinearize, PdfOutputDevice* pDevice, PdfPage* pPage, PdfObject* pLast, 
-NonPublic::PdfHintStream* pHint, TVecXRefOffset* pVecXRefOffset )
-{
-    long            lFileSize        = pDevice->GetLength();
-    PdfVariant      value( 0l );
-    PdfArray        hints;
-    PdfObject       trailer;
-
-    value.SetPaddingLength( LINEARIZATION_PADDING );
-
-    value.SetNumber( lFileSize );
-    pLinearize->GetDictionary().AddKey( "L", value );
-    value.SetNumber( pPage->GetObject()->Reference().ObjectNumber() );
-    pLinearize->GetDictionary().AddKey( "O", value );
-    value.SetNumber( m_lFirstInXRef );
-    pLinearize->GetDictionary().AddKey( "T", value );
-    value.SetNumber( m_lLinearizedLastOffset + pLast->GetObjectLength() );
-    pLinearize->GetDictionary().AddKey( "E", value );
-
-    value.SetNumber( m_lLinearizedOffset + pLinearize->GetObjectLength() );
-    hints.push_back( value );
-    value.SetNumber( pHint->GetObject()->GetObjectLength() );
-    hints.push_back( value );
-    pLinearize->GetDictionary().AddKey( "H", hints );
-
-    pDevice->Seek( m_lLinearizedOffset );
-    pLinearize->WriteObject( pDevice );
-    pDevice->Seek( lFileSize );
-
-    value.SetNumber( pVecXRefOffset->back() );
-    FillTrailerObject( &trailer, pLast->Reference().ObjectNumber()+1, true, false );
-    trailer.GetDictionary().AddKey("Prev", value );
-
-    pDevice->Seek( m_lTrailerOffset );
-    trailer.WriteObject( pDevice );
-    pDevice->Seek( lFileSize );
-}
-*/
 
 void PdfWriter::CreateFileIdentifier( PdfString & identifier, const PdfObject* pTrailer ) const
 {
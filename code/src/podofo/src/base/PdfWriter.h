@@ -38,7 +38,7 @@ class PdfParser;
 class PdfVecObjects;
 class PdfXRef;
 
-namespace NonPublic { class PdfHintStream; }
+namespace NonPublic { struct TLinearizedLayout; }
 
 /** The PdfWriter class writes a list of PdfObjects as PDF file.
  *  The XRef section (which is the required table of contents for any
@@ -89,6 +89,32 @@ class PODOFO_API PdfWriter {
      */
     void Write( PdfOutputDevice* pDevice );
 
+    /** Writes an incremental update of the document to a PdfOutputDevice.
+     *
+     *  Only objects which are not listed in rOriginal or which have been
+     *  modified (see PdfVariant::IsDirty) are written, followed by a XRef
+     *  section for these objects and a trailer pointing to the XRef section
+     *  of the original file. Original objects which have been removed from
+     *  the document are marked as free.
+     *
+     *  pDevice has to contain the original file and all data is appended
+     *  at its current position, which has to be the end of the original file.
+     *
+     *  An encrypted document keeps the encryption dictionary and the
+     *  encryption key of the original file, SetEncrypted() has to be called
+     *  with the PdfEncrypt object the original file was read with.
+     *
+     *  Updated objects are packed into an object stream, if 
+     *  SetUseXRefStream() and SetUseObjectStreams() are enabled.
+     *
+     *  \param pDevice write to the specified device
+     *  \param rOriginal sorted list of all objects read from the original file
+     *  \param lPrevXRefOffset offset of the last XRef section in the original file
+     *  \param lPrevSize value of the /Size key in the original trailer
+     */
+    void WriteUpdate( PdfOutputDevice* pDevice, const TPdfReferenceList & rOriginal,
+                      pdf_long lPrevXRefOffset, pdf_long lPrevSize );
+
     /** Set the write mode to use when writing the PDF.
      *  \param eWriteMode write mode
      */
@@ -112,6 +138,16 @@ class PODOFO_API PdfWriter {
 
     /** Enabled linearization for this document.
      *  I.e. optimize it for web usage. Default is false.
+     *
+     *  The catalog and the objects of the first page are written first,
+     *  followed by a primary hint stream, the objects of the other pages in 
+     *  page order, the objects shared by several pages and all other objects.
+     *  Objects which cannot be reached from the trailer are not written.
+     *
+     *  Linearized files always use XRef tables and no object streams,
+     *  i.e. SetUseXRefStream() and SetUseObjectStreams() are ignored.
+     *  The document is written twice internally, once to measure it.
+     *
      *  \param bLinearize if true create a web optimized PDF file
      */
     inline void SetLinearized( bool bLinearize );
@@ -133,6 +169,23 @@ class PODOFO_API PdfWriter {
      */
     inline bool GetUseXRefStream() const;
 
+    /** Pack all objects without a stream into flate compressed object
+     *  streams. The objects are ordered by their first use when walking
+     *  the document from the trailer, so the objects of a page end up
+     *  in the same object stream. This implies XRef streams and PDF 1.5.
+     *
+     *  Object streams are not used for encrypted documents. An incremental
+     *  update only packs the written objects if XRef streams are used.
+     *
+     *  \param bObjectStreams if true object streams will be created
+     */
+    inline void SetUseObjectStreams( bool bObjectStreams );
+
+    /** 
+     *  \returns wether object streams are used or not
+     */
+    inline bool GetUseObjectStreams() const;
+
     /** Get the file format version of the pdf
      *  \returns the file format version as string
      */
@@ -199,6 +252,55 @@ class PODOFO_API PdfWriter {
      */ 
     void WritePdfObjects( PdfOutputDevice* pDevice, const PdfVecObjects& vecObjects, PdfXRef* pXref ) PODOFO_LOCAL;
 
+    /** Get the object streams and XRef streams read from a file.
+     *  They are replaced by the ones written and must not be copied.
+     *
+     *  \param rReplaced the references of these objects are appended to this list
+     */
+    void GetReplacedStreams( TPdfReferenceList & rReplaced ) const PODOFO_LOCAL;
+
+    /** Writes all objects without a stream into object streams
+     *
+     *  \param pDevice write to this device
+     *  \param pXref add all packed objects and the object streams to this XRef stream
+     *  \param vecObjects the objects to pack in this order, none of them may have a stream
+     *  \param rPacked flags for all object numbers of the document,
+     *                  set to true for the object number of each packed object
+     */
+    void WriteObjectStreams( PdfOutputDevice* pDevice, PdfXRef* pXref, 
+                             const std::vector<PdfObject*> & vecObjects, std::vector<bool> & rPacked ) PODOFO_LOCAL;
+
+    /** Writes all objects which were not packed into object streams
+     *
+     *  \param pDevice write to this device
+     *  \param pXref add all written objects to this XRef stream
+     *  \param rPacked objects whose number is flagged are packed or 
+     *                  replaced and are skipped
+     */
+    void WriteUnpackedObjects( PdfOutputDevice* pDevice, PdfXRef* pXref, const std::vector<bool> & rPacked ) PODOFO_LOCAL;
+
+    /** Get all objects that can be stored in an object stream
+     *  in the order they are reached from the trailer. Objects which
+     *  are not reachable follow in the order of the vector of objects.
+     *
+     *  \param rOrder the objects are appended to this vector
+     */
+    void GetObjectStreamOrder( std::vector<PdfObject*> & rOrder ) PODOFO_LOCAL;
+
+    /** Write all objects which are new or have been modified since
+     *  the original file was read and mark removed objects as free.
+     *  \param pDevice write to this output device
+     *  \param rOriginal sorted list of all objects read from the original file
+     *  \param pXref add all written objects to this XRefTable
+     */
+    void WriteUpdatedObjects( PdfOutputDevice* pDevice, const TPdfReferenceList & rOriginal, PdfXRef* pXref ) PODOFO_LOCAL;
+
+    /** Write the XRef section, the trailer and the startxref keyword
+     *  \param pDevice write to this output device
+     *  \param pXref the XRef table of all written objects
+     */
+    void WriteXRefAndTrailer( PdfOutputDevice* pDevice, PdfXRef* pXref ) PODOFO_LOCAL;
+
     /** Creates a file identifier which is required in several
      *  PDF workflows. 
      *  All values from the files document information dictionary are
@@ -215,72 +317,62 @@ class PODOFO_API PdfWriter {
      */       
     void PODOFO_LOCAL WriteLinearized( PdfOutputDevice* pDevice );
 
-    /** Create a linearization dictionary for the current
-     *  document and return a pointer to it after inserting
-     *  it into the vector of PdfObjects
-     *
-     *  \returns a pointer to the linearization dictionary
+    /** Get the order of all objects in a linearized PDF file
+     *  \param rLayout the objects and pages are appended to this layout
      */
-    PdfObject* CreateLinearizationDictionary() PODOFO_LOCAL;
+    void PODOFO_LOCAL GetLinearizedLayout( NonPublic::TLinearizedLayout & rLayout );
 
-    /** Reorder and renumber all object as required for linearized PDF files.
-     *  This function is very slow.
+    /** Collect the objects reached from a variant for a linearized PDF file.
+     *  Page objects and nodes of the pages tree are never followed.
      *
-     *  \param pLinearize linearization dictionary
-     *  \param pHint primary hint stream dictionary
-     *  \param pPage first page to display in the document
-     *  \param ppLast the pointer will be initialized to the last object
-     *         belonging to the first page
-     */
-    //void ReorderObjectsLinearized( PdfObject* pLinearize, NonPublic::PdfHintStream* pHint, PdfPage* pPage, PdfObject** ppLast ) PODOFO_LOCAL;
-
-    /** Initialize m_pPagesTree with its correct value
-     *  Always call this function befre accessing the pages tree.
+     *  \param pVariant start at this variant
+     *  \param nOwner the page number or owner to assign to objects without an owner
+     *  \param rvecOwner the owner of each object in the vector of objects
+     *  \param rvecStamp objects whose stamp equals nStamp are not visited again
+     *  \param nStamp identifies this walk
+     *  \param rvecReached the indices of all reached objects are appended to this vector
      */
-    //void FetchPagesTree();
+    void PODOFO_LOCAL CollectLinearizedObjects( const PdfVariant* pVariant, int nOwner, std::vector<int> & rvecOwner, 
+                                                std::vector<int> & rvecStamp, int nStamp, std::vector<size_t> & rvecReached );
 
-    /** Find dependencies required for creating a linearized PDF of the catalog dictionary.
+    /** Write a linearized PDF file using a layout. 
+     *  
+     *  Without a hint stream the file is written to measure it and all offsets 
+     *  are stored in the layout. Afterwards the file can be written with the 
+     *  hint stream, whose tables are created from these offsets.
+     *
+     *  \param pDevice write to this output device
+     *  \param rLayout the layout of the file
+     *  \param pHint the hint stream or NULL to measure the file
      */
-    //void FindCatalogDependencies( PdfObject* pCatalog, const PdfName & rName, TPdfReferenceList* pList, bool bWithDependencies ) PODOFO_LOCAL;
+    void PODOFO_LOCAL WriteLinearizedFile( PdfOutputDevice* pDevice, NonPublic::TLinearizedLayout & rLayout, PdfObject* pHint );
 
-    /** Fill all keys in the linearization dictionary with their values
-     *  \param pLinearize a linearization dictionary
-     *  \param pHint the hint stream
-     *  \param pPage the first page in the linerarized PDF file
-     *  \param pLast pointer of the last object belonging to the first page
-     *  \param pVecXRefOffset xref table entries for previous entry
+    /** Pad a value written to a linearized PDF file with spaces
+     *  \param pDevice write to this output device
+     *  \param lEnd offset where the space reserved for the value ends
      */
-    // void FillLinearizationDictionary( PdfObject* pLinearize, PdfOutputDevice* pDevice, PdfPage* pPage, PdfObject* pLast, NonPublic::PdfHintStream* pHint, TVecXRefOffset* pVecXRefOffset ) PODOFO_LOCAL;
+    void PODOFO_LOCAL WriteLinearizedPadding( PdfOutputDevice* pDevice, pdf_uint64 lEnd );
 
  protected:
     PdfVecObjects*  m_vecObjects;
     PdfObject*      m_pTrailer;
 
     bool            m_bXRefStream;
+    bool            m_bObjectStreams;
 
     PdfEncrypt*     m_pEncrypt;    ///< If not NULL encrypt all strings and streams and create an encryption dictionary in the trailer
     PdfObject*      m_pEncryptObj; ///< Used to temporarly store the encryption dictionary
 
     PdfString       m_identifier;
+    PdfString       m_originalIdentifier; ///< First /ID entry of the original file, kept by incremental updates
+    pdf_long        m_lPrevXRefOffset;    ///< If not 0, an incremental update is written and the trailer points to this XRef section
+    pdf_long        m_lPrevSize;          ///< /Size of the original file for incremental updates
 
  private:
     EPdfWriteMode   m_eWriteMode;
     EPdfVersion     m_eVersion;
 
     bool            m_bLinearized;
- 
-    /**
-     * This value is required when writing
-     * a linearized PDF file.
-     * It represents the offset of the whitespace
-     * character before the first line in the XRef
-     * section.
-     */
-    size_t            m_lFirstInXRef;
-    size_t            m_lLinearizedOffset;
-    size_t            m_lLinearizedLastOffset;
-    size_t            m_lTrailerOffset;
-    PdfVecObjects   m_vecLinearized;
 };
 
 // -----------------------------------------------------
@@ -299,6 +391,22 @@ bool PdfWriter::GetLinearized() const
     return m_bLinearized;
 }
 
+// -----------------------------------------------------
+// 
+// -----------------------------------------------------
+void PdfWriter::SetUseObjectStreams( bool bObjectStreams )
+{
+    m_bObjectStreams = bObjectStreams;
+}
+
+// -----------------------------------------------------
+// 
+// -----------------------------------------------------
+bool PdfWriter::GetUseObjectStreams() const
+{
+    return m_bObjectStreams;
+}
+
 // -----------------------------------------------------
 // 
 // -----------------------------------------------------
@@ -90,9 +90,13 @@ PdfXRef::~PdfXRef()
 }
 
 void PdfXRef::AddObject( const PdfReference & rRef, pdf_uint64 offset, bool bUsed )
+{
+    this->AddItem( PdfXRef::TXRefItem( rRef, offset ), bUsed );
+}
+
+void PdfXRef::AddItem( const TXRefItem & item, bool bUsed )
 {
     TIVecXRefBlock     it = m_vecBlocks.begin();
-    PdfXRef::TXRefItem item( rRef, offset );
     bool               bInsertDone = false;
 
     while( it != m_vecBlocks.end() )
@@ -109,18 +113,27 @@ void PdfXRef::AddObject( const PdfReference & rRef, pdf_uint64 offset, bool bUse
     if( !bInsertDone ) 
     {
         PdfXRefBlock block;
-        block.m_nFirst = rRef.ObjectNumber();
+        block.m_nFirst = item.reference.ObjectNumber();
         block.m_nCount = 1;
         if( bUsed )
             block.items.push_back( item );
         else
-            block.freeItems.push_back( rRef );
+            block.freeItems.push_back( item.reference );
 
         m_vecBlocks.push_back( block );
         std::sort( m_vecBlocks.begin(), m_vecBlocks.end() );
     }
 }
 
+void PdfXRef::AddCompressedObject( const PdfReference & rRef, pdf_objnum nStream, pdf_uint32 nIndex )
+{
+    PdfXRef::TXRefItem item( rRef, nStream );
+    item.index      = nIndex;
+    item.compressed = true;
+
+    this->AddItem( item, true );
+}
+
 void PdfXRef::Write( PdfOutputDevice* pDevice )
 {
     PdfXRef::TCIVecXRefBlock  it         = m_vecBlocks.begin();
@@ -173,8 +186,11 @@ void PdfXRef::Write( PdfOutputDevice* pDevice )
                 ++itFree;
             }
 
-            this->WriteXRefEntry( pDevice, (*itItems).offset, (*itItems).reference.GenerationNumber(), 'n', 
-                                  (*itItems).reference.ObjectNumber()  );
+            if( (*itItems).compressed )
+                this->WriteCompressedEntry( pDevice, static_cast<pdf_objnum>((*itItems).offset), (*itItems).index );
+            else
+                this->WriteXRefEntry( pDevice, (*itItems).offset, (*itItems).reference.GenerationNumber(), 'n', 
+                                      (*itItems).reference.ObjectNumber()  );
             ++itItems;
         }
 
@@ -332,6 +348,11 @@ void PdfXRef::WriteXRefEntry( PdfOutputDevice* pDevice, pdf_uint64 offset,
     pDevice->Print( "%0.10" PDF_FORMAT_UINT64 " %0.5hu %c \n", offset, generation, cMode );
 }
 
+void PdfXRef::WriteCompressedEntry( PdfOutputDevice*, pdf_objnum, pdf_uint32 )
+{
+    PODOFO_RAISE_ERROR_INFO( ePdfError_InternalLogic, "Objects in object streams require a XRef stream." );
+}
+
 void PdfXRef::EndWrite( PdfOutputDevice* ) 
 {
 }
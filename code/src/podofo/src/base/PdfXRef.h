@@ -40,12 +40,14 @@ class PdfXRef {
  protected:
     struct TXRefItem{
         TXRefItem( const PdfReference & rRef, const pdf_uint64 & off ) 
-            : reference( rRef ), offset( off )
+            : reference( rRef ), offset( off ), index( 0 ), compressed( false )
             {
             }
 
         PdfReference reference;
-        pdf_uint64   offset;
+        pdf_uint64   offset;     ///< byte offset or object number of the object stream
+        pdf_uint32   index;      ///< index in the object stream if compressed
+        bool         compressed; ///< the object is stored in an object stream
 
         bool operator<( const TXRefItem & rhs ) const
         {
@@ -123,6 +125,15 @@ class PdfXRef {
      */
     void AddObject( const PdfReference & rRef, pdf_uint64 offset, bool bUsed );
 
+    /** Add an object which is stored in an object stream to the XRef table.
+     *  Only XRef streams can contain such objects.
+     *
+     *  \param rRef reference of this object, the generation number must be 0
+     *  \param nStream object number of the object stream
+     *  \param nIndex index of the object inside of the object stream
+     */
+    void AddCompressedObject( const PdfReference & rRef, pdf_objnum nStream, pdf_uint32 nIndex );
+
     /** Write the XRef table to an output device.
      * 
      *  \param pDevice an output device (usually a PDF file)
@@ -176,6 +187,16 @@ class PdfXRef {
     virtual void WriteXRefEntry( PdfOutputDevice* pDevice, pdf_uint64 offset, pdf_gennum generation, 
                                  char cMode, pdf_objnum objectNumber = 0 );
 
+    /** Write an entry of an object stored in an object stream to the XRef table.
+     *  The default implementation throws, as XRef tables cannot contain such entries.
+     *  
+     *  @param pDevice the output device to which the XRef table 
+     *                 should be written.
+     *  @param nStream the object number of the object stream
+     *  @param nIndex the index of the object in the object stream
+     */
+    virtual void WriteCompressedEntry( PdfOutputDevice* pDevice, pdf_objnum nStream, pdf_uint32 nIndex );
+
     /** Called at the end of writing the XRef table.
      *  Sub classes can overload this method to finish a XRef table.
      *
@@ -185,6 +206,8 @@ class PdfXRef {
     virtual void EndWrite( PdfOutputDevice* pDevice );
 
  private:
+    void AddItem( const TXRefItem & rItem, bool bUsed );
+
     const PdfReference* GetFirstFreeObject( PdfXRef::TCIVecXRefBlock itBlock, PdfXRef::TCIVecReferences itFree ) const;
     const PdfReference* GetNextFreeObject( PdfXRef::TCIVecXRefBlock itBlock, PdfXRef::TCIVecReferences itFree ) const;
 
@@ -25,32 +25,51 @@
 #include "PdfWriter.h"
 #include "PdfDefinesPrivate.h"
 
-#if defined(_AIX) || defined(__sun)
-#include <alloca.h>
-#elif defined(__APPLE__) || defined(__linux)
-#include <cstdlib>
-#elif defined(_WIN32)
-#include <malloc.h>
-#endif
-
 namespace PoDoFo {
 
+/** The number of bytes required to store lValue, at least one
+ */
+static int GetFieldWidth( pdf_uint64 lValue )
+{
+    int nWidth = 1;
+    while( lValue >>= 8 )
+        ++nWidth;
+
+    return nWidth;
+}
+
+/** Append lValue big-endian in nWidth bytes
+ */
+static void AppendField( std::vector<char> & rBuffer, pdf_uint64 lValue, int nWidth )
+{
+    for( int i = nWidth - 1; i >= 0; i-- )
+        rBuffer.push_back( static_cast<char>( (lValue >> (8 * i)) & 0xff ) );
+}
+
 PdfXRefStream::PdfXRefStream( PdfVecObjects* pParent, PdfWriter* pWriter )
     : m_pParent( pParent ), m_pWriter( pWriter ), m_pObject( NULL )
 {
-    m_bufferLen = 2 + sizeof( pdf_uint64 );
-
-    m_pObject    = pParent->CreateObject( "XRef" );
+    // EndWrite() rewrites the XRef object in place, so it has to be the
+    // last object written: never reuse the number of a free object for it.
+    m_pObject    = new PdfObject( PdfReference( static_cast<unsigned int>(pParent->GetObjectCount()), 0 ), "XRef" );
+    pParent->push_back( m_pObject );
     m_offset    = 0;
+
+    // Create the stream right away, objects with
+    // a stream are never packed into object streams
+    m_pObject->GetStream();
 }
 
 PdfXRefStream::~PdfXRefStream()
 {
+    // The XRef object belongs to the written file only, writing
+    // the same objects again creates a new one.
+    delete m_pParent->RemoveObject( m_pObject->Reference(), false );
 }
 
 void PdfXRefStream::BeginWrite( PdfOutputDevice* ) 
 {
-    m_pObject->GetStream()->BeginAppend();
+    m_vecEntries.clear();
 }
 
 void PdfXRefStream::WriteSubSection( PdfOutputDevice*, pdf_objnum first, pdf_uint32 count )
@@ -64,32 +83,64 @@ void PdfXRefStream::WriteSubSection( PdfOutputDevice*, pdf_objnum first, pdf_uin
 void PdfXRefStream::WriteXRefEntry( PdfOutputDevice*, pdf_uint64 offset, pdf_gennum generation, 
                                     char cMode, pdf_objnum objectNumber ) 
 {
-    char * buffer = reinterpret_cast<char*>(alloca(m_bufferLen));
+    TXRefStreamEntry entry;
 
     if( cMode == 'n' && objectNumber == m_pObject->Reference().ObjectNumber() )
         m_offset = offset;
     
-    buffer[0]             = static_cast<char>( cMode == 'n' ? 1 : 0 );
-    buffer[m_bufferLen-1] = static_cast<char>( cMode == 'n' ? 0 : generation );
+    entry.cType  = static_cast<char>( cMode == 'n' ? 1 : 0 );
+    entry.field2 = offset;
+    entry.field3 = cMode == 'n' ? 0 : generation;
+    m_vecEntries.push_back( entry );
+}
 
-    const pdf_uint64 offset_be = ::PoDoFo::compat::podofo_htonl(static_cast<pdf_uint32>(offset));
-    memcpy( &buffer[1], reinterpret_cast<const char*>(&offset_be), sizeof(pdf_uint64) );
-    
-    m_pObject->GetStream()->Append( buffer, m_bufferLen );
+void PdfXRefStream::WriteCompressedEntry( PdfOutputDevice*, pdf_objnum nStream, pdf_uint32 nIndex )
+{
+    TXRefStreamEntry entry;
+
+    entry.cType  = 2;
+    entry.field2 = nStream;
+    entry.field3 = nIndex;
+    m_vecEntries.push_back( entry );
 }
 
 void PdfXRefStream::EndWrite( PdfOutputDevice* pDevice ) 
 {
-    PdfArray w;
+    PdfArray   w;
+    pdf_uint64 lMax2 = 0;
+    pdf_uint64 lMax3 = 0;
+
+    std::vector<TXRefStreamEntry>::const_iterator it = m_vecEntries.begin();
+    while( it != m_vecEntries.end() )
+    {
+        lMax2 = PDF_MAX( lMax2, (*it).field2 );
+        lMax3 = PDF_MAX( lMax3, static_cast<pdf_uint64>((*it).field3) );
+        ++it;
+    }
+
+    // Offsets are the largest values, so do not waste
+    // bytes on the upper part of a 64 bit field
+    const int nWidth2 = GetFieldWidth( lMax2 );
+    const int nWidth3 = GetFieldWidth( lMax3 );
+
+    std::vector<char> buffer;
+    buffer.reserve( m_vecEntries.size() * (1 + nWidth2 + nWidth3) );
+    for( it = m_vecEntries.begin(); it != m_vecEntries.end(); ++it )
+    {
+        buffer.push_back( (*it).cType );
+        AppendField( buffer, (*it).field2, nWidth2 );
+        AppendField( buffer, (*it).field3, nWidth3 );
+    }
 
     w.push_back( static_cast<pdf_int64>(1) );
-    w.push_back( static_cast<pdf_int64>(sizeof(pdf_uint64)) );
-    w.push_back( static_cast<pdf_int64>(1) );
-
-    // Add our self to the XRef table
-    this->WriteXRefEntry( pDevice, pDevice->Tell(), 0, 'n' );
+    w.push_back( static_cast<pdf_int64>(nWidth2) );
+    w.push_back( static_cast<pdf_int64>(nWidth3) );
 
+    m_pObject->GetStream()->BeginAppend();
+    if( buffer.size() )
+        m_pObject->GetStream()->Append( &buffer[0], buffer.size() );
     m_pObject->GetStream()->EndAppend();
+    m_vecEntries.clear();
     m_pWriter->FillTrailerObject( m_pObject, this->GetSize(), false, false );
 
     m_pObject->GetDictionary().AddKey( "Index", m_indeces );
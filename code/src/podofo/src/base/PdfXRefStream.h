@@ -93,6 +93,15 @@ class PdfXRefStream : public PdfXRef {
     virtual void WriteXRefEntry( PdfOutputDevice* pDevice, pdf_uint64 offset, pdf_gennum generation, 
                                  char cMode, pdf_objnum objectNumber = 0 );
 
+    /** Write an entry of an object stored in an object stream to the XRef table
+     *  
+     *  @param pDevice the output device to which the XRef table 
+     *                 should be written.
+     *  @param nStream the object number of the object stream
+     *  @param nIndex the index of the object in the object stream
+     */
+    virtual void WriteCompressedEntry( PdfOutputDevice* pDevice, pdf_objnum nStream, pdf_uint32 nIndex );
+
     /** Called at the end of writing the XRef table.
      *  Sub classes can overload this method to finish a XRef table.
      *
@@ -107,7 +116,16 @@ class PdfXRefStream : public PdfXRef {
     PdfObject*     m_pObject;
     PdfArray       m_indeces;
 
-    size_t         m_bufferLen; ///< The length of the internal buffer for one XRef entry
+    /** One entry of the XRef stream, the fields are 
+     *  written in EndWrite() using as few bytes as possible.
+     */
+    struct TXRefStreamEntry {
+        char       cType;
+        pdf_uint64 field2;
+        pdf_uint32 field3;
+    };
+
+    std::vector<TXRefStreamEntry> m_vecEntries;
     pdf_uint64     m_offset;    ///< Offset of the XRefStream object
 };
 
@@ -187,7 +187,7 @@ void PdfXRefStreamParserObject::ReadXRefStreamEntry( char* pBuffer, pdf_long, co
 {
     int              i;
     pdf_int64        z;
-    unsigned long    nData[W_ARRAY_SIZE];
+    pdf_uint64       nData[W_ARRAY_SIZE];
 
     for( i=0;i<W_ARRAY_SIZE;i++ )
     {
@@ -25,7 +25,7 @@
 #include "PdfParserObject.h"
 
 #define W_ARRAY_SIZE 3
-#define W_MAX_BYTES  4
+#define W_MAX_BYTES  8
 
 namespace PoDoFo {
 
@@ -29,6 +29,7 @@
 #include "base/PdfName.h"
 #include "base/PdfStream.h"
 
+#include "PdfFontFaceCache.h"
 #include "PdfFontMetricsFreetype.h"
 
 #include <ft2build.h>
@@ -182,6 +183,8 @@ void PdfFontCID::EmbedFont( PdfObject* pDescriptor )
         pContents->GetDictionary().AddKey( "Length1", PdfVariant( static_cast<pdf_int64>(lSize) ) );
         pContents->GetStream()->Set( &stream );
     }
+
+    PdfFontFaceCache::AddEmbeddedBytes( lSize );
 }
 
 void PdfFontCID::CreateWidth( PdfObject* pFontDict ) const
@@ -128,6 +128,7 @@ static bool GetDataFromLPFONT( const LOGFONTW* inFont, char** outFontBuffer, uns
 
 #if defined(PODOFO_HAVE_FONTCONFIG)
 Util::PdfMutex PdfFontCache::m_FcMutex;
+void*          PdfFontCache::m_pFcSharedConfig = NULL;
 #endif
 
 PdfFontCache::PdfFontCache( PdfVecObjects* pParent )
@@ -138,7 +139,13 @@ PdfFontCache::PdfFontCache( PdfVecObjects* pParent )
 #if defined(PODOFO_HAVE_FONTCONFIG)
     {
         Util::PdfMutexWrapper mutex(m_FcMutex);
-        m_pFcConfig     = static_cast<void*>(FcInitLoadConfigAndFonts());
+        // Loading the configuration scans all fonts on the system,
+        // which takes longer than creating a small document,
+        // so it is done once for the whole process
+        if( !m_pFcSharedConfig )
+            m_pFcSharedConfig = static_cast<void*>(FcInitLoadConfigAndFonts());
+
+        m_pFcConfig     = m_pFcSharedConfig;
     }
 #endif
 
@@ -152,13 +159,6 @@ PdfFontCache::~PdfFontCache()
 {
     this->EmptyCache();
 
-#if defined(PODOFO_HAVE_FONTCONFIG)
-    {
-        Util::PdfMutexWrapper mutex(m_FcMutex);
-        FcConfigDestroy( static_cast<FcConfig*>(m_pFcConfig) );
-    }
-#endif
-
     if( m_ftLibrary ) 
     {
         FT_Done_FreeType( m_ftLibrary );
@@ -644,10 +644,8 @@ std::string PdfFontCache::GetFontConfigFontPath( FcConfig* pConfig, const char*
 std::string PdfFontCache::GetFontPath( const char* pszFontName, bool bBold, bool bItalic )
 {
 #if defined(PODOFO_HAVE_FONTCONFIG)
-    Util::PdfMutexWrapper mutex(m_FcMutex);
-    FcConfig*   pConfig = FcInitLoadConfigAndFonts();
-    std::string sPath   = this->GetFontConfigFontPath( pConfig, pszFontName, bBold, bItalic );
-    FcConfigDestroy( pConfig );    
+    std::string sPath = this->GetFontConfigFontPath( static_cast<FcConfig*>(m_pFcConfig), 
+                                                     pszFontName, bBold, bItalic );
 #else
     std::string sPath = "";
 #endif
@@ -131,6 +131,7 @@ class PODOFO_DOC_API PdfFontCache {
 
 #if defined(PODOFO_HAVE_FONTCONFIG)
     static Util::PdfMutex m_FcMutex;
+    static void*          m_pFcSharedConfig; ///< fontconfig handle used by all font caches
 #endif
 
  public:
@@ -0,0 +1,320 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "PdfFontFaceCache.h"
+
+#include "base/PdfDefinesPrivate.h"
+#include "base/util/PdfMutexWrapper.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif // PODOFO_HAVE_SYS_MMAN_H
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+/** Maximum number of bytes of all font subsets kept in the cache.
+ *  The oldest subsets are removed first.
+ */
+#define PDF_FONT_SUBSET_CACHE_SIZE (16 * 1024 * 1024)
+
+namespace PoDoFo {
+
+const pdf_uint64 PdfFontFaceCache::s_nHashBasis = 0xcbf29ce484222325ULL;
+
+Util::PdfMutex                       PdfFontFaceCache::s_mutex;
+PdfFontFaceCache::TMapFiles          PdfFontFaceCache::s_mapFiles;
+PdfFontFaceCache::TMapFaces          PdfFontFaceCache::s_mapFaces;
+PdfFontFaceCache::TMapSubsets        PdfFontFaceCache::s_mapSubsets;
+std::deque<PdfFontFaceCache::TSubsetKey> PdfFontFaceCache::s_queSubsets;
+size_t                               PdfFontFaceCache::s_nSubsetBytes = 0;
+PdfFontFaceCache::TStatistics        PdfFontFaceCache::s_statistics = { 0, 0, 0, 0, 0, 0 };
+
+FT_Face PdfFontFaceCache::OpenFace( FT_Library library, const char* pszFilename,
+                                    const char** ppData, pdf_long* plLen )
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+
+    TFontFile* pFile = GetFile( pszFilename );
+
+    // Faces are small in number, so a linear search is fine
+    TMapFaces::iterator it = s_mapFaces.begin();
+    while( it != s_mapFaces.end() )
+    {
+        if( (*it).second.library == library && (*it).second.pFile == pFile )
+        {
+            ++(*it).second.nRefCount;
+            ++s_statistics.nFacesShared;
+
+            *ppData = pFile->pData;
+            *plLen  = pFile->lLen;
+            return (*it).first;
+        }
+
+        ++it;
+    }
+
+    FT_Face  face;
+    FT_Error err = FT_New_Memory_Face( library, reinterpret_cast<const FT_Byte*>(pFile->pData),
+                                       static_cast<FT_Long>(pFile->lLen), 0, &face );
+    if( err )
+    {
+        PdfError::LogMessage( eLogSeverity_Critical, "FreeType returned the error %i when calling FT_New_Face for font %s.",
+                              err, pszFilename );
+        PODOFO_RAISE_ERROR( ePdfError_FreeType );
+    }
+
+    TFace entry;
+    entry.library   = library;
+    entry.pFile     = pFile;
+    entry.nRefCount = 1;
+
+    s_mapFaces[face] = entry;
+    ++pFile->nRefCount;
+    ++s_statistics.nFacesOpened;
+
+    *ppData = pFile->pData;
+    *plLen  = pFile->lLen;
+    return face;
+}
+
+void PdfFontFaceCache::ReleaseFace( FT_Face face )
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+
+    TMapFaces::iterator it = s_mapFaces.find( face );
+    PODOFO_ASSERT( it != s_mapFaces.end() );
+    if( it == s_mapFaces.end() )
+        return;
+
+    if( --(*it).second.nRefCount )
+        return;
+
+    TFontFile* pFile = (*it).second.pFile;
+    s_mapFaces.erase( it );
+
+    FT_Done_Face( face );
+    ReleaseFile( pFile );
+}
+
+PdfFontFaceCache::TFontFile* PdfFontFaceCache::GetFile( const char* pszFilename )
+{
+    struct stat st;
+    if( stat( pszFilename, &st ) != 0 || st.st_size <= 0 )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_FileNotFound, pszFilename );
+    }
+
+    TMapFiles::iterator it = s_mapFiles.find( pszFilename );
+    if( it != s_mapFiles.end() )
+    {
+        TFontFile* pFile = (*it).second;
+        if( pFile->lLen == static_cast<pdf_long>(st.st_size) && pFile->tModified == st.st_mtime )
+            return pFile;
+
+        // The file was changed on disk, faces created
+        // from the old contents keep using them
+        s_mapFiles.erase( it );
+        if( pFile->nRefCount )
+            pFile->bOutdated = true;
+        else
+            FreeFile( pFile );
+    }
+
+    FILE* hFile = fopen( pszFilename, "rb" );
+    if( !hFile )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_FileNotFound, pszFilename );
+    }
+
+    pdf_long lLen    = static_cast<pdf_long>(st.st_size);
+    char*    pData   = NULL;
+    bool     bMapped = false;
+
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+    void* pMap = mmap( NULL, lLen, PROT_READ, MAP_PRIVATE, fileno( hFile ), 0 );
+    if( pMap != MAP_FAILED )
+    {
+        pData   = static_cast<char*>(pMap);
+        bMapped = true;
+    }
+#endif // PODOFO_HAVE_SYS_MMAN_H
+
+    if( !pData )
+    {
+        pData = static_cast<char*>(podofo_malloc( lLen ));
+        if( !pData )
+        {
+            fclose( hFile );
+            PODOFO_RAISE_ERROR( ePdfError_OutOfMemory );
+        }
+
+        if( fread( pData, 1, lLen, hFile ) != static_cast<size_t>(lLen) )
+        {
+            podofo_free( pData );
+            fclose( hFile );
+            PODOFO_RAISE_ERROR_INFO( ePdfError_UnexpectedEOF, pszFilename );
+        }
+    }
+
+    fclose( hFile );
+
+    TFontFile* pFile = new TFontFile();
+    pFile->sFilename = pszFilename;
+    pFile->pData     = pData;
+    pFile->lLen      = lLen;
+    pFile->tModified = st.st_mtime;
+    pFile->bMapped   = bMapped;
+    pFile->nRefCount = 0;
+    pFile->bOutdated = false;
+
+    s_mapFiles[pFile->sFilename] = pFile;
+    ++s_statistics.nFilesLoaded;
+
+    return pFile;
+}
+
+void PdfFontFaceCache::ReleaseFile( TFontFile* pFile )
+{
+    if( !--pFile->nRefCount && pFile->bOutdated )
+        FreeFile( pFile );
+}
+
+void PdfFontFaceCache::FreeFile( TFontFile* pFile )
+{
+#ifdef PODOFO_HAVE_SYS_MMAN_H
+    if( pFile->bMapped )
+        munmap( pFile->pData, pFile->lLen );
+    else
+#endif // PODOFO_HAVE_SYS_MMAN_H
+        podofo_free( pFile->pData );
+
+    delete pFile;
+}
+
+bool PdfFontFaceCache::GetSubset( pdf_uint64 nFontHash, const std::vector<unsigned short> & rvecGlyphs,
+                                  std::string & rsData )
+{
+    if( rvecGlyphs.empty() )
+        return false;
+
+    TSubsetKey key( nFontHash, Hash( &rvecGlyphs[0], rvecGlyphs.size() * sizeof(unsigned short) ) );
+
+    Util::PdfMutexWrapper mutex( s_mutex );
+    TMapSubsets::const_iterator it = s_mapSubsets.find( key );
+    // Compare the glyphs, too, so that a hash collision
+    // does never result in a wrong font
+    if( it == s_mapSubsets.end() || (*it).second.vecGlyphs != rvecGlyphs )
+        return false;
+
+    rsData = (*it).second.sData;
+    ++s_statistics.nSubsetHits;
+    return true;
+}
+
+void PdfFontFaceCache::AddSubset( pdf_uint64 nFontHash, const std::vector<unsigned short> & rvecGlyphs,
+                                  const char* pData, pdf_long lLen )
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+    ++s_statistics.nSubsetBuilds;
+
+    if( rvecGlyphs.empty() || lLen > PDF_FONT_SUBSET_CACHE_SIZE )
+        return;
+
+    TSubsetKey key( nFontHash, Hash( &rvecGlyphs[0], rvecGlyphs.size() * sizeof(unsigned short) ) );
+    if( s_mapSubsets.find( key ) != s_mapSubsets.end() )
+        return;
+
+    TSubset & subset = s_mapSubsets[key];
+    subset.vecGlyphs = rvecGlyphs;
+    subset.sData.assign( pData, lLen );
+
+    s_queSubsets.push_back( key );
+    s_nSubsetBytes += lLen;
+
+    while( s_nSubsetBytes > PDF_FONT_SUBSET_CACHE_SIZE )
+    {
+        TMapSubsets::iterator it = s_mapSubsets.find( s_queSubsets.front() );
+        s_nSubsetBytes -= (*it).second.sData.length();
+        s_mapSubsets.erase( it );
+        s_queSubsets.pop_front();
+    }
+}
+
+void PdfFontFaceCache::AddEmbeddedBytes( pdf_long lLen )
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+    s_statistics.nBytesEmbedded += lLen;
+}
+
+pdf_uint64 PdfFontFaceCache::Hash( const void* pData, pdf_long lLen, pdf_uint64 nHash )
+{
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+    for( pdf_long i=0;i<lLen;i++ )
+    {
+        nHash ^= pBytes[i];
+        nHash *= 0x100000001b3ULL;
+    }
+
+    return nHash;
+}
+
+PdfFontFaceCache::TStatistics PdfFontFaceCache::GetStatistics()
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+    return s_statistics;
+}
+
+void PdfFontFaceCache::ResetStatistics()
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+    memset( &s_statistics, 0, sizeof(TStatistics) );
+}
+
+void PdfFontFaceCache::EmptyCache()
+{
+    Util::PdfMutexWrapper mutex( s_mutex );
+
+    TMapFiles::iterator it = s_mapFiles.begin();
+    while( it != s_mapFiles.end() )
+    {
+        if( (*it).second->nRefCount )
+        {
+            // Still used by a face, free it when it is released
+            (*it).second->bOutdated = true;
+        }
+        else
+            FreeFile( (*it).second );
+
+        ++it;
+    }
+
+    s_mapFiles.clear();
+    s_mapSubsets.clear();
+    s_queSubsets.clear();
+    s_nSubsetBytes = 0;
+}
+
+};
@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _PDF_FONT_FACE_CACHE_H_
+#define _PDF_FONT_FACE_CACHE_H_
+
+#include "podofo/base/PdfDefines.h"
+#include "podofo/base/Pdf3rdPtyForwardDecl.h"
+#include "podofo/base/util/PdfMutex.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace PoDoFo {
+
+/**
+ * PdfFontFaceCache keeps TrueType font files, freetype faces
+ * and font subsets in memory for the whole process, so that
+ * creating many small documents with the same fonts does not
+ * read, parse and subset the same files again and again.
+ *
+ * Font files are mapped into memory (or read if mmap is not
+ * available) the first time they are used and stay loaded
+ * until EmptyCache() is called. A file that was changed on
+ * disk is loaded again.
+ *
+ * A FT_Face belongs to the FT_Library it was created with and
+ * must not be used by two threads at the same time. Faces are
+ * therefore shared between all users of the same library,
+ * i.e. between all fonts of one document, and closed when
+ * the last user releases them.
+ *
+ * Font subsets are stored by a hash of the font tables and a
+ * hash of the glyph set, so building the same subset of the
+ * same font twice is answered from the cache.
+ *
+ * All methods are thread safe.
+ *
+ * This class is an internal class of PoDoFo
+ * and should not be used in user applications
+ *
+ * \see PdfFontMetricsFreetype
+ * \see PdfFontTTFSubset
+ */
+class PODOFO_DOC_API PdfFontFaceCache {
+ public:
+    /** Counters describing the work done by the font code
+     *  since the process was started or ResetStatistics() was called.
+     */
+    struct TStatistics {
+        pdf_uint64 nFilesLoaded;   ///< number of font files mapped or read into memory
+        pdf_uint64 nFacesOpened;   ///< number of freetype faces created from cached files
+        pdf_uint64 nFacesShared;   ///< number of requests answered by an already open face
+        pdf_uint64 nSubsetBuilds;  ///< number of TrueType subsets actually built
+        pdf_uint64 nSubsetHits;    ///< number of TrueType subsets taken from the cache
+        pdf_uint64 nBytesEmbedded; ///< number of font file bytes embedded into documents
+    };
+
+    /** Open a face for a TrueType font file.
+     *
+     *  If a face for this file was already opened with the same
+     *  library and is still in use, it is returned again.
+     *
+     *  \param library the freetype library to create the face with
+     *  \param pszFilename path to a TrueType font file
+     *  \param ppData the contents of the font file are returned here,
+     *                they are valid until ReleaseFace() is called
+     *  \param plLen the length of *ppData is returned here
+     *
+     *  \returns a freetype face which has to be released
+     *           using ReleaseFace() instead of FT_Done_Face()
+     */
+    static FT_Face OpenFace( FT_Library library, const char* pszFilename,
+                             const char** ppData, pdf_long* plLen );
+
+    /** Release a face returned by OpenFace().
+     *  The face is closed when it is not used anymore.
+     *
+     *  \param face a face returned by OpenFace()
+     */
+    static void ReleaseFace( FT_Face face );
+
+    /** Lookup a font subset built before.
+     *
+     *  \param nFontHash hash identifying the font
+     *  \param rvecGlyphs sorted list of all glyphs in the subset
+     *  \param rsData the subset font file is returned here
+     *
+     *  \returns true if the subset was found in the cache
+     */
+    static bool GetSubset( pdf_uint64 nFontHash, const std::vector<unsigned short> & rvecGlyphs,
+                           std::string & rsData );
+
+    /** Add a newly built font subset to the cache.
+     *
+     *  \param nFontHash hash identifying the font
+     *  \param rvecGlyphs sorted list of all glyphs in the subset
+     *  \param pData the subset font file
+     *  \param lLen length of pData
+     */
+    static void AddSubset( pdf_uint64 nFontHash, const std::vector<unsigned short> & rvecGlyphs,
+                           const char* pData, pdf_long lLen );
+
+    /** Count font data embedded into a document
+     *
+     *  \param lLen number of bytes embedded
+     */
+    static void AddEmbeddedBytes( pdf_long lLen );
+
+    /** Hash a block of memory. This is 64 bit FNV-1a,
+     *  which can be chained by passing the previous result as nHash.
+     *
+     *  \param pData data to hash
+     *  \param lLen length of pData
+     *  \param nHash hash of the data before pData
+     *
+     *  \returns the new hash value
+     */
+    static pdf_uint64 Hash( const void* pData, pdf_long lLen, pdf_uint64 nHash = s_nHashBasis );
+
+    /** \returns the current statistics
+     */
+    static TStatistics GetStatistics();
+
+    /** Reset all statistics to zero
+     */
+    static void ResetStatistics();
+
+    /** Free all cached font files and font subsets,
+     *  which are not in use anymore.
+     */
+    static void EmptyCache();
+
+    static const pdf_uint64 s_nHashBasis; ///< initial value for Hash()
+
+ private:
+    /** A font file in memory
+     */
+    struct TFontFile {
+        std::string sFilename;
+        char*       pData;
+        pdf_long    lLen;
+        time_t      tModified;
+        bool        bMapped;   ///< if true pData has to be unmapped instead of freed
+        int         nRefCount; ///< number of faces using this file
+        bool        bOutdated; ///< the file has changed on disk, it is freed when unused
+    };
+
+    /** A face created from a font file
+     */
+    struct TFace {
+        FT_Library library;
+        TFontFile* pFile;
+        int        nRefCount;
+    };
+
+    /** A font subset and the glyphs it contains
+     */
+    struct TSubset {
+        std::vector<unsigned short> vecGlyphs;
+        std::string                 sData;
+    };
+
+    typedef std::pair<pdf_uint64,pdf_uint64>      TSubsetKey;
+    typedef std::map<std::string,TFontFile*>      TMapFiles;
+    typedef std::map<FT_Face,TFace>               TMapFaces;
+    typedef std::map<TSubsetKey,TSubset>          TMapSubsets;
+
+    /** Get a font file from the cache or load it.
+     *  Has to be called with the mutex locked.
+     */
+    static TFontFile* GetFile( const char* pszFilename );
+
+    /** Release a font file, has to be called with the mutex locked.
+     */
+    static void ReleaseFile( TFontFile* pFile );
+
+    static void FreeFile( TFontFile* pFile );
+
+    static Util::PdfMutex       s_mutex;
+    static TMapFiles              s_mapFiles;
+    static TMapFaces              s_mapFaces;
+    static TMapSubsets            s_mapSubsets;
+    static std::deque<TSubsetKey> s_queSubsets;   ///< subsets in the order they were added
+    static size_t                 s_nSubsetBytes; ///< size of all subsets in the cache
+    static TStatistics            s_statistics;
+};
+
+};
+
+#endif // _PDF_FONT_FACE_CACHE_H_
@@ -27,6 +27,7 @@
 #include "base/PdfVariant.h"
 
 #include "PdfFontFactory.h"
+#include "PdfFontFaceCache.h"
 
 #include <sstream>
 
@@ -50,15 +51,26 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype( FT_Library* pLibrary, const char
                       pszFilename, pszSubsetPrefix ),
       m_pLibrary( pLibrary ),
       m_pFace( NULL ),
+      m_pFileData( NULL ),
+      m_lFileDataLen( 0 ),
       m_bSymbol( false )
 {
-    FT_Error err = FT_New_Face( *pLibrary, pszFilename, 0, &m_pFace );
-    if ( err )
-    {	
-        // throw an exception
-        PdfError::LogMessage( eLogSeverity_Critical, "FreeType returned the error %i when calling FT_New_Face for font %s.", 
-                              err, pszFilename );
-        PODOFO_RAISE_ERROR( ePdfError_FreeType );
+    if( m_eFontType == ePdfFontType_TrueType )
+    {
+        // TrueType files are kept in memory and their
+        // faces are shared by all fonts using the same file
+        m_pFace = PdfFontFaceCache::OpenFace( *pLibrary, pszFilename, &m_pFileData, &m_lFileDataLen );
+    }
+    else
+    {
+        FT_Error err = FT_New_Face( *pLibrary, pszFilename, 0, &m_pFace );
+        if ( err )
+        {	
+            // throw an exception
+            PdfError::LogMessage( eLogSeverity_Critical, "FreeType returned the error %i when calling FT_New_Face for font %s.", 
+                                  err, pszFilename );
+            PODOFO_RAISE_ERROR( ePdfError_FreeType );
+        }
     }
     
     InitFromFace();
@@ -70,6 +82,8 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype( FT_Library* pLibrary,
     : PdfFontMetrics( ePdfFontType_Unknown, "", pszSubsetPrefix ),
       m_pLibrary( pLibrary ),
       m_pFace( NULL ),
+      m_pFileData( NULL ),
+      m_lFileDataLen( 0 ),
       m_bSymbol( false )
 {
     m_bufFontData = PdfRefCountedBuffer( nBufLen ); // const_cast is ok, because we SetTakePossension to false!
@@ -84,6 +98,8 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype( FT_Library* pLibrary,
     : PdfFontMetrics( ePdfFontType_Unknown, "", pszSubsetPrefix ),
       m_pLibrary( pLibrary ),
       m_pFace( NULL ),
+      m_pFileData( NULL ),
+      m_lFileDataLen( 0 ),
       m_bSymbol( false ),
       m_bufFontData( rBuffer )
 {
@@ -101,6 +117,8 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype( FT_Library* pLibrary,
                       pszSubsetPrefix ),
       m_pLibrary( pLibrary ),
       m_pFace( face ),
+      m_pFileData( NULL ),
+      m_lFileDataLen( 0 ),
       m_bSymbol( false )
 {
     // asume true type
@@ -113,7 +131,10 @@ PdfFontMetricsFreetype::~PdfFontMetricsFreetype()
 {
     if ( m_pFace )
     {
-        FT_Done_Face( m_pFace );
+        if( m_pFileData )
+            PdfFontFaceCache::ReleaseFace( m_pFace );
+        else
+            FT_Done_Face( m_pFace );
     }
 }
 
@@ -398,7 +419,7 @@ double PdfFontMetricsFreetype::GetStrikeoutThickness() const
 // -----------------------------------------------------
 const char* PdfFontMetricsFreetype::GetFontData() const
 {
-    return m_bufFontData.GetBuffer();
+    return m_pFileData ? m_pFileData : m_bufFontData.GetBuffer();
 }
 
 // -----------------------------------------------------
@@ -406,7 +427,7 @@ const char* PdfFontMetricsFreetype::GetFontData() const
 // -----------------------------------------------------
 pdf_long PdfFontMetricsFreetype::GetFontDataLen() const
 {
-    return m_bufFontData.GetSize();
+    return m_pFileData ? m_lFileDataLen : m_bufFontData.GetSize();
 }  
 
 // -----------------------------------------------------
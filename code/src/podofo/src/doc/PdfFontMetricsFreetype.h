@@ -248,6 +248,8 @@ class PODOFO_DOC_API PdfFontMetricsFreetype : public PdfFontMetrics {
  protected:
     FT_Library*   m_pLibrary;
     FT_Face       m_pFace;
+    const char*   m_pFileData;    ///< contents of the font file if m_pFace is owned by PdfFontFaceCache
+    pdf_long      m_lFileDataLen;
 
  private:
     bool          m_bSymbol;  ///< Internal member to singnal a symbol font
@@ -25,6 +25,8 @@
 #include "base/PdfInputDevice.h"
 #include "base/PdfOutputDevice.h"
 
+#include "PdfFontFaceCache.h"
+
 #include <cstring>
 #include <iostream>
 #include <algorithm>
@@ -234,6 +236,30 @@ void PdfFontTTFSubset::SeeIfLongLocaOrNot()
 	m_bIsLongLoca = (usIsLong == 0 ? false : true);
 }
 
+pdf_uint64 PdfFontTTFSubset::GetFontHash()
+{
+    // The table checksums cover the contents of all tables,
+    // the checksum adjustment in the head table covers the whole file
+    pdf_uint32 values[] = { static_cast<pdf_uint32>(m_eFontFileType), m_faceIndex,
+                            static_cast<pdf_uint32>(m_ulStartOfTTFOffsets), m_numGlyphs,
+                            static_cast<pdf_uint32>(m_bIsLongLoca) };
+    pdf_uint64 nHash = PdfFontFaceCache::Hash( values, sizeof(values) );
+
+    std::vector<TTrueTypeTable>::const_iterator it = m_vTable.begin();
+    for (; it != m_vTable.end(); it++)
+    {
+        pdf_uint32 table[] = { static_cast<pdf_uint32>(it->m_checksum),
+                               static_cast<pdf_uint32>(it->m_offset),
+                               static_cast<pdf_uint32>(it->m_length) };
+        nHash = PdfFontFaceCache::Hash( it->m_tableName, __LENGTH_DWORD, nHash );
+        nHash = PdfFontFaceCache::Hash( table, sizeof(table), nHash );
+    }
+
+    unsigned char checksum[__LENGTH_DWORD];
+    GetData( GetTableOffset( "head" ) + 2*__LENGTH_DWORD, checksum, __LENGTH_DWORD );
+    return PdfFontFaceCache::Hash( checksum, __LENGTH_DWORD, nHash );
+}
+
 void PdfFontTTFSubset::BuildFont( PdfOutputDevice* pOutputDevice )
 {
     Init();
@@ -241,9 +267,6 @@ void PdfFontTTFSubset::BuildFont( PdfOutputDevice* pOutputDevice )
     // Not necessary as we do a sorted insert
     //std::sort(m_vGlyphIndice.begin(),m_vGlyphIndice.end());
 	
-    //Find the font offset table:
-    unsigned long ulStartOfTTFOffsets = m_ulStartOfTTFOffsets;
-
     // Deal with glyph indeces which are
     // not part of this font. Remove any
     // glyph that cannot be embedded therefore
@@ -260,6 +283,32 @@ void PdfFontTTFSubset::BuildFont( PdfOutputDevice* pOutputDevice )
         }
     }
 
+    // The same subset of a font is usually built again
+    // for every document, so try the cache first
+    pdf_uint64  nFontHash = this->GetFontHash();
+    std::string sData;
+    if( PdfFontFaceCache::GetSubset( nFontHash, m_vGlyphIndice, sData ) )
+    {
+        pOutputDevice->Write( sData.data(), sData.length() );
+        return;
+    }
+
+    // WriteFont() adds the components of composite glyphs
+    std::vector<unsigned short> vecGlyphs = m_vGlyphIndice;
+    PdfRefCountedBuffer         buffer;
+    PdfOutputDevice             output( &buffer );
+
+    this->WriteFont( &output );
+
+    PdfFontFaceCache::AddSubset( nFontHash, vecGlyphs, buffer.GetBuffer(), output.GetLength() );
+    pOutputDevice->Write( buffer.GetBuffer(), output.GetLength() );
+}
+
+void PdfFontTTFSubset::WriteFont( PdfOutputDevice* pOutputDevice )
+{
+    //Find the font offset table:
+    unsigned long ulStartOfTTFOffsets = m_ulStartOfTTFOffsets;
+
     //==============================================================================
     // Make a new font:
 	
@@ -503,7 +552,7 @@ void PdfFontTTFSubset::BuildFont( PdfOutputDevice* pOutputDevice )
             unsigned pad = GetPadding(m_vTable[i].m_length);
             if (pad != 0)
             {
-                buf = new unsigned char[pad];
+                buf = new unsigned char[pad]();
                 pOutputDevice->Write( reinterpret_cast<char*>(buf), pad );
                 delete[] buf;
             }
@@ -689,7 +738,7 @@ void PdfFontTTFSubset::BuildFont( PdfOutputDevice* pOutputDevice )
             unsigned pad = GetPadding(m_vTable[i].m_length);
             if (pad != 0)
             {
-                buf = new unsigned char[pad];
+                buf = new unsigned char[pad]();
                 pOutputDevice->Write( reinterpret_cast<char*>(buf), pad );
                 delete[] buf;
             }
@@ -80,6 +80,9 @@ class PODOFO_DOC_API PdfFontTTFSubset {
     /**
      * Actually generate the subsetted font
      *
+     * Subsets are cached for the whole process, so building
+     * the same subset of the same font again is cheap.
+     *
      * @param pOutputDevice write the font to this device
      */
     void BuildFont( PdfOutputDevice* pOutputDevice ); 
@@ -118,6 +121,18 @@ class PODOFO_DOC_API PdfFontTTFSubset {
     PdfFontTTFSubset& operator=(const PdfFontTTFSubset& rhs);
 
     void Init();
+
+    /** Write the subsetted font, called by BuildFont()
+     *  if the subset is not in the cache.
+     *
+     *  @param pOutputDevice write the font to this device
+     */
+    void WriteFont( PdfOutputDevice* pOutputDevice );
+
+    /** Calculate a hash identifying this font file.
+     *  Can only be called after Init().
+     */
+    pdf_uint64 GetFontHash();
     
     /** Get the offset of a specified table. 
      *  @param pszTableName name of the table
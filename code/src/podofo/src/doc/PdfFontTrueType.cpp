@@ -27,6 +27,8 @@
 #include "base/PdfName.h"
 #include "base/PdfStream.h"
 
+#include "PdfFontFaceCache.h"
+
 namespace PoDoFo {
 
 PdfFontTrueType::PdfFontTrueType( PdfFontMetrics* pMetrics, const PdfEncoding* const pEncoding, 
@@ -84,6 +86,8 @@ void PdfFontTrueType::EmbedFontFile( PdfObject* pDescriptor )
         pContents->GetStream()->Set( &stream );
             
     }
+
+    PdfFontFaceCache::AddEmbeddedBytes( lSize );
 }
 
 
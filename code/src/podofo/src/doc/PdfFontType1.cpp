@@ -28,6 +28,7 @@
 #include "base/PdfStream.h"
 
 #include "PdfDifferenceEncoding.h"
+#include "PdfFontFaceCache.h"
 
 #include <stdlib.h>
 
@@ -362,6 +363,7 @@ void PdfFontType1::EmbedSubsetFont()
 
 	// now embed
 	pContents->GetStream()->Set( reinterpret_cast<const char *>(outBuff), outIndex );
+	PdfFontFaceCache::AddEmbeddedBytes( outIndex );
 
 	// cleanup memory
     if( pAllocated )
@@ -468,6 +470,7 @@ void PdfFontType1::EmbedFontFile( PdfObject* pDescriptor )
 				break;
 			case 3:									// end-of-file
 				pContents->GetStream()->Set( pBuffer, lSize - 2L );
+				PdfFontFaceCache::AddEmbeddedBytes( lSize - 2L );
 				if( pAllocated )
 					free( pAllocated );
 
@@ -501,6 +504,7 @@ void PdfFontType1::EmbedFontFile( PdfObject* pDescriptor )
     
 	// TODO: Pdf Supports only Type1 fonts with binary encrypted sections and not the hex format
 	pContents->GetStream()->Set( pBuffer, lSize );
+    PdfFontFaceCache::AddEmbeddedBytes( lSize );
     if( pAllocated )
         free( pAllocated );
 
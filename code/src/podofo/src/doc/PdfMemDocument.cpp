@@ -33,6 +33,7 @@
 #include "base/PdfArray.h"
 #include "base/PdfDictionary.h"
 #include "base/PdfImmediateWriter.h"
+#include "base/PdfInputDevice.h"
 #include "base/PdfObject.h"
 #include "base/PdfParserObject.h"
 #include "base/PdfStream.h"
@@ -54,7 +55,9 @@ using namespace std;
 namespace PoDoFo {
 
 PdfMemDocument::PdfMemDocument()
-    : PdfDocument(), m_pEncrypt( NULL ), m_pParser( NULL )
+    : PdfDocument(), m_pEncrypt( NULL ), m_pParser( NULL ), 
+      m_lFileSize( 0 ), m_lPrevXRefOffset( 0 ), m_lPrevSize( 0 ), m_bXRefStream( false ),
+      m_bObjectStreams( true ), m_bWriteLinearized( false )
 {
     m_eVersion    = ePdfVersion_Default;
     m_eWriteMode  = ePdfWriteMode_Default;
@@ -62,7 +65,9 @@ PdfMemDocument::PdfMemDocument()
 }
 
 PdfMemDocument::PdfMemDocument( const char* pszFilename )
-    : PdfDocument(), m_pEncrypt( NULL ), m_pParser( NULL )
+    : PdfDocument(), m_pEncrypt( NULL ), m_pParser( NULL ), 
+      m_lFileSize( 0 ), m_lPrevXRefOffset( 0 ), m_lPrevSize( 0 ), m_bXRefStream( false ),
+      m_bObjectStreams( true ), m_bWriteLinearized( false )
 {
     this->Load( pszFilename );
 }
@@ -71,7 +76,9 @@ PdfMemDocument::PdfMemDocument( const char* pszFilename )
 #if defined(_MSC_VER)  &&  _MSC_VER <= 1200			// nicht fr Visualstudio 6
 #else
 PdfMemDocument::PdfMemDocument( const wchar_t* pszFilename )
-    : PdfDocument(), m_pEncrypt( NULL ), m_pParser( NULL )
+    : PdfDocument(), m_pEncrypt( NULL ), m_pParser( NULL ), 
+      m_lFileSize( 0 ), m_lPrevXRefOffset( 0 ), m_lPrevSize( 0 ), m_bXRefStream( false ),
+      m_bObjectStreams( true ), m_bWriteLinearized( false )
 {
     this->Load( pszFilename );
 }
@@ -94,7 +101,17 @@ void PdfMemDocument::Clear()
     delete m_pParser;
     m_pParser = NULL;
 
-    m_eWriteMode  = ePdfWriteMode_Default;
+    m_device          = PdfRefCountedInputDevice();
+    m_sFilename.clear();
+    m_lstOriginal.clear();
+    m_lFileSize       = 0;
+    m_lPrevXRefOffset = 0;
+    m_lPrevSize       = 0;
+    m_bXRefStream     = false;
+
+    m_eWriteMode     = ePdfWriteMode_Default;
+    m_bObjectStreams   = true;
+    m_bWriteLinearized = false;
     PdfDocument::Clear();
 }
 
@@ -103,6 +120,19 @@ void PdfMemDocument::InitFromParser( PdfParser* pParser )
     m_eVersion     = pParser->GetPdfVersion();
     m_bLinearized  = pParser->IsLinearized();
 
+    // Remember the loaded file for incremental updates, 
+    // before any object is added to the document
+    m_device          = pParser->GetDevice();
+    m_lFileSize       = pParser->GetFileSize();
+    m_lPrevXRefOffset = pParser->GetXRefOffset();
+    m_lPrevSize       = static_cast<pdf_long>(pParser->GetTrailer()->GetDictionary().GetKeyAsLong( PdfName::KeySize, 0 ));
+    m_bXRefStream     = pParser->HasXRefStream();
+
+    this->GetObjects().Sort();
+    m_lstOriginal.clear();
+    for( TCIVecObjects it = this->GetObjects().begin(); it != this->GetObjects().end(); ++it )
+        m_lstOriginal.push_back( (*it)->Reference() );
+
     PdfObject* pTrailer = new PdfObject( *(pParser->GetTrailer()) );
     this->SetTrailer ( pTrailer ); // Set immediately as trailer
                                    // so that pTrailer has an owner
@@ -160,6 +190,7 @@ void PdfMemDocument::Load( const char* pszFilename )
     // so that m_pParser is initialized for encrypted documents
     m_pParser = new PdfParser( PdfDocument::GetObjects() );
     m_pParser->ParseFile( pszFilename, true );
+    m_sFilename = pszFilename;
     InitFromParser( m_pParser );
     InitPagesTree();
 
@@ -289,6 +320,8 @@ void PdfMemDocument::Write( PdfOutputDevice* pDevice )
     PdfWriter writer( &(this->GetObjects()), this->GetTrailer() );
     writer.SetPdfVersion( this->GetPdfVersion() );
     writer.SetWriteMode( m_eWriteMode );
+    writer.SetUseObjectStreams( m_bObjectStreams );
+    writer.SetLinearized( m_bWriteLinearized );
 
     if( m_pEncrypt ) 
         writer.SetEncrypted( *m_pEncrypt );
@@ -296,6 +329,78 @@ void PdfMemDocument::Write( PdfOutputDevice* pDevice )
     writer.Write( pDevice );    
 }
 
+void PdfMemDocument::WriteUpdate( const char* pszFilename )
+{
+    if( !m_device.Device() )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidHandle, "WriteUpdate called without reading a PDF file." );
+    }
+
+	// makes sure pending subset-fonts are embedded
+	m_fontCache.EmbedSubsetFonts();
+
+    if( !m_sFilename.empty() && m_sFilename == pszFilename )
+    {
+        // Objects still read their data from the original file,
+        // so it must not be truncated: append to it instead.
+        PdfOutputDevice device( pszFilename, false );
+
+        this->AppendUpdate( &device );
+    }
+    else
+    {
+        PdfOutputDevice device( pszFilename );
+
+        this->WriteUpdate( &device );
+    }
+}
+
+void PdfMemDocument::WriteUpdate( PdfOutputDevice* pDevice )
+{
+    const size_t BUFFER_SIZE = 4096;
+
+    char   buffer[BUFFER_SIZE];
+    size_t lRemaining = m_lFileSize;
+
+    if( !m_device.Device() )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidHandle, "WriteUpdate called without reading a PDF file." );
+    }
+
+    // Copy the original file unmodified, objects which are 
+    // loaded on demand seek to their own position anyway
+    m_device.Device()->Seek( 0 );
+    while( lRemaining )
+    {
+        std::streamoff lRead = m_device.Device()->Read( buffer, static_cast<std::streamsize>(std::min( lRemaining, BUFFER_SIZE )) );
+        if( lRead <= 0 )
+        {
+            PODOFO_RAISE_ERROR( ePdfError_UnexpectedEOF );
+        }
+
+        pDevice->Write( buffer, static_cast<size_t>(lRead) );
+        lRemaining -= static_cast<size_t>(lRead);
+    }
+
+    this->AppendUpdate( pDevice );
+}
+
+void PdfMemDocument::AppendUpdate( PdfOutputDevice* pDevice )
+{
+    PdfWriter writer( &(this->GetObjects()), this->GetTrailer() );
+    writer.SetPdfVersion( this->GetPdfVersion() );
+    writer.SetWriteMode( m_eWriteMode );
+    // Keep the type of XRef section of the original file,
+    // object streams are only used if it is a XRef stream
+    writer.SetUseXRefStream( m_bXRefStream );
+    writer.SetUseObjectStreams( m_bObjectStreams );
+
+    if( m_pEncrypt ) 
+        writer.SetEncrypted( *m_pEncrypt );
+
+    writer.WriteUpdate( pDevice, m_lstOriginal, m_lPrevXRefOffset, m_lPrevSize );
+}
+
 PdfObject* PdfMemDocument::GetNamedObjectFromCatalog( const char* pszName ) const 
 {
     return this->GetCatalog()->GetIndirectKey( PdfName( pszName ) );
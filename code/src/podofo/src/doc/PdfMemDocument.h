@@ -195,6 +195,33 @@ class PODOFO_DOC_API PdfMemDocument : public PdfDocument {
      */
     void Write( PdfOutputDevice* pDevice );
 
+    /** Writes an incremental update of a loaded document to a file.
+     *
+     *  Only objects which have been added or modified since the document
+     *  was loaded are written, appended to the original file together with
+     *  a new XRef section and trailer. The bytes of the original file are
+     *  not touched, which is much faster than Write() for small changes
+     *  to large documents.
+     *
+     *  If pszFilename is the file the document was loaded from,
+     *  the update is appended to it in place. Otherwise the original
+     *  file is copied to pszFilename first.
+     *
+     *  \param pszFilename filename of the document 
+     *
+     *  \see Write
+     */
+    void WriteUpdate( const char* pszFilename );
+
+    /** Writes the original file followed by an incremental update
+     *  of the loaded document to an output device.
+     *
+     *  \param pDevice write to this output device
+     *
+     *  \see WriteUpdate
+     */
+    void WriteUpdate( PdfOutputDevice* pDevice );
+
     /** Set the write mode to use when writing the PDF.
      *  \param eWriteMode write mode
      */
@@ -205,6 +232,35 @@ class PODOFO_DOC_API PdfMemDocument : public PdfDocument {
      */
     virtual EPdfWriteMode GetWriteMode() const { return m_eWriteMode; }
 
+    /** Pack all objects without a stream into compressed object streams
+     *  and use a XRef stream when writing the document with Write().
+     *  This is enabled by default and makes the written file PDF 1.5.
+     *  Encrypted documents do not use object streams. Incremental updates
+     *  only use them if the loaded file has a XRef stream.
+     *
+     *  \param bObjectStreams if true object streams are used
+     */
+    void SetUseObjectStreams( bool bObjectStreams ) { m_bObjectStreams = bObjectStreams; }
+
+    /** 
+     *  \returns true if object streams are used when writing
+     */
+    bool GetUseObjectStreams() const { return m_bObjectStreams; }
+
+    /** Write a linearized PDF file with Write(), which can be displayed
+     *  while it is loaded. This is disabled by default. Linearized files
+     *  use no object streams, so SetUseObjectStreams() has no effect.
+     *
+     *  \param bLinearized if true a linearized PDF file is written
+     *  \see PdfWriter::SetLinearized
+     */
+    void SetWriteLinearized( bool bLinearized ) { m_bWriteLinearized = bLinearized; }
+
+    /** 
+     *  \returns true if Write() creates a linearized PDF file
+     */
+    bool GetWriteLinearized() const { return m_bWriteLinearized; }
+
     /** Set the PDF Version of the document. Has to be called before Write() to
      *  have an effect.
      *  \param eVersion  version of the pdf document
@@ -480,6 +536,11 @@ class PODOFO_DOC_API PdfMemDocument : public PdfDocument {
      */
     void InitFromParser( PdfParser* pParser );
 
+    /** Append an incremental update to pDevice, which has to
+     *  be positioned at the end of a copy of the original file.
+     */
+    void AppendUpdate( PdfOutputDevice* pDevice );
+
     /** Clear all internal variables
      */
     void Clear();
@@ -506,6 +567,17 @@ class PODOFO_DOC_API PdfMemDocument : public PdfDocument {
 
     PdfParser*      m_pParser; ///< This will be temporarily initialized to a PdfParser object so that SetPassword can work
     EPdfWriteMode   m_eWriteMode;
+
+    // The loaded file, required to write incremental updates
+    PdfRefCountedInputDevice m_device;           ///< Device the document was loaded from
+    std::string              m_sFilename;        ///< Filename the document was loaded from, if any
+    TPdfReferenceList        m_lstOriginal;      ///< Sorted list of all objects read from the file
+    size_t                   m_lFileSize;        ///< Length of the loaded file
+    pdf_long                 m_lPrevXRefOffset;  ///< Offset of the last XRef section of the loaded file
+    pdf_long                 m_lPrevSize;        ///< /Size key of the trailer of the loaded file
+    bool                     m_bXRefStream;      ///< Whether the loaded file uses a XRef stream
+    bool                     m_bObjectStreams;   ///< Whether Write() packs objects into object streams
+    bool                     m_bWriteLinearized; ///< Whether Write() creates a linearized file
 };
 
 // -----------------------------------------------------
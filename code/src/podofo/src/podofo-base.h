@@ -40,6 +40,7 @@
 #include "base/PdfError.h"
 #include "base/PdfFileStream.h"
 #include "base/PdfFilter.h"
+#include "base/PdfHintStream.h"
 #include "base/PdfImmediateWriter.h"
 #include "base/PdfInputDevice.h"
 #include "base/PdfInputStream.h"
@@ -59,6 +60,7 @@
 #include "base/PdfReference.h"
 #include "base/PdfRijndael.h"
 #include "base/PdfStream.h"
+#include "base/PdfStreamCompressor.h"
 #include "base/PdfString.h"
 #include "base/PdfTokenizer.h"
 #include "base/PdfVariant.h"
@@ -50,6 +50,7 @@
 #include "doc/PdfFontCID.h"
 #include "doc/PdfFontFactoryBase14Data.h"
 #include "doc/PdfFontFactory.h"
+#include "doc/PdfFontFaceCache.h"
 #include "doc/PdfFont.h"
 #include "doc/PdfFontMetricsBase14.h"
 #include "doc/PdfFontMetricsFreetype.h"
@@ -61,7 +62,6 @@
 #include "doc/PdfFontType1Base14.h"
 #include "doc/PdfFontType1.h"
 #include "doc/PdfFunction.h"
-#include "doc/PdfHintStream.h"
 #include "doc/PdfIdentityEncoding.h"
 #include "doc/PdfImage.h"
 #include "doc/PdfInfo.h"
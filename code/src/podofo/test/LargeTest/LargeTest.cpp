@@ -21,12 +21,20 @@
 #include <podofo.h>
 #include <fontconfig/fontconfig.h>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif // _WIN32
 
 using namespace PoDoFo;
 
 #define MIN_PAGES 100
 
 bool writeImmediately = true;
+int  numPages         = 0; // one page per font, at most MIN_PAGES
 
 void AddPage( PdfDocument* pDoc, const char* pszFontName, const char* pszImagePath )
 {
@@ -124,14 +132,18 @@ void CreateLargePdf( const char* pszFilename, const char* pszImagePath )
     else 
         pDoc = new PdfMemDocument();
 
-    if( pFontSet )
+    if( pFontSet && pFontSet->nfont )
     {
-        for( int i=0; i< (pFontSet->nfont > MIN_PAGES ? MIN_PAGES : pFontSet->nfont );i++ )
+        int nPages = numPages;
+        if( !nPages ) 
+            nPages = (pFontSet->nfont > MIN_PAGES ? MIN_PAGES : pFontSet->nfont );
+
+        for( int i=0; i< nPages;i++ )
         {
             FcValue v;
 
             //FcPatternPrint( pFontSet->fonts[i] );
-            FcPatternGet( pFontSet->fonts[i], FC_FAMILY, 0, &v );
+            FcPatternGet( pFontSet->fonts[i % pFontSet->nfont], FC_FAMILY, 0, &v );
             //font = FcNameUnparse( pFontSet->fonts[i] );
             printf(" -> Drawing with font: %s\n", reinterpret_cast<const char*>(v.u.s) );
             AddPage( pDoc, reinterpret_cast<const char*>(v.u.s), pszImagePath );
@@ -148,39 +160,84 @@ void CreateLargePdf( const char* pszFilename, const char* pszImagePath )
     delete pDoc;
 }
 
+/** Load a large PDF with demand loading and visit the contents of all pages.
+ *  The stream of each contents object is freed after it has been visited.
+ *  The objects themselves stay loaded, so the memory usage still grows
+ *  with the number of pages, but not with the size of their contents.
+ */
+void ReadLargePdf( const char* pszFilename )
+{
+    clock_t        start = clock();
+    PdfMemDocument doc;
+    pdf_long       lContents = 0;
+
+    doc.Load( pszFilename );
+    printf("Loaded %s in %.3f s\n", pszFilename, 
+           static_cast<double>(clock() - start) / CLOCKS_PER_SEC );
+
+    for( int i=0; i<doc.GetPageCount(); i++ ) 
+    {
+        PdfPage*   pPage     = doc.GetPage( i );
+        PdfObject* pContents = pPage->GetContents();
+        if( pContents && pContents->HasStream() ) 
+        {
+            lContents += pContents->GetStream()->GetLength();
+            doc.FreeObjectMemory( pContents, true );
+        }
+    }
+
+    printf("Visited %i pages with %li bytes of contents in %.3f s\n", doc.GetPageCount(), 
+           static_cast<long>(lContents), static_cast<double>(clock() - start) / CLOCKS_PER_SEC );
+#ifndef _WIN32
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+        printf("Peak resident set size: %li kB\n", static_cast<long>(usage.ru_maxrss) );
+#endif // _WIN32
+}
+
 void usage()
 {
-    printf("Usage: LargetTest [-m] output_filename image_file\n"
+    printf("Usage: LargetTest [-m] [-n pages] output_filename image_file\n"
+           "       LargetTest -r input_filename\n"
            "       output_filename: filename to write produced pdf to\n"
            "       image_file:      An image to embed in the PDF file\n"
+           "       input_filename:  A PDF file to read\n"
            "Options:\n"
            "       -m               Build entire document in memory before writing\n"
+           "       -n pages         Number of pages to write (default: one per font, at most %i)\n"
+           "       -r               Read a PDF file using demand loading and report time and memory usage\n"
            "\n"
-           "Note that output should be the same with and without the -m option.\n");
+           "Note that output should be the same with and without the -m option.\n"
+           "Use -n to write a large file and -r to check that reading it needs\n"
+           "a bounded amount of memory.\n", MIN_PAGES );
 }
 
 int main( int argc, char* argv[] ) 
 {
-    if( argc < 3 || argc > 4 )
-    {
-        usage();
-        return 1;
-    }
-    else if ( argc == 4)
+    bool readFile = false;
+
+    // Handle options
+    while( argc > 1 && argv[1][0] == '-' )
     {
-        // Handle options
-        // Is this argument an option?
-        if (argv[1][0] != '-')
-        {
-            usage();
-            return 1;
-        }
-        // Is it a recognised option?
-        if (argv[1][1] == 'm')
+        if( strcmp( argv[1], "-m" ) == 0 )
         {
             // User wants us to build the whole doc in RAM before writing it out.
             writeImmediately = false;
+        }
+        else if( strcmp( argv[1], "-r" ) == 0 )
+        {
+            readFile = true;
+        }
+        else if( strcmp( argv[1], "-n" ) == 0 && argc > 2 )
+        {
+            numPages = atoi( argv[2] );
+            if( numPages <= 0 ) 
+            {
+                usage();
+                return 1;
+            }
             ++argv;
+            --argc;
         }
         else
         {
@@ -188,13 +245,28 @@ int main( int argc, char* argv[] )
             usage();
             return 1;
         }
+
+        ++argv;
+        --argc;
     }
 
-    try {
-        CreateLargePdf( argv[1], argv[2] );
+    if( argc != (readFile ? 2 : 3) )
+    {
+        usage();
+        return 1;
+    }
 
-        printf("\nWrote the PDF file %s successfully\n", argv[1] ); 
+    try {
+        if( readFile ) 
+        {
+            ReadLargePdf( argv[1] );
+        }
+        else
+        {
+            CreateLargePdf( argv[1], argv[2] );
 
+            printf("\nWrote the PDF file %s successfully\n", argv[1] ); 
+        }
     } catch( PdfError & e ) {
         e.PrintErrorMsg();
         return e.GetError();
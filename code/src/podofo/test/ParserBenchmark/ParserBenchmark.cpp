@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <podofo-base.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace PoDoFo;
+using namespace std;
+
+#define DEFAULT_ITERATIONS 20
+
+void print_help()
+{
+    cerr << "Usage: ParserBenchmark [-n <iterations>] <input_filename> [<input_filename> ...]\n"
+         << "    -n       Parse every file this many times (default: " << DEFAULT_ITERATIONS << ")\n"
+         << "\n"
+         << "Times PdfParser::ParseFile on every file, reading from disk\n"
+         << "and from a memory buffer, with and without demand loading.\n"
+         << "Use it on the files in test/pdfs to compare parser changes.\n"
+         << flush;
+}
+
+/** Parse a file or a memory buffer nIterations times.
+ *  \returns the CPU time in milliseconds per iteration
+ */
+double time_parse( const char* pszFilename, const std::vector<char> & rData, 
+                   bool bFromMemory, bool bDemandLoading, int nIterations )
+{
+    clock_t start = clock();
+    for( int i=0;i<nIterations;i++ ) 
+    {
+        PdfVecObjects objects;
+        PdfParser     parser( &objects );
+        objects.SetAutoDelete( true );
+
+        if( bFromMemory )
+            parser.ParseFile( PdfRefCountedInputDevice( &(rData[0]), rData.size() ), bDemandLoading );
+        else
+            parser.ParseFile( pszFilename, bDemandLoading );
+    }
+    clock_t end = clock();
+
+    return (static_cast<double>(end - start) * 1000.0 / CLOCKS_PER_SEC) / nIterations;
+}
+
+bool benchmark( const char* pszFilename, int nIterations )
+{
+    std::ifstream file( pszFilename, std::ios::binary );
+    std::vector<char> data( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+    if( data.empty() )
+    {
+        cerr << "Cannot read " << pszFilename << endl;
+        return false;
+    }
+
+    try {
+        cout << pszFilename << " (" << data.size() << " bytes)" << endl;
+        cout << fixed << setprecision( 3 )
+             << "    file:                   " << time_parse( pszFilename, data, false, false, nIterations ) << " ms" << endl
+             << "    file, demand loading:   " << time_parse( pszFilename, data, false, true,  nIterations ) << " ms" << endl
+             << "    memory:                 " << time_parse( pszFilename, data, true,  false, nIterations ) << " ms" << endl
+             << "    memory, demand loading: " << time_parse( pszFilename, data, true,  true,  nIterations ) << " ms" << endl;
+    } catch( PdfError & e ) {
+        e.PrintErrorMsg();
+        return false;
+    }
+
+    return true;
+}
+
+int main( int argc, char* argv[] )
+{
+    int  nIterations = DEFAULT_ITERATIONS;
+    int  nFiles      = 0;
+    bool bSuccess    = true;
+
+    PdfError::EnableLogging( false );
+
+    for( int i=1; i<argc; i++ ) 
+    {
+        if( string("-n") == argv[i] && i + 1 < argc )
+        {
+            nIterations = atoi( argv[++i] );
+            if( nIterations <= 0 ) 
+            {
+                print_help();
+                return 1;
+            }
+        }
+        else
+        {
+            bSuccess = benchmark( argv[i], nIterations ) && bSuccess;
+            ++nFiles;
+        }
+    }
+
+    if( !nFiles ) 
+    {
+        print_help();
+        return 1;
+    }
+
+    return bSuccess ? 0 : 1;
+}
@@ -20,6 +20,7 @@
 
 #include <podofo-base.h>
 
+#include <ctime>
 #include <iostream>
 #include <string>
 using std::cerr;
@@ -33,10 +34,13 @@ using namespace PoDoFo;
 
 void print_help()
 {
-        cerr << "Usage: ParserTest [-d] [-clean] [-compact] <input_filename> [<output_filename>]\n"
+        cerr << "Usage: ParserTest [-d] [-clean] [-compact] [-xref] [-objstm] [-lin] <input_filename> [<output_filename>]\n"
              << "    -d       Enable demand loading of objects\n"
              << "    -clean   Write a clean PDF that is readable in a text editor\n"
              << "    -compact Write the PDF as compact as possible\n"
+             << "    -xref    Write a XRef stream\n"
+             << "    -objstm  Pack objects into object streams\n"
+             << "    -lin     Write a linearized PDF\n"
              << flush;
 }
 
@@ -98,18 +102,21 @@ void enc_test()
     */
 }
 
-void write_back( PdfParser* pParser, const char* pszFilename, EPdfWriteMode eWriteMode )
+void write_back( PdfParser* pParser, const char* pszFilename, EPdfWriteMode eWriteMode,
+                 bool bXRefStream, bool bObjectStreams, bool bLinearized )
 {
     //enc_test();
 
     PdfWriter writer( pParser );
     writer.SetWriteMode( eWriteMode );
+    writer.SetUseXRefStream( bXRefStream );
+    writer.SetUseObjectStreams( bObjectStreams );
+    writer.SetLinearized( bLinearized );
     /*
     PdfEncrypt encrypt( "user", "podofo", 0,
                         PdfEncrypt::ePdfEncryptAlgorithm_RC4V2, PdfEncrypt::ePdfKeyLength_128 );
     */
     //writer.SetUseXRefStream( true );
-    //writer.SetLinearized( true );
     writer.SetPdfVersion( ePdfVersion_1_6 );
     //writer.SetEncrypted( encrypt );
     writer.Write( pszFilename );
@@ -127,6 +134,9 @@ int main( int argc, char*  argv[] )
     
     bool useDemandLoading = false;
     bool useStrictMode = false;
+    bool useXRefStream = false;
+    bool useObjectStreams = false;
+    bool useLinearization = false;
     const char* pszInput = NULL;
     const char* pszFilename = NULL;
 
@@ -151,6 +161,18 @@ int main( int argc, char*  argv[] )
             {
                 eWriteMode = ePdfWriteMode_Compact;
             }
+            else if (string("-xref") == argv[i])
+            {
+                useXRefStream = true;
+            }
+            else if (string("-objstm") == argv[i])
+            {
+                useObjectStreams = true;
+            }
+            else if (string("-lin") == argv[i])
+            {
+                useLinearization = true;
+            }
         }
         else
         {
@@ -173,11 +195,14 @@ int main( int argc, char*  argv[] )
     if( pszInput == NULL )
     {
         print_help();
-        cerr << "Usage: ParserTest [-d] [-s] [-clean] [-compact] <input_filename> [<output_filename>]\n"
+        cerr << "Usage: ParserTest [-d] [-s] [-clean] [-compact] [-xref] [-objstm] [-lin] <input_filename> [<output_filename>]\n"
              << "    -d       Enable demand loading of objects\n"
              << "    -s       Enable strict parsing mode\n"
              << "    -clean   Enable clean writing mode\n"
              << "    -compact Enable compact writing mode\n"
+             << "    -xref    Write a XRef stream\n"
+             << "    -objstm  Pack objects into object streams\n"
+             << "    -lin     Write a linearized PDF\n"
              << flush;
         return 0;
     }
@@ -237,8 +262,9 @@ int main( int argc, char*  argv[] )
         if (pszFilename)
         {
             cerr << "Writing..." << flush;
-            write_back( &parser, pszFilename, eWriteMode );
-            cerr << " done" << endl;
+            clock_t start = clock();
+            write_back( &parser, pszFilename, eWriteMode, useXRefStream, useObjectStreams, useLinearization );
+            cerr << " done in " << static_cast<double>(clock() - start) / CLOCKS_PER_SEC << " s" << endl;
         }
     } catch( PdfError & e ) {
         e.PrintErrorMsg();
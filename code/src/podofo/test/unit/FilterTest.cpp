@@ -23,6 +23,7 @@
 #include <cppunit/Asserter.h>
 
 #include <stdlib.h>
+#include <time.h>
 
 using namespace PoDoFo;
 
@@ -132,3 +133,208 @@ void FilterTest::testCCITT()
 
 
 }
+
+void FilterTest::testRLEDecode()
+{
+    // Three literal bytes, a run of four bytes, one literal byte and EOD
+    const char pEncoded[]  = { 0x02, 'a', 'b', 'c', static_cast<char>(0xFD), 'x', 0x00, 'y', static_cast<char>(0x80), 'z' };
+    const char pExpected[] = "abcxxxxy";
+
+    TVecFilters filters;
+    filters.push_back( ePdfFilter_RunLengthDecode );
+
+    // Decode byte by byte, so that runs are split across blocks
+    PdfMemoryOutputStream stream;
+    std::auto_ptr<PdfOutputStream> pDecodeStream( PdfFilterFactory::CreateDecodeStream( filters, &stream ) );
+    for( size_t i=0;i<sizeof(pEncoded);i++ )
+        pDecodeStream->Write( pEncoded + i, 1 );
+    pDecodeStream->Close();
+
+    pdf_long lDecoded = stream.GetLength();
+    char*    pDecoded = stream.TakeBuffer();
+    CPPUNIT_ASSERT_EQUAL( static_cast<long>(strlen(pExpected)), static_cast<long>(lDecoded) );
+    CPPUNIT_ASSERT_EQUAL( memcmp( pExpected, pDecoded, strlen(pExpected) ), 0 );
+    free( pDecoded );
+}
+
+char* FilterTest::CreateLargeBuffer( long lLength )
+{
+    char* pBuffer = static_cast<char*>(malloc( lLength ));
+    long  lPos    = 0;
+    int   i       = 0;
+
+    while( lPos < lLength )
+    {
+        char szLine[64];
+        int  nLen = snprintf( szLine, sizeof(szLine), "BT /F1 12 Tf %i %i Td (%s) Tj ET\n", 
+                              i % 600, (i * 7) % 800, i % 3 ? "Hello" : "World" );
+        memcpy( pBuffer + lPos, szLine, PDF_MIN( static_cast<long>(nLen), lLength - lPos ) );
+        lPos += nLen;
+        ++i;
+    }
+
+    return pBuffer;
+}
+
+void FilterTest::TestStreamingFilter( const TVecFilters & filters, const char * pTestBuffer, const long lTestLength )
+{
+    PdfMemoryOutputStream encoded;
+    if( filters.size() ) 
+    {
+        std::auto_ptr<PdfOutputStream> pEncodeStream( PdfFilterFactory::CreateEncodeStream( filters, &encoded ) );
+        pEncodeStream->Write( pTestBuffer, lTestLength );
+        pEncodeStream->Close();
+    }
+    else
+        encoded.Write( pTestBuffer, lTestLength );
+
+    pdf_long lEncoded = encoded.GetLength();
+    char*    pEncoded = encoded.TakeBuffer();
+
+    // Read with odd sizes so that the reads do not line up with the filter blocks
+    const long lChunks[] = { 1, 7, 1000, 65536 };
+    for( size_t c=0;c<sizeof(lChunks)/sizeof(long);c++ )
+    {
+        PdfFilteredInputStream stream( pEncoded, lEncoded, filters );
+        char*    pDecoded = static_cast<char*>(malloc( lTestLength + lChunks[c] ));
+        pdf_long lDecoded = 0;
+        pdf_long lRead;
+
+        while( (lRead = stream.Read( pDecoded + lDecoded, lChunks[c] )) > 0 )
+            lDecoded += lRead;
+
+        CPPUNIT_ASSERT_EQUAL( static_cast<long>(lTestLength), static_cast<long>(lDecoded) );
+        CPPUNIT_ASSERT_EQUAL( memcmp( pTestBuffer, pDecoded, lTestLength ), 0 );
+        free( pDecoded );
+    }
+
+    // Pull the encoded data from another input stream
+    PdfMemoryInputStream   input( pEncoded, lEncoded );
+    PdfFilteredInputStream stream( &input, filters );
+    char* pDecoded = static_cast<char*>(malloc( lTestLength + 1 ));
+
+    CPPUNIT_ASSERT_EQUAL( static_cast<long>(lTestLength), static_cast<long>(stream.Read( pDecoded, lTestLength + 1 )) );
+    CPPUNIT_ASSERT_EQUAL( memcmp( pTestBuffer, pDecoded, lTestLength ), 0 );
+    CPPUNIT_ASSERT_EQUAL( 0L, static_cast<long>(stream.Read( pDecoded, 1 )) );
+    free( pDecoded );
+    free( pEncoded );
+}
+
+void FilterTest::testStreamingDecode()
+{
+    const long lLength = 300000;
+    char*      pBuffer = CreateLargeBuffer( lLength );
+
+    TVecFilters filters;
+    TestStreamingFilter( filters, pBuffer, lLength );
+
+    filters.push_back( ePdfFilter_FlateDecode );
+    TestStreamingFilter( filters, pBuffer, lLength );
+    TestStreamingFilter( filters, s_pTestBuffer2, s_lTestLength2 );
+
+    filters.clear();
+    filters.push_back( ePdfFilter_ASCII85Decode );
+    filters.push_back( ePdfFilter_FlateDecode );
+    TestStreamingFilter( filters, pBuffer, lLength );
+
+    filters.clear();
+    filters.push_back( ePdfFilter_ASCIIHexDecode );
+    TestStreamingFilter( filters, pBuffer, lLength );
+    TestStreamingFilter( filters, s_pTestBuffer2, s_lTestLength2 );
+
+    free( pBuffer );
+}
+
+void FilterTest::testPartialDecode()
+{
+    const long lLength = 1000000;
+    char*      pBuffer = CreateLargeBuffer( lLength );
+
+    PdfMemDocument doc;
+    PdfObject*     pObject = doc.GetObjects().CreateObject();
+    pObject->GetStream()->Set( pBuffer, lLength );
+
+    char     szHead[100];
+    pdf_long lHead = pObject->GetStream()->GetFilteredCopy( szHead, sizeof(szHead) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<long>(sizeof(szHead)), static_cast<long>(lHead) );
+    CPPUNIT_ASSERT_EQUAL( memcmp( pBuffer, szHead, sizeof(szHead) ), 0 );
+
+    // Asking for more than there is returns the whole stream
+    char*    pDecoded = static_cast<char*>(malloc( lLength + 10 ));
+    pdf_long lDecoded = pObject->GetStream()->GetFilteredCopy( pDecoded, lLength + 10 );
+    CPPUNIT_ASSERT_EQUAL( lLength, static_cast<long>(lDecoded) );
+    CPPUNIT_ASSERT_EQUAL( memcmp( pBuffer, pDecoded, lLength ), 0 );
+
+    free( pDecoded );
+    free( pBuffer );
+}
+
+void FilterTest::testDecodeBenchmark()
+{
+    const long lLength     = 16 * 1024 * 1024;
+    const int  nIterations = 5;
+    char*      pBuffer     = CreateLargeBuffer( lLength );
+
+    TVecFilters filters;
+    filters.push_back( ePdfFilter_FlateDecode );
+
+    PdfMemoryOutputStream encoded;
+    std::auto_ptr<PdfOutputStream> pEncodeStream( PdfFilterFactory::CreateEncodeStream( filters, &encoded ) );
+    pEncodeStream->Write( pBuffer, lLength );
+    pEncodeStream->Close();
+
+    pdf_long lEncoded = encoded.GetLength();
+    char*    pEncoded = encoded.TakeBuffer();
+
+    std::auto_ptr<PdfFilter> pFilter = PdfFilterFactory::Create( ePdfFilter_FlateDecode );
+    clock_t start = clock();
+    for( int i=0;i<nIterations;i++ )
+    {
+        char*    pDecoded;
+        pdf_long lDecoded;
+        pFilter->Decode( pEncoded, lEncoded, &pDecoded, &lDecoded );
+        CPPUNIT_ASSERT_EQUAL( lLength, static_cast<long>(lDecoded) );
+        free( pDecoded );
+    }
+    double dWhole = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / nIterations;
+
+    // Decode into one preallocated buffer
+    char* pDecoded = static_cast<char*>(malloc( lLength ));
+    start = clock();
+    for( int i=0;i<nIterations;i++ )
+    {
+        PdfFilteredInputStream stream( pEncoded, lEncoded, filters );
+        CPPUNIT_ASSERT_EQUAL( lLength, static_cast<long>(stream.Read( pDecoded, lLength )) );
+    }
+    double dDirect = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / nIterations;
+    CPPUNIT_ASSERT_EQUAL( memcmp( pBuffer, pDecoded, lLength ), 0 );
+
+    // Decode through a small buffer
+    start = clock();
+    for( int i=0;i<nIterations;i++ )
+    {
+        PdfFilteredInputStream stream( pEncoded, lEncoded, filters );
+        while( stream.Read( pDecoded, 16384 ) > 0 )
+            ;
+    }
+    double dSmall = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / nIterations;
+
+    // Decode only the first kilobyte
+    start = clock();
+    for( int i=0;i<nIterations * 100;i++ )
+    {
+        PdfFilteredInputStream stream( pEncoded, lEncoded, filters );
+        stream.Read( pDecoded, 1024 );
+    }
+    double dPartial = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / (nIterations * 100);
+
+    printf("Decoding %li bytes of flate data:\n", lLength );
+    printf("\t-> PdfFilter::Decode:               %.4f s\n", dWhole );
+    printf("\t-> PdfFilteredInputStream direct:   %.4f s\n", dDirect );
+    printf("\t-> PdfFilteredInputStream 16k reads: %.4f s\n", dSmall );
+    printf("\t-> PdfFilteredInputStream first 1k: %.6f s\n", dPartial );
+
+    free( pDecoded );
+    free( pEncoded );
+    free( pBuffer );
+}
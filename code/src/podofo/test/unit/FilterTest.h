@@ -32,6 +32,10 @@ class FilterTest : public CppUnit::TestFixture
   CPPUNIT_TEST_SUITE( FilterTest );
   CPPUNIT_TEST( testFilters );
   CPPUNIT_TEST( testCCITT );
+  CPPUNIT_TEST( testRLEDecode );
+  CPPUNIT_TEST( testStreamingDecode );
+  CPPUNIT_TEST( testPartialDecode );
+  CPPUNIT_TEST( testDecodeBenchmark );
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -42,8 +46,29 @@ class FilterTest : public CppUnit::TestFixture
 
   void testCCITT();
 
+  void testRLEDecode();
+
+  /** Decode with a PdfFilteredInputStream in small reads
+   */
+  void testStreamingDecode();
+
+  /** Decode only the first bytes of a stream
+   */
+  void testPartialDecode();
+
+  /** Compare the time to decode a large stream at once
+   *  and through a PdfFilteredInputStream
+   */
+  void testDecodeBenchmark();
+
  private:
   void TestFilter( PoDoFo::EPdfFilter eFilter, const char * pTestBuffer, const long lTestLength );
+
+  void TestStreamingFilter( const PoDoFo::TVecFilters & filters, const char * pTestBuffer, const long lTestLength );
+
+  /** Create a large buffer of compressible content stream like data
+   */
+  char* CreateLargeBuffer( long lLength );
 };
 
 #endif // _FILTER_TEST_H_
@@ -130,6 +130,79 @@ void FontTest::testCreateFontFtFace()
     }
 }
 
+void FontTest::testFontFaceCache()
+{
+    std::string sPath = GetTrueTypeFontPath();
+    if( sPath.empty() )
+    {
+        printf("No TrueType font found, skipping font face cache test\n");
+        return;
+    }
+
+    PdfFontFaceCache::ResetStatistics();
+
+    // Two fonts from the same file in one document share a face,
+    // the whole file is embedded for each of them
+    {
+        PdfMemDocument doc;
+        PdfFont* pFont1 = doc.CreateFont( "Font1", false, false, PdfEncodingFactory::GlobalWinAnsiEncodingInstance(),
+                                          PdfFontCache::eFontCreationFlags_None, true, sPath.c_str() );
+        PdfFont* pFont2 = doc.CreateFont( "Font1", false, false, PdfEncodingFactory::GlobalMacRomanEncodingInstance(),
+                                          PdfFontCache::eFontCreationFlags_None, true, sPath.c_str() );
+        CPPUNIT_ASSERT( pFont1 != NULL );
+        CPPUNIT_ASSERT( pFont2 != NULL );
+        CPPUNIT_ASSERT( pFont1 != pFont2 );
+        CPPUNIT_ASSERT_EQUAL( pFont1->GetFontMetrics()->GetFontDataLen(), pFont2->GetFontMetrics()->GetFontDataLen() );
+
+        PdfFontFaceCache::TStatistics stats = PdfFontFaceCache::GetStatistics();
+        CPPUNIT_ASSERT( stats.nFacesShared >= 1 );
+        CPPUNIT_ASSERT_EQUAL( static_cast<pdf_uint64>(2 * pFont1->GetFontMetrics()->GetFontDataLen()), stats.nBytesEmbedded );
+    }
+
+    // The same subset in two documents is built only once
+    std::string sSubset[2];
+    for( int i=0;i<2;i++ )
+    {
+        PdfMemDocument doc;
+        PdfFont* pFont = doc.CreateFontSubset( "Font1", false, false, PdfEncodingFactory::GlobalWinAnsiEncodingInstance(),
+                                               sPath.c_str() );
+        CPPUNIT_ASSERT( pFont != NULL );
+        sSubset[i].assign( pFont->GetFontMetrics()->GetFontData(), pFont->GetFontMetrics()->GetFontDataLen() );
+    }
+
+    PdfFontFaceCache::TStatistics stats = PdfFontFaceCache::GetStatistics();
+    CPPUNIT_ASSERT( stats.nSubsetHits >= 1 );
+    CPPUNIT_ASSERT_EQUAL( static_cast<pdf_uint64>(2), stats.nSubsetBuilds + stats.nSubsetHits );
+    CPPUNIT_ASSERT( !sSubset[0].empty() );
+    CPPUNIT_ASSERT( sSubset[0] == sSubset[1] );
+}
+
+std::string FontTest::GetTrueTypeFontPath()
+{
+    std::string sPath;
+    FcPattern*   pattern   = FcPatternCreate();
+    FcObjectSet* objectSet = FcObjectSetBuild( FC_FILE, NULL );
+    FcFontSet*   fontSet   = FcFontList( NULL, pattern, objectSet );
+
+    FcObjectSetDestroy( objectSet );
+    FcPatternDestroy( pattern );
+
+    if( fontSet )
+    {
+        for( int i=0;i<fontSet->nfont && sPath.empty();i++ )
+        {
+            FcChar8* file = NULL;
+            if( FcPatternGetString( fontSet->fonts[i], FC_FILE, 0, &file ) == FcResultMatch &&
+                PdfFontFactory::GetFontType( reinterpret_cast<char*>(file) ) == ePdfFontType_TrueType )
+                sPath = reinterpret_cast<char*>(file);
+        }
+
+        FcFontSetDestroy( fontSet );
+    }
+
+    return sPath;
+}
+
 bool FontTest::GetFontInfo( FcPattern* pFont, std::string & rsFamily, std::string & rsPath, 
                             bool & rbBold, bool & rbItalic )
 {
@@ -37,6 +37,7 @@ class FontTest : public CppUnit::TestFixture
 #if defined(PODOFO_HAVE_FONTCONFIG)
   CPPUNIT_TEST( testFonts );
   CPPUNIT_TEST( testCreateFontFtFace );
+  CPPUNIT_TEST( testFontFaceCache );
 #endif
   CPPUNIT_TEST_SUITE_END();
 
@@ -47,6 +48,7 @@ class FontTest : public CppUnit::TestFixture
 #if defined(PODOFO_HAVE_FONTCONFIG)
   void testFonts();
   void testCreateFontFtFace();
+  void testFontFaceCache();
 #endif
 
 private:
@@ -55,6 +57,10 @@ private:
 
     bool GetFontInfo( FcPattern* pFont, std::string & rsFamily, std::string & rsPath, 
                       bool & rbBold, bool & rbItalic );
+
+    /** \returns the path of any installed TrueType font or an empty string
+     */
+    std::string GetTrueTypeFontPath();
 #endif
 
 private:
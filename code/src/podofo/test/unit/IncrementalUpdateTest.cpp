@@ -0,0 +1,175 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "IncrementalUpdateTest.h"
+#include "TestUtils.h"
+
+#include <podofo.h>
+
+#include <fstream>
+#include <iterator>
+#include <string.h>
+
+#define PODOFO_TEST_NUM_PAGES 3
+#define PODOFO_TEST_TITLE     "Incremental Update"
+
+using namespace PoDoFo;
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( IncrementalUpdateTest );
+
+void IncrementalUpdateTest::setUp()
+{
+}
+
+void IncrementalUpdateTest::tearDown()
+{
+}
+
+void IncrementalUpdateTest::testOriginalUntouched()
+{
+    PdfRefCountedBuffer original;
+    createDocument( original, false );
+
+    PdfMemDocument doc;
+    doc.Load( original.GetBuffer(), static_cast<long>(original.GetSize()) );
+    modifyDocument( doc );
+
+    PdfRefCountedBuffer update;
+    PdfOutputDevice     device( &update );
+    doc.WriteUpdate( &device );
+
+    checkUpdate( original, update.GetBuffer(), device.GetLength() );
+}
+
+void IncrementalUpdateTest::testXRefStream()
+{
+    PdfRefCountedBuffer original;
+    createDocument( original, true );
+
+    PdfMemDocument doc;
+    doc.Load( original.GetBuffer(), static_cast<long>(original.GetSize()) );
+    modifyDocument( doc );
+
+    PdfRefCountedBuffer update;
+    PdfOutputDevice     device( &update );
+    doc.WriteUpdate( &device );
+
+    // The update has to use a XRef stream, too
+    std::string sUpdate( update.GetBuffer() + original.GetSize(), device.GetLength() - original.GetSize() );
+    CPPUNIT_ASSERT( sUpdate.find( "/XRef" ) != std::string::npos );
+    CPPUNIT_ASSERT( sUpdate.find( "trailer" ) == std::string::npos );
+
+    checkUpdate( original, update.GetBuffer(), device.GetLength() );
+}
+
+void IncrementalUpdateTest::testInPlace()
+{
+    PdfRefCountedBuffer original;
+    createDocument( original, false );
+
+    std::string sFilename = TestUtils::getTempFilename();
+    {
+        std::ofstream file( sFilename.c_str(), std::ios_base::binary );
+        file.write( original.GetBuffer(), original.GetSize() );
+    }
+
+    {
+        PdfMemDocument doc( sFilename.c_str() );
+        modifyDocument( doc );
+        doc.WriteUpdate( sFilename.c_str() );
+    }
+
+    std::ifstream file( sFilename.c_str(), std::ios_base::binary );
+    std::string   sUpdate( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+    file.close();
+    TestUtils::deleteFile( sFilename.c_str() );
+
+    checkUpdate( original, sUpdate.c_str(), sUpdate.length() );
+}
+
+void IncrementalUpdateTest::testRemoveObject()
+{
+    PdfRefCountedBuffer original;
+    createDocument( original, false );
+
+    PdfMemDocument doc;
+    doc.Load( original.GetBuffer(), static_cast<long>(original.GetSize()) );
+
+    // The third page is removed from the pages tree and from the file
+    PdfReference ref = doc.GetPage( PODOFO_TEST_NUM_PAGES - 1 )->GetObject()->Reference();
+    doc.GetPagesTree()->DeletePage( PODOFO_TEST_NUM_PAGES - 1 );
+    delete doc.GetObjects().RemoveObject( ref );
+
+    PdfRefCountedBuffer update;
+    PdfOutputDevice     device( &update );
+    doc.WriteUpdate( &device );
+
+    CPPUNIT_ASSERT_EQUAL( 0, memcmp( original.GetBuffer(), update.GetBuffer(), original.GetSize() ) );
+
+    PdfMemDocument parsed;
+    parsed.Load( update.GetBuffer(), static_cast<long>(device.GetLength()) );
+    CPPUNIT_ASSERT_EQUAL( PODOFO_TEST_NUM_PAGES - 1, parsed.GetPageCount() );
+    CPPUNIT_ASSERT( parsed.GetObjects().GetObject( ref ) == NULL );
+}
+
+void IncrementalUpdateTest::createDocument( PdfRefCountedBuffer & rBuffer, bool bXRefStream )
+{
+    PdfMemDocument doc;
+
+    for( int i = 0; i < PODOFO_TEST_NUM_PAGES; i++ )
+        doc.CreatePage( PdfPage::CreateStandardPageSize( ePdfPageSize_A4 ) );
+
+    PdfWriter writer( &(doc.GetObjects()), doc.GetTrailer() );
+    writer.SetUseXRefStream( bXRefStream );
+
+    PdfOutputDevice device( &rBuffer );
+    writer.Write( &device );
+
+    rBuffer.Resize( device.GetLength() );
+}
+
+void IncrementalUpdateTest::modifyDocument( PdfMemDocument & rDoc )
+{
+    PdfAnnotation* pAnnot = rDoc.GetPage( 0 )->CreateAnnotation( ePdfAnnotation_Text, PdfRect( 100.0, 100.0, 50.0, 50.0 ) );
+    pAnnot->SetContents( PdfString( "Note" ) );
+
+    rDoc.GetInfo()->SetTitle( PdfString( PODOFO_TEST_TITLE ) );
+}
+
+void IncrementalUpdateTest::checkUpdate( const PdfRefCountedBuffer & rOriginal, const char* pszUpdate, size_t lLen )
+{
+    // The original file has to be the unmodified prefix of the update
+    CPPUNIT_ASSERT( lLen > rOriginal.GetSize() );
+    CPPUNIT_ASSERT_EQUAL( 0, memcmp( rOriginal.GetBuffer(), pszUpdate, rOriginal.GetSize() ) );
+
+    PdfVecObjects objects;
+    PdfParser     parser( &objects );
+    parser.ParseFile( pszUpdate, static_cast<long>(lLen), false );
+    CPPUNIT_ASSERT_EQUAL( 1, parser.GetNumberOfIncrementalUpdates() );
+
+    PdfMemDocument doc;
+    doc.Load( pszUpdate, static_cast<long>(lLen) );
+    CPPUNIT_ASSERT_EQUAL( PODOFO_TEST_NUM_PAGES, doc.GetPageCount() );
+    CPPUNIT_ASSERT_EQUAL( 1, doc.GetPage( 0 )->GetNumAnnots() );
+    CPPUNIT_ASSERT_EQUAL( 0, doc.GetPage( 1 )->GetNumAnnots() );
+    CPPUNIT_ASSERT( doc.GetPage( 0 )->GetAnnotation( 0 )->GetContents() == PdfString( "Note" ) );
+    CPPUNIT_ASSERT( doc.GetInfo()->GetTitle() == PdfString( PODOFO_TEST_TITLE ) );
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _INCREMENTAL_UPDATE_TEST_H_
+#define _INCREMENTAL_UPDATE_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace PoDoFo {
+class PdfMemDocument;
+class PdfRefCountedBuffer;
+};
+
+/** This test tests PdfMemDocument::WriteUpdate
+ */
+class IncrementalUpdateTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( IncrementalUpdateTest );
+  CPPUNIT_TEST( testOriginalUntouched );
+  CPPUNIT_TEST( testXRefStream );
+  CPPUNIT_TEST( testInPlace );
+  CPPUNIT_TEST( testRemoveObject );
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testOriginalUntouched();
+  void testXRefStream();
+  void testInPlace();
+  void testRemoveObject();
+
+ private:
+  /**
+   * Write a document with a few pages to rBuffer.
+   *
+   * \param rBuffer the document is written to this buffer
+   * \param bXRefStream if true a XRef stream is written instead of a XRef table
+   */
+  void createDocument( PoDoFo::PdfRefCountedBuffer & rBuffer, bool bXRefStream );
+
+  /**
+   * Add an annotation to the first page of rDoc
+   * and change the title of the document.
+   */
+  void modifyDocument( PoDoFo::PdfMemDocument & rDoc );
+
+  /**
+   * Check that pszUpdate starts with the bytes of rOriginal,
+   * and that the parsed update contains the changes of modifyDocument.
+   */
+  void checkUpdate( const PoDoFo::PdfRefCountedBuffer & rOriginal, const char* pszUpdate, size_t lLen );
+};
+
+#endif // _INCREMENTAL_UPDATE_TEST_H_
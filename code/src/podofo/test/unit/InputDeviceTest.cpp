@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "InputDeviceTest.h"
+#include "TestUtils.h"
+
+#include <podofo.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace PoDoFo;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( InputDeviceTest );
+
+/** Size of the window PdfInputDevice maps at once
+ */
+static const long s_lMapSize = 1048576;
+
+void InputDeviceTest::setUp()
+{
+    m_sFilename = TestUtils::getTempFilename();
+}
+
+void InputDeviceTest::tearDown()
+{
+    TestUtils::deleteFile( m_sFilename.c_str() );
+}
+
+void InputDeviceTest::testReadToEof()
+{
+    const long sizes[] = { 1, 123520, s_lMapSize - 1, s_lMapSize, s_lMapSize + 12345 };
+
+    for( unsigned int i=0;i<sizeof(sizes)/sizeof(long);i++ )
+    {
+        createFile( sizes[i] );
+
+        PdfInputDevice device( m_sFilename.c_str() );
+        long lCount = 0;
+        int  c;
+        while( (c = device.GetChar()) != EOF )
+        {
+            CPPUNIT_ASSERT_EQUAL( GetPatternByte( lCount ), static_cast<char>(c) );
+            ++lCount;
+            CPPUNIT_ASSERT( lCount <= sizes[i] );
+        }
+
+        CPPUNIT_ASSERT_EQUAL( sizes[i], lCount );
+        CPPUNIT_ASSERT( device.Eof() );
+        CPPUNIT_ASSERT_EQUAL( EOF, device.Look() );
+        CPPUNIT_ASSERT_EQUAL( EOF, device.GetChar() );
+        CPPUNIT_ASSERT_EQUAL( static_cast<std::streamoff>(sizes[i]), device.Tell() );
+    }
+}
+
+void InputDeviceTest::testReadAcrossWindows()
+{
+    const long lSize = 2 * s_lMapSize + 777;
+    createFile( lSize );
+
+    PdfInputDevice    device( m_sFilename.c_str() );
+    std::vector<char> buffer( 100000 );
+    long              lTotal = 0;
+    std::streamoff    lRead;
+    while( (lRead = device.Read( &buffer[0], buffer.size() )) > 0 )
+    {
+        for( std::streamoff i=0;i<lRead;i++ )
+            CPPUNIT_ASSERT_EQUAL( GetPatternByte( lTotal + static_cast<long>(i) ), buffer[i] );
+
+        lTotal += static_cast<long>(lRead);
+        CPPUNIT_ASSERT( lTotal <= lSize );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( lSize, lTotal );
+    CPPUNIT_ASSERT( device.Eof() );
+    CPPUNIT_ASSERT_EQUAL( static_cast<std::streamoff>(lSize), device.Tell() );
+}
+
+void InputDeviceTest::testSeekEnd()
+{
+    const long lSize = 123520;
+    createFile( lSize );
+
+    PdfInputDevice device( m_sFilename.c_str() );
+    char           buffer[100];
+
+    device.Seek( -5, std::ios_base::end );
+    CPPUNIT_ASSERT_EQUAL( static_cast<std::streamoff>(lSize - 5), device.Tell() );
+    CPPUNIT_ASSERT_EQUAL( static_cast<std::streamoff>(5), device.Read( buffer, sizeof(buffer) ) );
+    CPPUNIT_ASSERT_EQUAL( GetPatternByte( lSize - 1 ), buffer[4] );
+    CPPUNIT_ASSERT_EQUAL( static_cast<std::streamoff>(lSize), device.Tell() );
+    CPPUNIT_ASSERT_EQUAL( EOF, device.Look() );
+
+    // Seeking back clears the end of file
+    device.Seek( 0, std::ios_base::beg );
+    CPPUNIT_ASSERT( !device.Eof() );
+    CPPUNIT_ASSERT_EQUAL( static_cast<int>(static_cast<unsigned char>(GetPatternByte( 0 ))), device.Look() );
+
+    device.Seek( 10, std::ios_base::end );
+    CPPUNIT_ASSERT_EQUAL( static_cast<std::streamoff>(0), device.Read( buffer, sizeof(buffer) ) );
+    CPPUNIT_ASSERT_EQUAL( EOF, device.GetChar() );
+}
+
+void InputDeviceTest::createFile( long lSize )
+{
+    FILE* hFile = fopen( m_sFilename.c_str(), "wb" );
+    CPPUNIT_ASSERT( hFile != NULL );
+
+    for( long i=0;i<lSize;i++ )
+        fputc( GetPatternByte( i ), hFile );
+
+    fclose( hFile );
+}
+
+char InputDeviceTest::GetPatternByte( long lPos )
+{
+    // 251 is prime, so the pattern does not repeat at window boundaries
+    return static_cast<char>(lPos % 251);
+}
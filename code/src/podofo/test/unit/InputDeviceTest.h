@@ -0,0 +1,65 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _INPUT_DEVICE_TEST_H_
+#define _INPUT_DEVICE_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+/** This test tests the class PdfInputDevice
+ *  reading from memory mapped files.
+ */
+class InputDeviceTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( InputDeviceTest );
+  CPPUNIT_TEST( testReadToEof );
+  CPPUNIT_TEST( testReadAcrossWindows );
+  CPPUNIT_TEST( testSeekEnd );
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  /** Read files, whose size is not a multiple of the
+   *  mapped window size, with GetChar() until EOF
+   */
+  void testReadToEof();
+
+  /** Read a file larger than one window with Read()
+   */
+  void testReadAcrossWindows();
+
+  void testSeekEnd();
+
+ private:
+  /** Create m_sFilename with lSize bytes of a known pattern
+   */
+  void createFile( long lSize );
+
+  static char GetPatternByte( long lPos );
+
+ private:
+  std::string m_sFilename;
+};
+
+#endif // _INPUT_DEVICE_TEST_H_
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "LinearizationTest.h"
+#include "TestUtils.h"
+
+#include <podofo.h>
+
+#include <stdlib.h>
+
+#define PODOFO_TEST_NUM_PAGES 4
+#define PODOFO_TEST_PASSWORD  "user"
+
+using namespace PoDoFo;
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( LinearizationTest );
+
+void LinearizationTest::setUp()
+{
+}
+
+void LinearizationTest::tearDown()
+{
+}
+
+void LinearizationTest::testLinearized()
+{
+    PdfMemDocument doc;
+    createDocument( doc );
+
+    std::string sData;
+    writeLinearized( doc, sData );
+
+    checkLinearized( sData, NULL );
+}
+
+void LinearizationTest::testEncrypted()
+{
+    PdfMemDocument doc;
+    createDocument( doc );
+    // The hint stream is encrypted, too
+    doc.SetEncrypted( PODOFO_TEST_PASSWORD, "owner", PdfEncrypt::ePdfPermissions_Print, 
+                      PdfEncrypt::ePdfEncryptAlgorithm_RC4V2, PdfEncrypt::ePdfKeyLength_128 );
+
+    std::string sData;
+    writeLinearized( doc, sData );
+
+    checkLinearized( sData, PODOFO_TEST_PASSWORD );
+}
+
+void LinearizationTest::testReferencesRestored()
+{
+    PdfMemDocument doc;
+    createDocument( doc );
+
+    std::vector<PdfReference> vecBefore;
+    TCIVecObjects it = doc.GetObjects().begin();
+    while( it != doc.GetObjects().end() )
+        vecBefore.push_back( (*it++)->Reference() );
+
+    std::string sFirst;
+    writeLinearized( doc, sFirst );
+
+    // The objects are only renumbered while writing
+    std::vector<PdfReference> vecAfter;
+    it = doc.GetObjects().begin();
+    while( it != doc.GetObjects().end() )
+        vecAfter.push_back( (*it++)->Reference() );
+
+    CPPUNIT_ASSERT( vecBefore == vecAfter );
+
+    std::string sSecond;
+    writeLinearized( doc, sSecond );
+    CPPUNIT_ASSERT( sFirst == sSecond );
+
+    doc.SetWriteLinearized( false );
+    PdfRefCountedBuffer buffer;
+    PdfOutputDevice     device( &buffer );
+    doc.Write( &device );
+
+    // The document can still be written normally
+    CPPUNIT_ASSERT( std::string( buffer.GetBuffer(), device.GetLength() ).find( "/Linearized" ) == std::string::npos );
+
+    PdfMemDocument parsed;
+    parsed.Load( buffer.GetBuffer(), static_cast<long>(device.GetLength()) );
+    CPPUNIT_ASSERT_EQUAL( PODOFO_TEST_NUM_PAGES, parsed.GetPageCount() );
+}
+
+void LinearizationTest::createDocument( PdfMemDocument & rDoc )
+{
+    PdfXObject xObject( PdfRect( 0.0, 0.0, 100.0, 100.0 ), &rDoc );
+    PdfPainter painter;
+
+    painter.SetPage( &xObject );
+    painter.DrawRect( 10.0, 10.0, 80.0, 80.0 );
+    painter.Stroke();
+    painter.FinishPage();
+
+    for( int i = 0; i < PODOFO_TEST_NUM_PAGES; i++ )
+    {
+        painter.SetPage( rDoc.CreatePage( PdfPage::CreateStandardPageSize( ePdfPageSize_A4 ) ) );
+        // The first page and all odd pages share the XObject
+        if( !i || i % 2 )
+            painter.DrawXObject( 100.0, 100.0, &xObject );
+        painter.DrawRect( 200.0, 200.0, 50.0 + i, 50.0 );
+        painter.Fill();
+        painter.FinishPage();
+    }
+}
+
+void LinearizationTest::writeLinearized( PdfMemDocument & rDoc, std::string & rsData )
+{
+    PdfRefCountedBuffer buffer;
+    PdfOutputDevice     device( &buffer );
+
+    rDoc.SetUseObjectStreams( false );
+    rDoc.SetWriteLinearized( true );
+    rDoc.Write( &device );
+
+    rsData.assign( buffer.GetBuffer(), device.GetLength() );
+}
+
+void LinearizationTest::checkLinearized( const std::string & rsData, const char* pszPassword )
+{
+    PdfMemDocument doc;
+    try {
+        doc.Load( rsData.c_str(), static_cast<long>(rsData.length()) );
+    } catch( PdfError & e ) {
+        if( e.GetError() != ePdfError_InvalidPassword || !pszPassword )
+            throw e;
+
+        doc.SetPassword( pszPassword );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( PODOFO_TEST_NUM_PAGES, doc.GetPageCount() );
+
+    // The linearization dictionary is the first object after the header
+    size_t lObj = rsData.find( " 0 obj" );
+    CPPUNIT_ASSERT( lObj != std::string::npos && lObj < 1024 );
+    size_t lStart = rsData.rfind( '\n', lObj ) + 1;
+    pdf_objnum nObj = static_cast<pdf_objnum>(atoi( rsData.substr( lStart, lObj - lStart ).c_str() ));
+
+    const PdfObject* pLinearized = doc.GetObjects().GetObject( PdfReference( nObj, 0 ) );
+    CPPUNIT_ASSERT( pLinearized && pLinearized->GetDictionary().HasKey( "Linearized" ) );
+
+    const PdfDictionary & rDict = pLinearized->GetDictionary();
+    CPPUNIT_ASSERT_EQUAL( static_cast<pdf_int64>(rsData.length()), rDict.GetKeyAsLong( "L" ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<pdf_int64>(PODOFO_TEST_NUM_PAGES), rDict.GetKeyAsLong( "N" ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<pdf_int64>(doc.GetPage( 0 )->GetObject()->Reference().ObjectNumber()), 
+                          rDict.GetKeyAsLong( "O" ) );
+
+    // The hint stream is followed by the first page
+    const PdfArray & rHint = rDict.GetKey( "H" )->GetArray();
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(2), static_cast<size_t>(rHint.GetSize()) );
+    const size_t lHint = static_cast<size_t>(rHint[0].GetNumber());
+    const size_t lPage = lHint + static_cast<size_t>(rHint[1].GetNumber());
+    const PdfObject* pHint = doc.GetObjects().GetObject( PdfReference( atoi( rsData.c_str() + lHint ), 0 ) );
+    CPPUNIT_ASSERT( pHint && pHint->HasStream() && pHint->GetDictionary().HasKey( "S" ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<int>(doc.GetPage( 0 )->GetObject()->Reference().ObjectNumber()), 
+                          atoi( rsData.c_str() + lPage ) );
+
+    // The main XRef section starts at T
+    const size_t lEntry = static_cast<size_t>(rDict.GetKeyAsLong( "T" ));
+    CPPUNIT_ASSERT( rsData.compare( lEntry + 1, 20, "0000000000 65535 f \n" ) == 0 );
+}
@@ -1,5 +1,5 @@
 /***************************************************************************
- *   Copyright (C) 2006 by Dominik Seichter                                *
+ *   Copyright (C) 2011 by Dominik Seichter                                *
  *   domseichter@web.de                                                    *
  *                                                                         *
  *   This program is free software; you can redistribute it and/or modify  *
@@ -18,52 +18,53 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-#ifndef _PDF_HINT_STREAM_H_
-#define _PDF_HINT_STREAM_H_
+#ifndef _LINEARIZATION_TEST_H_
+#define _LINEARIZATION_TEST_H_
 
-#include "podofo/base/PdfDefines.h"
-#include "podofo/base/PdfWriter.h"
-#include "PdfElement.h"
+#include <cppunit/extensions/HelperMacros.h>
 
-namespace PoDoFo {
-
-class PdfPagesTree;
+#include <string>
 
-namespace NonPublic {
+namespace PoDoFo {
+class PdfMemDocument;
+};
 
-// PdfHintStream is not part of the public API and is NOT exported as part of
-// the DLL/shared library interface. Do not rely on it.
+/** This test tests writing linearized PDF files with PdfWriter::SetLinearized
+ */
+class LinearizationTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( LinearizationTest );
+  CPPUNIT_TEST( testLinearized );
+  CPPUNIT_TEST( testEncrypted );
+  CPPUNIT_TEST( testReferencesRestored );
+  CPPUNIT_TEST_SUITE_END();
 
-class PdfHintStream : public PdfElement {
  public:
-    PdfHintStream( PdfVecObjects* pParent, PdfPagesTree* pPagesTree );
-    ~PdfHintStream();
-
-    /** Create the hint stream 
-     *  \param pXRef pointer to a valid XREF table structure
-     */
-    //void Create( TVecXRefTable* pXRef );
+  void setUp();
+  void tearDown();
 
-    /** Write a pdf_uint16 to the stream in big endian format.
-     *  \param val the value to write to the stream
-     */
-    void WriteUInt16( pdf_uint16 val );
+  void testLinearized();
+  void testEncrypted();
+  void testReferencesRestored();
 
-    /** Write a pdf_uint32 to the stream in big endian format.
-     *  \param val the value to write to the stream
-     */
-    void WriteUInt32( pdf_uint32 );
-
- private:
-    //void CreatePageHintTable( TVecXRefTable* pXRef );
-    void CreateSharedObjectHintTable();
- 
  private:
-    PdfPagesTree* m_pPagesTree;
-};
+  /**
+   * Add a few pages to rDoc, which share a form XObject.
+   */
+  void createDocument( PoDoFo::PdfMemDocument & rDoc );
 
-}; // end namespace NonPublic
+  /**
+   * Write rDoc linearized to rsData.
+   */
+  void writeLinearized( PoDoFo::PdfMemDocument & rDoc, std::string & rsData );
 
-}; // end namespace PoDoFo
+  /**
+   * Check the linearization dictionary and the page count of a written file.
+   *
+   * \param rsData a linearized PDF file
+   * \param pszPassword the user password if the file is encrypted or NULL
+   */
+  void checkLinearized( const std::string & rsData, const char* pszPassword );
+};
 
-#endif /* _PDF_HINT_STREAM_H_ */
+#endif // _LINEARIZATION_TEST_H_
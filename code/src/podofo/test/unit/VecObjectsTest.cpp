@@ -0,0 +1,271 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "VecObjectsTest.h"
+
+#include <podofo.h>
+
+#include <time.h>
+
+using namespace PoDoFo;
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION( VecObjectsTest );
+
+void VecObjectsTest::setUp()
+{
+}
+
+void VecObjectsTest::tearDown()
+{
+}
+
+void VecObjectsTest::testGetObject()
+{
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    PdfObject* pObj1 = vecObjects.CreateObject();
+    PdfObject* pObj2 = vecObjects.CreateObject( "Page" );
+    PdfObject* pObj3 = vecObjects.CreateObject( PdfVariant( static_cast<pdf_int64>(42) ) );
+
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(3), vecObjects.GetSize() );
+    CPPUNIT_ASSERT( pObj1 == vecObjects.GetObject( PdfReference( 1, 0 ) ) );
+    CPPUNIT_ASSERT( pObj2 == vecObjects.GetObject( PdfReference( 2, 0 ) ) );
+    CPPUNIT_ASSERT( pObj3 == vecObjects.GetObject( PdfReference( 3, 0 ) ) );
+
+    // the generation number has to match, too
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 2, 1 ) ) );
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 0, 0 ) ) );
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 4, 0 ) ) );
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 100000, 0 ) ) );
+}
+
+void VecObjectsTest::testUnsortedInsert()
+{
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    const pdf_objnum nNumbers[] = { 10, 3, 7, 1, 12, 5 };
+    const int        nCount     = sizeof(nNumbers) / sizeof(pdf_objnum);
+    for( int i=0;i<nCount;i++ )
+        vecObjects.push_back( new PdfObject( PdfReference( nNumbers[i], 0 ), PdfVariant( static_cast<pdf_int64>(nNumbers[i]) ) ) );
+
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(13), vecObjects.GetObjectCount() );
+
+    for( int i=0;i<nCount;i++ )
+    {
+        PdfObject* pObj = vecObjects.GetObject( PdfReference( nNumbers[i], 0 ) );
+        CPPUNIT_ASSERT( pObj != NULL );
+        CPPUNIT_ASSERT_EQUAL( static_cast<pdf_int64>(nNumbers[i]), pObj->GetNumber() );
+    }
+
+    // inserting into a sorted vector keeps it sorted
+    vecObjects.Sort();
+    vecObjects.insert_sorted( new PdfObject( PdfReference( 4, 0 ), PdfVariant( static_cast<pdf_int64>(4) ) ) );
+    CPPUNIT_ASSERT( vecObjects.GetObject( PdfReference( 4, 0 ) ) != NULL );
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(3), vecObjects.GetIndex( PdfReference( 5, 0 ) ) );
+
+    pdf_objnum nLast = 0;
+    TCIVecObjects it = vecObjects.begin();
+    while( it != vecObjects.end() )
+    {
+        CPPUNIT_ASSERT( (*it)->Reference().ObjectNumber() > nLast );
+        nLast = (*it)->Reference().ObjectNumber();
+        ++it;
+    }
+}
+
+void VecObjectsTest::testRemoveObject()
+{
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    for( int i=0;i<10;i++ )
+        vecObjects.CreateObject();
+
+    PdfObject* pObj = vecObjects.RemoveObject( PdfReference( 4, 0 ) );
+    CPPUNIT_ASSERT( pObj != NULL );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 4, 0 ), pObj->Reference() );
+    delete pObj;
+
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 4, 0 ) ) );
+    CPPUNIT_ASSERT( NULL == vecObjects.RemoveObject( PdfReference( 4, 0 ) ) );
+    CPPUNIT_ASSERT( NULL == vecObjects.RemoveObject( PdfReference( 5, 1 ) ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(9), vecObjects.GetSize() );
+    CPPUNIT_ASSERT( vecObjects.GetObject( PdfReference( 5, 0 ) ) != NULL );
+
+    // remove using an iterator
+    pObj = vecObjects.RemoveObject( vecObjects.begin() );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 1, 0 ), pObj->Reference() );
+    delete pObj;
+
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 1, 0 ) ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(8), vecObjects.GetSize() );
+}
+
+void VecObjectsTest::testSharedObjectNumber()
+{
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    PdfObject* pObj0 = new PdfObject( PdfReference( 5, 0 ), PdfVariant( static_cast<pdf_int64>(0) ) );
+    PdfObject* pObj1 = new PdfObject( PdfReference( 5, 1 ), PdfVariant( static_cast<pdf_int64>(1) ) );
+    vecObjects.push_back( pObj1 );
+    vecObjects.push_back( pObj0 );
+
+    CPPUNIT_ASSERT( pObj0 == vecObjects.GetObject( PdfReference( 5, 0 ) ) );
+    CPPUNIT_ASSERT( pObj1 == vecObjects.GetObject( PdfReference( 5, 1 ) ) );
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 5, 2 ) ) );
+
+    delete vecObjects.RemoveObject( PdfReference( 5, 1 ), false );
+    CPPUNIT_ASSERT( NULL == vecObjects.GetObject( PdfReference( 5, 1 ) ) );
+    CPPUNIT_ASSERT( pObj0 == vecObjects.GetObject( PdfReference( 5, 0 ) ) );
+
+    // numbers beyond the limit of the PDF specification are still found
+    PdfObject* pLarge = new PdfObject( PdfReference( 100000000, 0 ), PdfVariant( static_cast<pdf_int64>(2) ) );
+    vecObjects.push_back( pLarge );
+    CPPUNIT_ASSERT( pLarge == vecObjects.GetObject( PdfReference( 100000000, 0 ) ) );
+}
+
+void VecObjectsTest::testFreeObjects()
+{
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    for( int i=0;i<10;i++ )
+        vecObjects.CreateObject();
+
+    delete vecObjects.RemoveObject( PdfReference( 7, 0 ) );
+    delete vecObjects.RemoveObject( PdfReference( 2, 0 ) );
+    vecObjects.AddFreeObject( PdfReference( 20, 0 ) );
+    vecObjects.AddFreeObject( PdfReference( 2, 0 ) );
+
+    // the free list is sorted and contains no duplicates
+    const TPdfReferenceList & lstFree = vecObjects.GetFreeObjects();
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(3), lstFree.size() );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 2, 0 ), lstFree[0] );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 7, 0 ), lstFree[1] );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 20, 0 ), lstFree[2] );
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(21), vecObjects.GetObjectCount() );
+
+    // free numbers are reused first
+    PdfObject* pObj = vecObjects.CreateObject();
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 2, 0 ), pObj->Reference() );
+    CPPUNIT_ASSERT( pObj == vecObjects.GetObject( PdfReference( 2, 0 ) ) );
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(2), lstFree.size() );
+}
+
+void VecObjectsTest::testObjectDependencies()
+{
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    // 1 -> 2 -> 3 -> 1 is a cycle, 2 also refers to the missing object 9
+    PdfObject* pObj1 = vecObjects.CreateObject();
+    PdfObject* pObj2 = vecObjects.CreateObject();
+    PdfObject* pObj3 = vecObjects.CreateObject();
+    PdfObject* pObj4 = vecObjects.CreateObject();
+
+    PdfArray array;
+    array.push_back( pObj3->Reference() );
+    array.push_back( PdfReference( 9, 0 ) );
+
+    pObj1->GetDictionary().AddKey( "Next", pObj2->Reference() );
+    pObj2->GetDictionary().AddKey( "Kids", array );
+    pObj3->GetDictionary().AddKey( "Next", pObj1->Reference() );
+    pObj4->GetDictionary().AddKey( "Next", pObj1->Reference() );
+
+    TPdfReferenceList lstDependencies;
+    vecObjects.GetObjectDependencies( pObj1, &lstDependencies );
+
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(4), lstDependencies.size() );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 1, 0 ), lstDependencies[0] );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 2, 0 ), lstDependencies[1] );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 3, 0 ), lstDependencies[2] );
+    CPPUNIT_ASSERT_EQUAL( PdfReference( 9, 0 ), lstDependencies[3] );
+
+    // references already in the list are kept, but not followed
+    lstDependencies.clear();
+    lstDependencies.push_back( pObj1->Reference() );
+    vecObjects.GetObjectDependencies( pObj4, &lstDependencies );
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(1), lstDependencies.size() );
+}
+
+void VecObjectsTest::testEditBenchmark()
+{
+    const int nObjects = 200000;
+    const int nEdits   = 2000;
+    const int nLookups = 50;
+
+    PdfVecObjects vecObjects;
+    vecObjects.SetAutoDelete( true );
+
+    // Objects of a parsed document are added in ascending order,
+    // each one refers to the next one
+    clock_t start = clock();
+    vecObjects.Reserve( nObjects );
+    for( int i=1;i<=nObjects;i++ )
+    {
+        PdfObject* pObj = new PdfObject( PdfReference( i, 0 ), PdfDictionary() );
+        if( i < nObjects )
+            pObj->GetDictionary().AddKey( "Next", PdfReference( i + 1, 0 ) );
+        vecObjects.push_back( pObj );
+    }
+    double dLoad = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    // Follow the chain of all objects
+    start = clock();
+    TPdfReferenceList lstDependencies;
+    vecObjects.GetObjectDependencies( vecObjects.GetObject( PdfReference( 1, 0 ) ), &lstDependencies );
+    double dDependencies = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(nObjects - 1), lstDependencies.size() );
+
+    // Free some objects, so that new objects reuse their numbers
+    start = clock();
+    for( int i=0;i<nEdits;i++ )
+        delete vecObjects.RemoveObject( PdfReference( 1 + (i * 97) % nObjects, 0 ) );
+    double dRemove = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    // Each edit creates an object, e.g. an annotation, and looks up a few others
+    start = clock();
+    unsigned int nSeed = 1;
+    for( int i=0;i<nEdits;i++ )
+    {
+        PdfObject* pObj = vecObjects.CreateObject( "Annot" );
+        CPPUNIT_ASSERT( pObj == vecObjects.GetObject( pObj->Reference() ) );
+
+        for( int j=0;j<nLookups;j++ )
+        {
+            nSeed = nSeed * 1103515245 + 12345;
+            vecObjects.GetObject( PdfReference( 1 + nSeed % nObjects, 0 ) );
+        }
+    }
+    double dEdit = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    CPPUNIT_ASSERT_EQUAL( static_cast<size_t>(nObjects), vecObjects.GetSize() );
+
+    printf("Editing %i objects:\n", nObjects );
+    printf("\t-> Loading:                      %.4f s\n", dLoad );
+    printf("\t-> Removing %i objects:        %.4f s\n", nEdits, dRemove );
+    printf("\t-> %i edits with %i lookups:   %.4f s\n", nEdits, nLookups, dEdit );
+    printf("\t-> GetObjectDependencies:        %.4f s\n", dDependencies );
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Dominik Seichter                                *
+ *   domseichter@web.de                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _VEC_OBJECTS_TEST_H_
+#define _VEC_OBJECTS_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/** This test tests the class PdfVecObjects
+ */
+class VecObjectsTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( VecObjectsTest );
+  CPPUNIT_TEST( testGetObject );
+  CPPUNIT_TEST( testUnsortedInsert );
+  CPPUNIT_TEST( testRemoveObject );
+  CPPUNIT_TEST( testSharedObjectNumber );
+  CPPUNIT_TEST( testFreeObjects );
+  CPPUNIT_TEST( testObjectDependencies );
+  CPPUNIT_TEST( testEditBenchmark );
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testGetObject();
+  void testUnsortedInsert();
+  void testRemoveObject();
+  void testSharedObjectNumber();
+  void testFreeObjects();
+  void testObjectDependencies();
+
+  /** Time lookups while objects are created and removed,
+   *  like it happens when a large document is edited.
+   */
+  void testEditBenchmark();
+};
+
+#endif // _VEC_OBJECTS_TEST_H_
+
+
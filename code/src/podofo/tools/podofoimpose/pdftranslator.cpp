@@ -32,6 +32,7 @@
 #include <istream>
 #include <ostream>
 #include <cstdlib>
+#include <cstring>
 using std::ostringstream;
 using std::map;
 using std::vector;
@@ -51,6 +52,16 @@ namespace PoDoFo
 #define MAX_SOURCE_PAGES 5000
 #define MAX_RECORD_SIZE 2048
 
+		/// FNV-1a, good enough to find candidates for identical streams
+		static pdf_uint64 hashBuffer ( const char * buffer, pdf_long len, pdf_uint64 hash )
+		{
+			for ( pdf_long i = 0; i < len; ++i )
+			{
+				hash ^= static_cast<unsigned char> ( buffer[i] );
+				hash *= 1099511628211ULL;
+			}
+			return hash;
+		}
 
 
 		bool PdfTranslator::checkIsPDF ( std::string path )
@@ -76,6 +87,8 @@ namespace PoDoFo
 			std::cerr<<"PdfTranslator::PdfTranslator"<<std::endl;
 			sourceDoc = 0;
 			targetDoc = 0;
+			duplicateStreams = 0;
+			threads = 0;
 			extraSpace = 0;
 			scaleFactor = 1.0;
 		}
@@ -179,6 +192,13 @@ namespace PoDoFo
 				if ( obj->HasStream() )
 				{
 					* ( ret->GetStream() ) = * ( obj->GetStream() );
+
+					PdfObject *dup ( findDuplicateStream ( ret ) );
+					if ( dup )
+					{
+						delete targetDoc->GetObjects().RemoveObject ( ret->Reference() );
+						ret = dup;
+					}
 				}
 			}
 			else if ( obj->IsArray() )
@@ -199,10 +219,15 @@ namespace PoDoFo
 					return migrateMap[obj->GetReference().ToString() ];
 				}
 
-				PdfObject * o ( migrateResource ( sourceDoc->GetObjects().GetObject ( obj->GetReference() ) ) );
+				PdfObject * source ( sourceDoc->GetObjects().GetObject ( obj->GetReference() ) );
+				PdfObject * o ( migrateResource ( source ) );
 
                                 ret  = new PdfObject ( o->Reference() ) ;
 
+				// The copy is complete, the source can be loaded again if needed
+				if ( source->HasStream() )
+					freeSourceObject ( source );
+
 			}
 			else
 			{
@@ -217,6 +242,46 @@ namespace PoDoFo
 
 		}
 
+		void PdfTranslator::freeSourceObject ( PdfObject * obj )
+		{
+			// Objects merged from several source files are not backed by a parser
+			if ( dynamic_cast<PdfParserObject*> ( obj ) )
+				sourceDoc->FreeObjectMemory ( obj, true );
+		}
+
+		PdfObject* PdfTranslator::findDuplicateStream ( PdfObject * obj )
+		{
+			std::string dict;
+			char *data ( 0 );
+			pdf_long len ( 0 );
+			obj->ToString ( dict );
+			obj->GetStream()->GetCopy ( &data, &len );
+
+			pdf_uint64 hash ( hashBuffer ( dict.data(), dict.size(), 14695981039346656037ULL ) );
+			hash = hashBuffer ( data, len, hash );
+
+			std::vector<PdfObject*> & candidates ( streamHashes[hash] );
+			PdfObject *ret ( 0 );
+			for ( std::vector<PdfObject*>::const_iterator it = candidates.begin(); it != candidates.end() && !ret; ++it )
+			{
+				std::string cdict;
+				char *cdata ( 0 );
+				pdf_long clen ( 0 );
+				( *it )->ToString ( cdict );
+				( *it )->GetStream()->GetCopy ( &cdata, &clen );
+				if ( cdict == dict && clen == len && !memcmp ( cdata, data, len ) )
+					ret = *it;
+				free ( cdata );
+			}
+			free ( data );
+
+			if ( ret )
+				++duplicateStreams;
+			else
+				candidates.push_back ( obj );
+			return ret;
+		}
+
 		PdfObject* PdfTranslator::getInheritedResources ( PdfPage* page )
 		{
 // 			std::cerr<<"PdfTranslator::getInheritedResources"<<std::endl;
@@ -244,15 +309,19 @@ namespace PoDoFo
 			targetDoc = new PdfMemDocument;
 			outFilePath  = target;
 
+			// Page contents are only collected here, decoding and compressing
+			// them into the xobjects is done on all processors at once below.
+			PdfStreamCompressor compressor ( threads );
+
 			for ( int i = 0; i < pcount ; ++i )
 			{
 				PdfPage * page = sourceDoc->GetPage ( i );
-				PdfMemoryOutputStream outMemStream ( 1 );
 
 				PdfXObject *xobj = new PdfXObject ( page->GetMediaBox(), targetDoc );
 				if ( page->GetContents()->HasStream() )
 				{
-					page->GetContents()->GetStream()->GetFilteredCopy ( &outMemStream );
+					compressor.AddStream ( xobj->GetContents(), page->GetContents() );
+					freeSourceObject ( page->GetContents() );
 				}
 				else if ( page->GetContents()->IsArray() )
 				{
@@ -261,7 +330,7 @@ namespace PoDoFo
 					{
 						if ( carray[ci].HasStream() )
 						{
-							carray[ci].GetStream()->GetFilteredCopy ( &outMemStream );
+							compressor.AddStream ( xobj->GetContents(), &carray[ci] );
 						}
 						else if ( carray[ci].IsReference() )
 						{
@@ -275,9 +344,12 @@ namespace PoDoFo
 								}
 								else if ( co->HasStream() )
 								{
-									co->GetStream()->GetFilteredCopy ( &outMemStream );
+									compressor.AddStream ( xobj->GetContents(), co );
+									freeSourceObject ( co );
 									break;
 								}
+								else
+									break;
 							}
 
 						}
@@ -298,11 +370,6 @@ namespace PoDoFo
 					}
 				}
 
-				outMemStream.Close();
-
-				PdfMemoryInputStream inStream ( outMemStream.TakeBuffer(),outMemStream.GetLength() );
-				xobj->GetContents()->GetStream()->Set ( &inStream );
-
 				resources[i+1] = getInheritedResources ( page );
 				xobjects[i+1] = xobj;
 				cropRect[i+1] = page->GetCropBox();
@@ -312,6 +379,11 @@ namespace PoDoFo
 
 			}
 
+			compressor.Run();
+			std::cerr << "Compressed " << compressor.GetInputLength() << " bytes of page contents to "
+			          << compressor.GetOutputLength() << " bytes using "
+			          << compressor.GetThreadCount() << " thread(s)" << std::endl;
+
 
 			targetDoc->SetPdfVersion ( sourceDoc->GetPdfVersion() );
 
@@ -492,6 +564,8 @@ namespace PoDoFo
 				++git;
 			}
 
+			if ( duplicateStreams )
+				std::cerr << "Merged " << duplicateStreams << " duplicate resource stream(s)" << std::endl;
 			targetDoc->Write ( outFilePath.c_str() );
 
 		}
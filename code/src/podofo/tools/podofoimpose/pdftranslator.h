@@ -117,6 +117,8 @@ class PdfTranslator
 		PdfObject* getInheritedResources ( PdfPage* page );
 		void mergeResKey ( PdfObject *base, PdfName key,  PdfObject *tomerge );
 		PdfObject* migrateResource(PdfObject * obj);
+		PdfObject* findDuplicateStream ( PdfObject * obj );
+		void freeSourceObject ( PdfObject * obj );
 		void drawLine ( double x, double y, double xx, double yy, std::ostringstream & a );
 		void signature ( double x , double y, int sheet, const std::vector<int> & pages, std::ostringstream & a );
 		
@@ -131,8 +133,14 @@ class PdfTranslator
 		std::vector<std::string> multiSource;
 		
 		std::map<std::string, PdfObject*> migrateMap;
+		/// Migrated stream objects by a hash of their dictionary and data,
+		/// so that resources shared by several source files are copied once.
+		std::map<pdf_uint64, std::vector<PdfObject*> > streamHashes;
+		int duplicateStreams;
 	public:
 		int pcount;
+		/// Number of threads used to compress page contents, 0 for one per processor
+		unsigned int threads;
 		double sourceWidth;
 		double sourceHeight;
 		double destWidth;
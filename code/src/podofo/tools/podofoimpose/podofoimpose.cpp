@@ -25,6 +25,12 @@
 #include <string>
 #include <cstdio>
 
+#ifdef _WIN32
+#include <ctime>
+#else
+#include <sys/time.h>
+#endif
+
 using std::cerr;
 using std::endl;
 using std::strtod;
@@ -37,12 +43,33 @@ struct _params
 	string outFilePath;
 	string planFilePath;
 	PoDoFo::Impose::PlanReader planReader;
+	unsigned int threads;
 } params;
 
+/// Wall clock time in seconds
+double timeNow()
+{
+#ifdef _WIN32
+	return static_cast<double> ( clock() ) / CLOCKS_PER_SEC;
+#else
+	struct timeval tv;
+	gettimeofday ( &tv, NULL );
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+void reportTime ( const char * phase, double & start )
+{
+	double now ( timeNow() );
+	cerr << phase << " : " << ( now - start ) << " s" << endl;
+	start = now;
+}
+
 void usage()
 {
-	cerr << "Usage : " << params.executablePath << " Input Output Plan [Interpretor]" << endl;
+	cerr << "Usage : " << params.executablePath << " [-j Threads] Input Output Plan [Interpretor]" << endl;
 	cerr << "***" << endl;
+	cerr << "\t-j Threads is the number of threads compressing page contents, default is one per processor" << endl<< endl;
 	cerr << "\tInput is a PDF file or a file which contains a list of PDF file paths" << endl<< endl;
 	cerr << "\tOutput will be a PDF file" << endl<< endl;
 	cerr << "\tPlan is an imposition plan file" <<endl<< endl;
@@ -53,6 +80,14 @@ void usage()
 int parseCommandLine ( int argc, char* argv[] )
 {
 	params.executablePath = argv[0];
+	params.threads = 0;
+
+	if ( argc > 2 && !string ( argv[1] ).compare ( "-j" ) )
+	{
+		params.threads = static_cast<unsigned int> ( std::atoi ( argv[2] ) );
+		argv += 2;
+		argc -= 2;
+	}
 
 	if ( argc <  4 )
 	{
@@ -103,12 +138,18 @@ int main ( int argc, char *argv[] )
 	try
 	{
 		PoDoFo::Impose::PdfTranslator *translator = new  PoDoFo::Impose::PdfTranslator;
+		translator->threads = params.threads;
 
+		double start ( timeNow() );
 		translator->setSource ( params.inFilePath );
+		reportTime ( "Read", start );
 		translator->setTarget ( params.outFilePath );
+		reportTime ( "Copy pages", start );
 		translator->loadPlan ( params.planFilePath, params.planReader );
+		reportTime ( "Load plan", start );
 
 		translator->impose();
+		reportTime ( "Impose and write", start );
 	}
 	catch ( PoDoFo::PdfError & e )
 	{
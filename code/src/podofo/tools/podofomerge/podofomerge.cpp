@@ -21,8 +21,15 @@
 #include <podofo.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <cstdio>
 
+#ifdef _WIN32
+#include <time.h>
+#else
+#include <sys/time.h>
+#endif
+
 using namespace PoDoFo;
 
 #ifdef _HAVE_CONFIG
@@ -31,16 +38,67 @@ using namespace PoDoFo;
 
 void print_help()
 {
-  printf("Usage: podofomerge [inputfile1] [inputfile2] [outputfile]\n\n");
+  printf("Usage: podofomerge [-c] [-j threads] [inputfile1] [inputfile2] [outputfile]\n\n");
+  printf("       -c          flate compress all streams which are not compressed yet\n");
+  printf("       -j threads  number of threads used by -c, default is one per processor\n");
   printf("\nPoDoFo Version: %s\n\n", PODOFO_VERSION_STRING);
 }
 
-void merge( const char* pszInput1, const char* pszInput2, const char* pszOutput )
+/** Wall clock time in seconds
+ */
+static double get_time()
+{
+#ifdef _WIN32
+    return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+static void print_time( const char* pszPhase, double & dStart )
+{
+    double dNow = get_time();
+    printf("%s took %.3f seconds.\n", pszPhase, dNow - dStart );
+    dStart = dNow;
+}
+
+/** Flate compress all streams of the document which have no filter
+ *  on all threads of a PdfStreamCompressor.
+ */
+void compress( PdfMemDocument & doc, unsigned int nThreads )
 {
+    PdfStreamCompressor compressor( nThreads );
+
+    TIVecObjects it = doc.GetObjects().begin();
+    while( it != doc.GetObjects().end() )
+    {
+        PdfObject* pObj = *it++;
+        if( pObj->IsDictionary() && pObj->HasStream() &&
+            !pObj->GetDictionary().HasKey( PdfName::KeyFilter ) )
+        {
+            compressor.AddStream( pObj, pObj );
+        }
+    }
+
+    compressor.Run();
+    printf("Compressed %li bytes to %li bytes using %u thread(s).\n",
+           static_cast<long>(compressor.GetInputLength()),
+           static_cast<long>(compressor.GetOutputLength()),
+           compressor.GetThreadCount() );
+}
+
+void merge( const char* pszInput1, const char* pszInput2, const char* pszOutput,
+            bool bCompress, unsigned int nThreads )
+{
+    double dStart = get_time();
+
     printf("Reading file: %s\n", pszInput1 );
     PdfMemDocument input1( pszInput1 );
     printf("Reading file: %s\n", pszInput2 );
     PdfMemDocument input2( pszInput2 );
+    print_time( "Reading", dStart );
 
 // #define TEST_ONLY_SOME_PAGES
 #ifdef TEST_ONLY_SOME_PAGES
@@ -49,6 +107,13 @@ void merge( const char* pszInput1, const char* pszInput2, const char* pszOutput
     printf("Appending %i pages on a document with %i pages.\n", input2.GetPageCount(), input1.GetPageCount() );
     input1.Append( input2 );
 #endif
+    print_time( "Appending", dStart );
+
+    if( bCompress )
+    {
+        compress( input1, nThreads );
+        print_time( "Compressing", dStart );
+    }
 
     // we are going to bookmark the insertions
     // using destinations - also adding each as a NamedDest
@@ -73,6 +138,7 @@ void merge( const char* pszInput1, const char* pszInput2, const char* pszOutput
 
     printf("Writing file: %s\n", pszOutput );
     input1.Write( pszOutput );
+    print_time( "Writing", dStart );
 }
 
 int main( int argc, char* argv[] )
@@ -80,19 +146,34 @@ int main( int argc, char* argv[] )
   char*   pszInput1;
   char*   pszInput2;
   char*   pszOutput;
+  bool          bCompress = false;
+  unsigned int  nThreads  = 0;
+
+  int i = 1;
+  while( i < argc && argv[i][0] == '-' )
+  {
+    if( strcmp( argv[i], "-c" ) == 0 )
+      bCompress = true;
+    else if( strcmp( argv[i], "-j" ) == 0 && i + 1 < argc )
+      nThreads = static_cast<unsigned int>(atoi( argv[++i] ));
+    else
+      break;
+
+    ++i;
+  }
 
-  if( argc != 4 )
+  if( argc - i != 3 )
   {
     print_help();
     exit( -1 );
   }
 
-  pszInput1 = argv[1];
-  pszInput2 = argv[2];
-  pszOutput = argv[3];
+  pszInput1 = argv[i];
+  pszInput2 = argv[i+1];
+  pszOutput = argv[i+2];
 
   try {
-        merge( pszInput1, pszInput2, pszOutput );
+        merge( pszInput1, pszInput2, pszOutput, bCompress, nThreads );
   } catch( PdfError & e ) {
       fprintf( stderr, "Error %i occurred!\n", e.GetError() );
       e.PrintErrorMsg();
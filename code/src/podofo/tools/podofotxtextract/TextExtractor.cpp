@@ -21,8 +21,34 @@
 #include "TextExtractor.h"
 
 #include <stack>
+#include <string.h>
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/** Number of pages which are prepared and extracted at once.
+ *  The contents of these pages are kept in memory.
+ */
+#define PAGES_PER_BATCH 256
+
+/** A TJ offset below this value (in thousandths of
+ *  text space units) is treated as a space between words.
+ */
+#define TJ_SPACE_OFFSET -200.0
+
+/** The jobs handled by one worker thread
+ */
+struct TWorker {
+    std::vector<void*>* pJobs;
+    size_t              nFirst;
+    size_t              nStep;
+    bool                bWords;
+};
 
 TextExtractor::TextExtractor()
+    : m_nThreads( 0 ), m_nPages( 0 )
 {
 
 }
@@ -31,6 +57,16 @@ TextExtractor::~TextExtractor()
 {
 }
 
+void TextExtractor::SetThreadCount( unsigned int nThreads )
+{
+    m_nThreads = nThreads;
+}
+
+void TextExtractor::SetIndexFile( const char* pszIndex )
+{
+    m_sIndexFile = pszIndex ? pszIndex : "";
+}
+
 void TextExtractor::Init( const char* pszInput )
 {
     if( !pszInput )
@@ -38,141 +74,487 @@ void TextExtractor::Init( const char* pszInput )
         PODOFO_RAISE_ERROR( ePdfError_InvalidHandle );
     }
 
+    if( !m_nThreads )
+    {
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+        long lCpus = sysconf( _SC_NPROCESSORS_ONLN );
+        m_nThreads = lCpus > 0 ? static_cast<unsigned int>(lCpus) : 1;
+#else
+        m_nThreads = 1;
+#endif
+    }
+
+#if !defined(PODOFO_MULTI_THREAD) || defined(_WIN32)
+    m_nThreads = 1;
+#endif
+
     PdfMemDocument document( pszInput );
 
+    m_nPages = 0;
+    m_mapFonts.clear();
+    m_mapIndex.clear();
+
     int nCount = document.GetPageCount();
-    for( int i=0; i<nCount; i++ ) 
+    std::vector<TPageJob*> vecJobs;
+    for( int nFirst=0; nFirst<nCount; nFirst += PAGES_PER_BATCH )
     {
-        PdfPage* pPage = document.GetPage( i );
-        
-        this->ExtractText( &document, pPage );
+        int nLast = PDF_MIN( nFirst + PAGES_PER_BATCH, nCount );
+        try {
+            for( int i=nFirst; i<nLast; i++ ) 
+            {
+                PdfPage* pPage = document.GetPage( i );
+
+                vecJobs.push_back( new TPageJob() );
+                this->PrepareJob( &document, pPage, vecJobs.back() );
+            }
+
+            this->RunJobs( vecJobs );
+        } catch( PdfError & e ) {
+            for( size_t i=0;i<vecJobs.size();i++ )
+                DeleteJob( vecJobs[i] );
+
+            e.AddToCallstack( __FILE__, __LINE__ );
+            throw e;
+        }
+
+        this->WriteJobs( vecJobs, nFirst );
     }
+
+    if( !m_sIndexFile.empty() )
+        this->WriteIndex();
 }
 
-void TextExtractor::ExtractText( PdfMemDocument* pDocument, PdfPage* pPage ) 
+void TextExtractor::PrepareJob( PdfMemDocument* pDocument, PdfPage* pPage, TPageJob* pJob )
 {
-    const char*      pszToken = NULL;
-    PdfVariant       var;
-    EPdfContentsType eType;
+    pJob->eError = ePdfError_ErrOk;
+
+    // Collect the contents streams just like PdfContentsTokenizer does
+    std::vector<PdfObject*> vecContents;
+    PdfObject* pContents = pPage->GetContents();
+    if( pContents && pContents->IsArray()  )
+    {
+        PdfArray& a = pContents->GetArray();
+        for ( PdfArray::iterator it = a.begin(); it != a.end() ; ++it )
+        {
+            if ( !(*it).IsReference() )
+            {
+                PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDataType, "/Contents array contained non-references" );
+            }
 
-    PdfContentsTokenizer tokenizer( pPage );
+            PdfObject* pStream = pDocument->GetObjects().GetObject( (*it).GetReference() );
+            if( pStream && pStream->HasStream() )
+                vecContents.push_back( pStream );
+        }
+    }
+    else if ( pContents && pContents->HasStream() )
+    {
+        vecContents.push_back( pContents );
+    }
+    else if ( !pContents || !pContents->IsDictionary() )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDataType, "Page /Contents not stream or array of streams" );
+    }
 
-    double dCurPosX     = 0.0;
-    double dCurPosY     = 0.0;
-    double dCurFontSize = 0.0;
-    bool   bTextBlock   = false;
-    PdfFont* pCurFont   = NULL;
+    for( size_t i=0; i<vecContents.size(); i++ )
+    {
+        TContents* pData = new TContents();
+        pData->pData = NULL;
+        pData->lLen  = 0;
+        pJob->contents.push_back( pData );
 
-    std::stack<PdfVariant> stack;
+        vecContents[i]->GetStream()->GetCopy( &pData->pData, &pData->lLen );
+        pData->filters    = PdfFilterFactory::CreateFilterList( vecContents[i] );
+        pData->dictionary = vecContents[i]->GetDictionary();
+    }
 
-    while( tokenizer.ReadNext( eType, pszToken, var ) )
+    // Resolve all fonts of the page, as the
+    // worker threads must not access the document
+    PdfObject* pResources = pPage->GetResources();
+    PdfObject* pFonts     = pResources ? pResources->GetIndirectKey( "Font" ) : NULL;
+    if( pFonts && pFonts->IsDictionary() )
     {
-        if( eType == ePdfContentsType_Keyword )
+        TCIKeyMap itKeys = pFonts->GetDictionary().GetKeys().begin();
+        while( itKeys != pFonts->GetDictionary().GetKeys().end() )
         {
-            // support 'l' and 'm' tokens
-            if( strcmp( pszToken, "l" ) == 0 || 
-                strcmp( pszToken, "m" ) == 0 )
-            {
-                dCurPosX = stack.top().GetReal();
-                stack.pop();
-                dCurPosY = stack.top().GetReal();
-                stack.pop();
-            }
-            else if( strcmp( pszToken, "BT" ) == 0 ) 
+            PdfObject* pFont = (*itKeys).second;
+            if( pFont->IsReference() )
+                pFont = pDocument->GetObjects().GetObject( pFont->GetReference() );
+
+            if( pFont ) 
+                pJob->fonts[(*itKeys).first] = this->GetFont( pDocument, pFont );
+
+            ++itKeys;
+        }
+    }
+}
+
+const PdfFont* TextExtractor::GetFont( PdfMemDocument* pDocument, PdfObject* pFontObject )
+{
+    const PdfReference & ref = pFontObject->Reference();
+    if( ref.ObjectNumber() )
+    {
+        std::map<PdfReference,const PdfFont*>::const_iterator it = m_mapFonts.find( ref );
+        if( it != m_mapFonts.end() )
+            return (*it).second;
+    }
+
+    PdfFont* pFont = NULL;
+    try {
+        pFont = pDocument->GetFont( pFontObject );
+    } catch( const PdfError & e ) {
+        pFont = NULL;
+    }
+
+    if( !pFont ) 
+    {
+        fprintf( stderr, "WARNING: Unable to create font for object %i %i R\n",
+                 ref.ObjectNumber(), ref.GenerationNumber() );
+    }
+    else if( pFont->GetEncoding() )
+    {
+        // Some encodings initialize their tables when they are used
+        // for the first time. Do this now, so that the encoding is
+        // only read by the worker threads.
+        char szAll[256];
+        for( int i=0; i<255; i++ )
+            szAll[i] = static_cast<char>(i + 1);
+
+        try {
+            pFont->GetEncoding()->ConvertToUnicode( PdfString( szAll, 255 ), pFont );
+        } catch( const PdfError & e ) {
+            // Errors are reported again when text is converted
+        }
+    }
+
+    if( ref.ObjectNumber() )
+        m_mapFonts[ref] = pFont;
+
+    return pFont;
+}
+
+void TextExtractor::RunJobs( std::vector<TPageJob*> & rJobs )
+{
+    std::vector<void*> vecJobs( rJobs.begin(), rJobs.end() );
+    size_t             nThreads = PDF_MAX( PDF_MIN( static_cast<size_t>(m_nThreads), rJobs.size() ), static_cast<size_t>(1) );
+    std::vector<TWorker> vecWorkers( nThreads );
+
+    // Pages are distributed interleaved, so that
+    // large and small pages are spread over all threads
+    for( size_t i=0; i<nThreads; i++ )
+    {
+        vecWorkers[i].pJobs  = &vecJobs;
+        vecWorkers[i].nFirst = i;
+        vecWorkers[i].nStep  = nThreads;
+        vecWorkers[i].bWords = !m_sIndexFile.empty();
+    }
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+    // The calling thread is a worker, too
+    std::vector<pthread_t> vecThreads;
+    for( size_t i=1; i<nThreads; i++ )
+    {
+        pthread_t thread;
+        if( pthread_create( &thread, NULL, &TextExtractor::WorkerThread, &vecWorkers[i] ) == 0 )
+            vecThreads.push_back( thread );
+        else
+            // Do the work of this thread on the calling thread
+            TextExtractor::WorkerThread( &vecWorkers[i] );
+    }
+
+    TextExtractor::WorkerThread( &vecWorkers[0] );
+
+    for( size_t i=0; i<vecThreads.size(); i++ )
+        pthread_join( vecThreads[i], NULL );
+#else
+    for( size_t i=0; i<rJobs.size(); i++ )
+        ExtractText( rJobs[i], vecWorkers[0].bWords );
+#endif
+}
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+void* TextExtractor::WorkerThread( void* pData )
+{
+    TWorker* pWorker = static_cast<TWorker*>(pData);
+    for( size_t i=pWorker->nFirst; i<pWorker->pJobs->size(); i += pWorker->nStep )
+        ExtractText( static_cast<TPageJob*>((*pWorker->pJobs)[i]), pWorker->bWords );
+
+    return NULL;
+}
+#endif
+
+void TextExtractor::WriteJobs( std::vector<TPageJob*> & rJobs, int nFirstPage )
+{
+    EPdfError eError = ePdfError_ErrOk;
+    int       nPage  = nFirstPage;
+    for( size_t i=0; i<rJobs.size(); i++ )
+    {
+        TPageJob* pJob = rJobs[i];
+        ++nPage;
+
+        if( eError == ePdfError_ErrOk )
+        {
+            fputs( pJob->sWarnings.c_str(), stderr );
+
+            if( pJob->eError != ePdfError_ErrOk )
             {
-                bTextBlock   = true;     
-                // BT does not reset font
-                // dCurFontSize = 0.0;
-                // pCurFont     = NULL;
+                fprintf( stderr, "Error: Cannot extract text from page %i.\n", nPage );
+                eError = pJob->eError;
             }
-            else if( strcmp( pszToken, "ET" ) == 0 ) 
+            else
             {
-                if( !bTextBlock ) 
-                    fprintf( stderr, "WARNING: Found ET without BT!\n" );
+                fwrite( pJob->sText.data(), 1, pJob->sText.length(), stdout );
+                ++m_nPages;
+
+                // Pages are written in ascending order,
+                // so the page lists stay sorted
+                TWordSet::const_iterator it = pJob->words.begin();
+                while( it != pJob->words.end() )
+                {
+                    m_mapIndex[*it].push_back( nPage );
+                    ++it;
+                }
             }
+        }
+
+        DeleteJob( pJob );
+    }
+
+    rJobs.clear();
+
+    if( eError != ePdfError_ErrOk )
+    {
+        PODOFO_RAISE_ERROR( eError );
+    }
+}
+
+void TextExtractor::WriteIndex()
+{
+    FILE* hFile = fopen( m_sIndexFile.c_str(), "wb" );
+    if( !hFile )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_FileNotFound, m_sIndexFile.c_str() );
+    }
+
+    std::map<std::string,std::vector<int> >::const_iterator it = m_mapIndex.begin();
+    while( it != m_mapIndex.end() )
+    {
+        fputs( (*it).first.c_str(), hFile );
+
+        int nLast = 0;
+        for( size_t i=0; i<(*it).second.size(); i++ )
+        {
+            fprintf( hFile, "%c%i", i ? ' ' : '\t', (*it).second[i] - nLast );
+            nLast = (*it).second[i];
+        }
+
+        fputc( '\n', hFile );
+        ++it;
+    }
+
+    if( fclose( hFile ) != 0 )
+    {
+        PODOFO_RAISE_ERROR_INFO( ePdfError_UnexpectedEOF, m_sIndexFile.c_str() );
+    }
+}
+
+void TextExtractor::DeleteJob( TPageJob* pJob )
+{
+    for( size_t i=0; i<pJob->contents.size(); i++ )
+    {
+        podofo_free( pJob->contents[i]->pData );
+        delete pJob->contents[i];
+    }
+
+    delete pJob;
+}
+
+void TextExtractor::ExtractText( TPageJob* pJob, bool bWords ) 
+{
+    try {
+        // Decode all contents streams into one buffer
+        std::string sContents;
+        char        buffer[65536];
+        for( size_t i=0; i<pJob->contents.size(); i++ )
+        {
+            TContents*             pData = pJob->contents[i];
+            PdfFilteredInputStream input( pData->pData, pData->lLen, pData->filters, &pData->dictionary );
+            pdf_long               lRead;
+            while( (lRead = input.Read( buffer, sizeof(buffer) )) > 0 )
+                sContents.append( buffer, lRead );
+
+            // Tokens must not span two streams
+            sContents.append( 1, '\n' );
+        }
+
+        const char*      pszToken = NULL;
+        PdfVariant       var;
+        EPdfContentsType eType;
+
+        PdfContentsTokenizer tokenizer( sContents.data(), static_cast<long>(sContents.length()) );
+
+        double dCurPosX       = 0.0;
+        double dCurPosY       = 0.0;
+        bool   bTextBlock     = false;
+        const PdfFont* pCurFont = NULL;
+        std::string    sUtf8;
+
+        std::stack<PdfVariant> stack;
 
-            if( bTextBlock ) 
+        while( tokenizer.ReadNext( eType, pszToken, var ) )
+        {
+            if( eType == ePdfContentsType_Keyword )
             {
-                if( strcmp( pszToken, "Tf" ) == 0 ) 
+                // support 'l' and 'm' tokens
+                if( strcmp( pszToken, "l" ) == 0 || 
+                    strcmp( pszToken, "m" ) == 0 )
                 {
-                    dCurFontSize = stack.top().GetReal();
-                    stack.pop();
-                    PdfName fontName = stack.top().GetName();
-                    PdfObject* pFont = pPage->GetFromResources( PdfName("Font"), fontName );
-                    if( !pFont ) 
-                    {
-                        PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidHandle, "Cannot create font!" );
-                    }
-
-                    pCurFont = pDocument->GetFont( pFont );
-                    if( !pCurFont ) 
+                    if( stack.size() >= 2 )
                     {
-                        fprintf( stderr, "WARNING: Unable to create font for object %i %i R\n",
-                                 pFont->Reference().ObjectNumber(),
-                                 pFont->Reference().GenerationNumber() );
+                        dCurPosX = stack.top().GetReal();
+                        stack.pop();
+                        dCurPosY = stack.top().GetReal();
+                        stack.pop();
                     }
                 }
-                else if( strcmp( pszToken, "Tj" ) == 0 ||
-                         strcmp( pszToken, "'" ) == 0 ) 
+                else if( strcmp( pszToken, "BT" ) == 0 ) 
                 {
-                    AddTextElement( dCurPosX, dCurPosY, pCurFont, stack.top().GetString() );
-                    stack.pop();
+                    bTextBlock   = true;     
+                    // BT does not reset font
+                    // pCurFont     = NULL;
                 }
-                else if( strcmp( pszToken, "\"" ) == 0 )
+                else if( strcmp( pszToken, "ET" ) == 0 ) 
                 {
-                    AddTextElement( dCurPosX, dCurPosY, pCurFont, stack.top().GetString() );
-                    stack.pop();
-                    stack.pop(); // remove char spacing from stack
-                    stack.pop(); // remove word spacing from stack
+                    if( !bTextBlock ) 
+                        pJob->sWarnings += "WARNING: Found ET without BT!\n";
                 }
-                else if( strcmp( pszToken, "TJ" ) == 0 ) 
+
+                if( bTextBlock && !stack.empty() ) 
                 {
-                    PdfArray array = stack.top().GetArray();
-                    stack.pop();
-                    
-                    for( int i=0; i<static_cast<int>(array.GetSize()); i++ ) 
+                    if( strcmp( pszToken, "Tf" ) == 0 ) 
+                    {
+                        stack.pop();
+                        if( stack.empty() || !stack.top().IsName() )
+                        {
+                            PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidDataType, "Tf without a font name!" );
+                        }
+
+                        TFontMap::const_iterator it = pJob->fonts.find( stack.top().GetName() );
+                        if( it == pJob->fonts.end() ) 
+                        {
+                            PODOFO_RAISE_ERROR_INFO( ePdfError_InvalidHandle, "Cannot create font!" );
+                        }
+
+                        pCurFont = (*it).second;
+                    }
+                    else if( strcmp( pszToken, "Tj" ) == 0 ||
+                             strcmp( pszToken, "'" ) == 0 ||
+                             strcmp( pszToken, "\"" ) == 0 ) 
+                    {
+                        // For '"' the char and word spacing are
+                        // below the string on the stack
+                        if( stack.top().IsString() || stack.top().IsHexString() )
+                        {
+                            sUtf8.clear();
+                            ConvertToUtf8( pJob, pCurFont, stack.top().GetString(), sUtf8 );
+                            AddTextElement( pJob, bWords, dCurPosX, dCurPosY, sUtf8 );
+                        }
+                    }
+                    else if( strcmp( pszToken, "TJ" ) == 0 && stack.top().IsArray() ) 
                     {
-                        if( array[i].IsString() )
-                            AddTextElement( dCurPosX, dCurPosY, pCurFont, array[i].GetString() );
+                        // All strings of the array are one text element,
+                        // large offsets between them separate words
+                        const PdfArray & array = stack.top().GetArray();
+                        sUtf8.clear();
+                        for( int i=0; i<static_cast<int>(array.GetSize()); i++ ) 
+                        {
+                            if( array[i].IsString() || array[i].IsHexString() )
+                                ConvertToUtf8( pJob, pCurFont, array[i].GetString(), sUtf8 );
+                            else if( array[i].IsNumber() || array[i].IsReal() )
+                            {
+                                if( array[i].GetReal() < TJ_SPACE_OFFSET && !sUtf8.empty() && 
+                                    sUtf8[sUtf8.length() - 1] != ' ' )
+                                    sUtf8.append( 1, ' ' );
+                            }
+                        }
+
+                        AddTextElement( pJob, bWords, dCurPosX, dCurPosY, sUtf8 );
                     }
                 }
+
+                // All operands belong to this operator
+                while( !stack.empty() )
+                    stack.pop();
+            }
+            else if ( eType == ePdfContentsType_Variant )
+            {
+                stack.push( var );
+            }
+            else if ( eType != ePdfContentsType_ImageData )
+            {
+                // Impossible; type must be keyword or variant
+                PODOFO_RAISE_ERROR( ePdfError_InternalLogic );
             }
         }
-        else if ( eType == ePdfContentsType_Variant )
-        {
-            stack.push( var );
-        }
-        else
-        {
-            // Impossible; type must be keyword or variant
-            PODOFO_RAISE_ERROR( ePdfError_InternalLogic );
-        }
+
+        pJob->sText.append( 1, '\f' );
+    } catch( const PdfError & e ) {
+        pJob->eError = e.GetError();
     }
 }
 
-void TextExtractor::AddTextElement( double dCurPosX, double dCurPosY, 
-                                    PdfFont* pCurFont, const PdfString & rString )
+void TextExtractor::ConvertToUtf8( TPageJob* pJob, const PdfFont* pCurFont, 
+                                   const PdfString & rString, std::string & rsUtf8 )
 {
     if( !pCurFont ) 
     {
-        fprintf( stderr, "WARNING: Found text but do not have a current font: %s\n", rString.GetString() );
+        pJob->sWarnings += "WARNING: Found text but do not have a current font: ";
+        pJob->sWarnings += rString.GetString();
+        pJob->sWarnings += "\n";
         return;
     }
 
     if( !pCurFont->GetEncoding() ) 
     {
-        fprintf( stderr, "WARNING: Found text but do not have a current encoding: %s\n", rString.GetString() );
+        pJob->sWarnings += "WARNING: Found text but do not have a current encoding: ";
+        pJob->sWarnings += rString.GetString();
+        pJob->sWarnings += "\n";
         return;
     }
 
-    // For now just write to console
     PdfString unicode = pCurFont->GetEncoding()->ConvertToUnicode( rString, pCurFont );
-    const char* pszData = unicode.GetStringUtf8().c_str();
-    while( *pszData ) {
-        printf("%02x", static_cast<unsigned char>(*pszData) );
-        ++pszData;
-    }
-    printf("\n");
+    rsUtf8 += unicode.GetStringUtf8();
+}
 
-    printf("(%.3f,%.3f) %s \n", dCurPosX, dCurPosY, unicode.GetStringUtf8().c_str() );
+void TextExtractor::AddTextElement( TPageJob* pJob, bool bWords, double dCurPosX, double dCurPosY, 
+                                    const std::string & sUtf8 )
+{
+    if( sUtf8.empty() )
+        return;
+
+    char szPos[64];
+    snprintf( szPos, sizeof(szPos), "(%.3f,%.3f) ", dCurPosX, dCurPosY );
+    pJob->sText += szPos;
+    pJob->sText += sUtf8;
+    pJob->sText += "\n";
+
+    if( !bWords )
+        return;
+
+    // Split at ASCII whitespace and punctuation, all
+    // other characters are part of a word
+    std::string sWord;
+    for( size_t i=0; i<=sUtf8.length(); i++ )
+    {
+        unsigned char c = i < sUtf8.length() ? static_cast<unsigned char>(sUtf8[i]) : 0;
+        if( c >= 0x80 || 
+            (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') )
+            sWord += static_cast<char>(c);
+        else if( c >= 'A' && c <= 'Z' )
+            sWord += static_cast<char>(c - 'A' + 'a');
+        else if( !sWord.empty() )
+        {
+            pJob->words.insert( sWord );
+            sWord.clear();
+        }
+    }
 }
@@ -23,6 +23,10 @@
 
 #include <podofo.h>
 #include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 using namespace PoDoFo;
 
@@ -33,35 +37,143 @@ using namespace PoDoFo;
 /** This class uses the PoDoFo lib to parse 
  *  a PDF file and to write all text it finds
  *  in this PDF document to stdout.
+ *
+ *  Pages are extracted on several threads. All access to the
+ *  document happens on the calling thread: it copies the contents
+ *  streams of a page and resolves its fonts using a cache keyed by
+ *  the font's object reference. The worker threads only decode and
+ *  tokenize this copy. The text is written as UTF-8 in page order,
+ *  each page is terminated by a form feed.
  */
 class TextExtractor {
  public:
     TextExtractor();
     virtual ~TextExtractor();
 
+    /** Set the number of threads extracting text.
+     *
+     *  \param nThreads number of threads, 0 uses one
+     *                  thread per available processor
+     */
+    void SetThreadCount( unsigned int nThreads );
+
+    /** Write an index of all words to a file in addition to the text.
+     *
+     *  Each line of the index contains a word in lower case, a tab
+     *  and the numbers of all pages containing the word separated by
+     *  spaces. The first page number is absolute, all following
+     *  numbers are the difference to the previous page number.
+     *  Lines are sorted by word.
+     *
+     *  \param pszIndex path of the index file or NULL to write no index
+     */
+    void SetIndexFile( const char* pszIndex );
+
     void Init( const char* pszInput );
 
+    /** \returns the number of pages extracted by Init()
+     */
+    inline int GetPageCount() const { return m_nPages; }
+
+    /** \returns the number of threads used by Init()
+     */
+    inline unsigned int GetThreadCount() const { return m_nThreads; }
+
  private:
-    /** Extract all text from the given page
+    /** Encoded data of one contents stream
+     */
+    struct TContents {
+        char*         pData;
+        pdf_long      lLen;
+        TVecFilters   filters;
+        PdfDictionary dictionary;
+    };
+
+    typedef std::map<PdfName,const PdfFont*> TFontMap;
+    typedef std::set<std::string>            TWordSet;
+
+    /** Everything needed to extract the text of one page
+     *  without accessing the document, and the results.
+     */
+    struct TPageJob {
+        std::vector<TContents*> contents;
+        TFontMap                fonts;      ///< font resources of the page
+
+        std::string             sText;
+        std::string             sWarnings;
+        TWordSet                words;
+        EPdfError               eError;
+    };
+
+    /** Copy the contents streams of a page and look up its fonts.
      *
      *  \param pDocument the owning document
-     *  \param pPage extract the text of this page.
+     *  \param pPage prepare this page
+     *  \param pJob the job to initialize
      */
-    void ExtractText( PdfMemDocument* pDocument, PdfPage* pPage );
+    void PrepareJob( PdfMemDocument* pDocument, PdfPage* pPage, TPageJob* pJob );
 
-    /** Adds a text string to a list which can be sorted by 
-     *  position on the page later, so that the whole structure 
-     *  of the text including formatting can be reconstructed.
+    /** Get a font from the font cache or create it.
      *
+     *  \param pDocument the owning document
+     *  \param pFontObject a font dictionary
+     *  \returns the font or NULL if it cannot be created
+     */
+    const PdfFont* GetFont( PdfMemDocument* pDocument, PdfObject* pFontObject );
+
+    /** Extract text of all jobs using all threads
+     */
+    void RunJobs( std::vector<TPageJob*> & rJobs );
+
+    /** Write the results of the jobs in order and delete them
+     */
+    void WriteJobs( std::vector<TPageJob*> & rJobs, int nFirstPage );
+
+    void WriteIndex();
+
+    /** Extract all text from the given page
+     *
+     *  \param pJob a prepared page, the results are stored in it
+     *  \param bWords also collect all words of the page
+     */
+    static void ExtractText( TPageJob* pJob, bool bWords );
+
+    /** Adds a text string to the text of a page.
+     *
+     *  \param pJob the page containing the text
+     *  \param bWords also add the words of the text to the page
      *  \param dCurPosX x position of the text
      *  \param dCurPosY y position of the text
+     *  \param sUtf8 the actual string
+     */
+    static void AddTextElement( TPageJob* pJob, bool bWords, double dCurPosX, double dCurPosY, 
+                                const std::string & sUtf8 );
+
+    /** Convert a string to UTF-8 using the encoding of a font
+     *
+     *  \param pJob warnings are added to this page
      *  \param pCurFont font of the text
-     *  \param rString the actual string
+     *  \param rString the encoded string
+     *  \param rsUtf8 the converted string is appended here
      */
-    void AddTextElement( double dCurPosX, double dCurPosY, 
-                         PdfFont* pCurFont, const PdfString & rString );
+    static void ConvertToUtf8( TPageJob* pJob, const PdfFont* pCurFont, 
+                               const PdfString & rString, std::string & rsUtf8 );
+
+    static void DeleteJob( TPageJob* pJob );
+
+#if defined(PODOFO_MULTI_THREAD) && !defined(_WIN32)
+    static void* WorkerThread( void* pData );
+#endif
+
  private:
     char         m_szBuffer[MAX_PATH];
+
+    unsigned int m_nThreads;
+    int          m_nPages;
+    std::string  m_sIndexFile;
+
+    std::map<PdfReference,const PdfFont*>    m_mapFonts;  ///< fonts by object reference
+    std::map<std::string,std::vector<int> >  m_mapIndex;  ///< pages by word
 };
 
 #endif // _TEXT_EXTRACTOR_H_
@@ -22,24 +22,65 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <cstdio>
 
+#ifdef _WIN32
+#include <time.h>
+#else
+#include <sys/time.h>
+#endif
+
 #ifdef _HAVE_CONFIG
 #include <config.h>
 #endif // _HAVE_CONFIG
 
 void print_help()
 {
-  printf("Usage: podofotxtextract [inputfile]\n\n");
+  printf("Usage: podofotxtextract [-j threads] [-i indexfile] [inputfile]\n\n");
+  printf("       -j threads    number of threads extracting pages, default is one per processor\n");
+  printf("       -i indexfile  also write an index of all words to indexfile.\n");
+  printf("                     Each line contains a word, a tab and the numbers of all\n");
+  printf("                     pages containing the word. The first number is a page\n");
+  printf("                     number, each following number is the difference to the\n");
+  printf("                     previous one.\n\n");
+  printf("The text is written to stdout as UTF-8, each page ends with a form feed.\n");
   printf("\nPoDoFo Version: %s\n\n", PODOFO_VERSION_STRING);
 }
 
+/** Wall clock time in seconds
+ */
+static double get_time()
+{
+#ifdef _WIN32
+    return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
 int main( int argc, char* argv[] )
 {
   char*    pszInput;
+  char*    pszIndex = NULL;
 
   TextExtractor extractor;
 
+  while( argc > 3 && argv[1][0] == '-' )
+  {
+    if( strcmp( argv[1], "-j" ) == 0 )
+      extractor.SetThreadCount( static_cast<unsigned int>(atoi( argv[2] )) );
+    else if( strcmp( argv[1], "-i" ) == 0 )
+      pszIndex = argv[2];
+    else
+      break;
+
+    argv += 2;
+    argc -= 2;
+  }
+
   if( argc != 2 )
   {
     print_help();
@@ -47,9 +88,17 @@ int main( int argc, char* argv[] )
   }
 
   pszInput  = argv[1];
+  extractor.SetIndexFile( pszIndex );
 
   try {
+      double dStart = get_time();
       extractor.Init( pszInput );
+
+      double dTime = get_time() - dStart;
+      fprintf( stderr, "Extracted %i pages in %.3f seconds (%.1f pages/s) using %u thread(s).\n",
+               extractor.GetPageCount(), dTime, 
+               dTime > 0.0 ? extractor.GetPageCount() / dTime : 0.0,
+               extractor.GetThreadCount() );
   } catch( PdfError & e ) {
       fprintf( stderr, "Error: An error %i ocurred during processing the pdf file.\n", e.GetError() );
       e.PrintErrorMsg();